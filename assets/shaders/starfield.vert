@@ -1,6 +1,7 @@
-layout(location=0) in vec3 position;
-layout(location=1) in vec2 offs;
-layout(location=2) in vec4 color;
+// one instance per star, see StarInstance
+layout(location=0) in vec2 direction; // octahedral
+layout(location=1) in float magnitude; // normalized over [-2, 20]
+layout(location=2) in uint spectralClass;
 
 uniform mat4 mvp;
 uniform float aspectRatio;
@@ -8,13 +9,47 @@ uniform float aspectRatio;
 out vec4 vs_color;
 out vec2 vs_texCoord;
 
+const float kMinMagnitude = -2.0;
+const float kMaxMagnitude = 20.0;
+const float kMinRadius = 0.04;
+const float kMaxRadius = 0.16;
+
+const vec3 kTints[7] = vec3[](
+    vec3(155.0, 176.0, 255.0), // O, blue
+    vec3(170.0, 191.0, 255.0), // B, blue-white
+    vec3(202.0, 215.0, 255.0), // A, white
+    vec3(248.0, 247.0, 255.0), // F, yellow-white
+    vec3(255.0, 244.0, 234.0), // G, yellow
+    vec3(255.0, 210.0, 161.0), // K, orange
+    vec3(255.0, 204.0, 111.0)  // M, red
+);
+
+vec3 octahedralDecode(vec2 p)
+{
+    vec3 v = vec3(p, 1.0 - abs(p.x) - abs(p.y));
+    if (v.z < 0.0)
+        v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(v);
+}
+
 void main() {
-    vec4 centerClip = mvp * vec4(position, 1.0);
+    // triangle strip: (-, -), (-, +), (+, -), (+, +)
+    vec2 corner = vec2(gl_VertexID >> 1, gl_VertexID & 1) * 2.0 - 1.0;
+
+    float apparentMagnitude = clamp(mix(kMinMagnitude, kMaxMagnitude, magnitude), -1.5, 10.0);
+    float brightness = pow(10.0, -0.4 * apparentMagnitude);
+    float brightnessNorm = brightness / pow(10.0, -0.5 * -1.5);
+    float radius = mix(kMinRadius, kMaxRadius, brightnessNorm);
+    vec2 offs = radius * corner;
+
+    // a point at infinity, on the far plane
+    vec4 centerClip = mvp * vec4(octahedralDecode(direction), 0.0);
+    centerClip.z = 0.999999 * centerClip.w;
 
     vec2 offsetClip = offs;
     offsetClip.x /= aspectRatio;
 
-    vs_color = color;
+    vs_color = vec4(kTints[min(spectralClass, 6u)] / 255.0, 0.5);
     vs_texCoord = normalize(offs);
     gl_Position = centerClip + vec4(offsetClip * centerClip.w, 0.0, 0.0);
 }
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <chrono>
+
+using Seconds = std::chrono::duration<double, std::ratio<1>>;
@@ -2,6 +2,12 @@
 
 #include <memory>
 #include <cstdio>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 std::vector<std::byte> readFile(const std::string &path)
 {
@@ -16,3 +22,69 @@ std::vector<std::byte> readFile(const std::string &path)
         return {};
     return buffer;
 }
+
+bool writeFile(const std::string &path, std::span<const std::byte> data)
+{
+    const auto tempPath = path + ".tmp" + std::to_string(getpid());
+    {
+        auto stream = std::unique_ptr<FILE, decltype(&fclose)>(fopen(tempPath.c_str(), "wb"), &fclose);
+        if (!stream)
+            return false;
+        if (fwrite(data.data(), 1, data.size(), stream.get()) != data.size() || fflush(stream.get()) != 0)
+        {
+            stream.reset();
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+}
+
+MappedFile::MappedFile(const std::string &path)
+{
+    const auto fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        return;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        // the mapping stays valid after the descriptor is closed
+        auto *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            m_data = static_cast<const std::byte *>(data);
+            m_size = st.st_size;
+        }
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile &&other)
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other)
+{
+    if (this != &other)
+    {
+        unmap();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
+
+void MappedFile::unmap()
+{
+    if (m_data)
+        munmap(const_cast<std::byte *>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+}
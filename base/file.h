@@ -1,6 +1,34 @@
 #pragma once
 
+#include <span>
 #include <string>
 #include <vector>
 
 std::vector<std::byte> readFile(const std::string &path);
+
+// Writes to a temporary file next to `path` and renames it over `path`, so readers never see a partial file.
+bool writeFile(const std::string &path, std::span<const std::byte> data);
+
+// Read-only memory mapping of a whole file.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(MappedFile &&other);
+    MappedFile &operator=(MappedFile &&other);
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool isValid() const { return m_data != nullptr; }
+    std::span<const std::byte> data() const { return {m_data, m_size}; }
+
+private:
+    void unmap();
+
+    const std::byte *m_data{nullptr};
+    std::size_t m_size{0};
+};
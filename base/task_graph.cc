@@ -0,0 +1,61 @@
+#include "task_graph.h"
+
+#include "thread_pool.h"
+
+#include <cassert>
+
+TaskGraph::TaskId TaskGraph::add(Task task, std::initializer_list<TaskId> dependencies)
+{
+    const auto id = m_nodes.size();
+    for (const auto dependency : dependencies)
+    {
+        assert(dependency < id);
+        m_nodes[dependency].successors.push_back(id);
+    }
+    m_nodes.push_back({.task = std::move(task), .successors = {}, .dependencyCount = dependencies.size()});
+    m_pendingDependencies.emplace_back(0);
+    return id;
+}
+
+void TaskGraph::clear()
+{
+    m_nodes.clear();
+    m_pendingDependencies.clear();
+}
+
+void TaskGraph::run(ThreadPool *threadPool)
+{
+    if (!threadPool || threadPool->threadCount() == 0)
+    {
+        for (auto &node : m_nodes)
+            node.task();
+        return;
+    }
+
+    for (std::size_t id = 0; id < m_nodes.size(); ++id)
+        m_pendingDependencies[id].store(m_nodes[id].dependencyCount, std::memory_order_relaxed);
+    m_remaining.store(m_nodes.size(), std::memory_order_relaxed);
+    m_group = threadPool->createGroup();
+    for (std::size_t id = 0; id < m_nodes.size(); ++id)
+    {
+        if (m_nodes[id].dependencyCount == 0)
+            submit(threadPool, id);
+    }
+    threadPool->waitUntil(m_group, [this] { return m_remaining.load(std::memory_order_acquire) == 0; });
+}
+
+void TaskGraph::submit(ThreadPool *threadPool, TaskId id)
+{
+    threadPool->submit(
+        [this, threadPool, id] {
+            auto &node = m_nodes[id];
+            node.task();
+            for (const auto successor : node.successors)
+            {
+                if (m_pendingDependencies[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    submit(threadPool, successor);
+            }
+            m_remaining.fetch_sub(1, std::memory_order_release);
+        },
+        m_group);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+class ThreadPool;
+
+// Tasks with dependencies between them, run on a ThreadPool. A task is submitted as soon as all the tasks it depends
+// on are done, so independent branches of the graph run concurrently. The graph can be run any number of times.
+class TaskGraph
+{
+public:
+    using Task = std::function<void()>;
+    using TaskId = std::size_t;
+
+    // The dependencies must have been added before, which keeps the graph acyclic.
+    TaskId add(Task task, std::initializer_list<TaskId> dependencies = {});
+    void clear();
+
+    std::size_t size() const { return m_nodes.size(); }
+
+    // Runs every task once and blocks until they're all done. Without a pool the tasks run inline, in the order they
+    // were added. While it waits the calling thread only helps with the tasks of this graph, never with other work
+    // queued on the pool.
+    void run(ThreadPool *threadPool);
+
+private:
+    struct Node
+    {
+        Task task;
+        std::vector<TaskId> successors;
+        std::size_t dependencyCount{0};
+    };
+
+    void submit(ThreadPool *threadPool, TaskId id);
+
+    std::vector<Node> m_nodes;
+    std::deque<std::atomic<std::size_t>> m_pendingDependencies; // of each node, during run()
+    std::atomic<std::size_t> m_remaining{0};
+    std::uint64_t m_group{0}; // of the tasks submitted by run()
+};
@@ -0,0 +1,119 @@
+#include "thread_pool.h"
+
+namespace
+{
+thread_local const ThreadPool *t_currentPool{nullptr};
+thread_local std::size_t t_workerIndex{0};
+
+// Without a group, matches any task.
+auto inGroup(std::optional<ThreadPool::TaskGroup> group)
+{
+    return [group](const auto &queued) { return !group || queued.group == *group; };
+}
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t threadCount)
+{
+    m_queues.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i)
+        m_queues.push_back(std::make_unique<Queue>());
+    m_workers.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i)
+        m_workers.emplace_back([this, i] { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(m_wakeMutex);
+        m_stopping = true;
+    }
+    m_wakeCondition.notify_all();
+    m_workers.clear();
+}
+
+void ThreadPool::submit(Task task, TaskGroup group)
+{
+    if (m_workers.empty())
+    {
+        task();
+        return;
+    }
+
+    // tasks spawned by a worker go to its own queue, everything else is distributed round-robin
+    const auto queueIndex = t_currentPool == this
+                                ? t_workerIndex
+                                : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+    {
+        auto &queue = *m_queues[queueIndex];
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back({.task = std::move(task), .group = group});
+    }
+    m_queuedTasks.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard lock(m_wakeMutex);
+    }
+    m_wakeCondition.notify_one();
+}
+
+bool ThreadPool::runPendingTask(std::optional<TaskGroup> group)
+{
+    const auto thiefIndex = t_currentPool == this ? t_workerIndex : m_queues.size();
+    auto task = thiefIndex < m_queues.size() ? popTask(thiefIndex, group) : std::nullopt;
+    if (!task)
+        task = stealTask(thiefIndex, group);
+    if (!task)
+        return false;
+    (*task)();
+    return true;
+}
+
+std::optional<ThreadPool::Task> ThreadPool::popTask(std::size_t queueIndex, std::optional<TaskGroup> group)
+{
+    auto &queue = *m_queues[queueIndex];
+    std::lock_guard lock(queue.mutex);
+    const auto it = std::find_if(queue.tasks.rbegin(), queue.tasks.rend(), inGroup(group));
+    if (it == queue.tasks.rend())
+        return std::nullopt;
+    auto task = std::move(it->task);
+    queue.tasks.erase(std::next(it).base());
+    m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+    return task;
+}
+
+std::optional<ThreadPool::Task> ThreadPool::stealTask(std::size_t thiefIndex, std::optional<TaskGroup> group)
+{
+    const auto queueCount = m_queues.size();
+    for (std::size_t i = 1; i <= queueCount; ++i)
+    {
+        const auto victimIndex = (thiefIndex + i) % queueCount;
+        if (victimIndex == thiefIndex)
+            continue;
+        auto &queue = *m_queues[victimIndex];
+        std::lock_guard lock(queue.mutex);
+        const auto it = std::find_if(queue.tasks.begin(), queue.tasks.end(), inGroup(group));
+        if (it == queue.tasks.end())
+            continue;
+        auto task = std::move(it->task);
+        queue.tasks.erase(it);
+        m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+    }
+    return std::nullopt;
+}
+
+void ThreadPool::workerLoop(std::size_t index)
+{
+    t_currentPool = this;
+    t_workerIndex = index;
+
+    for (;;)
+    {
+        if (runPendingTask(std::nullopt))
+            continue;
+        std::unique_lock lock(m_wakeMutex);
+        m_wakeCondition.wait(lock, [this] { return m_stopping || m_queuedTasks.load(std::memory_order_acquire) > 0; });
+        if (m_stopping && m_queuedTasks.load(std::memory_order_acquire) == 0)
+            break;
+    }
+}
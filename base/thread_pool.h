@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a task deque: it pops its own tasks from the back and steals from the
+// front of the other deques when it runs out of work.
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+
+    // Tag shared by related tasks, so that a thread waiting for them only helps with those. Workers run any task.
+    using TaskGroup = std::uint64_t;
+    static constexpr TaskGroup kNoGroup = 0;
+
+    explicit ThreadPool(std::size_t threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool &&) = delete;
+    ThreadPool &operator=(ThreadPool &&) = delete;
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    std::size_t threadCount() const { return m_workers.size(); }
+
+    // A group that no other call returned.
+    TaskGroup createGroup() { return m_nextGroup.fetch_add(1, std::memory_order_relaxed); }
+
+    void submit(Task task, TaskGroup group = kNoGroup);
+
+    // Splits [0, count) into chunks of at most `grainSize` items and calls `body(begin, end)` for each of them.
+    // Blocks until every chunk is done. The calling thread runs chunks while it waits, so this can be called from
+    // inside a task, and a pool without workers simply runs `body` inline.
+    template<typename Body>
+    void parallelFor(std::size_t count, std::size_t grainSize, Body &&body)
+    {
+        if (count == 0)
+            return;
+        grainSize = std::max<std::size_t>(grainSize, 1);
+        const auto chunkCount = (count + grainSize - 1) / grainSize;
+        if (m_workers.empty() || chunkCount == 1)
+        {
+            for (std::size_t begin = 0; begin < count; begin += grainSize)
+                body(begin, std::min(begin + grainSize, count));
+            return;
+        }
+        const auto group = createGroup();
+        std::atomic<std::size_t> remaining{chunkCount};
+        for (std::size_t begin = 0; begin < count; begin += grainSize)
+        {
+            const auto end = std::min(begin + grainSize, count);
+            submit(
+                [&body, &remaining, begin, end] {
+                    body(begin, end);
+                    remaining.fetch_sub(1, std::memory_order_release);
+                },
+                group);
+        }
+        waitUntil(group, [&remaining] { return remaining.load(std::memory_order_acquire) == 0; });
+    }
+
+    // Runs tasks of `group` on the calling thread until `done` returns true. The tasks of other groups are left to
+    // the workers: a wait on the main thread must not pick up a long job that merely shares the pool.
+    template<typename Predicate>
+    void waitUntil(TaskGroup group, Predicate &&done)
+    {
+        while (!done())
+        {
+            if (!runPendingTask(group))
+                std::this_thread::yield();
+        }
+    }
+
+private:
+    struct QueuedTask
+    {
+        Task task;
+        TaskGroup group;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<QueuedTask> tasks;
+    };
+
+    // Without a group, any task.
+    bool runPendingTask(std::optional<TaskGroup> group);
+    std::optional<Task> popTask(std::size_t queueIndex, std::optional<TaskGroup> group);
+    std::optional<Task> stealTask(std::size_t thiefIndex, std::optional<TaskGroup> group);
+    void workerLoop(std::size_t index);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::jthread> m_workers;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+    std::atomic<std::size_t> m_queuedTasks{0};
+    std::atomic<std::size_t> m_nextQueue{0};
+    std::atomic<TaskGroup> m_nextGroup{kNoGroup + 1};
+    bool m_stopping{false};
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "duration.h"
 #include "rect.h"
 
 #include <glad/gl.h>
@@ -37,8 +38,6 @@ enum class MouseButton
     Middle = GLFW_MOUSE_BUTTON_MIDDLE
 };
 
-using Seconds = std::chrono::duration<double, std::ratio<1>>;
-
 class WindowBase
 {
 public:
@@ -0,0 +1,71 @@
+#include "compiled_assets.h"
+#include "starfield.h"
+#include "universe.h"
+
+#include <base/arg_parser.h>
+#include <base/file.h>
+#include <base/thread_pool.h>
+
+#include <filesystem>
+#include <print>
+
+// Compiles the data files into the binary assets next to them, which Universe::load and Starfield::load read
+// instead of the sources as long as they're up to date.
+
+namespace
+{
+
+// `loadSource` reads the source into `T`, ignoring any compiled asset.
+template<typename Asset, typename T, typename LoadSource>
+bool compile(const std::string &sourcePath, LoadSource &&loadSource)
+{
+    T value;
+    if (!loadSource(value, sourcePath))
+    {
+        std::println(stderr, "Failed to load {}", sourcePath);
+        return false;
+    }
+    const auto compiledPath = compiledAssetPath(sourcePath);
+    const auto data = Asset::compile(value);
+    if (!writeFile(compiledPath, data))
+    {
+        std::println(stderr, "Failed to write {}", compiledPath);
+        return false;
+    }
+    std::println("{} -> {} ({} bytes)", sourcePath, compiledPath, data.size());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    std::string universePath;
+    std::string starsPath;
+
+    ArgParser parser;
+    parser.addOption(universePath, 'u', "universe");
+    parser.addOption(starsPath, 's', "stars");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    if (universePath.empty() && starsPath.empty())
+    {
+        std::println(stderr, "Usage: {} [-u universe.json] [-s stars.json|stars.csv]", argv[0]);
+        return 1;
+    }
+
+    ThreadPool threadPool;
+    const auto loadUniverse = [](Universe &universe, const std::string &path) { return universe.loadJson(path); };
+    const auto loadStarfield = [&threadPool](Starfield &starfield, const std::string &path) {
+        if (std::filesystem::path{path}.extension() == ".csv")
+            return starfield.loadCsv(path, &threadPool);
+        return starfield.loadJson(path, &threadPool);
+    };
+
+    bool compiled = true;
+    if (!universePath.empty())
+        compiled = compile<UniverseAsset, Universe>(universePath, loadUniverse) && compiled;
+    if (!starsPath.empty())
+        compiled = compile<StarfieldAsset, Starfield>(starsPath, loadStarfield) && compiled;
+    return compiled ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Layout shared by the binary files that are memory-mapped and read in place, universe snapshots and compiled assets:
+// a header, then sections of fixed-size records at aligned offsets, one of which holds the strings.
+
+// every section starts at a multiple of this, which covers the alignment of all the records
+inline constexpr std::size_t kSectionAlignment = 8;
+
+constexpr std::size_t alignUp(std::size_t size)
+{
+    return (size + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+}
+
+struct SectionRange
+{
+    std::uint64_t offset; // bytes, from the start of the file
+    std::uint64_t count;  // records
+};
+
+struct StringRef
+{
+    std::uint32_t offset;
+    std::uint32_t size;
+};
+
+// Places the sections one after the other past the header, given their record counts. Returns the size of the file.
+inline std::size_t layoutSections(std::size_t headerSize, std::span<SectionRange> sections,
+                                  std::span<const std::size_t> recordSizes)
+{
+    assert(sections.size() == recordSizes.size());
+    auto offset = alignUp(headerSize);
+    for (std::size_t i = 0; i < sections.size(); ++i)
+    {
+        sections[i].offset = offset;
+        offset = alignUp(offset + sections[i].count * recordSizes[i]);
+    }
+    return offset;
+}
+
+// Zeroes the padding after each section, for buffers that are reused without being cleared.
+inline void clearSectionPadding(std::span<std::byte> data, std::span<const SectionRange> sections,
+                                std::span<const std::size_t> recordSizes)
+{
+    for (std::size_t i = 0; i < sections.size(); ++i)
+    {
+        const auto end = sections[i].offset + sections[i].count * recordSizes[i];
+        std::fill(data.begin() + end, data.begin() + alignUp(end), std::byte{0});
+    }
+}
+
+// Whether the sections fit in the data past the header, at aligned offsets, and the data itself is aligned so that
+// the records can be read in place.
+inline bool validSections(std::span<const std::byte> data, std::size_t headerSize,
+                          std::span<const SectionRange> sections, std::span<const std::size_t> recordSizes)
+{
+    if (reinterpret_cast<std::uintptr_t>(data.data()) % kSectionAlignment != 0)
+        return false;
+    for (std::size_t i = 0; i < sections.size(); ++i)
+    {
+        const auto &[offset, count] = sections[i];
+        if (offset % kSectionAlignment != 0 || offset < headerSize || offset > data.size() ||
+            count > (data.size() - offset) / recordSizes[i])
+            return false;
+    }
+    return true;
+}
+
+// The records of a section, const if the data is.
+template<typename Record, typename Byte>
+auto sectionRecords(std::span<Byte> data, const SectionRange &range)
+{
+    using Type = std::conditional_t<std::is_const_v<Byte>, const Record, Record>;
+    return std::span{reinterpret_cast<Type *>(data.data() + range.offset), static_cast<std::size_t>(range.count)};
+}
+
+// Strings of a file being written, copied straight into their section.
+class StringWriter
+{
+public:
+    explicit StringWriter(std::span<char> chars)
+        : m_chars(chars)
+    {
+    }
+
+    StringRef add(std::string_view string)
+    {
+        assert(string.size() <= m_chars.size() - m_size);
+        const StringRef ref{static_cast<std::uint32_t>(m_size), static_cast<std::uint32_t>(string.size())};
+        std::ranges::copy(string, m_chars.begin() + m_size);
+        m_size += string.size();
+        return ref;
+    }
+
+    std::size_t size() const { return m_size; }
+
+private:
+    std::span<char> m_chars;
+    std::size_t m_size{0};
+};
+
+// Strings of a file being read, checked on access.
+class StringReader
+{
+public:
+    explicit StringReader(std::span<const char> chars)
+        : m_chars(chars)
+    {
+    }
+
+    bool contains(StringRef ref) const
+    {
+        return ref.offset <= m_chars.size() && ref.size <= m_chars.size() - ref.offset;
+    }
+    std::string_view view(StringRef ref) const { return {m_chars.data() + ref.offset, ref.size}; }
+    std::string string(StringRef ref) const { return std::string{view(ref)}; }
+
+private:
+    std::span<const char> m_chars;
+};
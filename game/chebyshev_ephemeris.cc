@@ -0,0 +1,215 @@
+#include "chebyshev_ephemeris.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+// References:
+// Press, W. H. et al. Numerical Recipes, chapter 5.8: Chebyshev Approximation, Cambridge University Press, 2007
+// Newhall, X X. Numerical Representation of Planetary Ephemerides, Celestial Mechanics 45, 305-310, 1989
+
+namespace
+{
+
+constexpr auto kMinSegmentLength = JulianDays{1.0 / 24.0};
+
+// Sum of coefficients[j] * T_j(t).
+double clenshaw(const double *coefficients, std::size_t count, double t)
+{
+    double b1 = 0.0;
+    double b2 = 0.0;
+    for (std::size_t j = count - 1; j > 0; --j)
+    {
+        const auto b = std::fma(2.0 * t, b1, coefficients[j] - b2);
+        b2 = b1;
+        b1 = b;
+    }
+    return std::fma(t, b1, coefficients[0] - b2);
+}
+
+// Only the first element of each span of `output`, at `index`.
+Ephemeris::Output outputAt(const Ephemeris::Output &output, std::size_t index)
+{
+    const auto at = [index]<typename T>(std::span<T> values) {
+        return values.empty() ? values : values.subspan(index, 1);
+    };
+    return {at(output.positions), at(output.velocities), at(output.positionsOnOrbitPlane)};
+}
+
+} // namespace
+
+ChebyshevEphemeris::ChebyshevEphemeris(const Ephemeris &ephemeris, JulianDate begin, JulianDate end,
+                                       const Settings &settings)
+    : m_exact(ephemeris)
+    , m_begin(begin)
+    , m_end(std::max(begin, end))
+    , m_settings(settings)
+{
+    assert(m_settings.degree >= 2);
+    const auto span = std::max(m_end - m_begin, kMinSegmentLength);
+    for (std::size_t body = 0; body < m_exact.size(); ++body)
+    {
+        auto segmentLength = m_exact.isHyperbolic(body)
+                                 ? span
+                                 : m_exact.period(body) / std::max<std::size_t>(m_settings.segmentsPerOrbit, 1);
+        std::vector<double> coefficients;
+        double errorBound = 0.0;
+        while (true)
+        {
+            // segments tile the span exactly
+            const auto segmentCount = static_cast<std::size_t>(std::ceil(span / std::min(segmentLength, span)));
+            segmentLength = span / static_cast<double>(segmentCount);
+            coefficients.clear();
+            fit(body, segmentLength, coefficients, errorBound);
+            if (errorBound <= m_settings.tolerance || segmentLength < kMinSegmentLength)
+                break;
+            segmentLength /= 2.0;
+        }
+        m_bodies.push_back({.firstCoefficient = m_coefficients.size(),
+                            .segmentCount = coefficients.size() / coefficientsPerSegment(),
+                            .segmentLength = segmentLength,
+                            .orbitPlane = m_exact.orbitPlane(body)});
+        m_coefficients.insert(m_coefficients.end(), coefficients.begin(), coefficients.end());
+        m_errorBound = std::max(m_errorBound, errorBound);
+    }
+}
+
+std::size_t ChebyshevEphemeris::segmentCount() const
+{
+    std::size_t count = 0;
+    for (const auto &body : m_bodies)
+        count += body.segmentCount;
+    return count;
+}
+
+void ChebyshevEphemeris::fit(std::size_t body, JulianDays segmentLength, std::vector<double> &coefficients,
+                             double &errorBound) const
+{
+    const auto degree = m_settings.degree;
+    const auto nodeCount = degree + 1;
+    const auto checkCount = 2 * nodeCount;
+    const auto segmentCount = static_cast<std::size_t>(std::round((m_end - m_begin) / segmentLength));
+    const auto pi = glm::pi<double>();
+
+    std::vector<JulianDate> dates(std::max(nodeCount, checkCount));
+    std::vector<glm::dvec2> positions(dates.size());
+    std::vector<double> nodes(nodeCount);
+    for (std::size_t k = 0; k < nodeCount; ++k)
+        nodes[k] = std::cos(pi * (static_cast<double>(k) + 0.5) / nodeCount);
+
+    errorBound = 0.0;
+    coefficients.reserve(segmentCount * coefficientsPerSegment());
+    for (std::size_t segment = 0; segment < std::max<std::size_t>(segmentCount, 1); ++segment)
+    {
+        const auto segmentBegin = m_begin + static_cast<double>(segment) * segmentLength;
+        const auto date = [&](double t) { return segmentBegin + 0.5 * (t + 1.0) * segmentLength; };
+
+        // coefficients of x and y, with the first one halved so that the series is a plain sum
+        for (std::size_t k = 0; k < nodeCount; ++k)
+            dates[k] = date(nodes[k]);
+        m_exact.compute(body, std::span{dates}.first(nodeCount),
+                        {.positionsOnOrbitPlane = std::span{positions}.first(nodeCount)});
+        const auto first = coefficients.size();
+        coefficients.resize(first + coefficientsPerSegment());
+        auto *x = coefficients.data() + first;
+        auto *y = x + nodeCount;
+        for (std::size_t j = 0; j < nodeCount; ++j)
+        {
+            double sumX = 0.0;
+            double sumY = 0.0;
+            for (std::size_t k = 0; k < nodeCount; ++k)
+            {
+                const auto weight = std::cos(pi * static_cast<double>(j) * (static_cast<double>(k) + 0.5) / nodeCount);
+                sumX += weight * positions[k].x;
+                sumY += weight * positions[k].y;
+            }
+            const auto scale = (j == 0 ? 1.0 : 2.0) / nodeCount;
+            x[j] = scale * sumX;
+            y[j] = scale * sumY;
+        }
+
+        // derivatives: d[j - 1] = d[j + 1] + 2 j c[j], in AU/day
+        auto *vx = y + nodeCount;
+        auto *vy = vx + degree;
+        const auto dtdDays = 2.0 / segmentLength.count();
+        for (auto [c, d] : {std::pair{x, vx}, std::pair{y, vy}})
+        {
+            double next = 0.0;    // d[j + 1]
+            double current = 0.0; // d[j]
+            for (std::size_t j = degree; j > 0; --j)
+            {
+                const auto previous = next + 2.0 * static_cast<double>(j) * c[j];
+                next = current;
+                current = previous;
+                d[j - 1] = previous;
+            }
+            d[0] *= 0.5;
+            for (std::size_t j = 0; j < degree; ++j)
+                d[j] *= dtdDays;
+        }
+
+        // measured error between the nodes, plus the tail of the series
+        for (std::size_t k = 0; k < checkCount; ++k)
+            dates[k] = date(-1.0 + 2.0 * static_cast<double>(k) / (checkCount - 1));
+        m_exact.compute(body, std::span{dates}.first(checkCount),
+                        {.positionsOnOrbitPlane = std::span{positions}.first(checkCount)});
+        double segmentError = std::hypot(x[degree], y[degree]) + std::hypot(x[degree - 1], y[degree - 1]);
+        double maxError = 0.0;
+        for (std::size_t k = 0; k < checkCount; ++k)
+        {
+            const auto t = -1.0 + 2.0 * static_cast<double>(k) / (checkCount - 1);
+            const glm::dvec2 fitted{clenshaw(x, nodeCount, t), clenshaw(y, nodeCount, t)};
+            maxError = std::max(maxError, glm::length(fitted - positions[k]));
+        }
+        segmentError += maxError;
+        errorBound = std::max(errorBound, segmentError);
+    }
+}
+
+void ChebyshevEphemeris::compute(JulianDate date, const Ephemeris::Output &output) const
+{
+    if (!covers(date))
+    {
+        m_exact.compute(date, output);
+        return;
+    }
+    for (std::size_t body = 0; body < m_bodies.size(); ++body)
+        computeState(body, date, body, output);
+}
+
+void ChebyshevEphemeris::compute(std::size_t body, std::span<const JulianDate> dates,
+                                 const Ephemeris::Output &output) const
+{
+    for (std::size_t i = 0; i < dates.size(); ++i)
+    {
+        if (covers(dates[i]))
+            computeState(body, dates[i], i, output);
+        else
+            m_exact.compute(body, dates.subspan(i, 1), outputAt(output, i));
+    }
+}
+
+void ChebyshevEphemeris::computeState(std::size_t body, JulianDate date, std::size_t outputIndex,
+                                      const Ephemeris::Output &output) const
+{
+    const auto degree = m_settings.degree;
+    const auto &[firstCoefficient, segmentCount, segmentLength, orbitPlane] = m_bodies[body];
+    const auto offset = (date - m_begin) / segmentLength;
+    const auto segment = std::min(static_cast<std::size_t>(offset), segmentCount - 1);
+    const auto t = 2.0 * (offset - static_cast<double>(segment)) - 1.0;
+    const auto *x = m_coefficients.data() + firstCoefficient + segment * coefficientsPerSegment();
+    const auto *y = x + degree + 1;
+
+    const glm::dvec2 position{clenshaw(x, degree + 1, t), clenshaw(y, degree + 1, t)};
+    if (!output.positionsOnOrbitPlane.empty())
+        output.positionsOnOrbitPlane[outputIndex] = position;
+    if (!output.positions.empty())
+        output.positions[outputIndex] = position.x * orbitPlane.periapsis + position.y * orbitPlane.minorAxis;
+    if (!output.velocities.empty())
+    {
+        const auto *vx = y + degree + 1;
+        const auto *vy = vx + degree;
+        const glm::dvec2 velocity{clenshaw(vx, degree, t), clenshaw(vy, degree, t)};
+        output.velocities[outputIndex] = velocity.x * orbitPlane.periapsis + velocity.y * orbitPlane.minorAxis;
+    }
+}
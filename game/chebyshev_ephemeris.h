@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ephemeris.h"
+
+#include <vector>
+
+// Piecewise Chebyshev fit of the bodies of an Ephemeris over a span of dates, in the spirit of the JPL DE files. Each
+// body gets segments of equal length, short enough for its fit to stay within the tolerance; positions and
+// velocities are then a couple of Clenshaw recurrences away, with no transcendental function at all. Dates outside
+// the span fall back to the exact ephemeris.
+class ChebyshevEphemeris
+{
+public:
+    struct Settings
+    {
+        std::size_t degree{12};
+        double tolerance{1e-9};          // AU, on positions
+        std::size_t segmentsPerOrbit{8}; // to start with, halved until the tolerance is met
+    };
+
+    ChebyshevEphemeris() = default;
+    explicit ChebyshevEphemeris(const Ephemeris &ephemeris, JulianDate begin, JulianDate end,
+                                const Settings &settings);
+
+    JulianDate begin() const { return m_begin; }
+    JulianDate end() const { return m_end; }
+    bool covers(JulianDate date) const { return !m_bodies.empty() && m_begin <= date && date <= m_end; }
+    std::size_t segmentCount() const;
+
+    // Bound on the position error over the whole span: the largest error measured between the nodes of any segment,
+    // plus the size of the last two coefficients of its series.
+    double errorBound() const { return m_errorBound; } // AU
+
+    // Same as Ephemeris::compute.
+    void compute(JulianDate date, const Ephemeris::Output &output) const;
+    void compute(std::size_t body, std::span<const JulianDate> dates, const Ephemeris::Output &output) const;
+
+private:
+    struct Body
+    {
+        std::size_t firstCoefficient;
+        std::size_t segmentCount;
+        JulianDays segmentLength;
+        Ephemeris::OrbitPlane orbitPlane;
+    };
+
+    void fit(std::size_t body, JulianDays segmentLength, std::vector<double> &coefficients, double &errorBound) const;
+    void computeState(std::size_t body, JulianDate date, std::size_t outputIndex,
+                      const Ephemeris::Output &output) const;
+    std::size_t coefficientsPerSegment() const { return 4 * m_settings.degree + 2; }
+
+    Ephemeris m_exact;
+    JulianDate m_begin;
+    JulianDate m_end;
+    Settings m_settings;
+    std::vector<Body> m_bodies;
+    // per segment: x and y on the orbit plane (degree + 1 each), then their derivatives in AU/day (degree each)
+    std::vector<double> m_coefficients;
+    double m_errorBound{0.0};
+};
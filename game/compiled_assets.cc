@@ -0,0 +1,255 @@
+#include "compiled_assets.h"
+
+#include "binary_layout.h"
+#include "starfield.h"
+#include "universe.h"
+#include "universe_definitions.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <utility>
+
+namespace
+{
+
+// Bump when the layout of the header or of any record changes.
+constexpr std::uint32_t kUniverseFormatVersion = 2;
+constexpr std::uint32_t kStarfieldFormatVersion = 2;
+
+constexpr std::array<char, 8> kUniverseMagic = {'S', 'D', 'U', 'N', 'I', 'V', 'A', 'S'};
+constexpr std::array<char, 8> kStarfieldMagic = {'S', 'D', 'S', 'T', 'A', 'R', 'A', 'S'};
+
+template<std::size_t SectionCount>
+struct FileHeader
+{
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t sectionCount;
+    std::uint64_t size; // bytes, of the whole file
+    std::array<SectionRange, SectionCount> sections;
+};
+
+// Writes the header and lays out the sections, whose record counts are set, into a zeroed buffer.
+template<std::size_t SectionCount>
+std::vector<std::byte> allocate(FileHeader<SectionCount> &header,
+                                const std::array<std::size_t, SectionCount> &recordSizes)
+{
+    header.size = layoutSections(sizeof(header), header.sections, recordSizes);
+    std::vector<std::byte> buffer(header.size);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    return buffer;
+}
+
+// The header of the data, if it's valid and the sections fit.
+template<std::size_t SectionCount>
+std::optional<FileHeader<SectionCount>> readHeader(std::span<const std::byte> data, const std::array<char, 8> &magic,
+                                                   std::uint32_t version,
+                                                   const std::array<std::size_t, SectionCount> &recordSizes)
+{
+    FileHeader<SectionCount> header;
+    if (data.size() < sizeof(header))
+        return std::nullopt;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != magic || header.version != version || header.sectionCount != SectionCount ||
+        header.size != data.size() || !validSections(data, sizeof(header), header.sections, recordSizes))
+        return std::nullopt;
+    return header;
+}
+
+namespace universe_asset
+{
+
+// nothing but the definitions
+using Header = FileHeader<UniverseDefinitions::SectionCount>;
+
+} // namespace universe_asset
+
+namespace starfield_asset
+{
+
+// the arrays of the starfield, one element per star but for the names
+enum Section : std::size_t
+{
+    NameChars,          // chars of the StringArena
+    NameOffsets,        // uint32, offsets of the StringArena
+    RightAscensions,    // float, radians
+    Declinations,       // float, radians
+    ApparentMagnitudes, // float
+    SpectralClasses,    // uint8
+    ProperNames,        // uint32, in the StringArena
+    SectionCount
+};
+
+constexpr std::array<std::size_t, SectionCount> kRecordSizes = {sizeof(char),  sizeof(std::uint32_t),
+                                                                 sizeof(float), sizeof(float),
+                                                                 sizeof(float), sizeof(SpectralClass),
+                                                                 sizeof(std::uint32_t)};
+
+using Header = FileHeader<SectionCount>;
+
+// The arrays of a valid asset, in place.
+struct Views
+{
+    std::span<const float> rightAscensions;
+    std::span<const float> declinations;
+    std::span<const float> apparentMagnitudes;
+    std::span<const SpectralClass> spectralClasses;
+    std::span<const std::uint32_t> properNames;
+};
+
+// Checks the asset and reads its names into `names`, returns nullopt if it isn't valid.
+std::optional<Views> read(std::span<const std::byte> data, StringArena &names)
+{
+    const auto header = readHeader(data, kStarfieldMagic, kStarfieldFormatVersion, kRecordSizes);
+    if (!header)
+        return std::nullopt;
+
+    const auto &sections = header->sections;
+    const auto nameChars = sectionRecords<char>(data, sections[NameChars]);
+    const auto nameOffsets = sectionRecords<std::uint32_t>(data, sections[NameOffsets]);
+    const auto spectralClasses = sectionRecords<std::uint8_t>(data, sections[SpectralClasses]);
+    const Views views{.rightAscensions = sectionRecords<float>(data, sections[RightAscensions]),
+                      .declinations = sectionRecords<float>(data, sections[Declinations]),
+                      .apparentMagnitudes = sectionRecords<float>(data, sections[ApparentMagnitudes]),
+                      .spectralClasses = sectionRecords<SpectralClass>(data, sections[SpectralClasses]),
+                      .properNames = sectionRecords<std::uint32_t>(data, sections[ProperNames])};
+
+    const auto count = views.rightAscensions.size();
+    if (views.declinations.size() != count || views.apparentMagnitudes.size() != count ||
+        spectralClasses.size() != count || views.properNames.size() != count || nameOffsets.empty())
+        return std::nullopt;
+    const auto nameCount = nameOffsets.size() - 1;
+    const auto validSpectralClass = [](std::uint8_t c) { return c <= std::to_underlying(SpectralClass::M); };
+    const auto validName = [nameCount](std::uint32_t name) { return name < nameCount; };
+    if (!std::ranges::all_of(spectralClasses, validSpectralClass) || !std::ranges::all_of(views.properNames, validName))
+        return std::nullopt;
+    if (!names.assign({nameChars.data(), nameChars.size()}, nameOffsets))
+        return std::nullopt;
+    return views;
+}
+
+} // namespace starfield_asset
+
+} // namespace
+
+std::string compiledAssetPath(const std::string &sourcePath)
+{
+    return std::filesystem::path{sourcePath}.replace_extension(".bin").string();
+}
+
+bool isCompiledAssetCurrent(const std::string &sourcePath, const std::string &compiledPath)
+{
+    std::error_code error;
+    const auto compiledTime = std::filesystem::last_write_time(compiledPath, error);
+    if (error)
+        return false;
+    const auto sourceTime = std::filesystem::last_write_time(sourcePath, error);
+    return error || sourceTime <= compiledTime;
+}
+
+std::vector<std::byte> UniverseAsset::compile(const Universe &universe)
+{
+    using namespace universe_asset;
+
+    Header header{.magic = kUniverseMagic,
+                  .version = kUniverseFormatVersion,
+                  .sectionCount = UniverseDefinitions::SectionCount,
+                  .size = 0,
+                  .sections = {}};
+    UniverseDefinitions::countRecords(universe, header.sections);
+
+    auto buffer = allocate(header, UniverseDefinitions::kRecordSizes);
+    const auto data = std::span{buffer};
+
+    StringWriter strings(sectionRecords<char>(data, header.sections[UniverseDefinitions::Strings]));
+    UniverseDefinitions::write(universe, data, header.sections, strings);
+    assert(strings.size() == header.sections[UniverseDefinitions::Strings].count);
+
+    return buffer;
+}
+
+bool UniverseAsset::load(Universe &universe, std::span<const std::byte> data)
+{
+    using namespace universe_asset;
+
+    if (!universe.m_worlds.empty() || !universe.m_marketSectors.empty() || !universe.m_shipClasses.empty())
+        return false;
+
+    const auto header = readHeader(data, kUniverseMagic, kUniverseFormatVersion, UniverseDefinitions::kRecordSizes);
+    if (!header || !UniverseDefinitions::validate(data, header->sections))
+        return false;
+
+    UniverseDefinitions::read(universe, data, header->sections);
+    universe.initializeEconomy();
+
+    return true;
+}
+
+std::vector<std::byte> StarfieldAsset::compile(const Starfield &starfield)
+{
+    using namespace starfield_asset;
+
+    const auto nameChars = starfield.names.chars();
+    const auto nameOffsets = starfield.names.offsets();
+
+    Header header{.magic = kStarfieldMagic,
+                  .version = kStarfieldFormatVersion,
+                  .sectionCount = SectionCount,
+                  .size = 0,
+                  .sections = {}};
+    auto &sections = header.sections;
+    sections[NameChars].count = nameChars.size();
+    sections[NameOffsets].count = nameOffsets.size();
+    for (const auto section : {RightAscensions, Declinations, ApparentMagnitudes, SpectralClasses, ProperNames})
+        sections[section].count = starfield.size();
+
+    auto buffer = allocate(header, kRecordSizes);
+    const auto data = std::span{buffer};
+    std::ranges::copy(nameChars, sectionRecords<char>(data, sections[NameChars]).begin());
+    std::ranges::copy(nameOffsets, sectionRecords<std::uint32_t>(data, sections[NameOffsets]).begin());
+    std::ranges::copy(starfield.rightAscensions(), sectionRecords<float>(data, sections[RightAscensions]).begin());
+    std::ranges::copy(starfield.declinations(), sectionRecords<float>(data, sections[Declinations]).begin());
+    std::ranges::copy(starfield.apparentMagnitudes(),
+                      sectionRecords<float>(data, sections[ApparentMagnitudes]).begin());
+    std::ranges::copy(starfield.spectralClasses(),
+                      sectionRecords<SpectralClass>(data, sections[SpectralClasses]).begin());
+    std::ranges::copy(starfield.properNames(), sectionRecords<std::uint32_t>(data, sections[ProperNames]).begin());
+
+    return buffer;
+}
+
+bool StarfieldAsset::load(Starfield &starfield, std::span<const std::byte> data)
+{
+    StringArena names;
+    const auto views = starfield_asset::read(data, names);
+    if (!views)
+        return false;
+    const auto copy = [](const auto &view) { return std::vector(view.begin(), view.end()); };
+    starfield.assign({.rightAscensions = copy(views->rightAscensions),
+                      .declinations = copy(views->declinations),
+                      .apparentMagnitudes = copy(views->apparentMagnitudes),
+                      .spectralClasses = copy(views->spectralClasses),
+                      .properNames = copy(views->properNames)},
+                     std::move(names));
+    return true;
+}
+
+bool StarfieldAsset::load(Starfield &starfield, MappedFile file)
+{
+    StringArena names;
+    const auto views = starfield_asset::read(file.data(), names);
+    if (!views)
+        return false;
+    starfield.m_arrays = {};
+    starfield.m_assetFile = std::move(file);
+    starfield.names = std::move(names);
+    starfield.m_rightAscensions = views->rightAscensions;
+    starfield.m_declinations = views->declinations;
+    starfield.m_apparentMagnitudes = views->apparentMagnitudes;
+    starfield.m_spectralClasses = views->spectralClasses;
+    starfield.m_properNames = views->properNames;
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+
+struct Universe;
+class Starfield;
+class MappedFile;
+
+// Compiled forms of the data files, universe.json and the star catalogs, made offline by sundog-assetc and stored next
+// to their sources with a .bin extension. Same layout as the universe snapshots (see binary_layout.h): fixed-size
+// records with angles already in radians and a string table, checked by their header and section bounds and then read
+// in place from a memory-mapped file. Native byte order.
+
+// universe.json -> universe.bin
+std::string compiledAssetPath(const std::string &sourcePath);
+
+// Whether the compiled asset exists and isn't older than its source, if the source is there at all.
+bool isCompiledAssetCurrent(const std::string &sourcePath, const std::string &compiledPath);
+
+// The definitions of a universe, as in universe.json: ship classes, market and worlds. Market prices aren't part of
+// it, they're drawn again at every load as with the JSON source.
+class UniverseAsset
+{
+public:
+    static std::vector<std::byte> compile(const Universe &universe);
+
+    // Loads the definitions into a universe that wasn't loaded yet. Returns false if the data isn't a valid asset, in
+    // which case the universe is left untouched.
+    static bool load(Universe &universe, std::span<const std::byte> data);
+};
+
+class StarfieldAsset
+{
+public:
+    static std::vector<std::byte> compile(const Starfield &starfield);
+
+    // Returns false if the data isn't a valid asset, in which case the starfield is left untouched. The arrays are
+    // copied out of `data`.
+    static bool load(Starfield &starfield, std::span<const std::byte> data);
+    // Same, but the arrays are read in place from the mapping, which the starfield keeps. Only the names are copied.
+    static bool load(Starfield &starfield, MappedFile file);
+};
@@ -0,0 +1,283 @@
+#include "ephemeris.h"
+
+#include "simd.h"
+#include "universe.h"
+
+#include <base/thread_pool.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+
+constexpr auto kTolerance = 1e-10;
+constexpr auto kMaxIterations = 50;
+
+// bodies per task when a batch is split across a thread pool
+constexpr std::size_t kGrainSize = 4096;
+
+template<typename P>
+struct OrbitPacks
+{
+    P epoch;
+    P meanAnomalyAtEpoch;
+    P meanMotion;
+    P eccentricity;
+    P semiMajorAxis;
+    P semiMinorAxis;
+    std::array<P, 3> periapsis;
+    std::array<P, 3> minorAxis;
+};
+
+template<typename P>
+struct PlaneState
+{
+    P x;
+    P y;
+    P vx;
+    P vy;
+};
+
+// Position and velocity on the orbit plane of elliptic orbits, solving Kepler's equation with Newton's method. Lanes
+// stop being updated once they converge, like the scalar loop in Orbit.
+template<typename P>
+PlaneState<P> ellipticState(const OrbitPacks<P> &orbits, const P &days)
+{
+    using T = simd::ValueType<P>;
+    constexpr auto kPi = glm::pi<T>();
+    const auto &e = orbits.eccentricity;
+
+    // mean anomaly in [-pi, pi), starting from +/-pi keeps Newton's method monotonic at high eccentricities
+    P M = orbits.meanAnomalyAtEpoch + (days - orbits.epoch) * orbits.meanMotion;
+    M -= T{2} * kPi * simd::floor((M + kPi) / (T{2} * kPi));
+    P E = simd::select(e < T{0.8}, M, simd::select(M < T{0}, P{-kPi}, P{kPi}));
+
+    P dE{T{1}};
+    P iterations{T{0}};
+    auto active = simd::abs(dE) >= T{kTolerance};
+    while (simd::anyOf(active))
+    {
+        const P step = (E - e * simd::sin(E) - M) / (T{1} - e * simd::cos(E));
+        E = simd::select(active, E - step, E);
+        dE = simd::select(active, step, dE);
+        iterations = simd::select(active, iterations + T{1}, iterations);
+        active = simd::abs(dE) >= T{kTolerance} && iterations < T{kMaxIterations};
+    }
+
+    // x = a (cos E - e), y = b sin E, dE/dt = n / (1 - e cos E)
+    const P sinE = simd::sin(E);
+    const P cosE = simd::cos(E);
+    const P rate = orbits.meanMotion / (T{1} - e * cosE);
+    return {orbits.semiMajorAxis * (cosE - e), orbits.semiMinorAxis * sinE, -orbits.semiMajorAxis * sinE * rate,
+            orbits.semiMinorAxis * cosE * rate};
+}
+
+// Solves every lane and writes the first `count` of them to [outputBegin, outputBegin + count).
+template<typename P>
+void writeStates(const OrbitPacks<P> &orbits, const P &days, std::size_t count, std::size_t outputBegin,
+                 const Ephemeris::Output &output)
+{
+    const auto state = ellipticState(orbits, days);
+    const auto &p = orbits.periapsis;
+    const auto &q = orbits.minorAxis;
+
+    if (!output.positionsOnOrbitPlane.empty())
+    {
+        for (std::size_t lane = 0; lane < count; ++lane)
+            output.positionsOnOrbitPlane[outputBegin + lane] = {simd::lane(state.x, lane), simd::lane(state.y, lane)};
+    }
+    if (!output.positions.empty())
+    {
+        const std::array<P, 3> position{p[0] * state.x + q[0] * state.y, p[1] * state.x + q[1] * state.y,
+                                        p[2] * state.x + q[2] * state.y};
+        for (std::size_t lane = 0; lane < count; ++lane)
+            output.positions[outputBegin + lane] = {simd::lane(position[0], lane), simd::lane(position[1], lane),
+                                                    simd::lane(position[2], lane)};
+    }
+    if (!output.velocities.empty())
+    {
+        const std::array<P, 3> velocity{p[0] * state.vx + q[0] * state.vy, p[1] * state.vx + q[1] * state.vy,
+                                        p[2] * state.vx + q[2] * state.vy};
+        for (std::size_t lane = 0; lane < count; ++lane)
+            output.velocities[outputBegin + lane] = {simd::lane(velocity[0], lane), simd::lane(velocity[1], lane),
+                                                     simd::lane(velocity[2], lane)};
+    }
+}
+
+} // namespace
+
+std::size_t Ephemeris::add(const Orbit &orbit)
+{
+    const auto body = size();
+    for (auto *values : {&m_epoch, &m_meanAnomalyAtEpoch, &m_meanMotion, &m_eccentricity, &m_semiMajorAxis,
+                         &m_semiMinorAxis, &m_periapsisX, &m_periapsisY, &m_periapsisZ, &m_minorAxisX, &m_minorAxisY,
+                         &m_minorAxisZ})
+        values->emplace_back();
+    set(body, orbit);
+    return body;
+}
+
+void Ephemeris::set(std::size_t body, const Orbit &orbit)
+{
+    assert(body < size());
+    const auto elements = orbit.elements();
+    const auto e = elements.eccentricity;
+    const auto a = elements.semiMajorAxis;
+    const auto rotation = orbit.orbitRotationMatrix();
+
+    m_epoch[body] = elements.epoch.time_since_epoch().count();
+    m_meanAnomalyAtEpoch[body] = elements.meanAnomalyAtEpoch;
+    // assuming kGMSun = (4.0 * pi^2) AU^3/years^2, like Orbit::meanAnomaly
+    m_meanMotion[body] = 2.0 * glm::pi<double>() * std::pow(std::abs(a), -3.0 / 2.0) / kEarthYearInDays;
+    m_eccentricity[body] = e;
+    m_semiMajorAxis[body] = a;
+    m_semiMinorAxis[body] = e < 1.0 ? a * std::sqrt(1.0 - e * e) : 0.0;
+    m_periapsisX[body] = rotation[0][0];
+    m_periapsisY[body] = rotation[0][1];
+    m_periapsisZ[body] = rotation[0][2];
+    m_minorAxisX[body] = rotation[1][0];
+    m_minorAxisY[body] = rotation[1][1];
+    m_minorAxisZ[body] = rotation[1][2];
+
+    const auto it = std::ranges::lower_bound(m_hyperbolicBodies, body);
+    const auto wasHyperbolic = it != m_hyperbolicBodies.end() && *it == body;
+    const auto elementsIt = m_hyperbolicElements.begin() + std::distance(m_hyperbolicBodies.begin(), it);
+    if (e >= 1.0)
+    {
+        if (wasHyperbolic)
+        {
+            *elementsIt = elements;
+        }
+        else
+        {
+            m_hyperbolicElements.insert(elementsIt, elements);
+            m_hyperbolicBodies.insert(it, body);
+        }
+    }
+    else if (wasHyperbolic)
+    {
+        m_hyperbolicElements.erase(elementsIt);
+        m_hyperbolicBodies.erase(it);
+    }
+}
+
+void Ephemeris::clear()
+{
+    for (auto *values : {&m_epoch, &m_meanAnomalyAtEpoch, &m_meanMotion, &m_eccentricity, &m_semiMajorAxis,
+                         &m_semiMinorAxis, &m_periapsisX, &m_periapsisY, &m_periapsisZ, &m_minorAxisX, &m_minorAxisY,
+                         &m_minorAxisZ})
+        values->clear();
+    m_hyperbolicBodies.clear();
+    m_hyperbolicElements.clear();
+}
+
+Ephemeris::OrbitPlane Ephemeris::orbitPlane(std::size_t body) const
+{
+    return {{m_periapsisX[body], m_periapsisY[body], m_periapsisZ[body]},
+            {m_minorAxisX[body], m_minorAxisY[body], m_minorAxisZ[body]}};
+}
+
+JulianDays Ephemeris::period(std::size_t body) const
+{
+    assert(!isHyperbolic(body));
+    return JulianDays{2.0 * glm::pi<double>() / m_meanMotion[body]};
+}
+
+void Ephemeris::compute(JulianDate date, const Output &output, ThreadPool *threadPool) const
+{
+    assert(output.positions.empty() || output.positions.size() >= size());
+    assert(output.velocities.empty() || output.velocities.size() >= size());
+    assert(output.positionsOnOrbitPlane.empty() || output.positionsOnOrbitPlane.size() >= size());
+
+    if (threadPool && size() > kGrainSize)
+        threadPool->parallelFor(size(), kGrainSize,
+                                [&](std::size_t begin, std::size_t end) { computeRange(date, begin, end, output); });
+    else
+        computeRange(date, 0, size(), output);
+}
+
+void Ephemeris::compute(std::size_t body, std::span<const JulianDate> dates, const Output &output) const
+{
+    using P = simd::Pack<double>;
+    constexpr auto kWidth = simd::kWidth<P>;
+
+    assert(body < size());
+    assert(output.positions.empty() || output.positions.size() >= dates.size());
+    assert(output.velocities.empty() || output.velocities.size() >= dates.size());
+    assert(output.positionsOnOrbitPlane.empty() || output.positionsOnOrbitPlane.size() >= dates.size());
+
+    if (isHyperbolic(body))
+    {
+        for (std::size_t i = 0; i < dates.size(); ++i)
+            computeHyperbolic(body, dates[i], i, output);
+        return;
+    }
+
+    const OrbitPacks<P> orbits{.epoch = P{m_epoch[body]},
+                               .meanAnomalyAtEpoch = P{m_meanAnomalyAtEpoch[body]},
+                               .meanMotion = P{m_meanMotion[body]},
+                               .eccentricity = P{m_eccentricity[body]},
+                               .semiMajorAxis = P{m_semiMajorAxis[body]},
+                               .semiMinorAxis = P{m_semiMinorAxis[body]},
+                               .periapsis = {P{m_periapsisX[body]}, P{m_periapsisY[body]}, P{m_periapsisZ[body]}},
+                               .minorAxis = {P{m_minorAxisX[body]}, P{m_minorAxisY[body]}, P{m_minorAxisZ[body]}}};
+    for (std::size_t first = 0; first < dates.size(); first += kWidth)
+    {
+        // the last batch is padded with copies of its first date, their results are thrown away
+        const auto count = std::min(kWidth, dates.size() - first);
+        const auto days = simd::generate<P>(
+            [&](std::size_t lane) { return dates[first + (lane < count ? lane : 0)].time_since_epoch().count(); });
+        writeStates(orbits, days, count, first, output);
+    }
+}
+
+void Ephemeris::computeRange(JulianDate date, std::size_t begin, std::size_t end, const Output &output) const
+{
+    using P = simd::Pack<double>;
+    constexpr auto kWidth = simd::kWidth<P>;
+
+    const P days{date.time_since_epoch().count()};
+    for (std::size_t first = begin; first < end; first += kWidth)
+    {
+        // the last batch is padded with copies of its first body, their results are thrown away
+        const auto count = std::min(kWidth, end - first);
+        const auto load = [first, count](const std::vector<double> &values) {
+            return simd::generate<P>([&](std::size_t lane) { return values[first + (lane < count ? lane : 0)]; });
+        };
+        const OrbitPacks<P> orbits{.epoch = load(m_epoch),
+                                   .meanAnomalyAtEpoch = load(m_meanAnomalyAtEpoch),
+                                   .meanMotion = load(m_meanMotion),
+                                   .eccentricity = load(m_eccentricity),
+                                   .semiMajorAxis = load(m_semiMajorAxis),
+                                   .semiMinorAxis = load(m_semiMinorAxis),
+                                   .periapsis = {load(m_periapsisX), load(m_periapsisY), load(m_periapsisZ)},
+                                   .minorAxis = {load(m_minorAxisX), load(m_minorAxisY), load(m_minorAxisZ)}};
+        writeStates(orbits, days, count, first, output);
+    }
+
+    // overwrite the garbage the elliptic kernel produced for hyperbolic orbits
+    const auto hyperbolicBegin = std::ranges::lower_bound(m_hyperbolicBodies, begin);
+    const auto hyperbolicEnd = std::ranges::lower_bound(m_hyperbolicBodies, end);
+    for (auto it = hyperbolicBegin; it != hyperbolicEnd; ++it)
+        computeHyperbolic(*it, date, *it, output);
+}
+
+void Ephemeris::computeHyperbolic(std::size_t body, JulianDate date, std::size_t outputIndex,
+                                  const Output &output) const
+{
+    const auto it = std::ranges::lower_bound(m_hyperbolicBodies, body);
+    assert(it != m_hyperbolicBodies.end() && *it == body);
+    const Orbit orbit(m_hyperbolicElements[std::distance(m_hyperbolicBodies.begin(), it)]);
+
+    const auto [positionOnOrbitPlane, velocityOnOrbitPlane] = orbit.stateVectorOnOrbitPlane(date);
+    const auto rotation = orbit.orbitRotationMatrix();
+    if (!output.positionsOnOrbitPlane.empty())
+        output.positionsOnOrbitPlane[outputIndex] = positionOnOrbitPlane;
+    if (!output.positions.empty())
+        output.positions[outputIndex] = rotation * glm::dvec3(positionOnOrbitPlane, 0.0);
+    if (!output.velocities.empty())
+        output.velocities[outputIndex] = rotation * glm::dvec3(velocityOnOrbitPlane, 0.0);
+}
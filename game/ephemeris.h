@@ -0,0 +1,68 @@
+#pragma once
+
+#include "julian_clock.h"
+#include "orbital_elements.h"
+
+#include <glm/glm.hpp>
+
+#include <span>
+#include <vector>
+
+class Orbit;
+class ThreadPool;
+
+// Batch version of Orbit::stateVector. The elements of every orbit are kept in structure-of-arrays form, together with
+// the constants derived from them (mean motion, semi-minor axis, orientation of the orbit plane), so that Kepler's
+// equation can be solved for several bodies at once in SIMD lanes. Hyperbolic orbits are rare and fall back to Orbit.
+class Ephemeris
+{
+public:
+    // Where compute() writes its results, one element per body or per date. Empty spans are skipped.
+    struct Output
+    {
+        std::span<glm::dvec3> positions;             // AU
+        std::span<glm::dvec3> velocities;            // AU/day
+        std::span<glm::dvec2> positionsOnOrbitPlane; // AU
+    };
+
+    // Positions are positionOnOrbitPlane.x * periapsis + positionOnOrbitPlane.y * minorAxis.
+    struct OrbitPlane
+    {
+        glm::dvec3 periapsis;
+        glm::dvec3 minorAxis;
+    };
+
+    // Returns the index of the body.
+    std::size_t add(const Orbit &orbit);
+    void set(std::size_t body, const Orbit &orbit);
+    void clear();
+
+    std::size_t size() const { return m_epoch.size(); }
+
+    OrbitPlane orbitPlane(std::size_t body) const;
+    bool isHyperbolic(std::size_t body) const { return m_eccentricity[body] >= 1.0; }
+    JulianDays period(std::size_t body) const; // of elliptic orbits
+
+    // State of every body at `date`. If `threadPool` is not null, large batches are split across it.
+    void compute(JulianDate date, const Output &output, ThreadPool *threadPool = nullptr) const;
+
+    // State of one body at each of `dates`.
+    void compute(std::size_t body, std::span<const JulianDate> dates, const Output &output) const;
+
+private:
+    void computeRange(JulianDate date, std::size_t begin, std::size_t end, const Output &output) const;
+    void computeHyperbolic(std::size_t body, JulianDate date, std::size_t outputIndex, const Output &output) const;
+
+    std::vector<double> m_epoch;              // days
+    std::vector<double> m_meanAnomalyAtEpoch; // radians
+    std::vector<double> m_meanMotion;         // radians/day
+    std::vector<double> m_eccentricity;
+    std::vector<double> m_semiMajorAxis; // AU
+    std::vector<double> m_semiMinorAxis; // AU
+    // first two columns of Orbit::orbitRotationMatrix: directions of the periapsis and of the semi-minor axis
+    std::vector<double> m_periapsisX, m_periapsisY, m_periapsisZ;
+    std::vector<double> m_minorAxisX, m_minorAxisY, m_minorAxisZ;
+    // e >= 1, solved with Orbit
+    std::vector<std::size_t> m_hyperbolicBodies;
+    std::vector<OrbitalElements> m_hyperbolicElements;
+};
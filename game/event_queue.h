@@ -0,0 +1,69 @@
+#pragma once
+
+#include "julian_clock.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Events keyed by date, in a binary heap. Events at the same date come out in the order they were pushed, so that a
+// step of the simulation that crosses several of them applies them in a deterministic order.
+template<typename T>
+class EventQueue
+{
+public:
+    void push(JulianDate date, T event)
+    {
+        m_events.push_back({date, m_nextSequence++, std::move(event)});
+        std::push_heap(m_events.begin(), m_events.end(), Later{});
+    }
+
+    // Pops the events dated before `date`, earliest first, and passes them to `func(date, event)`. Events that `func`
+    // pushes are popped too if they're due. Returns the number of events popped.
+    template<typename Func>
+    std::size_t popDue(JulianDate date, Func &&func)
+    {
+        std::size_t count = 0;
+        while (!m_events.empty() && m_events.front().date < date)
+        {
+            std::pop_heap(m_events.begin(), m_events.end(), Later{});
+            auto entry = std::move(m_events.back());
+            m_events.pop_back();
+            func(entry.date, std::move(entry.event));
+            ++count;
+        }
+        return count;
+    }
+
+    bool empty() const { return m_events.empty(); }
+    std::size_t size() const { return m_events.size(); }
+    JulianDate nextDate() const { return m_events.front().date; } // if not empty
+
+    void clear()
+    {
+        m_events.clear();
+        m_nextSequence = 0;
+    }
+
+private:
+    struct Entry
+    {
+        JulianDate date;
+        std::uint64_t sequence;
+        T event;
+    };
+
+    // std heaps put the largest element first
+    struct Later
+    {
+        bool operator()(const Entry &lhs, const Entry &rhs) const
+        {
+            if (lhs.date != rhs.date)
+                return lhs.date > rhs.date;
+            return lhs.sequence > rhs.sequence;
+        }
+    };
+
+    std::vector<Entry> m_events;
+    std::uint64_t m_nextSequence{0};
+};
@@ -2,7 +2,10 @@
 
 #include "universe.h"
 #include "universe_map.h"
+#include "mission_optimizer.h"
 #include "mission_table.h"
+#include "mission_table_builder.h"
+#include "mission_table_cache.h"
 
 #include "date_gizmo.h"
 #include "trading_window.h"
@@ -13,65 +16,26 @@
 #include <base/asset_path.h>
 #include <base/shader_manager.h>
 #include <base/painter.h>
+#include <base/thread_pool.h>
 
 #include <glm/gtx/string_cast.hpp>
 
-#include <mdspan>
-
-namespace
-{
-
-std::optional<MissionPlan> findMissionPlan(const MissionTable *missionTable)
-{
-    std::optional<MissionPlan> bestPlan;
-
-    std::println("{}x{}", missionTable->arrivals.size(), missionTable->departures.size());
-
-    auto orbits = std::mdspan(missionTable->transferOrbits.data(), missionTable->arrivals.size(),
-                              missionTable->departures.size());
-    for (std::size_t i = 0; i != orbits.extent(0); ++i)
-    {
-        assert(i < missionTable->arrivals.size());
-        const auto [timeArrival, posArrival, velWorldArrival] = missionTable->arrivals[i];
-        for (std::size_t j = 0; j < orbits.extent(1); ++j)
-        {
-            assert(j < missionTable->departures.size());
-            const auto [timeDeparture, posDeparture, velWorldDeparture] = missionTable->departures[j];
-            if (const auto &orbit = orbits[i, j])
-            {
-                if (!bestPlan ||
-                    orbit->deltaVDeparture + orbit->deltaVArrival < bestPlan->deltaVDeparture + bestPlan->deltaVArrival)
-                {
-                    const auto orbitalElements =
-                        orbitalElementsFromStateVector(posArrival, orbit->velArrival, timeArrival);
-                    bestPlan = MissionPlan{.origin = missionTable->origin(),
-                                           .destination = missionTable->destination(),
-                                           .departureDate = timeDeparture,
-                                           .arrivalDate = timeArrival};
-                    bestPlan->orbit.setElements(orbitalElements);
-                    bestPlan->deltaVDeparture = orbit->deltaVDeparture;
-                    bestPlan->deltaVArrival = orbit->deltaVArrival;
-                }
-            }
-        }
-    }
-
-    return bestPlan;
-}
-
-} // namespace
-
 Game::Game() = default;
 
 Game::~Game() = default;
 
 bool Game::initialize()
 {
+    m_threadPool = std::make_unique<ThreadPool>();
+
     m_universe = std::make_unique<Universe>();
     if (!m_universe->load(dataFilePath("universe.json")))
         return false;
 
     m_universe->setDate(JulianClock::now() + JulianYears{150.0});
+    // the date moves by a fraction of a day per frame
+    m_universe->setPropagation(Universe::Propagation::Incremental);
+    m_universe->setThreadPool(m_threadPool.get());
 
     m_overlayPainter = std::make_unique<Painter>();
 
@@ -86,8 +50,17 @@ bool Game::initialize()
     const auto *shipClass = shipClasses[1];
 
     auto ship = m_universe->addShip(shipClass, origin, "SIGBUS");
-    m_missionTable = std::make_unique<MissionTable>(origin, destination, m_universe->date(), 0.03);
-    auto plan = findMissionPlan(m_missionTable.get());
+    const MissionTable::Settings missionTableSettings{.maxDeltaV = 0.03, .adaptiveRefinement = true};
+    const MissionTableCache missionTableCache;
+    // tables start at midnight, so that runs on the same day find them in the cache, but the ship can't leave before
+    // the current date
+    const auto missionTableStart = toJulianDate(toYearMonthDay(m_universe->date()));
+    // the ship needs its plan right away, so this one is built up front
+    const auto missionTable = missionTableCache.loadOrSolve(origin, destination, missionTableStart,
+                                                            missionTableSettings, m_threadPool.get());
+    MissionOptimizer missionOptimizer(missionTable.get());
+    missionOptimizer.setEarliestDeparture(m_universe->date());
+    auto plan = missionOptimizer.bestPlan();
     if (plan.has_value())
     {
         const auto transferDeparture = plan->orbit.stateVector(plan->departureDate);
@@ -113,11 +86,15 @@ bool Game::initialize()
 #endif
 
 #if 0
-    m_missionPlanGizmo = m_uiRoot->appendChild<MissionPlanGizmo>(ship, m_missionTable.get());
+    m_missionTableBuilder = std::make_unique<MissionTableBuilder>(
+        origin, destination, missionTableStart, missionTableSettings, m_threadPool.get(), &missionTableCache);
+    m_missionPlanGizmo = m_uiRoot->appendChild<MissionPlanGizmo>(ship, m_missionTableBuilder->table());
     m_missionPlanGizmo->setAlign(ui::Align::Left | ui::Align::VerticalCenter);
 
     m_missionPlanGizmo->confirmClickedSignal.connect([this] {
         m_uiRoot->removeChild(m_missionPlanGizmo);
+        m_missionPlanGizmo = nullptr;
+        m_missionTableBuilder.reset();
         m_timeStep = JulianDate::duration{30.0f};
     });
 #else
@@ -178,6 +155,13 @@ void Game::render() const
 void Game::update(Seconds elapsed)
 {
     m_universe->update(elapsed.count() * m_timeStep);
+    if (m_missionTableBuilder)
+    {
+        // pick up the results of the background build as they come, then keep the porkchop plot of the mission
+        // planner in sync with the current date
+        if (!m_missionTableBuilder->poll() && m_missionTableBuilder->isFinished())
+            m_missionTableBuilder->table()->advance(m_universe->date(), m_threadPool.get());
+    }
     m_universeMap->update(elapsed);
 }
 
@@ -12,12 +12,13 @@ class Universe;
 class UniverseMap;
 class DateGizmo;
 class TradingWindow;
-class MissionTable;
+class MissionTableBuilder;
 class MissionPlanGizmo;
 class WorldInfoGizmo;
 class ShipInfoGizmo;
 class World;
 class Ship;
+class ThreadPool;
 
 namespace ui
 {
@@ -56,14 +57,15 @@ private:
 
     bool m_playing = false;
     SizeI m_viewportSize;
+    std::unique_ptr<ThreadPool> m_threadPool;
     std::unique_ptr<Universe> m_universe;
     std::unique_ptr<Painter> m_overlayPainter;
     std::unique_ptr<UniverseMap> m_universeMap;
+    std::unique_ptr<MissionTableBuilder> m_missionTableBuilder; // outlives the gizmos showing its table
     std::unique_ptr<ui::Rectangle> m_uiRoot;
     std::unique_ptr<ui::EventManager> m_uiEventManager;
     DateGizmo *m_dateGizmo{nullptr};
     TradingWindow *m_tradingWindow{nullptr};
-    std::unique_ptr<MissionTable> m_missionTable;
     MissionPlanGizmo *m_missionPlanGizmo{nullptr};
     WorldInfoGizmo *m_worldInfoGizmo{nullptr};
     ShipInfoGizmo *m_shipInfoGizmo{nullptr};
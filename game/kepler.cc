@@ -0,0 +1,213 @@
+#include "kepler.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+// References:
+// Danby, J. M. A. The Solution of Kepler's Equation III, Celestial Mechanics 40, 303-312, 1987
+// Murison, M. A. A Practical Method for Solving the Kepler Equation, 2006
+
+namespace
+{
+
+constexpr auto kNewtonTolerance = 1e-10;
+constexpr auto kDanbyTolerance = 1e-14;
+constexpr auto kMaxIterations = 50;
+
+// the lookup table covers e in [0, kLookupMaxEccentricity] and |M| in [0, pi], Danby takes over above
+constexpr auto kLookupMaxEccentricity = 0.95;
+constexpr std::size_t kLookupRows = 64;
+constexpr std::size_t kLookupColumns = 256;
+
+thread_local std::uint64_t t_solveCount{0};
+
+struct Reduced
+{
+    double M;     // in [0, pi]
+    double sign;  // of the mean anomaly in [-pi, pi)
+    double turns; // whole turns taken off the mean anomaly
+};
+
+Reduced reduceMeanAnomaly(double M)
+{
+    constexpr auto kPi = glm::pi<double>();
+    const auto turns = 2.0 * kPi * std::floor((M + kPi) / (2.0 * kPi));
+    const auto reduced = M - turns;
+    return {std::abs(reduced), reduced < 0.0 ? -1.0 : 1.0, turns};
+}
+
+// M in [0, pi], from Danby's starter: from E = M, Newton's method can be thrown far off near e = 1
+KeplerSolution newtonElliptic(double M, double e)
+{
+    auto E = M + 0.85 * e;
+    int iteration = 0;
+    while (iteration < kMaxIterations)
+    {
+        const auto dE = (E - e * std::sin(E) - M) / (1.0 - e * std::cos(E));
+        E -= dE;
+        ++iteration;
+        if (std::abs(dE) < kNewtonTolerance)
+            break;
+    }
+    return {E, iteration};
+}
+
+// M >= 0
+KeplerSolution newtonHyperbolic(double M, double e)
+{
+    auto H = std::log(2.0 * M / e + 1.8);
+    int iteration = 0;
+    while (iteration < kMaxIterations)
+    {
+        const auto dH = (e * std::sinh(H) - H - M) / (e * std::cosh(H) - 1.0);
+        H -= dH;
+        ++iteration;
+        if (std::abs(dH) < kNewtonTolerance)
+            break;
+    }
+    return {H, iteration};
+}
+
+// Danby's quartic correction, given f and its first three derivatives.
+double danbyStep(double f0, double f1, double f2, double f3)
+{
+    const auto d1 = -f0 / f1;
+    const auto d2 = -f0 / (f1 + 0.5 * d1 * f2);
+    return -f0 / (f1 + 0.5 * d2 * f2 + d2 * d2 * f3 / 6.0);
+}
+
+// M in [0, pi]
+KeplerSolution danbyElliptic(double M, double e)
+{
+    auto E = M + 0.85 * e;
+    int iteration = 0;
+    while (iteration < kMaxIterations)
+    {
+        const auto sinE = e * std::sin(E);
+        const auto cosE = e * std::cos(E);
+        const auto dE = danbyStep(E - sinE - M, 1.0 - cosE, sinE, cosE);
+        E += dE;
+        ++iteration;
+        if (std::abs(dE) < kDanbyTolerance)
+            break;
+    }
+    return {E, iteration};
+}
+
+// M >= 0
+KeplerSolution danbyHyperbolic(double M, double e)
+{
+    auto H = std::log(2.0 * M / e + 1.8);
+    int iteration = 0;
+    while (iteration < kMaxIterations)
+    {
+        const auto sinhH = e * std::sinh(H);
+        const auto coshH = e * std::cosh(H);
+        const auto dH = danbyStep(sinhH - H - M, coshH - 1.0, sinhH, coshH);
+        H += dH;
+        ++iteration;
+        if (std::abs(dH) < kDanbyTolerance * std::max(1.0, H))
+            break;
+    }
+    return {H, iteration};
+}
+
+// E and dE/dM = 1 / (1 - e cos E) on a grid of (e, M), interpolated with cubic Hermite polynomials along M and
+// linearly along e.
+class LookupTable
+{
+public:
+    LookupTable()
+    {
+        m_anomalies.resize(kLookupRows * (kLookupColumns + 1));
+        m_derivatives.resize(m_anomalies.size());
+        for (std::size_t row = 0; row < kLookupRows; ++row)
+        {
+            const auto e = static_cast<double>(row) * kRowSpacing;
+            for (std::size_t column = 0; column <= kLookupColumns; ++column)
+            {
+                const auto E = danbyElliptic(static_cast<double>(column) * kColumnSpacing, e).anomaly;
+                m_anomalies[index(row, column)] = E;
+                m_derivatives[index(row, column)] = 1.0 / (1.0 - e * std::cos(E));
+            }
+        }
+    }
+
+    // M in [0, pi], e in [0, kLookupMaxEccentricity]
+    double operator()(double M, double e) const
+    {
+        const auto rowPosition = e / kRowSpacing;
+        const auto row = std::min(static_cast<std::size_t>(rowPosition), kLookupRows - 2);
+        const auto t = rowPosition - static_cast<double>(row);
+        const auto columnPosition = M / kColumnSpacing;
+        const auto column = std::min(static_cast<std::size_t>(columnPosition), kLookupColumns - 1);
+        const auto s = columnPosition - static_cast<double>(column);
+        return (1.0 - t) * hermite(row, column, s) + t * hermite(row + 1, column, s);
+    }
+
+private:
+    static constexpr auto kRowSpacing = kLookupMaxEccentricity / (kLookupRows - 1);
+    static constexpr auto kColumnSpacing = glm::pi<double>() / kLookupColumns;
+
+    static std::size_t index(std::size_t row, std::size_t column) { return row * (kLookupColumns + 1) + column; }
+
+    double hermite(std::size_t row, std::size_t column, double s) const
+    {
+        const auto i = index(row, column);
+        const auto s2 = s * s;
+        const auto s3 = s2 * s;
+        return (2.0 * s3 - 3.0 * s2 + 1.0) * m_anomalies[i] + (s3 - 2.0 * s2 + s) * kColumnSpacing * m_derivatives[i] +
+               (-2.0 * s3 + 3.0 * s2) * m_anomalies[i + 1] + (s3 - s2) * kColumnSpacing * m_derivatives[i + 1];
+    }
+
+    std::vector<double> m_anomalies;
+    std::vector<double> m_derivatives;
+};
+
+// M in [0, pi], e in [0, kLookupMaxEccentricity]
+KeplerSolution lookupElliptic(double M, double e)
+{
+    static const LookupTable table;
+    const auto E = table(M, e);
+    // Halley step
+    const auto f0 = E - e * std::sin(E) - M;
+    const auto f1 = 1.0 - e * std::cos(E);
+    const auto f2 = e * std::sin(E);
+    return {E - f0 / (f1 - 0.5 * f0 * f2 / f1), 1};
+}
+
+} // namespace
+
+KeplerSolution solveKepler(KeplerSolver solver, double M, double e)
+{
+    ++t_solveCount;
+
+    if (e >= 1.0)
+    {
+        // H is odd in M
+        const auto solution =
+            solver == KeplerSolver::Newton ? newtonHyperbolic(std::abs(M), e) : danbyHyperbolic(std::abs(M), e);
+        return {std::copysign(solution.anomaly, M), solution.iterations};
+    }
+
+    if (solver == KeplerSolver::Markley)
+        return {markleyEccentricAnomaly(M, e), 0};
+
+    // E - turns is odd in M - turns
+    const auto reduced = reduceMeanAnomaly(M);
+    const auto solution = [&] {
+        if (solver == KeplerSolver::Newton)
+            return newtonElliptic(reduced.M, e);
+        if (solver == KeplerSolver::Lookup && e <= kLookupMaxEccentricity)
+            return lookupElliptic(reduced.M, e);
+        return danbyElliptic(reduced.M, e);
+    }();
+    return {reduced.sign * solution.anomaly + reduced.turns, solution.iterations};
+}
+
+std::uint64_t keplerSolveCount()
+{
+    return t_solveCount;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "simd.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <cstdint>
+
+enum class KeplerSolver
+{
+    Newton,  // Newton's method from Danby's starter, to 1e-10
+    Danby,   // Danby's starter and quartic (Householder) iteration, to 1e-14
+    Markley, // Markley's cubic starter and one fifth order correction, no loops nor branches
+    Lookup   // piecewise cubic table in (M, e) and one Halley step, to ~1e-9 rad, good enough for rendering
+};
+
+struct KeplerSolution
+{
+    double anomaly;    // eccentric anomaly E if e < 1, hyperbolic anomaly H otherwise
+    int iterations{0}; // of the iterative solvers, 0 for Markley
+};
+
+// Solves Kepler's equation M = E - e sin E (elliptic) or M = e sinh H - H (hyperbolic). The solvers that reduce M to
+// [-pi, pi] add the whole turns back, so E is continuous in M whatever the solver. Hyperbolic orbits always use Danby,
+// except with Newton, and so does Lookup above the eccentricities its table covers (0.95).
+KeplerSolution solveKepler(KeplerSolver solver, double M, double e);
+
+// Number of calls to solveKepler made so far by the calling thread, to count the solves of a frame.
+std::uint64_t keplerSolveCount();
+
+// Markley's solver for elliptic orbits, on scalars or SIMD packs.
+// Markley, F. L. Kepler Equation Solver, Celestial Mechanics and Dynamical Astronomy 63, 101-111, 1995
+template<typename P>
+P markleyEccentricAnomaly(const P &meanAnomaly, const P &e)
+{
+    using T = simd::ValueType<P>;
+    constexpr auto kPi = glm::pi<T>();
+
+    // M in [-pi, pi)
+    const P turns = T{2} * kPi * simd::floor((meanAnomaly + kPi) / (T{2} * kPi));
+    const P M = meanAnomaly - turns;
+
+    // cubic starter
+    const P alpha = (T{3} * kPi * kPi + T{1.6} * kPi * (kPi - simd::abs(M)) / (T{1} + e)) / (kPi * kPi - T{6});
+    const P d = T{3} * (T{1} - e) + alpha * e;
+    const P q = T{2} * alpha * d * (T{1} - e) - M * M;
+    const P r = T{3} * alpha * d * (d - T{1} + e) * M + M * M * M;
+    const P w = simd::cbrt(simd::abs(r) + simd::sqrt(q * q * q + r * r));
+    const P w2 = w * w;
+    const P E1 = (T{2} * r * w2 / (w2 * w2 + w2 * q + q * q) + M) / d;
+
+    // fifth order correction
+    const P sinE = simd::sin(E1);
+    const P cosE = simd::cos(E1);
+    const P f0 = E1 - e * sinE - M;
+    const P f1 = T{1} - e * cosE;
+    const P f2 = e * sinE;
+    const P f3 = e * cosE;
+    const P f4 = -f2;
+    const P d3 = -f0 / (f1 - T{0.5} * f0 * f2 / f1);
+    const P d4 = -f0 / (f1 + T{0.5} * d3 * f2 + d3 * d3 * f3 / T{6});
+    const P d5 = -f0 / (f1 + T{0.5} * d4 * f2 + d4 * d4 * f3 / T{6} + d4 * d4 * d4 * f4 / T{24});
+    return E1 + d5 + turns;
+}
@@ -1,8 +1,11 @@
 #include "lambert.h"
 
+#include "simd.h"
+
 #include <glm/gtc/constants.hpp>
 
 #include <array>
+#include <cassert>
 #include <cmath>
 
 //
@@ -18,8 +21,6 @@
 namespace
 {
 
-constexpr const auto Pi = glm::pi<double>();
-
 // this function computes the lagrange coefficient values to compute
 // the final 2 velocity vectors
 // input
@@ -35,45 +36,57 @@ constexpr const auto Pi = glm::pi<double>();
 //  fg(1) = f lagrange coefficient
 //  fg(2) = g lagrange coefficient
 //  fg(3) = gdot lagrange coefficient
-std::tuple<double, double, double> fg_battin(double mu, double a, double s, double c, double nu, double t, double r1,
-                                             double r2)
+template<typename T>
+std::tuple<T, T, T> fg_battin(T mu, T a, T s, T c, T nu, T t, T r1, T r2)
 {
-    double small_number = 1.0e-3;
-    double f, g, gdot;
+    constexpr auto Pi = glm::pi<T>();
+    const T small_number = 1.0e-3;
+    T f, g, gdot;
     if (a > small_number)
     {
-        double be = 2.0 * std::asin((std::sqrt((s - c) / (2.0 * a))));
+        T be = T{2} * std::asin((std::sqrt((s - c) / (T{2} * a))));
         if (nu > Pi)
         {
             be = -be;
         }
-        double a_min = s * 5.0e-1;
-        double t_min = std::sqrt(std::pow(a_min, 3.0) / mu) * (Pi - be + std::sin(be));
-        double dum = (std::sqrt(s / (2.0 * a)));
-        double ae = 2.0 * std::asin(dum);
+        // the time of flight on the minimum energy ellipse tells which of the two ellipses of semi-major axis a
+        // the transfer is on, so it takes the beta angle of that ellipse rather than the one of a
+        T a_min = s * T{0.5};
+        T be_min = T{2} * std::asin(std::sqrt((s - c) / s));
+        if (nu > Pi)
+        {
+            be_min = -be_min;
+        }
+        T t_min = std::sqrt(a_min * a_min * a_min / mu) * (Pi - be_min + std::sin(be_min));
+        T dum = (std::sqrt(s / (T{2} * a)));
+        T ae = T{2} * std::asin(dum);
         if (t > t_min)
         {
-            ae = 2.0 * Pi - ae;
+            ae = T{2} * Pi - ae;
         }
-        double de = ae - be;
-        f = 1.0 - a / r1 * (1.0 - std::cos(de));
+        T de = ae - be;
+        f = T{1} - a / r1 * (T{1} - std::cos(de));
         g = t - std::sqrt(a * a * a / mu) * (de - std::sin(de));
-        gdot = 1.0 - a / r2 * (1.0 - cos(de));
+        gdot = T{1} - a / r2 * (T{1} - std::cos(de));
     }
     else if (a < -small_number)
     {
-        double ah = 2.0 * std::asinh(std::sqrt(s / (-2.0 * a)));
-        double bh = 2.0 * std::asinh(std::sqrt((s - c) / (-2.0 * a)));
-        double dh = ah - bh;
-        f = 1.0 - a / r1 * (1.0 - std::cosh(dh));
-        g = t - std::sqrt(std::pow(-a, 3.0) / mu) * (std::sinh(dh) - dh);
-        gdot = 1.0 - a / r2 * (1.0 - std::cosh(dh));
+        T ah = T{2} * std::asinh(std::sqrt(s / (T{-2} * a)));
+        T bh = T{2} * std::asinh(std::sqrt((s - c) / (T{-2} * a)));
+        if (nu > Pi)
+        {
+            bh = -bh;
+        }
+        T dh = ah - bh;
+        f = T{1} - a / r1 * (T{1} - std::cosh(dh));
+        g = t - std::sqrt(-a * a * a / mu) * (std::sinh(dh) - dh);
+        gdot = T{1} - a / r2 * (T{1} - std::cosh(dh));
     }
     else
     {
-        f = 0.0;
-        g = 0.0;
-        gdot = 0.0;
+        f = T{0};
+        g = T{0};
+        gdot = T{0};
     }
     return {f, g, gdot};
 }
@@ -84,23 +97,21 @@ std::tuple<double, double, double> fg_battin(double mu, double a, double s, doub
 //  u = same as the u variable in the battin description
 // output
 //  k = continued fraction value
-double k_battin(double u)
+template<typename P>
+P k_battin(const P &u)
 {
+    using T = simd::ValueType<P>;
     static constexpr std::array<double, 21> d = {
         0.33333333333333331, 0.14814814814814814, 0.29629629629629628, 0.22222222222222221, 0.27160493827160492,
         0.23344556677890010, 0.26418026418026419, 0.23817663817663817, 0.26056644880174290, 0.24079807361541108,
         0.25842383737120578, 0.24246606855302508, 0.25700483091787441, 0.24362139917695474, 0.25599545906059318,
         0.24446916326782844, 0.25524057782122300, 0.24511784511784512, 0.25465465465465464, 0.24563024563024563,
         0.25418664443054689};
-    // clang-format off
-    return d[0] / (1.0 + d[1] * u / (1.0 + d[2] * u / (1.0 + d[3] * u /
-           (1.0 + d[4] * u / (1.0 + d[5] * u/ (1.0 + d[6] * u /
-           (1.0 + d[7] * u / (1.0 + d[8] * u / (1.0 + d[9] * u /
-           (1.0 + d[10] * u / (1.0 + d[11] * u / (1.0 + d[12] * u /
-           (1.0 + d[13] * u / (1.0 + d[14] * u / (1.0 + d[15] * u /
-           (1.0 + d[16] * u / (1.0 + d[17] * u / (1.0 + d[18] * u /
-           (1.0 + d[19] * u / (1.0 + d[20] * u))))))))))))))))))));
-    // clang-format on
+    // d[0] / (1 + d[1] * u / (1 + d[2] * u / ... (1 + d[20] * u))), evaluated from the innermost term out
+    P k = T{1} + static_cast<T>(d[20]) * u;
+    for (std::size_t i = d.size() - 2; i > 0; --i)
+        k = T{1} + static_cast<T>(d[i]) * u / k;
+    return static_cast<T>(d[0]) / k;
 }
 
 // this function computes the first continued fraction for the battin
@@ -110,126 +121,262 @@ double k_battin(double u)
 // output
 //  xi = value for the continued fraction
 // Orbital Mechanics with MATLAB
-double xi_battin(double x)
+template<typename P>
+P xi_battin(const P &x)
 {
+    using T = simd::ValueType<P>;
     static constexpr std::array<double, 20> c = {
         0.25396825396825395, 0.25252525252525254, 0.25174825174825177, 0.25128205128205128, 0.25098039215686274,
         0.25077399380804954, 0.25062656641604009, 0.25051759834368531, 0.25043478260869567, 0.25037037037037035,
         0.25031928480204341, 0.25027808676307006, 0.25024437927663734, 0.25021645021645023, 0.25019305019305021,
         0.25017325017325015, 0.25015634771732331, 0.25014180374361883, 0.25012919896640828, 0.25011820330969264};
-    double eta = x / std::pow(std::sqrt(1.0 + x) + 1.0, 2.0);
-    // clang-format off
-    return 8.0 * (std::sqrt(1.0 + x) + 1.0) / (3.0 + 1.0 /
-           (5.0 + eta + 9.0 / 7.0 * eta / (1.0 + c[0] * eta /
-           (1.0 + c[1] * eta / (1.0 + c[2] * eta / (1.0 + c[3] * eta /
-           (1.0 + c[4] * eta / (1.0 + c[5] * eta / (1.0 + c[6] * eta /
-           (1.0 + c[7] * eta /(1.0 + c[8] * eta / (1.0 + c[9] * eta /
-           (1.0 + c[10] * eta / (1.0 + c[11] * eta / (1.0 + c[12] * eta /
-           (1.0 + c[13] * eta / (1.0 + c[14] * eta / (1.0 + c[15] * eta /
-           (1.0 + c[16] * eta / (1.0 + c[17] * eta / (1.0 + c[18] * eta /
-           (1.0 + c[19] * eta))))))))))))))))))))));
-    // clang-format on
+    const P sqrtx1 = simd::sqrt(T{1} + x) + T{1};
+    const P eta = x / (sqrtx1 * sqrtx1);
+    // 8 * (sqrt(1 + x) + 1) / (3 + 1 / (5 + eta + 9 / 7 * eta / (1 + c[0] * eta / ... (1 + c[19] * eta)))),
+    // evaluated from the innermost term out
+    P xi = T{1} + static_cast<T>(c[19]) * eta;
+    for (std::size_t i = c.size() - 1; i > 0; --i)
+        xi = T{1} + static_cast<T>(c[i - 1]) * eta / xi;
+    xi = T{5} + eta + static_cast<T>(9.0 / 7.0) * eta / xi;
+    return T{8} * sqrtx1 / (T{3} + T{1} / xi);
 }
 
-} // namespace
+template<typename T>
+constexpr T kTolerance = 1.0e-8;
 
-// this function contains the battin lambert solution method
-// inputs
-//  mu = gravitational constant (kilometers^3/seconds^2)
-//  r1 = initial position vector (kilometers)
-//  r2 = final position vector (kilometers)
-//  dt = transfer time (seconds)
-//  ot = orbit type (1 = prograde, 2 = retrograde)
-// outputs
-// vi = initial velocity vector of transfer orbit (kilometers/second)
-// vf = final velocity vector of transfer orbit (kilometers/second)
-// Battin, R. An Introduction to the Mathematics and Methods of Astrodynamics,
-// Chapter 7: Solving Lambert's Problem, AIAA Education Series,
-// 1801 Alexander Bell Drive, Reston, VA, Revised Edition edition, 1999
-std::optional<TransferVelocities> lambert_battin(double mu, const glm::dvec3 &r1, const glm::dvec3 &r2, double dt,
-                                                 OrbitType ot)
+// the iteration can't get below float's epsilon, so the single precision solver is only good for screening
+template<>
+constexpr float kTolerance<float> = 1.0e-5f;
+
+constexpr int kMaxIterations = 20;
+
+// Geometry of a single problem, everything the successive substitution loop and the final velocity computation need.
+template<typename T>
+struct BattinProblem
+{
+    glm::vec<3, T> r1;
+    glm::vec<3, T> r2;
+    T mu;
+    T dt;
+    T r1mag;
+    T r2mag;
+    T nu;
+    T c;
+    T s;
+    T l;
+    T m;
+    T rop;
+    T x0; // initial guess
+};
+
+template<typename T>
+BattinProblem<T> battinProblem(double mu, const glm::dvec3 &r1, const glm::dvec3 &r2, double dt, OrbitType ot)
 {
-    // convergence tolerance
-    double tol = 1.0e-8;
-    double r1mag = glm::length(r1);
-    double r2mag = glm::length(r2);
+    constexpr auto Pi = glm::pi<T>();
+    BattinProblem<T> problem{.r1 = glm::vec<3, T>{r1},
+                             .r2 = glm::vec<3, T>{r2},
+                             .mu = static_cast<T>(mu),
+                             .dt = static_cast<T>(dt)};
+    const T r1mag = glm::length(problem.r1);
+    const T r2mag = glm::length(problem.r2);
     // determine true anomaly angle here (radians)
-    glm::dvec3 c12 = glm::cross(r1, r2);
-    double nu = std::acos(glm::dot(r1, r2) / (r1mag * r2mag));
+    const auto c12 = glm::cross(problem.r1, problem.r2);
+    T nu = std::acos(glm::dot(problem.r1, problem.r2) / (r1mag * r2mag));
     // determine the true anomaly angle using the orbit type
     // 1 is prograde, 2 is retrograde
     if (ot == OrbitType::Prograde)
     {
-        if (c12.z <= 0.0)
+        if (c12.z <= T{0})
         {
-            nu = 2.0 * Pi - nu;
+            nu = T{2} * Pi - nu;
         }
     }
     if (ot == OrbitType::Retrograde)
     {
-        if (c12.z >= 0.0)
+        if (c12.z >= T{0})
         {
-            nu = 2.0 * Pi - nu;
+            nu = T{2} * Pi - nu;
         }
     }
-    double c = std::sqrt(r1mag * r1mag + r2mag * r2mag - 2.0 * r1mag * r2mag * std::cos(nu));
-    double s = (r1mag + r2mag + c) / 2.0;
-    double eps = (r2mag - r1mag) / r1mag;
-    double lam = std::sqrt(r1mag * r2mag) * std::cos(nu * 0.5) / s;
-    double t = sqrt(8.0 * mu / std::pow(s, 3.0)) * dt;
-    double t_p = 4.0 / 3.0 * (1.0 - std::pow(lam, 3.0));
-    double m = std::pow(t, 2.0) / std::pow(1.0 + lam, 6.0);
-    double tansq2w = (eps * eps * 0.25) / (std::sqrt(r2mag / r1mag) + r2mag / r1mag * (2.0 + sqrt(r2mag / r1mag)));
-    double rop = std::sqrt(r2mag * r1mag) * (std::cos(nu * 0.25) * std::cos(nu * 0.25) + tansq2w);
-    double ltop, l;
+    const T c = std::sqrt(r1mag * r1mag + r2mag * r2mag - T{2} * r1mag * r2mag * std::cos(nu));
+    const T s = (r1mag + r2mag + c) / T{2};
+    const T eps = (r2mag - r1mag) / r1mag;
+    const T lam = std::sqrt(r1mag * r2mag) * std::cos(nu * T{0.5}) / s;
+    const T t = std::sqrt(T{8} * problem.mu / (s * s * s)) * problem.dt;
+    const T t_p = T{4} / T{3} * (T{1} - lam * lam * lam);
+    const T m = t * t / std::pow(T{1} + lam, T{6});
+    const T tansq2w =
+        (eps * eps * T{0.25}) / (std::sqrt(r2mag / r1mag) + r2mag / r1mag * (T{2} + std::sqrt(r2mag / r1mag)));
+    const T rop = std::sqrt(r2mag * r1mag) * (std::cos(nu * T{0.25}) * std::cos(nu * T{0.25}) + tansq2w);
+    T ltop, l;
     if (nu < Pi)
     {
-        ltop = (std::sin(nu * 25.0e-2) * std::sin(nu * 25.0e-2) + tansq2w);
-        l = ltop / (ltop + std::cos(nu * 5.0e-1));
+        ltop = (std::sin(nu * T{0.25}) * std::sin(nu * T{0.25}) + tansq2w);
+        l = ltop / (ltop + std::cos(nu * T{0.5}));
     }
     else
     {
-        ltop = std::cos(nu * 25.0e-2) * std::cos(nu * 25.0e-2) + tansq2w;
-        l = (ltop - std::cos(nu * 5.0e-1)) / ltop;
+        ltop = std::cos(nu * T{0.25}) * std::cos(nu * T{0.25}) + tansq2w;
+        l = (ltop - std::cos(nu * T{0.5})) / ltop;
     }
+    problem.r1mag = r1mag;
+    problem.r2mag = r2mag;
+    problem.nu = nu;
+    problem.c = c;
+    problem.s = s;
+    problem.l = l;
+    problem.m = m;
+    problem.rop = rop;
     // initial guess is set here
-    double x, y;
-    if (t <= t_p)
-    {
-        x = 0.0;
-    }
-    else
-    {
-        x = l;
-    }
-    double dx = 1.0;
-    int iter = 0;
-    const int itermax = 20;
+    problem.x0 = t <= t_p ? T{0} : l;
+    return problem;
+}
+
+template<typename P>
+struct BattinIteration
+{
+    P x;
+    P y;
+    P iterations;
+};
+
+// Successive substitution on every lane of the packs. A lane stops being updated as soon as it converges (or runs out
+// of iterations), so each lane ends up with exactly the values the scalar loop would produce for it.
+template<typename P>
+BattinIteration<P> battinIterate(P x, const P &l, const P &m)
+{
+    using T = simd::ValueType<P>;
+    constexpr T tol = kTolerance<T>;
+    P y{T{0}};
+    P dx{T{1}};
+    P iterations{T{0}};
+    auto active = dx >= tol;
     // this loop does the successive substitution
-    while (dx >= tol && iter <= itermax)
+    while (simd::anyOf(active))
     {
-        double xi = xi_battin(x);
-        double denom = (1.0 + 2.0 * x + l) * (4.0 * x + xi * (3.0 + x));
-        double h1 = std::pow(l + x, 2.0) * (1.0 + 3.0 * x + xi) / denom;
-        double h2 = (m * (x - l + xi)) / denom;
-        double b = 27.0 * h2 * 25.0e-2 / std::pow(1.0 + h1, 3.0);
-        double u = b / (2.0 * (std::sqrt(1.0 + b) + 1.0));
-        double k = k_battin(u);
-        y = (1.0 + h1) / 3.0 * (2.0 + std::sqrt(1.0 + b) / (1.0 + 2.0 * u * k * k));
-        double xnew = std::sqrt(std::pow((1.0 - l) / 2.0, 2.0) + m / (y * y)) - (1.0 + l) / 2.0;
-        dx = std::abs(x - xnew);
-        x = xnew;
-        iter = iter + 1;
+        const P xi = xi_battin(x);
+        const P denom = (T{1} + T{2} * x + l) * (T{4} * x + xi * (T{3} + x));
+        const P h1 = (l + x) * (l + x) * (T{1} + T{3} * x + xi) / denom;
+        const P h2 = (m * (x - l + xi)) / denom;
+        const P h1cube = (T{1} + h1) * (T{1} + h1) * (T{1} + h1);
+        const P b = T{27} * h2 * T{0.25} / h1cube;
+        const P sqrtb1 = simd::sqrt(T{1} + b);
+        const P u = b / (T{2} * (sqrtb1 + T{1}));
+        const P k = k_battin(u);
+        const P ynew = (T{1} + h1) / T{3} * (T{2} + sqrtb1 / (T{1} + T{2} * u * k * k));
+        const P halfOneMinusL = (T{1} - l) / T{2};
+        const P xnew = simd::sqrt(halfOneMinusL * halfOneMinusL + m / (ynew * ynew)) - (T{1} + l) / T{2};
+        dx = simd::select(active, simd::abs(x - xnew), dx);
+        x = simd::select(active, xnew, x);
+        y = simd::select(active, ynew, y);
+        iterations = simd::select(active, iterations + T{1}, iterations);
+        active = dx >= tol && iterations <= T{kMaxIterations};
     }
-    if (iter > itermax)
+    return {x, y, iterations};
+}
+
+template<typename T>
+std::optional<TransferVelocities> battinVelocities(const BattinProblem<T> &problem, T x, T y, T iterations)
+{
+    if (iterations > T{kMaxIterations})
     {
         // solution wasn't found
         return {};
     }
 
-    double a = mu * dt * dt / (16.0 * rop * rop * x * y * y);
+    const auto &[r1, r2, mu, dt, r1mag, r2mag, nu, c, s, l, m, rop, x0] = problem;
+    const T a = mu * dt * dt / (T{16} * rop * rop * x * y * y);
     auto [f, g, gdot] = fg_battin(mu, a, s, c, nu, dt, r1mag, r2mag);
     auto v1 = (r2 - f * r1) / g;
     auto v2 = (gdot * r2 - r1) / g;
-    return TransferVelocities{v1, v2};
+    return TransferVelocities{glm::dvec3{v1}, glm::dvec3{v2}};
+}
+
+} // namespace
+
+// this function contains the battin lambert solution method
+// inputs
+//  mu = gravitational constant (kilometers^3/seconds^2)
+//  r1 = initial position vector (kilometers)
+//  r2 = final position vector (kilometers)
+//  dt = transfer time (seconds)
+//  ot = orbit type (1 = prograde, 2 = retrograde)
+// outputs
+// vi = initial velocity vector of transfer orbit (kilometers/second)
+// vf = final velocity vector of transfer orbit (kilometers/second)
+// Battin, R. An Introduction to the Mathematics and Methods of Astrodynamics,
+// Chapter 7: Solving Lambert's Problem, AIAA Education Series,
+// 1801 Alexander Bell Drive, Reston, VA, Revised Edition edition, 1999
+std::optional<TransferVelocities> lambert_battin(double mu, const glm::dvec3 &r1, const glm::dvec3 &r2, double dt,
+                                                 OrbitType ot)
+{
+    const auto problem = battinProblem<double>(mu, r1, r2, dt, ot);
+    const auto [x, y, iterations] = battinIterate(problem.x0, problem.l, problem.m);
+    return battinVelocities(problem, x, y, iterations);
+}
+
+template<typename T>
+void lambert_battin_batch(double mu, std::span<const LambertProblem> problems,
+                          std::span<std::optional<TransferVelocities>> solutions, OrbitType ot)
+{
+    using P = simd::Pack<T>;
+    constexpr auto kWidth = simd::kWidth<P>;
+
+    assert(solutions.size() == problems.size());
+
+    for (std::size_t first = 0; first < problems.size(); first += kWidth)
+    {
+        const auto count = std::min(kWidth, problems.size() - first);
+
+        std::array<BattinProblem<T>, kWidth> lanes;
+        for (std::size_t lane = 0; lane < kWidth; ++lane)
+        {
+            // pad the last batch with copies of its first problem, their solutions are thrown away
+            const auto &[r1, r2, dt] = problems[first + (lane < count ? lane : 0)];
+            lanes[lane] = battinProblem<T>(mu, r1, r2, dt, ot);
+        }
+
+        const auto [x, y, iterations] =
+            battinIterate(simd::generate<P>([&lanes](std::size_t lane) { return lanes[lane].x0; }),
+                          simd::generate<P>([&lanes](std::size_t lane) { return lanes[lane].l; }),
+                          simd::generate<P>([&lanes](std::size_t lane) { return lanes[lane].m; }));
+
+        for (std::size_t lane = 0; lane < count; ++lane)
+        {
+            solutions[first + lane] = battinVelocities(lanes[lane], simd::lane(x, lane), simd::lane(y, lane),
+                                                       simd::lane(iterations, lane));
+        }
+    }
+}
+
+template void lambert_battin_batch<float>(double mu, std::span<const LambertProblem> problems,
+                                          std::span<std::optional<TransferVelocities>> solutions, OrbitType ot);
+template void lambert_battin_batch<double>(double mu, std::span<const LambertProblem> problems,
+                                           std::span<std::optional<TransferVelocities>> solutions, OrbitType ot);
+
+template<typename T>
+std::size_t lambertBatchWidth()
+{
+    return simd::kWidth<simd::Pack<T>>;
+}
+
+template std::size_t lambertBatchWidth<float>();
+template std::size_t lambertBatchWidth<double>();
+
+std::vector<LambertSolution> solve_lambert(LambertSolver solver, double mu, const glm::dvec3 &r1,
+                                           const glm::dvec3 &r2, double dt, OrbitType ot, int maxRevolutions)
+{
+    switch (solver)
+    {
+    case LambertSolver::Battin: {
+        const auto problem = battinProblem<double>(mu, r1, r2, dt, ot);
+        const auto [x, y, iterations] = battinIterate(problem.x0, problem.l, problem.m);
+        if (const auto velocities = battinVelocities(problem, x, y, iterations))
+            return {LambertSolution{*velocities, 0, static_cast<int>(iterations)}};
+        return {};
+    }
+    case LambertSolver::Izzo:
+        return lambert_izzo(mu, r1, r2, dt, ot, maxRevolutions);
+    }
+    return {};
 }
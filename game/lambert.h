@@ -2,7 +2,11 @@
 
 #include <glm/glm.hpp>
 
+#include <cstddef>
+#include <optional>
+#include <span>
 #include <tuple>
+#include <vector>
 
 enum class OrbitType
 {
@@ -17,3 +21,54 @@ struct TransferVelocities
 };
 std::optional<TransferVelocities> lambert_battin(double mu, const glm::dvec3 &r1, const glm::dvec3 &r2, double dt,
                                                  OrbitType ot = OrbitType::Prograde);
+
+struct LambertProblem
+{
+    glm::dvec3 r1;
+    glm::dvec3 r2;
+    double dt;
+};
+
+// Solves a batch of problems with the Battin method, running the iteration for several problems at once in SIMD lanes.
+// T is the precision used for the computation: double agrees with lambert_battin down to rounding, float is about twice
+// as fast but only good to ~1e-5 in relative terms, so its solutions should be refined before they're used.
+template<typename T>
+void lambert_battin_batch(double mu, std::span<const LambertProblem> problems,
+                          std::span<std::optional<TransferVelocities>> solutions, OrbitType ot = OrbitType::Prograde);
+
+extern template void lambert_battin_batch<float>(double mu, std::span<const LambertProblem> problems,
+                                                 std::span<std::optional<TransferVelocities>> solutions, OrbitType ot);
+extern template void lambert_battin_batch<double>(double mu, std::span<const LambertProblem> problems,
+                                                  std::span<std::optional<TransferVelocities>> solutions, OrbitType ot);
+
+// Number of problems lambert_battin_batch<T> solves at once.
+template<typename T>
+std::size_t lambertBatchWidth();
+
+extern template std::size_t lambertBatchWidth<float>();
+extern template std::size_t lambertBatchWidth<double>();
+
+struct LambertSolution
+{
+    TransferVelocities velocities;
+    int revolutions;
+    int iterations;
+};
+
+// Izzo's solver: Householder iterations on the x variable of the universal time of flight equation. Returns the
+// zero revolution solution followed by the left and right branches of every multi-revolution solution up to
+// `maxRevolutions` that exists for the given time of flight.
+// Izzo, D. Revisiting Lambert's problem, Celestial Mechanics and Dynamical Astronomy 121, 1-15 (2015)
+std::vector<LambertSolution> lambert_izzo(double mu, const glm::dvec3 &r1, const glm::dvec3 &r2, double dt,
+                                          OrbitType ot = OrbitType::Prograde, int maxRevolutions = 0);
+
+enum class LambertSolver
+{
+    Battin,
+    Izzo
+};
+
+// Common entry point for both solvers. Battin only ever finds the zero revolution solution.
+std::vector<LambertSolution> solve_lambert(LambertSolver solver, double mu, const glm::dvec3 &r1,
+                                           const glm::dvec3 &r2, double dt, OrbitType ot = OrbitType::Prograde,
+                                           int maxRevolutions = 0);
@@ -0,0 +1,249 @@
+#include "lambert.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+constexpr auto Pi = glm::pi<double>();
+
+constexpr int kMaxIterations = 15;
+
+// Non-dimensional time of flight equation for a given lambda = +-sqrt(1 - c / s), see section 2 of the paper.
+class TimeOfFlight
+{
+public:
+    explicit TimeOfFlight(double lambda)
+        : m_lambda(lambda)
+    {
+    }
+
+    // Non-dimensional time of flight for `x` and `n` revolutions. Uses Battin's series close to the parabola,
+    // Lagrange's expression around it and Lancaster's everywhere else.
+    double operator()(double x, int n) const
+    {
+        constexpr double kBattin = 0.01;
+        constexpr double kLagrange = 0.2;
+        const double dist = std::abs(x - 1.0);
+        if (dist < kLagrange && dist > kBattin)
+            return lagrange(x, n);
+
+        const double k = m_lambda * m_lambda;
+        const double e = x * x - 1.0;
+        const double rho = std::abs(e);
+        const double z = std::sqrt(1.0 + k * e);
+        if (dist < kBattin)
+        {
+            const double eta = z - m_lambda * x;
+            const double s1 = 0.5 * (1.0 - m_lambda - x * eta);
+            const double q = 4.0 / 3.0 * hypergeometricF(s1);
+            return (eta * eta * eta * q + 4.0 * m_lambda * eta) / 2.0 + n * Pi / std::pow(rho, 1.5);
+        }
+
+        const double y = std::sqrt(rho);
+        const double g = x * z - m_lambda * e;
+        double d;
+        if (e < 0.0)
+        {
+            d = n * Pi + std::acos(g);
+        }
+        else
+        {
+            const double f = y * (z - m_lambda * x);
+            d = std::log(f + g);
+        }
+        return (x - m_lambda * z - d / y) / e;
+    }
+
+    // First three derivatives of the time of flight with respect to x, given the time of flight `t` at `x`.
+    std::tuple<double, double, double> derivatives(double x, double t) const
+    {
+        const double l2 = m_lambda * m_lambda;
+        const double l3 = l2 * m_lambda;
+        const double umx2 = 1.0 - x * x;
+        const double y = std::sqrt(1.0 - l2 * umx2);
+        const double y2 = y * y;
+        const double y3 = y2 * y;
+        const double dt = 1.0 / umx2 * (3.0 * t * x - 2.0 + 2.0 * l3 * x / y);
+        const double ddt = 1.0 / umx2 * (3.0 * t + 5.0 * x * dt + 2.0 * (1.0 - l2) * l3 / y3);
+        const double dddt = 1.0 / umx2 * (7.0 * x * ddt + 8.0 * dt - 6.0 * (1.0 - l2) * l2 * l3 * x / y3 / y2);
+        return {dt, ddt, dddt};
+    }
+
+private:
+    double lagrange(double x, int n) const
+    {
+        const double a = 1.0 / (1.0 - x * x);
+        if (a > 0.0)
+        {
+            // ellipse
+            const double alpha = 2.0 * std::acos(x);
+            double beta = 2.0 * std::asin(std::sqrt(m_lambda * m_lambda / a));
+            if (m_lambda < 0.0)
+                beta = -beta;
+            return a * std::sqrt(a) * ((alpha - std::sin(alpha)) - (beta - std::sin(beta)) + 2.0 * Pi * n) / 2.0;
+        }
+        // hyperbola
+        const double alpha = 2.0 * std::acosh(x);
+        double beta = 2.0 * std::asinh(std::sqrt(-m_lambda * m_lambda / a));
+        if (m_lambda < 0.0)
+            beta = -beta;
+        return -a * std::sqrt(-a) * ((beta - std::sinh(beta)) - (alpha - std::sinh(alpha))) / 2.0;
+    }
+
+    static double hypergeometricF(double z)
+    {
+        constexpr double kTolerance = 1.0e-11;
+        double sj = 1.0;
+        double cj = 1.0;
+        for (int j = 0; std::abs(cj) > kTolerance; ++j)
+        {
+            cj = cj * (3.0 + j) * (1.0 + j) / (2.5 + j) * z / (j + 1);
+            sj += cj;
+        }
+        return sj;
+    }
+
+    double m_lambda;
+};
+
+// Householder iterations (third order) on T(x) = t starting from `x`. Returns the number of iterations, or nothing if
+// they didn't converge.
+std::optional<int> householder(const TimeOfFlight &tof, double t, double &x, int n, double tolerance)
+{
+    for (int iteration = 1; iteration <= kMaxIterations; ++iteration)
+    {
+        const double t0 = tof(x, n);
+        const auto [dt, ddt, dddt] = tof.derivatives(x, t0);
+        const double delta = t0 - t;
+        const double dt2 = dt * dt;
+        const double xnew =
+            x - delta * (dt2 - delta * ddt / 2.0) / (dt * (dt2 - delta * ddt) + dddt * delta * delta / 6.0);
+        const double error = std::abs(x - xnew);
+        x = xnew;
+        if (!std::isfinite(x))
+            return {};
+        if (error <= tolerance)
+            return iteration;
+    }
+    return {};
+}
+
+} // namespace
+
+std::vector<LambertSolution> lambert_izzo(double mu, const glm::dvec3 &r1, const glm::dvec3 &r2, double dt,
+                                          OrbitType ot, int maxRevolutions)
+{
+    if (dt <= 0.0)
+        return {};
+
+    const double c = glm::length(r2 - r1);
+    const double r1mag = glm::length(r1);
+    const double r2mag = glm::length(r2);
+    const double s = (c + r1mag + r2mag) / 2.0;
+
+    const auto ir1 = r1 / r1mag;
+    const auto ir2 = r2 / r2mag;
+    const auto h = glm::cross(ir1, ir2);
+    // the transfer plane (and with it the direction of motion) isn't defined for collinear positions
+    if (glm::length(h) == 0.0 || h.z == 0.0)
+        return {};
+    const auto ih = glm::normalize(h);
+
+    const double lambda2 = 1.0 - c / s;
+    double lambda = std::sqrt(lambda2);
+    glm::dvec3 it1, it2;
+    if (ih.z < 0.0)
+    {
+        // the transfer angle is larger than 180 degrees as seen from above the z axis
+        lambda = -lambda;
+        it1 = glm::normalize(glm::cross(ir1, ih));
+        it2 = glm::normalize(glm::cross(ir2, ih));
+    }
+    else
+    {
+        it1 = glm::normalize(glm::cross(ih, ir1));
+        it2 = glm::normalize(glm::cross(ih, ir2));
+    }
+    if (ot == OrbitType::Retrograde)
+    {
+        lambda = -lambda;
+        it1 = -it1;
+        it2 = -it2;
+    }
+    const double lambda3 = lambda * lambda2;
+    const double t = std::sqrt(2.0 * mu / (s * s * s)) * dt;
+
+    const TimeOfFlight tof(lambda);
+
+    // find the maximum number of revolutions for which there's a solution: the minimum time of flight for n
+    // revolutions is found with Halley iterations on dT/dx = 0
+    const double t00 = std::acos(lambda) + lambda * std::sqrt(1.0 - lambda2);
+    const double t1 = 2.0 / 3.0 * (1.0 - lambda3);
+    int maxN = static_cast<int>(t / Pi);
+    if (maxN > 0 && t < t00 + maxN * Pi)
+    {
+        double x = 0.0;
+        double tMin = t00 + maxN * Pi;
+        for (int iteration = 0; iteration <= 12; ++iteration)
+        {
+            const auto [dtdx, ddtdx, dddtdx] = tof.derivatives(x, tMin);
+            const double xnew = dtdx != 0.0 ? x - dtdx * ddtdx / (ddtdx * ddtdx - dtdx * dddtdx / 2.0) : x;
+            if (std::abs(x - xnew) < 1.0e-13)
+                break;
+            tMin = tof(xnew, maxN);
+            x = xnew;
+        }
+        if (tMin > t)
+            --maxN;
+    }
+    maxN = std::min(maxN, maxRevolutions);
+
+    const double gamma = std::sqrt(mu * s / 2.0);
+    const double rho = (r1mag - r2mag) / c;
+    const double sigma = std::sqrt(1.0 - rho * rho);
+
+    std::vector<LambertSolution> solutions;
+    solutions.reserve(2 * maxN + 1);
+    const auto addSolution = [&](double x, int n, std::optional<int> iterations) {
+        if (!iterations)
+            return;
+        const double y = std::sqrt(1.0 - lambda2 + lambda2 * x * x);
+        const double vr1 = gamma * ((lambda * y - x) - rho * (lambda * y + x)) / r1mag;
+        const double vr2 = -gamma * ((lambda * y - x) + rho * (lambda * y + x)) / r2mag;
+        const double vt = gamma * sigma * (y + lambda * x);
+        const double vt1 = vt / r1mag;
+        const double vt2 = vt / r2mag;
+        solutions.emplace_back(TransferVelocities{vr1 * ir1 + vt1 * it1, vr2 * ir2 + vt2 * it2}, n, *iterations);
+    };
+
+    // zero revolution solution, the initial guess comes from a piecewise approximation of T(x)
+    double x;
+    if (t >= t00)
+        x = -(t - t00) / (t - t00 + 4.0);
+    else if (t <= t1)
+        x = t1 * (t1 - t) / (2.0 / 5.0 * (1.0 - lambda2 * lambda3) * t) + 1.0;
+    else
+        x = std::pow(t / t00, 0.69314718055994529 / std::log(t1 / t00)) - 1.0;
+    const auto iterations = householder(tof, t, x, 0, 1.0e-5);
+    addSolution(x, 0, iterations);
+
+    // left and right branches of the multi-revolution solutions
+    for (int n = 1; n <= maxN; ++n)
+    {
+        double left = std::pow((n * Pi + Pi) / (8.0 * t), 2.0 / 3.0);
+        left = (left - 1.0) / (left + 1.0);
+        const auto leftIterations = householder(tof, t, left, n, 1.0e-8);
+        addSolution(left, n, leftIterations);
+
+        double right = std::pow((8.0 * t) / (n * Pi), 2.0 / 3.0);
+        right = (right - 1.0) / (right + 1.0);
+        const auto rightIterations = householder(tof, t, right, n, 1.0e-8);
+        addSolution(right, n, rightIterations);
+    }
+
+    return solutions;
+}
@@ -0,0 +1,192 @@
+#include "market_economy.h"
+
+#include "simd.h"
+
+#include <base/thread_pool.h>
+
+#include <algorithm>
+#include <cassert>
+#include <random>
+
+namespace
+{
+
+// offsets the noise of a row can be read at; the table holds one row more so that every row is contiguous
+constexpr std::size_t kNoiseOffsets = std::size_t{1} << 16;
+
+// cells per task when a tick is split across a thread pool, in whole rows
+constexpr std::size_t kGrainSize = 16384;
+
+// finalizer of splitmix64
+std::uint64_t mix(std::uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111eb;
+    x ^= x >> 31;
+    return x;
+}
+
+// Settings scaled to the length of a tick.
+struct TickFactors
+{
+    float tickLength;
+    float fluctuation; // tickLength * volatility
+    float supplyRetention;
+    float demandRetention;
+};
+
+// One row of the components.
+struct Cells
+{
+    const float *noise;
+    const float *production;
+    const float *consumption;
+    float *supply;
+    float *demand;
+};
+
+// Cells [i, i + kWidth<P>) of a row.
+template<typename P>
+void tickCells(const Cells &cells, std::size_t i, const TickFactors &factors)
+{
+    const auto noise = simd::load<P>(cells.noise + i);
+    const auto production = simd::load<P>(cells.production + i);
+    const auto consumption = simd::load<P>(cells.consumption + i);
+    auto supply = simd::load<P>(cells.supply + i);
+    auto demand = simd::load<P>(cells.demand + i);
+
+    // a good tick for the producers is a bad one for the consumers
+    supply += production * (factors.tickLength + factors.fluctuation * noise);
+    demand += consumption * (factors.tickLength - factors.fluctuation * noise);
+
+    // what's produced and consumed at the same world is traded there first
+    const P traded = simd::min(supply, demand);
+    supply = (supply - traded) * factors.supplyRetention;
+    demand = (demand - traded) * factors.demandRetention;
+
+    simd::store(supply, cells.supply + i);
+    simd::store(demand, cells.demand + i);
+}
+
+} // namespace
+
+MarketEconomy::MarketEconomy() = default;
+
+MarketEconomy::MarketEconomy(const Settings &settings)
+    : m_settings(settings)
+{
+}
+
+void MarketEconomy::reset(std::size_t worldCount, std::size_t itemCount, std::uint64_t seed)
+{
+    resize(worldCount, itemCount, seed);
+
+    std::mt19937_64 generator(seed);
+    std::uniform_real_distribution<float> rate(1.0f, 20.0f);
+    std::uniform_real_distribution<float> itemPrice(5000.0f, 55000.0f);
+    std::uniform_real_distribution<float> priceLevel(0.8f, 1.2f);
+    std::vector<float> itemPrices(itemCount);
+    std::ranges::generate(itemPrices, [&] { return itemPrice(generator); });
+    for (std::size_t world = 0; world < worldCount; ++world)
+    {
+        const auto level = priceLevel(generator);
+        for (std::size_t item = 0; item < itemCount; ++item)
+        {
+            const auto cell = world * itemCount + item;
+            const bool produced = generator() % 2 != 0;
+            const bool consumed = generator() % 2 != 0;
+            production[cell] = produced ? rate(generator) : 0.0f;
+            consumption[cell] = consumed ? rate(generator) : 0.0f;
+            supply[cell] = production[cell] * m_settings.referenceStock;
+            demand[cell] = consumption[cell] * m_settings.referenceStock;
+            basePrices[cell] = level * itemPrices[item];
+        }
+    }
+}
+
+void MarketEconomy::resize(std::size_t worldCount, std::size_t itemCount, std::uint64_t seed, std::uint64_t tickCount)
+{
+    m_worldCount = worldCount;
+    m_itemCount = itemCount;
+    m_seed = seed;
+    m_tickCount = tickCount;
+
+    const auto cellCount = worldCount * itemCount;
+    for (auto *component : {&production, &consumption, &supply, &demand, &basePrices})
+        component->assign(cellCount, 0.0f);
+
+    std::mt19937 generator(static_cast<std::uint32_t>(mix(seed)));
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    m_noiseTable.resize(kNoiseOffsets + itemCount);
+    std::ranges::generate(m_noiseTable, [&] { return noise(generator); });
+}
+
+void MarketEconomy::tick(ThreadPool *threadPool)
+{
+    const auto rowsPerTask = std::max<std::size_t>(kGrainSize / std::max<std::size_t>(m_itemCount, 1), 1);
+    if (threadPool && m_worldCount > rowsPerTask)
+        threadPool->parallelFor(m_worldCount, rowsPerTask,
+                                [this](std::size_t begin, std::size_t end) { tickRows(begin, end); });
+    else
+        tickRows(0, m_worldCount);
+    ++m_tickCount;
+}
+
+void MarketEconomy::tickRows(std::size_t begin, std::size_t end)
+{
+    using P = simd::Pack<float>;
+    constexpr auto kWidth = simd::kWidth<P>;
+
+    const auto tickLength = m_settings.tickLength;
+    const TickFactors factors{.tickLength = tickLength,
+                              .fluctuation = tickLength * m_settings.volatility,
+                              .supplyRetention = std::max(1.0f - tickLength * m_settings.spoilage, 0.0f),
+                              .demandRetention = std::max(1.0f - tickLength * m_settings.demandDecay, 0.0f)};
+    for (std::size_t world = begin; world < end; ++world)
+    {
+        const auto row = world * m_itemCount;
+        const Cells cells{.noise = noise(world).data(),
+                          .production = production.data() + row,
+                          .consumption = consumption.data() + row,
+                          .supply = supply.data() + row,
+                          .demand = demand.data() + row};
+        std::size_t i = 0;
+        for (; i + kWidth <= m_itemCount; i += kWidth)
+            tickCells<P>(cells, i, factors);
+        for (; i < m_itemCount; ++i)
+            tickCells<float>(cells, i, factors);
+    }
+}
+
+std::span<const float> MarketEconomy::noise(std::size_t world) const
+{
+    const auto offset = mix(m_seed ^ mix(m_tickCount * m_worldCount + world)) % kNoiseOffsets;
+    return std::span{m_noiseTable}.subspan(offset, m_itemCount);
+}
+
+void MarketEconomy::writePrices(std::size_t world, std::span<std::uint64_t> sellPrices,
+                                std::span<std::uint64_t> buyPrices) const
+{
+    assert(sellPrices.size() == m_itemCount && buyPrices.size() == m_itemCount);
+    const auto row = world * m_itemCount;
+    const auto sellFactor = 1.0f + m_settings.spread;
+    const auto buyFactor = 1.0f - m_settings.spread;
+    for (std::size_t item = 0; item < m_itemCount; ++item)
+    {
+        const auto cell = row + item;
+        const auto price = cellPrice(cell);
+        sellPrices[item] = production[cell] > 0.0f ? static_cast<std::uint64_t>(sellFactor * price + 0.5f) : 0;
+        buyPrices[item] = consumption[cell] > 0.0f ? static_cast<std::uint64_t>(buyFactor * price + 0.5f) : 0;
+    }
+}
+
+float MarketEconomy::cellPrice(std::size_t cell) const
+{
+    // the base price when supply and demand are balanced, more expensive as the unmet demand grows compared to the
+    // usual flow of goods, cheaper as the stock grows
+    const auto reference = (production[cell] + consumption[cell]) * m_settings.referenceStock + 1.0f;
+    const auto ratio = (demand[cell] + reference) / (supply[cell] + reference);
+    return basePrices[cell] * std::clamp(ratio, m_settings.minPriceRatio, m_settings.maxPriceRatio);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class ThreadPool;
+
+// Supply and demand of the market items at every world, advanced in ticks of fixed length, with the prices derived
+// from them when they're read. Each component is a worlds x items array, one row per world in the order of
+// Universe::worlds(), indexed by MarketItem::id, and a tick is one pass of elementwise SIMD updates over the rows,
+// split across worlds on a thread pool. The fluctuations of each row at each tick are read from a table filled from
+// the seed, at an offset hashed from the tick and the world, so a run only depends on the seed, whatever the number of
+// threads.
+class MarketEconomy
+{
+public:
+    struct Settings
+    {
+        float tickLength{1.0f};      // days
+        float volatility{0.2f};      // of production and consumption, from one tick to the next
+        float spoilage{0.02f};       // fraction of the supply lost per day
+        float demandDecay{0.05f};    // fraction of the unmet demand given up per day
+        float referenceStock{30.0f}; // days of production and consumption that keep the price at the base price
+        float minPriceRatio{0.25f};  // of the price to the base price
+        float maxPriceRatio{4.0f};
+        float spread{0.05f}; // between the base price and the prices the market sells and buys at
+    };
+
+    MarketEconomy();
+    explicit MarketEconomy(const Settings &settings);
+
+    const Settings &settings() const { return m_settings; }
+
+    // Random production, consumption and base prices, each world producing and consuming about half of the items.
+    void reset(std::size_t worldCount, std::size_t itemCount, std::uint64_t seed);
+    // Every component zeroed, to be filled by the caller, e.g. from a snapshot.
+    void resize(std::size_t worldCount, std::size_t itemCount, std::uint64_t seed, std::uint64_t tickCount = 0);
+
+    std::size_t worldCount() const { return m_worldCount; }
+    std::size_t itemCount() const { return m_itemCount; }
+    std::uint64_t seed() const { return m_seed; }
+    std::uint64_t tickCount() const { return m_tickCount; }
+
+    void tick(ThreadPool *threadPool = nullptr);
+
+    // Price of the item of a cell of the components, in credits.
+    float price(std::size_t world, std::size_t item) const { return cellPrice(world * m_itemCount + item); }
+
+    // Prices of a world in credits, around price(): the sell prices of the items it produces, the buy prices of the
+    // items it consumes, 0 for the others.
+    void writePrices(std::size_t world, std::span<std::uint64_t> sellPrices, std::span<std::uint64_t> buyPrices) const;
+
+    // Components, worldCount() x itemCount().
+    std::vector<float> production;  // units/day
+    std::vector<float> consumption; // units/day
+    std::vector<float> supply;      // units in stock
+    std::vector<float> demand;      // units wanted and not supplied yet
+    std::vector<float> basePrices;  // credits, when supply meets demand
+
+private:
+    void tickRows(std::size_t begin, std::size_t end);
+    float cellPrice(std::size_t cell) const;
+    std::span<const float> noise(std::size_t world) const; // fluctuations of the row at the current tick
+
+    Settings m_settings;
+    std::size_t m_worldCount{0};
+    std::size_t m_itemCount{0};
+    std::uint64_t m_seed{0};
+    std::uint64_t m_tickCount{0};
+    std::vector<float> m_noiseTable; // in [-1, 1]
+};
@@ -118,6 +118,16 @@ MarketItemDetailsGizmo::MarketItemDetailsGizmo(const World *world, Ship *ship, G
         if (m_item)
             m_ship->changeCargo(m_item, 1);
     });
+
+    m_pricesChangedConnection = m_ship->universe()->marketPricesChangedSignal.connect([this] {
+        if (m_item)
+            updatePrices();
+    });
+}
+
+MarketItemDetailsGizmo::~MarketItemDetailsGizmo()
+{
+    m_pricesChangedConnection.disconnect();
 }
 
 void MarketItemDetailsGizmo::setItem(const MarketItem *item)
@@ -131,9 +141,14 @@ void MarketItemDetailsGizmo::setItem(const MarketItem *item)
     m_sectorText->setText(m_item->sector->name);
     m_descriptionText->setText(m_item->description);
 
-    const auto *price = m_world->findMarketItemPrice(m_item);
-    m_sellPriceText->setText(formatCredits(price ? price->buyPrice : 0));
-    m_buyPriceText->setText(formatCredits(price ? price->sellPrice : 0));
+    updatePrices();
+}
+
+void MarketItemDetailsGizmo::updatePrices()
+{
+    const auto id = m_item->id;
+    m_sellPriceText->setText(formatCredits(m_world->buyPrices()[id]));
+    m_buyPriceText->setText(formatCredits(m_world->sellPrices()[id]));
 
     struct WorldPrice
     {
@@ -145,14 +160,10 @@ void MarketItemDetailsGizmo::setItem(const MarketItem *item)
     {
         if (world == m_world)
             continue;
-        const auto *price = world->findMarketItemPrice(m_item);
-        if (price)
-        {
-            if (price->buyPrice)
-                buyPrices.emplace_back(world, price->buyPrice);
-            if (price->sellPrice)
-                sellPrices.emplace_back(world, price->sellPrice);
-        }
+        if (const auto buyPrice = world->buyPrices()[id])
+            buyPrices.emplace_back(world, buyPrice);
+        if (const auto sellPrice = world->sellPrices()[id])
+            sellPrices.emplace_back(world, sellPrice);
     }
     std::ranges::sort(buyPrices, std::ranges::greater{}, &WorldPrice::price);
     std::ranges::sort(sellPrices, std::ranges::less{}, &WorldPrice::price);
@@ -12,10 +12,13 @@ class MarketItemDetailsGizmo : public ui::Column
 {
 public:
     explicit MarketItemDetailsGizmo(const World *world, Ship *ship, ui::Gizmo *parent = nullptr);
+    ~MarketItemDetailsGizmo() override;
 
     void setItem(const MarketItem *item);
 
 private:
+    void updatePrices();
+
     const World *m_world{nullptr};
     Ship *m_ship{nullptr};
     const MarketItem *m_item{nullptr};
@@ -28,4 +31,5 @@ private:
     TableGizmo *m_importerTable{nullptr};
     ButtonGizmo *m_sellButton{nullptr};
     ButtonGizmo *m_buyButton{nullptr};
+    muslots::Connection m_pricesChangedConnection;
 };
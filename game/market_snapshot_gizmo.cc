@@ -46,52 +46,47 @@ MarketSnapshotGizmo::MarketSnapshotGizmo(const World *world, Ship *ship, Gizmo *
 
     initialize();
 
-    m_cargoChangedConnection = m_ship->cargoChangedSignal.connect([this](const MarketItem *item) {
-        auto *row = [this, item]() -> TableGizmoRow * {
-            for (std::size_t i = 0; i < m_tableGizmo->rowCount(); ++i)
-            {
-                auto *row = m_tableGizmo->rowAt(i);
-                auto rowData = row->data();
-                if (rowData.has_value())
-                {
-                    const auto *rowItem = std::any_cast<const MarketItem *>(rowData);
-                    if (rowItem == item)
-                        return row;
-                }
-            }
-            return nullptr;
-        }();
-        if (row)
-            row->setValue(0, m_ship->cargo(item));
-    });
+    m_cargoChangedConnection =
+        m_ship->universe()->shipCargoChangedSignal.connect([this](Ship *ship, const MarketItem *item) {
+            if (ship != m_ship)
+                return;
+            if (auto *row = m_itemRows[item->id])
+                row->setValue(0, m_ship->cargo(item));
+        });
+    m_pricesChangedConnection = m_ship->universe()->marketPricesChangedSignal.connect([this] { updatePrices(); });
 }
 
 MarketSnapshotGizmo::~MarketSnapshotGizmo()
 {
     m_cargoChangedConnection.disconnect();
+    m_pricesChangedConnection.disconnect();
 }
 
 void MarketSnapshotGizmo::initialize()
 {
     m_tableGizmo->clearRows();
 
-    const auto &prices = m_world->marketItemPrices();
+    const auto sellPrices = m_world->sellPrices();
+    const auto buyPrices = m_world->buyPrices();
+    const auto cargo = m_ship->cargoCounts();
+    const auto traded = [&sellPrices, &buyPrices](const auto &item) {
+        return sellPrices[item->id] != 0 || buyPrices[item->id] != 0;
+    };
 
+    m_itemRows.assign(m_world->universe()->marketItems().size(), nullptr);
     for (const auto *sector : m_world->universe()->marketSectors())
     {
-        auto filteredPrices =
-            prices | std::views::filter([sector](const auto &price) { return price.item->sector == sector; });
-        if (!filteredPrices.empty())
+        auto tradedItems = sector->items | std::views::filter(traded);
+        if (!tradedItems.empty())
         {
             auto *row = m_tableGizmo->appendRow();
             row->setValue(1, sector->name);
             row->setTextColor(g_styleSettings.accentColor);
 
-            for (const auto &price : filteredPrices)
+            for (const auto &item : tradedItems)
             {
-                const auto *item = price.item;
-                const auto cargo = m_ship->cargo(item);
-                auto *row = m_tableGizmo->appendRow(cargo, price.item->name, price.buyPrice, price.sellPrice);
+                const auto id = item->id;
+                auto *row = m_tableGizmo->appendRow(cargo[id], item->name, buyPrices[id], sellPrices[id]);
                 row->setHoverable(true);
                 row->setHoveredColor(glm::vec4{1.0f, 1.0f, 1.0f, 0.25f});
                 row->setSelectedColor(g_styleSettings.baseColor);
@@ -99,8 +94,24 @@ void MarketSnapshotGizmo::initialize()
                 row->setSelectedTextColor(kBlack);
                 row->setIndent(1, 20.0f);
                 row->setSelectable(true);
-                row->setData(price.item);
+                row->setData(static_cast<const MarketItem *>(item.get()));
+                m_itemRows[id] = row;
             }
         }
     }
 }
+
+void MarketSnapshotGizmo::updatePrices()
+{
+    // the items traded at a world don't change, only their prices
+    const auto sellPrices = m_world->sellPrices();
+    const auto buyPrices = m_world->buyPrices();
+    for (std::size_t id = 0; id < m_itemRows.size(); ++id)
+    {
+        if (auto *row = m_itemRows[id])
+        {
+            row->setValue(2, buyPrices[id]);
+            row->setValue(3, sellPrices[id]);
+        }
+    }
+}
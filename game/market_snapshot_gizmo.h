@@ -5,6 +5,7 @@
 class World;
 class Ship;
 class TableGizmo;
+class TableGizmoRow;
 class MarketItem;
 
 class MarketSnapshotGizmo : public ui::Column
@@ -17,9 +18,12 @@ public:
 
 private:
     void initialize();
+    void updatePrices();
 
     const World *m_world{nullptr};
     Ship *m_ship{nullptr};
     TableGizmo *m_tableGizmo{nullptr};
+    std::vector<TableGizmoRow *> m_itemRows; // indexed by MarketItem::id, nullptr if not traded here
     muslots::Connection m_cargoChangedConnection;
+    muslots::Connection m_pricesChangedConnection;
 };
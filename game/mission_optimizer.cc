@@ -0,0 +1,330 @@
+#include "mission_optimizer.h"
+
+#include "lambert.h"
+#include "mission_table.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <ranges>
+
+namespace
+{
+
+constexpr auto kDateTolerance = 1e-3; // days
+constexpr auto kMaxSweeps = 50;
+
+struct Minimum
+{
+    double x;
+    double fx;
+};
+
+// Brent's method: minimizes `f` over [a, b], combining golden section steps with parabolic interpolation.
+// Brent, R. Algorithms for Minimization without Derivatives, chapter 5, Prentice-Hall, 1973
+template<typename Func>
+Minimum brentMinimize(Func &&f, double a, double b, double tolerance)
+{
+    constexpr auto kGoldenSection = 0.3819660112501051; // (3 - sqrt(5)) / 2
+    constexpr auto kMaxIterations = 100;
+
+    double x = a + kGoldenSection * (b - a);
+    double w = x;
+    double v = x;
+    double fx = f(x);
+    double fw = fx;
+    double fv = fx;
+    double d = 0.0;
+    double e = 0.0;
+    for (int iteration = 0; iteration < kMaxIterations; ++iteration)
+    {
+        const double middle = 0.5 * (a + b);
+        if (std::abs(x - middle) <= 2.0 * tolerance - 0.5 * (b - a))
+            break;
+
+        bool goldenSection = true;
+        if (std::abs(e) > tolerance)
+        {
+            // fit a parabola through x, w and v, comparisons fail on NaNs so infinite values fall back to a golden
+            // section step
+            const double r = (x - w) * (fx - fv);
+            double q = (x - v) * (fx - fw);
+            double p = (x - v) * q - (x - w) * r;
+            q = 2.0 * (q - r);
+            if (q > 0.0)
+                p = -p;
+            else
+                q = -q;
+            const double previousE = e;
+            e = d;
+            if (std::abs(p) < std::abs(0.5 * q * previousE) && p > q * (a - x) && p < q * (b - x))
+            {
+                d = p / q;
+                const double u = x + d;
+                if (u - a < 2.0 * tolerance || b - u < 2.0 * tolerance)
+                    d = middle > x ? tolerance : -tolerance;
+                goldenSection = false;
+            }
+        }
+        if (goldenSection)
+        {
+            e = (x >= middle ? a : b) - x;
+            d = kGoldenSection * e;
+        }
+
+        const double u = std::abs(d) >= tolerance ? x + d : x + (d > 0.0 ? tolerance : -tolerance);
+        const double fu = f(u);
+        if (fu <= fx)
+        {
+            if (u >= x)
+                a = x;
+            else
+                b = x;
+            v = w;
+            fv = fw;
+            w = x;
+            fw = fx;
+            x = u;
+            fx = fu;
+        }
+        else
+        {
+            if (u < x)
+                a = u;
+            else
+                b = u;
+            if (fu <= fw || w == x)
+            {
+                v = w;
+                fv = fw;
+                w = u;
+                fw = fu;
+            }
+            else if (fu <= fv || v == x || v == w)
+            {
+                v = u;
+                fv = fu;
+            }
+        }
+    }
+    return {x, fx};
+}
+
+double totalDeltaV(const std::optional<MissionTable::OrbitDeltaV> &transfer)
+{
+    return transfer ? transfer->deltaVDeparture + transfer->deltaVArrival : std::numeric_limits<double>::infinity();
+}
+
+// Cheapest transfer between the worlds of the table for the given dates, with the table's Lambert solver.
+std::optional<MissionTable::OrbitDeltaV> solveTransfer(const MissionTable &table, JulianDate departureDate,
+                                                       JulianDate arrivalDate)
+{
+    if (arrivalDate <= departureDate)
+        return {};
+
+    const auto [posDeparture, velWorldDeparture] = table.origin()->orbit().stateVector(departureDate);
+    const auto [posArrival, velWorldArrival] = table.destination()->orbit().stateVector(arrivalDate);
+    const auto &settings = table.settings();
+    const auto solutions = solve_lambert(settings.solver, kGMSun, posDeparture, posArrival,
+                                         (arrivalDate - departureDate).count(), OrbitType::Prograde,
+                                         settings.maxRevolutions);
+
+    std::optional<MissionTable::OrbitDeltaV> cheapest;
+    for (const auto &[velocities, revolutions, iterations] : solutions)
+    {
+        const auto &[velDeparture, velArrival] = velocities;
+        const MissionTable::OrbitDeltaV transfer{velDeparture, velArrival,
+                                                 glm::length(velDeparture - velWorldDeparture),
+                                                 glm::length(velArrival - velWorldArrival)};
+        // lambert_battin sometimes returns vec3{inf}
+        if (std::isfinite(totalDeltaV(transfer)) && totalDeltaV(transfer) < totalDeltaV(cheapest))
+            cheapest = transfer;
+    }
+    return cheapest;
+}
+
+} // namespace
+
+MissionOptimizer::MissionOptimizer(const MissionTable *missionTable)
+    : m_missionTable(missionTable)
+{
+}
+
+void MissionOptimizer::setEarliestDeparture(JulianDate date)
+{
+    m_earliestDeparture = date;
+    clearCache();
+}
+
+std::optional<MissionPlan> MissionOptimizer::bestPlan(std::size_t basinCount) const
+{
+    const auto rows = m_missionTable->arrivals.size();
+    const auto columns = m_missionTable->departures.size();
+
+    // grid cells that are lower than all of their neighbours
+    std::vector<std::size_t> basins;
+    for (std::size_t i = 0; i != rows; ++i)
+    {
+        for (std::size_t j = 0; j != columns; ++j)
+        {
+            if (isBasin(i, j) && std::isfinite(cellDeltaV(i, j)))
+                basins.push_back(cellIndex(i, j));
+        }
+    }
+    const auto count = std::min(basinCount, basins.size());
+    std::ranges::partial_sort(basins, basins.begin() + count, {}, [this, columns](std::size_t index) {
+        return cellDeltaV(index / columns, index % columns);
+    });
+
+    std::optional<MissionPlan> bestPlan;
+    for (const auto index : basins | std::views::take(count))
+    {
+        auto plan =
+            refine(m_missionTable->departures[index % columns].date, m_missionTable->arrivals[index / columns].date);
+        if (plan && (!bestPlan || plan->deltaVDeparture + plan->deltaVArrival <
+                                      bestPlan->deltaVDeparture + bestPlan->deltaVArrival))
+            bestPlan = std::move(plan);
+    }
+    return bestPlan;
+}
+
+std::optional<MissionPlan> MissionOptimizer::basinPlan(std::size_t arrivalIndex, std::size_t departureIndex)
+{
+    if (!std::isfinite(cellDeltaV(arrivalIndex, departureIndex)))
+        return {};
+
+    const auto basin = basinMinimum(arrivalIndex, departureIndex);
+    auto it = m_basinPlans.find(basin);
+    if (it == m_basinPlans.end())
+    {
+        const auto columns = m_missionTable->departures.size();
+        auto plan = refine(m_missionTable->departures[basin % columns].date,
+                           m_missionTable->arrivals[basin / columns].date);
+        it = m_basinPlans.emplace(basin, std::move(plan)).first;
+    }
+    return it->second;
+}
+
+std::optional<MissionPlan> MissionOptimizer::refine(JulianDate departureDate, JulianDate arrivalDate) const
+{
+    const auto &departures = m_missionTable->departures;
+    const auto &arrivals = m_missionTable->arrivals;
+    assert(!departures.empty() && !arrivals.empty());
+
+    // line searches are bracketed by one grid step on each side of the current date
+    const auto stepSize = [](const std::vector<MissionTable::DateState> &states) {
+        return states.size() > 1 ? (states[1].date - states[0].date).count() : 1.0;
+    };
+    const auto departureStep = stepSize(departures);
+    const auto arrivalStep = stepSize(arrivals);
+    const auto firstDeparture =
+        std::max(departures.front().date, m_earliestDeparture.value_or(departures.front().date));
+    departureDate = std::max(departureDate, firstDeparture);
+
+    // Cyclic coordinate descent, with a Brent line search along each date. `lineSearch` moves `date` to the minimum
+    // of `f(offset)` around it if that's an improvement.
+    double bestDeltaV = deltaV(departureDate, arrivalDate);
+    if (!std::isfinite(bestDeltaV))
+        return {};
+    const auto lineSearch = [&bestDeltaV](JulianDate &date, double step, JulianDate first, JulianDate last,
+                                          auto &&f) {
+        const auto lower = std::max(-step, (first - date).count());
+        const auto upper = std::min(step, (last - date).count());
+        if (lower >= upper)
+            return;
+        const auto minimum = brentMinimize(f, lower, upper, kDateTolerance);
+        if (minimum.fx < bestDeltaV)
+        {
+            date += JulianDays{minimum.x};
+            bestDeltaV = minimum.fx;
+        }
+    };
+    for (int sweep = 0; sweep < kMaxSweeps; ++sweep)
+    {
+        const auto previousDeparture = departureDate;
+        const auto previousArrival = arrivalDate;
+        lineSearch(departureDate, departureStep, firstDeparture, departures.back().date,
+                   [&](double offset) { return deltaV(departureDate + JulianDays{offset}, arrivalDate); });
+        lineSearch(arrivalDate, arrivalStep, arrivals.front().date, arrivals.back().date,
+                   [&](double offset) { return deltaV(departureDate, arrivalDate + JulianDays{offset}); });
+        if (std::abs((departureDate - previousDeparture).count()) < kDateTolerance &&
+            std::abs((arrivalDate - previousArrival).count()) < kDateTolerance)
+            break;
+    }
+
+    const auto transfer = solveTransfer(*m_missionTable, departureDate, arrivalDate);
+    if (!transfer)
+        return {};
+
+    const auto posArrival = m_missionTable->destination()->orbit().position(arrivalDate);
+    MissionPlan plan{.origin = m_missionTable->origin(),
+                     .destination = m_missionTable->destination(),
+                     .departureDate = departureDate,
+                     .arrivalDate = arrivalDate};
+    plan.orbit.setElements(orbitalElementsFromStateVector(posArrival, transfer->velArrival, arrivalDate));
+    plan.orbit.setKeplerSolver(KeplerSolver::Markley);
+    plan.deltaVDeparture = transfer->deltaVDeparture;
+    plan.deltaVArrival = transfer->deltaVArrival;
+    return plan;
+}
+
+std::size_t MissionOptimizer::cellIndex(std::size_t arrivalIndex, std::size_t departureIndex) const
+{
+    return arrivalIndex * m_missionTable->departures.size() + departureIndex;
+}
+
+double MissionOptimizer::cellDeltaV(std::size_t arrivalIndex, std::size_t departureIndex) const
+{
+    const auto transfer = m_missionTable->transfers()[arrivalIndex, departureIndex];
+    return transfer ? transfer->totalDeltaV() : std::numeric_limits<double>::infinity();
+}
+
+bool MissionOptimizer::isBasin(std::size_t arrivalIndex, std::size_t departureIndex) const
+{
+    const auto rows = m_missionTable->arrivals.size();
+    const auto columns = m_missionTable->departures.size();
+    const auto cell = cellDeltaV(arrivalIndex, departureIndex);
+    for (std::size_t i = std::max<std::size_t>(arrivalIndex, 1) - 1; i != std::min(arrivalIndex + 2, rows); ++i)
+    {
+        for (std::size_t j = std::max<std::size_t>(departureIndex, 1) - 1; j != std::min(departureIndex + 2, columns);
+             ++j)
+        {
+            if (cellDeltaV(i, j) < cell)
+                return false;
+        }
+    }
+    return true;
+}
+
+std::size_t MissionOptimizer::basinMinimum(std::size_t arrivalIndex, std::size_t departureIndex) const
+{
+    const auto rows = m_missionTable->arrivals.size();
+    const auto columns = m_missionTable->departures.size();
+    // steepest descent to the lowest neighbour until there's none lower
+    for (;;)
+    {
+        auto next = std::pair{arrivalIndex, departureIndex};
+        auto nextDeltaV = cellDeltaV(arrivalIndex, departureIndex);
+        for (std::size_t i = std::max<std::size_t>(arrivalIndex, 1) - 1; i != std::min(arrivalIndex + 2, rows); ++i)
+        {
+            for (std::size_t j = std::max<std::size_t>(departureIndex, 1) - 1;
+                 j != std::min(departureIndex + 2, columns); ++j)
+            {
+                if (const auto value = cellDeltaV(i, j); value < nextDeltaV)
+                {
+                    next = {i, j};
+                    nextDeltaV = value;
+                }
+            }
+        }
+        if (next == std::pair{arrivalIndex, departureIndex})
+            return cellIndex(arrivalIndex, departureIndex);
+        std::tie(arrivalIndex, departureIndex) = next;
+    }
+}
+
+double MissionOptimizer::deltaV(JulianDate departureDate, JulianDate arrivalDate) const
+{
+    return totalDeltaV(solveTransfer(*m_missionTable, departureDate, arrivalDate));
+}
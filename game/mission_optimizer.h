@@ -0,0 +1,45 @@
+#pragma once
+
+#include "universe.h"
+
+#include <unordered_map>
+
+class MissionTable;
+
+// Refines the transfers of a MissionTable with departure and arrival dates as continuous variables. The table is only
+// used to find starting points: the plans returned are true local minima of the total delta-v, not grid cells.
+class MissionOptimizer
+{
+public:
+    explicit MissionOptimizer(const MissionTable *missionTable);
+
+    // Cheapest plan over the `basinCount` lowest basins of the table.
+    std::optional<MissionPlan> bestPlan(std::size_t basinCount = 4) const;
+
+    // Plan at the bottom of the basin the given cell belongs to, or nothing if the cell has no transfer. Basins are
+    // found by steepest descent on the grid and their plans are cached, so this is cheap enough to call on every mouse
+    // move.
+    std::optional<MissionPlan> basinPlan(std::size_t arrivalIndex, std::size_t departureIndex);
+
+    // Drops the cached basin plans, needed after the window of the table moves.
+    void clearCache() { m_basinPlans.clear(); }
+
+    // Keeps the plans from departing before `date`, for tables that start earlier, e.g. at the midnight before the
+    // current date so that they can be cached.
+    void setEarliestDeparture(JulianDate date);
+
+    // Local minimum of the total delta-v starting from the given dates, constrained to the dates of the table and to
+    // the earliest departure, or nothing if the Lambert solver finds no transfer there.
+    std::optional<MissionPlan> refine(JulianDate departureDate, JulianDate arrivalDate) const;
+
+private:
+    std::size_t cellIndex(std::size_t arrivalIndex, std::size_t departureIndex) const;
+    double cellDeltaV(std::size_t arrivalIndex, std::size_t departureIndex) const;
+    bool isBasin(std::size_t arrivalIndex, std::size_t departureIndex) const; // no neighbour is lower
+    std::size_t basinMinimum(std::size_t arrivalIndex, std::size_t departureIndex) const;
+    double deltaV(JulianDate departureDate, JulianDate arrivalDate) const;
+
+    const MissionTable *m_missionTable{nullptr};
+    std::optional<JulianDate> m_earliestDeparture;
+    std::unordered_map<std::size_t, std::optional<MissionPlan>> m_basinPlans;
+};
@@ -27,7 +27,7 @@ constexpr double toKmS(double speed)
 
 } // namespace
 
-MissionPlanGizmo::MissionPlanGizmo(Ship *ship, const MissionTable *missionTable, Gizmo *parent)
+MissionPlanGizmo::MissionPlanGizmo(Ship *ship, MissionTable *missionTable, Gizmo *parent)
     : ui::Column(parent)
     , m_ship(ship)
 {
@@ -10,7 +10,7 @@ class MissionPlotGizmo;
 class MissionPlanGizmo : public ui::Column
 {
 public:
-    explicit MissionPlanGizmo(Ship *ship, const MissionTable *missionTable, ui::Gizmo *parent = nullptr);
+    explicit MissionPlanGizmo(Ship *ship, MissionTable *missionTable, ui::Gizmo *parent = nullptr);
 
     muslots::Signal<> confirmClickedSignal;
 
@@ -10,13 +10,17 @@ Image32 createMissionPlot(const MissionTable &table)
 
     double minDeltaV = std::numeric_limits<double>::max();
     double maxDeltaV = std::numeric_limits<double>::lowest();
-    for (const auto &orbit : table.transferOrbits)
+    const auto orbits = table.transfers();
+    for (std::size_t y = 0; y < orbits.extent(0); ++y)
     {
-        if (orbit)
+        for (std::size_t x = 0; x < orbits.extent(1); ++x)
         {
-            const auto deltaV = orbit->deltaVDeparture + orbit->deltaVArrival;
-            minDeltaV = std::min(minDeltaV, deltaV);
-            maxDeltaV = std::max(maxDeltaV, deltaV);
+            if (const auto orbit = orbits[y, x])
+            {
+                const auto deltaV = orbit->totalDeltaV();
+                minDeltaV = std::min(minDeltaV, deltaV);
+                maxDeltaV = std::max(maxDeltaV, deltaV);
+            }
         }
     }
 
@@ -33,8 +37,7 @@ Image32 createMissionPlot(const MissionTable &table)
         return glm::mix(gradient[index], gradient[index + 1], t - std::floor(t));
     };
 
-    assert(table.transferOrbits.size() == width * height);
-    auto orbits = std::mdspan(table.transferOrbits.data(), height, width);
+    assert(orbits.extent(0) == height && orbits.extent(1) == width);
     auto pixels = std::mdspan(reinterpret_cast<glm::u8vec4 *>(image.pixels().data()), height, width);
     for (std::size_t y = 0; y < orbits.extent(0); ++y)
     {
@@ -42,7 +45,7 @@ Image32 createMissionPlot(const MissionTable &table)
         {
             const auto color = [&] {
                 if (const auto orbit = orbits[y, x])
-                    return gradientColor(orbit->deltaVDeparture + orbit->deltaVArrival);
+                    return gradientColor(orbit->totalDeltaV());
                 else
                     return glm::vec3{1.0f};
             }();
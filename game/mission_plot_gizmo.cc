@@ -6,16 +6,17 @@
 #include <glm/gtx/string_cast.hpp>
 
 #include <cassert>
-#include <mdspan>
 
 using namespace ui;
 
-MissionPlotGizmo::MissionPlotGizmo(const MissionTable *missionTable, Gizmo *parent)
+MissionPlotGizmo::MissionPlotGizmo(MissionTable *missionTable, Gizmo *parent)
     : Gizmo(parent)
     , m_font(g_styleSettings.smallFont)
     , m_missionTable(missionTable)
+    , m_missionOptimizer(missionTable)
     , m_plotImage(createMissionPlot(*missionTable))
     , m_plotTexture(m_plotImage)
+    , m_transfersChangedConnection(missionTable->transfersChangedSignal.connect([this] { updatePlot(); }))
 {
     m_margins = Margins{.left = m_font.pixelHeight, .right = 0, .top = 0, .bottom = m_font.pixelHeight};
 
@@ -28,6 +29,11 @@ MissionPlotGizmo::MissionPlotGizmo(const MissionTable *missionTable, Gizmo *pare
     m_plotTexture.setWrapModeT(gl::Texture::WrapMode::ClampToEdge);
 }
 
+MissionPlotGizmo::~MissionPlotGizmo()
+{
+    m_transfersChangedConnection.disconnect();
+}
+
 void MissionPlotGizmo::paintContents(Painter *painter, const glm::vec2 &pos, int depth) const
 {
     using namespace std::literals::string_view_literals;
@@ -106,37 +112,21 @@ void MissionPlotGizmo::updateMissionPlan(const glm::vec2 &pos)
         if (departureIndex < 0 || departureIndex >= m_missionTable->departures.size())
             return {};
 
-        auto transfers = std::mdspan(m_missionTable->transferOrbits.data(), m_missionTable->arrivals.size(),
-                                     m_missionTable->departures.size());
-        const auto &transfer = transfers[arrivalIndex, departureIndex];
-        if (!transfer.has_value())
+        // snap to the bottom of the basin under the cursor
+        auto missionPlan = m_missionOptimizer.basinPlan(arrivalIndex, departureIndex);
+        if (!missionPlan)
             return {};
 
-        const auto [dateArrival, posArrival, velWorldArrival] = m_missionTable->arrivals[arrivalIndex];
-        const auto [dateDeparture, posDeparture, velWorldDeparture] = m_missionTable->departures[departureIndex];
-
-        const auto orbitalElements = orbitalElementsFromStateVector(posArrival, transfer->velArrival, dateArrival);
-        const auto *origin = m_missionTable->origin();
-        const auto *destination = m_missionTable->destination();
-
-        MissionPlan missionPlan{
-            .origin = origin, .destination = destination, .departureDate = dateDeparture, .arrivalDate = dateArrival};
-        missionPlan.orbit.setElements(orbitalElements);
-        missionPlan.deltaVDeparture = transfer->deltaVDeparture;
-        missionPlan.deltaVArrival = transfer->deltaVArrival;
-
         {
             // TODO sanity check, remove this and add unit tests
-            const auto [orbitPosDeparture, orbitVelDeparture] = missionPlan.orbit.stateVector(dateDeparture);
-            const auto [orbitPosArrival, orbitVelArrival] = missionPlan.orbit.stateVector(dateArrival);
+            const auto orbitPosDeparture = missionPlan->orbit.position(missionPlan->departureDate);
+            const auto orbitPosArrival = missionPlan->orbit.position(missionPlan->arrivalDate);
             const auto closeEnough = [](const glm::dvec3 &a, const glm::dvec3 &b) {
                 constexpr auto kTolerance = 1e-6;
                 return glm::distance(a, b) < kTolerance;
             };
-            assert(closeEnough(orbitPosDeparture, posDeparture));
-            assert(closeEnough(orbitVelDeparture, transfer->velDeparture));
-            assert(closeEnough(orbitPosArrival, posArrival));
-            assert(closeEnough(orbitVelArrival, transfer->velArrival));
+            assert(closeEnough(orbitPosDeparture, missionPlan->origin->orbit().position(missionPlan->departureDate)));
+            assert(closeEnough(orbitPosArrival, missionPlan->destination->orbit().position(missionPlan->arrivalDate)));
         }
 
         return missionPlan;
@@ -146,6 +136,14 @@ void MissionPlotGizmo::updateMissionPlan(const glm::vec2 &pos)
     missionPlanChangedSignal();
 }
 
+void MissionPlotGizmo::updatePlot()
+{
+    // the table keeps its size when its window moves, so the texture can be reused
+    m_plotImage = createMissionPlot(*m_missionTable);
+    m_plotTexture.data(std::as_bytes(m_plotImage.pixels()));
+    m_missionOptimizer.clearCache();
+}
+
 void MissionPlotGizmo::setMissionPlan(std::optional<MissionPlan> missionPlan)
 {
     m_missionPlan = std::move(missionPlan);
@@ -1,17 +1,21 @@
 #pragma once
 
+#include "mission_optimizer.h"
 #include "universe.h"
 
 #include <base/gui.h>
 #include <base/glhelpers.h>
 #include <base/image.h>
 
+#include <muslots/muslots.h>
+
 class MissionTable;
 
 class MissionPlotGizmo : public ui::Gizmo
 {
 public:
-    explicit MissionPlotGizmo(const MissionTable *missionTable, Gizmo *parent = nullptr);
+    explicit MissionPlotGizmo(MissionTable *missionTable, Gizmo *parent = nullptr);
+    ~MissionPlotGizmo() override;
 
     void paintContents(Painter *painter, const glm::vec2 &pos, int depth) const override;
     bool handleMousePress(const glm::vec2 &pos) override;
@@ -25,11 +29,14 @@ public:
 
 private:
     void updateMissionPlan(const glm::vec2 &pos);
+    void updatePlot();
 
     const MissionTable *m_missionTable{nullptr};
+    MissionOptimizer m_missionOptimizer;
     Font m_font;
     Image32 m_plotImage;
     gl::Texture m_plotTexture;
     std::optional<MissionPlan> m_missionPlan;
     ui::Margins m_margins;
+    muslots::Connection m_transfersChangedConnection;
 };
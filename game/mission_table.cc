@@ -2,7 +2,24 @@
 
 #include "lambert.h"
 
-#include <mdspan>
+#include <base/thread_pool.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <vector>
+
+namespace
+{
+
+// Transfer orbits are solved in square tiles of the arrival x departure grid, so that every task touches a small
+// contiguous set of departure and arrival states and writes a compact block of results.
+constexpr std::size_t kTileSize = 32;
 
 template<typename T>
 bool isNormal(const glm::vec<3, T> &v)
@@ -10,10 +27,255 @@ bool isNormal(const glm::vec<3, T> &v)
     return std::isnormal(v.x) && std::isnormal(v.y) && std::isnormal(v.z);
 }
 
-MissionTable::MissionTable(const World *origin, const World *destination, JulianDate start, double maxDeltaV)
+// Cells screened in single precision are kept for the double precision pass if their delta-v is within this factor of
+// the budget, to make up for the float solver's error.
+constexpr double kScreeningMargin = 1.05;
+
+std::optional<MissionTable::OrbitDeltaV> transferDeltaV(const MissionTable::DateState &departure,
+                                                        const MissionTable::DateState &arrival,
+                                                        const std::optional<TransferVelocities> &orbit,
+                                                        double maxDeltaV)
+{
+    if (!orbit)
+        return {};
+
+    const auto [velDeparture, velArrival] = *orbit;
+    // FIXME sometimes lambert_battin returns vec3{inf}
+    if (!isNormal(velDeparture) || !isNormal(velArrival))
+        return {};
+
+    const auto deltaVDeparture = glm::length(velDeparture - departure.worldVelocity);
+    const auto deltaVArrival = glm::length(velArrival - arrival.worldVelocity);
+    const auto deltaV = deltaVDeparture + deltaVArrival;
+    if (deltaV >= maxDeltaV)
+        return {};
+
+    assert(!std::isnan(deltaV));
+    return MissionTable::OrbitDeltaV{velDeparture, velArrival, deltaVDeparture, deltaVArrival};
+}
+
+// Picks the solution branch with the lowest total delta-v.
+std::optional<MissionTable::OrbitDeltaV> cheapestTransfer(const MissionTable::DateState &departure,
+                                                          const MissionTable::DateState &arrival,
+                                                          std::span<const LambertSolution> solutions, double maxDeltaV)
+{
+    std::optional<MissionTable::OrbitDeltaV> cheapest;
+    for (const auto &solution : solutions)
+    {
+        const auto transfer = transferDeltaV(departure, arrival, solution.velocities, maxDeltaV);
+        if (transfer && (!cheapest || transfer->deltaVDeparture + transfer->deltaVArrival <
+                                          cheapest->deltaVDeparture + cheapest->deltaVArrival))
+            cheapest = transfer;
+    }
+    return cheapest;
+}
+
+struct Cell
+{
+    std::size_t arrival;
+    std::size_t departure;
+};
+
+// Solves lists of grid cells with the Lambert solver picked in the settings. Keeps its scratch buffers between calls,
+// so every task should use its own.
+class CellSolver
+{
+public:
+    CellSolver(const MissionTable &table, const MissionTable::Settings &settings, double maxDeltaV)
+        : m_table(table)
+        , m_settings(settings)
+        , m_maxDeltaV(maxDeltaV)
+    {
+    }
+
+    // Writes the transfer for `cells[k]` to `transfers[k]`, returns the number of Lambert problems solved.
+    std::size_t solve(std::span<const Cell> cells, std::span<std::optional<MissionTable::OrbitDeltaV>> transfers)
+    {
+        assert(cells.size() == transfers.size());
+        m_indices.clear();
+        m_problems.clear();
+        for (std::size_t k = 0; k != cells.size(); ++k)
+        {
+            transfers[k] = std::nullopt;
+            const auto &departure = m_table.departures[cells[k].departure];
+            const auto &arrival = m_table.arrivals[cells[k].arrival];
+            if (arrival.date <= departure.date)
+                continue;
+            const auto transitInterval = arrival.date - departure.date;
+            m_indices.push_back(k);
+            m_problems.emplace_back(departure.worldPosition, arrival.worldPosition, transitInterval.count());
+        }
+        const auto problemCount = m_problems.size();
+
+        const auto departure = [this, cells](std::size_t k) -> const auto & {
+            return m_table.departures[cells[m_indices[k]].departure];
+        };
+        const auto arrival = [this, cells](std::size_t k) -> const auto & {
+            return m_table.arrivals[cells[m_indices[k]].arrival];
+        };
+
+        if (m_settings.solver == LambertSolver::Izzo)
+        {
+            for (std::size_t k = 0; k != m_problems.size(); ++k)
+            {
+                const auto &[r1, r2, dt] = m_problems[k];
+                transfers[m_indices[k]] =
+                    cheapestTransfer(departure(k), arrival(k),
+                                     lambert_izzo(kGMSun, r1, r2, dt, OrbitType::Prograde, m_settings.maxRevolutions),
+                                     m_maxDeltaV);
+            }
+            return problemCount;
+        }
+
+        if (m_settings.floatScreening)
+        {
+            solveBattin<float>();
+            std::size_t kept = 0;
+            for (std::size_t k = 0; k != m_problems.size(); ++k)
+            {
+                // lanes that didn't converge in single precision might still converge in double
+                if (m_solutions[k] &&
+                    !transferDeltaV(departure(k), arrival(k), m_solutions[k], kScreeningMargin * m_maxDeltaV))
+                    continue;
+                m_indices[kept] = m_indices[k];
+                m_problems[kept] = m_problems[k];
+                ++kept;
+            }
+            m_indices.resize(kept);
+            m_problems.resize(kept);
+        }
+
+        solveBattin<double>();
+        for (std::size_t k = 0; k != m_problems.size(); ++k)
+            transfers[m_indices[k]] = transferDeltaV(departure(k), arrival(k), m_solutions[k], m_maxDeltaV);
+        return problemCount;
+    }
+
+private:
+    template<typename T>
+    void solveBattin()
+    {
+        m_solutions.resize(m_problems.size());
+        lambert_battin_batch<T>(kGMSun, m_problems, m_solutions);
+    }
+
+    const MissionTable &m_table;
+    const MissionTable::Settings &m_settings;
+    double m_maxDeltaV;
+    std::vector<std::size_t> m_indices;
+    std::vector<LambertProblem> m_problems;
+    std::vector<std::optional<TransferVelocities>> m_solutions;
+};
+
+std::optional<MissionTable::TransferDeltaV> compact(const std::optional<MissionTable::OrbitDeltaV> &transfer)
+{
+    if (!transfer)
+        return {};
+    return MissionTable::TransferDeltaV{static_cast<float>(transfer->deltaVDeparture),
+                                        static_cast<float>(transfer->deltaVArrival)};
+}
+
+double totalDeltaV(const std::optional<MissionTable::TransferDeltaV> &transfer)
+{
+    return transfer ? transfer->totalDeltaV() : std::numeric_limits<double>::infinity();
+}
+
+// Adaptive mode: the grid is first sampled every kCoarseStep cells, then regions are recursively split in four while
+// any of their corners is below kRefinementMargin times the budget. A region stops being split as soon as bilinear
+// interpolation from its corners predicts its midpoints to within kInterpolationTolerance, and the cells inside it are
+// interpolated instead of solved, except for the ones that come within kBoundaryBand of the budget. Regions around
+// coarse local minima are refined all the way down so that the cheapest transfer is always solved.
+constexpr std::size_t kCoarseStep = 16;
+constexpr double kRefinementMargin = 1.1;
+constexpr double kInterpolationTolerance = 1e-2; // relative to the budget
+constexpr double kBoundaryBand = 2.0 * kInterpolationTolerance;
+
+// Lambert problems solved by each task in the adaptive mode.
+constexpr std::size_t kNodeGrainSize = 256;
+
+// Progressive mode: the first pass samples every kProgressiveStride cells, every following pass halves the stride.
+// Results are published every kProgressiveBandSize cells.
+constexpr std::size_t kProgressiveStride = 16;
+constexpr std::size_t kProgressiveBandSize = 4096;
+
+// Grid lines sampled by the coarse pass: every `step` cells, plus the last one.
+std::vector<std::size_t> coarseLines(std::size_t size, std::size_t step)
+{
+    std::vector<std::size_t> lines;
+    for (std::size_t line = 0; line < size; line += step)
+        lines.push_back(line);
+    if (lines.back() != size - 1)
+        lines.push_back(size - 1);
+    return lines;
+}
+
+// Block of the grid between two sampled arrival lines and two sampled departure lines, corners included.
+struct Region
+{
+    std::size_t arrivalBegin;
+    std::size_t arrivalEnd;
+    std::size_t departureBegin;
+    std::size_t departureEnd;
+    bool nearMinimum{false};
+
+    bool isSplittable() const { return arrivalEnd - arrivalBegin > 1 || departureEnd - departureBegin > 1; }
+    std::size_t arrivalMiddle() const { return (arrivalBegin + arrivalEnd) / 2; }
+    std::size_t departureMiddle() const { return (departureBegin + departureEnd) / 2; }
+
+    std::array<Cell, 4> corners() const
+    {
+        return {Cell{arrivalBegin, departureBegin}, Cell{arrivalBegin, departureEnd}, Cell{arrivalEnd, departureBegin},
+                Cell{arrivalEnd, departureEnd}};
+    }
+};
+
+MissionTable::TransferDeltaV bilinear(const std::array<MissionTable::TransferDeltaV, 4> &corners, double u, double v)
+{
+    const auto mix = [&corners, u, v](auto field) {
+        return static_cast<float>(glm::mix(glm::mix<double>(corners[0].*field, corners[1].*field, v),
+                                           glm::mix<double>(corners[2].*field, corners[3].*field, v), u));
+    };
+    return {mix(&MissionTable::TransferDeltaV::deltaVDeparture), mix(&MissionTable::TransferDeltaV::deltaVArrival)};
+}
+
+// Slides a window of date samples by `shift` samples, moving its ring offset along. Returns the range of samples that
+// are new to the window and need to be sampled again.
+std::pair<std::size_t, std::size_t> slideWindow(std::vector<MissionTable::DateState> &states, std::size_t &ringOffset,
+                                                std::int64_t shift)
+{
+    const auto size = states.size();
+    const auto count = static_cast<std::size_t>(std::abs(shift));
+    assert(count < size);
+    if (shift >= 0)
+    {
+        std::ranges::rotate(states, states.begin() + count);
+        ringOffset = (ringOffset + count) % size;
+        return {size - count, size};
+    }
+    std::ranges::rotate(states, states.end() - count);
+    ringOffset = (ringOffset + size - count) % size;
+    return {0, count};
+}
+
+} // namespace
+
+MissionTable::MissionTable(const World *origin, const World *destination, JulianDate start, const Settings &settings,
+                           ThreadPool *threadPool)
+    : MissionTable(origin, destination, start, settings, Unsolved{})
+{
+    solveAll(threadPool);
+}
+
+MissionTable::MissionTable(const World *origin, const World *destination, JulianDate start, const Settings &settings,
+                           Unsolved)
     : m_origin(origin)
     , m_destination(destination)
+    , m_settings(settings)
+    , m_epoch(start)
 {
+    m_ephemeris.add(origin->orbit());
+    m_ephemeris.add(destination->orbit());
+
     const auto &originOrbit = origin->orbit();
     const auto &destinationOrbit = destination->orbit();
 
@@ -22,14 +284,7 @@ MissionTable::MissionTable(const World *origin, const World *destination, Julian
 
     // const auto maxPeriod = JulianDays{std::max(originOrbit.period(), destinationOrbit.period())};
     const auto maxPeriod = 2.0 * std::min(originOrbit.period(), destinationOrbit.period());
-    const auto departureStep = maxPeriod / kDepartureSamples;
-    JulianDate departure = start;
-    for (std::size_t i = 0; i < kDepartureSamples; ++i)
-    {
-        const auto [position, velocity] = m_origin->orbit().stateVector(departure);
-        departures.emplace_back(departure, position, velocity);
-        departure += departureStep;
-    }
+    m_departureStep = maxPeriod / kDepartureSamples;
 
     // assuming GM = 4 * pi^2
     // Hohmann transfer: tH = pi * sqrt((r1 + r2)^3 / 8 * GM)
@@ -37,49 +292,458 @@ MissionTable::MissionTable(const World *origin, const World *destination, Julian
     const JulianDays transitHohmann = JulianYears{
         0.5 *
         std::pow(0.5 * (originOrbit.elements().semiMajorAxis + destinationOrbit.elements().semiMajorAxis), 3.0 / 2.0)};
-    const auto minTransitInterval = 0.5 * transitHohmann;
+    m_minTransitInterval = 0.5 * transitHohmann;
     const auto maxTransitInterval = 1.5 * transitHohmann;
-    const auto arrivalStep = (maxPeriod + maxTransitInterval - minTransitInterval) / kArrivalSamples;
+    m_arrivalStep = (maxPeriod + maxTransitInterval - m_minTransitInterval) / kArrivalSamples;
+
+    departures.resize(kDepartureSamples);
+    sampleDepartures(0, departures.size());
+    arrivals.resize(kArrivalSamples);
+    sampleArrivals(0, arrivals.size());
+
+    const auto cellCount = departures.size() * arrivals.size();
+    m_deltaVDeparture.resize(cellCount);
+    m_deltaVArrival.resize(cellCount);
+    m_validMask.resize((cellCount + 63) / 64);
+}
+
+MissionTable::TransferGrid MissionTable::transfers() const
+{
+    return TransferGrid(0,
+                        TransferGrid::mapping_type(std::dextents<std::size_t, 2>(arrivals.size(), departures.size()),
+                                                   m_rowOffset, m_columnOffset),
+                        TransferAccessor(m_deltaVDeparture.data(), m_deltaVArrival.data(), m_validMask.data()));
+}
 
-    JulianDate arrival = start + minTransitInterval;
-    for (std::size_t i = 0; i < kArrivalSamples; ++i)
+void MissionTable::setTransfer(std::size_t cell, const std::optional<TransferDeltaV> &transfer)
+{
+    // cells solved by different tasks can share a word of the mask
+    const auto bit = std::uint64_t{1} << (cell % 64);
+    std::atomic_ref<std::uint64_t> word(m_validMask[cell / 64]);
+    if (transfer)
+    {
+        m_deltaVDeparture[cell] = transfer->deltaVDeparture;
+        m_deltaVArrival[cell] = transfer->deltaVArrival;
+        word.fetch_or(bit, std::memory_order_relaxed);
+    }
+    else
     {
-        const auto [position, velocity] = m_destination->orbit().stateVector(arrival);
-        arrivals.emplace_back(arrival, position, velocity);
-        arrival += arrivalStep;
+        word.fetch_and(~bit, std::memory_order_relaxed);
     }
+}
 
-    transferOrbits.resize(departures.size() * arrivals.size());
-    auto orbits = std::mdspan(transferOrbits.data(), arrivals.size(), departures.size());
-    for (std::size_t i = 0; i != orbits.extent(0); ++i)
+void MissionTable::sampleDepartures(std::size_t begin, std::size_t end)
+{
+    for (std::size_t i = begin; i != end; ++i)
+        departures[i].date =
+            m_epoch + static_cast<double>(m_departureOffset + static_cast<std::int64_t>(i)) * m_departureStep;
+    sampleStates(kOriginBody, std::span{departures}.subspan(begin, end - begin));
+}
+
+void MissionTable::sampleArrivals(std::size_t begin, std::size_t end)
+{
+    for (std::size_t i = begin; i != end; ++i)
+        arrivals[i].date = m_epoch + m_minTransitInterval +
+                           static_cast<double>(m_arrivalOffset + static_cast<std::int64_t>(i)) * m_arrivalStep;
+    sampleStates(kDestinationBody, std::span{arrivals}.subspan(begin, end - begin));
+}
+
+void MissionTable::sampleStates(std::size_t body, std::span<DateState> states) const
+{
+    std::vector<JulianDate> dates(states.size());
+    std::vector<glm::dvec3> positions(states.size());
+    std::vector<glm::dvec3> velocities(states.size());
+    std::ranges::transform(states, dates.begin(), &DateState::date);
+    m_ephemeris.compute(body, dates, {.positions = positions, .velocities = velocities});
+    for (std::size_t i = 0; i < states.size(); ++i)
     {
-        assert(i < arrivals.size());
-        const auto &arrival = arrivals[i];
-        for (std::size_t j = 0; j < orbits.extent(1); ++j)
+        states[i].worldPosition = positions[i];
+        states[i].worldVelocity = velocities[i];
+    }
+}
+
+void MissionTable::copyTransfers(const MissionTable &other)
+{
+    assert(other.m_deltaVDeparture.size() == m_deltaVDeparture.size());
+    assert(other.m_rowOffset == m_rowOffset && other.m_columnOffset == m_columnOffset);
+    std::ranges::copy(other.m_deltaVDeparture, m_deltaVDeparture.begin());
+    std::ranges::copy(other.m_deltaVArrival, m_deltaVArrival.begin());
+    std::ranges::copy(other.m_validMask, m_validMask.begin());
+    m_solveCount = other.m_solveCount;
+}
+
+void MissionTable::solveAll(ThreadPool *threadPool)
+{
+    if (m_settings.adaptiveRefinement)
+        solveAdaptive(threadPool);
+    else
+        solveBlock(0, arrivals.size(), 0, departures.size(), threadPool);
+}
+
+bool MissionTable::advance(JulianDate start, ThreadPool *threadPool)
+{
+    const auto stepsSinceEpoch = [this, start](JulianDays step) {
+        return static_cast<std::int64_t>(std::floor((start - m_epoch) / step));
+    };
+    const auto departureOffset = stepsSinceEpoch(m_departureStep);
+    const auto arrivalOffset = stepsSinceEpoch(m_arrivalStep);
+    const auto columnShift = departureOffset - m_departureOffset;
+    const auto rowShift = arrivalOffset - m_arrivalOffset;
+    if (columnShift == 0 && rowShift == 0)
+        return false;
+    m_departureOffset = departureOffset;
+    m_arrivalOffset = arrivalOffset;
+
+    const auto columns = static_cast<std::int64_t>(departures.size());
+    const auto rows = static_cast<std::int64_t>(arrivals.size());
+    if (std::abs(columnShift) >= columns || std::abs(rowShift) >= rows)
+    {
+        // nothing to reuse
+        m_rowOffset = 0;
+        m_columnOffset = 0;
+        sampleDepartures(0, departures.size());
+        sampleArrivals(0, arrivals.size());
+        solveAll(threadPool);
+    }
+    else
+    {
+        const auto [departureBegin, departureEnd] = slideWindow(departures, m_columnOffset, columnShift);
+        const auto [arrivalBegin, arrivalEnd] = slideWindow(arrivals, m_rowOffset, rowShift);
+        sampleDepartures(departureBegin, departureEnd);
+        sampleArrivals(arrivalBegin, arrivalEnd);
+        solveBlock(0, arrivals.size(), departureBegin, departureEnd, threadPool);
+        // the cells of the new arrival rows that aren't in the new departure columns
+        solveBlock(arrivalBegin, arrivalEnd, 0, departureBegin, threadPool);
+        solveBlock(arrivalBegin, arrivalEnd, departureEnd, departures.size(), threadPool);
+    }
+    transfersChangedSignal();
+    return true;
+}
+
+void MissionTable::solveBlock(std::size_t arrivalBegin, std::size_t arrivalEnd, std::size_t departureBegin,
+                              std::size_t departureEnd, ThreadPool *threadPool)
+{
+    if (arrivalBegin == arrivalEnd || departureBegin == departureEnd)
+        return;
+
+    const auto grid = transfers();
+
+    const auto tileRows = (arrivalEnd - arrivalBegin + kTileSize - 1) / kTileSize;
+    const auto tileColumns = (departureEnd - departureBegin + kTileSize - 1) / kTileSize;
+    std::atomic<std::size_t> solveCount{0};
+    const auto solveTiles = [&](std::size_t beginTile, std::size_t endTile) {
+        CellSolver solver(*this, m_settings, m_settings.maxDeltaV);
+        std::vector<Cell> cells;
+        std::vector<std::optional<OrbitDeltaV>> transfers;
+        for (std::size_t tile = beginTile; tile != endTile; ++tile)
+        {
+            const auto rowBegin = arrivalBegin + (tile / tileColumns) * kTileSize;
+            const auto rowEnd = std::min(rowBegin + kTileSize, arrivalEnd);
+            const auto columnBegin = departureBegin + (tile % tileColumns) * kTileSize;
+            const auto columnEnd = std::min(columnBegin + kTileSize, departureEnd);
+            cells.clear();
+            for (std::size_t i = rowBegin; i != rowEnd; ++i)
+            {
+                for (std::size_t j = columnBegin; j != columnEnd; ++j)
+                    cells.emplace_back(i, j);
+            }
+            transfers.resize(cells.size());
+            solveCount += solver.solve(cells, transfers);
+            for (std::size_t k = 0; k != cells.size(); ++k)
+                setTransfer(grid.mapping()(cells[k].arrival, cells[k].departure), compact(transfers[k]));
+        }
+    };
+
+    const auto tileCount = tileRows * tileColumns;
+    if (threadPool)
+        threadPool->parallelFor(tileCount, 1, solveTiles);
+    else
+        solveTiles(0, tileCount);
+    m_solveCount += solveCount;
+}
+
+void MissionTable::solveAdaptive(ThreadPool *threadPool)
+{
+    const auto maxDeltaV = m_settings.maxDeltaV;
+    const auto orbits = transfers();
+    // cells in regions far above the budget are never touched
+    std::ranges::fill(m_validMask, 0);
+
+    // Sampled cells are solved without the budget cut, so that we can tell how far above it they are. The cut is
+    // applied at the very end.
+    std::vector<bool> sampled(m_deltaVDeparture.size());
+    std::vector<Cell> nodes;
+    std::atomic<std::size_t> solveCount{0};
+    const auto addNode = [&sampled, &nodes, columns = departures.size()](std::size_t arrival, std::size_t departure) {
+        const auto index = arrival * columns + departure;
+        if (sampled[index])
+            return;
+        sampled[index] = true;
+        nodes.emplace_back(arrival, departure);
+    };
+    const auto solveNodes = [this, &nodes, &orbits, &solveCount, threadPool] {
+        const auto solveRange = [&](std::size_t begin, std::size_t end) {
+            CellSolver solver(*this, m_settings, std::numeric_limits<double>::infinity());
+            const auto cells = std::span{nodes}.subspan(begin, end - begin);
+            std::vector<std::optional<OrbitDeltaV>> transfers(cells.size());
+            solveCount += solver.solve(cells, transfers);
+            for (std::size_t k = 0; k != cells.size(); ++k)
+                setTransfer(orbits.mapping()(cells[k].arrival, cells[k].departure), compact(transfers[k]));
+        };
+        if (threadPool)
+            threadPool->parallelFor(nodes.size(), kNodeGrainSize, solveRange);
+        else
+            solveRange(0, nodes.size());
+        nodes.clear();
+    };
+    const auto deltaV = [&orbits](const Cell &cell) { return totalDeltaV(orbits[cell.arrival, cell.departure]); };
+
+    const auto arrivalLines = coarseLines(arrivals.size(), kCoarseStep);
+    const auto departureLines = coarseLines(departures.size(), kCoarseStep);
+    for (const auto i : arrivalLines)
+    {
+        for (const auto j : departureLines)
+            addNode(i, j);
+    }
+    solveNodes();
+
+    const auto regionRows = arrivalLines.size() - 1;
+    const auto regionColumns = departureLines.size() - 1;
+    std::vector<Region> regions;
+    for (std::size_t i = 0; i != regionRows; ++i)
+    {
+        for (std::size_t j = 0; j != regionColumns; ++j)
+        {
+            regions.push_back(
+                Region{arrivalLines[i], arrivalLines[i + 1], departureLines[j], departureLines[j + 1]});
+        }
+    }
+
+    // regions around a local minimum of the coarse samples are always refined down to single cells
+    for (std::size_t i = 0; i != arrivalLines.size(); ++i)
+    {
+        for (std::size_t j = 0; j != departureLines.size(); ++j)
+        {
+            const auto value = deltaV(Cell{arrivalLines[i], departureLines[j]});
+            if (!(value < kRefinementMargin * maxDeltaV))
+                continue;
+            bool isMinimum = true;
+            for (std::size_t ni = std::max<std::size_t>(i, 1) - 1; ni != std::min(i + 2, arrivalLines.size()); ++ni)
+            {
+                for (std::size_t nj = std::max<std::size_t>(j, 1) - 1; nj != std::min(j + 2, departureLines.size());
+                     ++nj)
+                {
+                    if (deltaV(Cell{arrivalLines[ni], departureLines[nj]}) < value)
+                        isMinimum = false;
+                }
+            }
+            if (!isMinimum)
+                continue;
+            for (std::size_t ri = std::max<std::size_t>(i, 1) - 1; ri != std::min(i + 1, regionRows); ++ri)
+            {
+                for (std::size_t rj = std::max<std::size_t>(j, 1) - 1; rj != std::min(j + 1, regionColumns); ++rj)
+                    regions[ri * regionColumns + rj].nearMinimum = true;
+            }
+        }
+    }
+
+    const auto interpolate = [&](const Region &region) {
+        const auto corners = region.corners();
+        std::array<TransferDeltaV, 4> cornerTransfers;
+        for (std::size_t k = 0; k != corners.size(); ++k)
+        {
+            const auto transfer = orbits[corners[k].arrival, corners[k].departure];
+            if (!transfer)
+                return false;
+            cornerTransfers[k] = *transfer;
+        }
+        const auto minCorner = std::ranges::min(corners | std::views::transform(deltaV));
+
+        const auto coordinates = [&region](const Cell &cell) {
+            const auto u = region.arrivalEnd != region.arrivalBegin
+                               ? static_cast<double>(cell.arrival - region.arrivalBegin) /
+                                     (region.arrivalEnd - region.arrivalBegin)
+                               : 0.0;
+            const auto v = region.departureEnd != region.departureBegin
+                               ? static_cast<double>(cell.departure - region.departureBegin) /
+                                     (region.departureEnd - region.departureBegin)
+                               : 0.0;
+            return std::pair{u, v};
+        };
+
+        const auto im = region.arrivalMiddle();
+        const auto jm = region.departureMiddle();
+        const auto midpoints = std::array{Cell{region.arrivalBegin, jm}, Cell{region.arrivalEnd, jm},
+                                          Cell{im, region.departureBegin}, Cell{im, region.departureEnd}, Cell{im, jm}};
+        for (const auto &midpoint : midpoints)
+        {
+            const auto value = deltaV(midpoint);
+            // a midpoint below every corner means there's a minimum in there
+            if (!std::isfinite(value) || value < minCorner)
+                return false;
+            const auto [u, v] = coordinates(midpoint);
+            const auto predicted = bilinear(cornerTransfers, u, v);
+            if (std::abs(totalDeltaV(predicted) - value) > kInterpolationTolerance * maxDeltaV)
+                return false;
+        }
+
+        for (std::size_t i = region.arrivalBegin; i <= region.arrivalEnd; ++i)
+        {
+            for (std::size_t j = region.departureBegin; j <= region.departureEnd; ++j)
+            {
+                const auto index = i * departures.size() + j;
+                if (sampled[index])
+                    continue;
+                const auto [u, v] = coordinates(Cell{i, j});
+                const auto transfer = bilinear(cornerTransfers, u, v);
+                // the interpolation can't be trusted to tell on which side of the budget the cell is
+                if (std::abs(totalDeltaV(transfer) - maxDeltaV) < kBoundaryBand * maxDeltaV)
+                {
+                    addNode(i, j);
+                    continue;
+                }
+                setTransfer(orbits.mapping()(i, j), transfer);
+            }
+        }
+        return true;
+    };
+
+    while (!regions.empty())
+    {
+        // drop the regions that are fully sampled or that are far above the budget, sample the midpoints of the rest
+        std::erase_if(regions, [&](const Region &region) {
+            return !region.isSplittable() || std::ranges::none_of(region.corners(), [&](const Cell &cell) {
+                       return deltaV(cell) < kRefinementMargin * maxDeltaV;
+                   });
+        });
+        for (const auto &region : regions)
+        {
+            const auto im = region.arrivalMiddle();
+            const auto jm = region.departureMiddle();
+            addNode(region.arrivalBegin, jm);
+            addNode(region.arrivalEnd, jm);
+            addNode(im, region.departureBegin);
+            addNode(im, region.departureEnd);
+            addNode(im, jm);
+        }
+        solveNodes();
+
+        std::vector<Region> children;
+        for (const auto &region : regions)
+        {
+            if (!region.nearMinimum && interpolate(region))
+                continue;
+            const auto im = region.arrivalMiddle();
+            const auto jm = region.departureMiddle();
+            // only the children around the lowest sample keep being refined all the way down
+            const auto lowest = [&] {
+                auto samples = std::array{Cell{region.arrivalBegin, region.departureBegin},
+                                          Cell{region.arrivalBegin, jm},
+                                          Cell{region.arrivalBegin, region.departureEnd},
+                                          Cell{im, region.departureBegin},
+                                          Cell{im, jm},
+                                          Cell{im, region.departureEnd},
+                                          Cell{region.arrivalEnd, region.departureBegin},
+                                          Cell{region.arrivalEnd, jm},
+                                          Cell{region.arrivalEnd, region.departureEnd}};
+                return *std::ranges::min_element(samples, {}, deltaV);
+            }();
+            for (const auto [arrivalBegin, arrivalEnd] :
+                 {std::pair{region.arrivalBegin, im}, std::pair{im, region.arrivalEnd}})
+            {
+                for (const auto [departureBegin, departureEnd] :
+                     {std::pair{region.departureBegin, jm}, std::pair{jm, region.departureEnd}})
+                {
+                    // a region one cell wide only gets split along the other axis
+                    if (arrivalBegin == arrivalEnd || departureBegin == departureEnd)
+                        continue;
+                    const auto nearMinimum = region.nearMinimum && lowest.arrival >= arrivalBegin &&
+                                             lowest.arrival <= arrivalEnd && lowest.departure >= departureBegin &&
+                                             lowest.departure <= departureEnd;
+                    children.emplace_back(arrivalBegin, arrivalEnd, departureBegin, departureEnd, nearMinimum);
+                }
+            }
+        }
+        regions = std::move(children);
+    }
+    // interpolated cells too close to the budget
+    solveNodes();
+
+    for (std::size_t i = 0; i != arrivals.size(); ++i)
+    {
+        for (std::size_t j = 0; j != departures.size(); ++j)
         {
-            assert(j < departures.size());
-            const auto &departure = departures[j];
-            if (arrival.date > departure.date)
+            if (totalDeltaV(orbits[i, j]) >= maxDeltaV)
+                setTransfer(orbits.mapping()(i, j), std::nullopt);
+        }
+    }
+    m_solveCount += solveCount;
+}
+
+std::optional<MissionTable::OrbitDeltaV> MissionTable::transferOrbit(std::size_t arrivalIndex,
+                                                                     std::size_t departureIndex) const
+{
+    if (!transfers()[arrivalIndex, departureIndex])
+        return {};
+    CellSolver solver(*this, m_settings, m_settings.maxDeltaV);
+    const auto cell = Cell{arrivalIndex, departureIndex};
+    std::optional<OrbitDeltaV> transfer;
+    solver.solve(std::span{&cell, 1}, std::span{&transfer, 1});
+    return transfer;
+}
+
+bool MissionTable::solveProgressive(std::stop_token stopToken, ThreadPool *threadPool,
+                                    const std::function<void()> &publish)
+{
+    const auto orbits = transfers();
+    const auto rows = arrivals.size();
+    const auto columns = departures.size();
+
+    std::vector<Cell> band;
+    const auto solveBand = [this, &band, &orbits, rows, columns, threadPool](std::size_t stride) {
+        std::atomic<std::size_t> solveCount{0};
+        const auto solveRange = [&](std::size_t begin, std::size_t end) {
+            CellSolver solver(*this, m_settings, m_settings.maxDeltaV);
+            const auto cells = std::span{band}.subspan(begin, end - begin);
+            std::vector<std::optional<OrbitDeltaV>> transfers(cells.size());
+            solveCount += solver.solve(cells, transfers);
+            // the sample stands for its whole block until the finer passes get there
+            for (std::size_t k = 0; k != cells.size(); ++k)
             {
-                const auto transitInterval = arrival.date - departure.date;
-                if (auto orbit =
-                        lambert_battin(kGMSun, departure.worldPosition, arrival.worldPosition, transitInterval.count()))
+                const auto transfer = compact(transfers[k]);
+                for (auto i = cells[k].arrival; i != std::min(cells[k].arrival + stride, rows); ++i)
                 {
-                    const auto [velDeparture, velArrival] = *orbit;
-                    // FIXME sometimes lambert_battin returns vec3{inf}
-                    if (isNormal(velDeparture) && isNormal(velArrival))
-                    {
-                        const auto deltaVDeparture = glm::length(velDeparture - departure.worldVelocity);
-                        const auto deltaVArrival = glm::length(velArrival - arrival.worldVelocity);
-                        const auto deltaV = deltaVDeparture + deltaVArrival;
-                        if (deltaV < maxDeltaV)
-                        {
-                            assert(!std::isnan(deltaV));
-                            orbits[i, j] = OrbitDeltaV{velDeparture, velArrival, deltaVDeparture, deltaVArrival};
-                        }
-                    }
+                    for (auto j = cells[k].departure; j != std::min(cells[k].departure + stride, columns); ++j)
+                        setTransfer(orbits.mapping()(i, j), transfer);
                 }
             }
+        };
+        if (threadPool)
+            threadPool->parallelFor(band.size(), kNodeGrainSize, solveRange);
+        else
+            solveRange(0, band.size());
+        m_solveCount += solveCount;
+        band.clear();
+    };
+
+    for (auto stride = kProgressiveStride; stride != 0; stride /= 2)
+    {
+        for (std::size_t i = 0; i < rows; i += stride)
+        {
+            for (std::size_t j = 0; j < columns; j += stride)
+            {
+                // samples of the previous passes are already there
+                if (stride == kProgressiveStride || i % (2 * stride) != 0 || j % (2 * stride) != 0)
+                    band.emplace_back(i, j);
+            }
+            if (band.size() >= kProgressiveBandSize || i + stride >= rows)
+            {
+                solveBand(stride);
+                publish();
+                if (stopToken.stop_requested())
+                    return false;
+            }
         }
     }
+    return true;
 }
@@ -1,7 +1,78 @@
 #pragma once
 
+#include "lambert.h"
 #include "universe.h"
 
+#include <muslots/muslots.h>
+
+#include <cstdint>
+#include <functional>
+#include <mdspan>
+#include <stop_token>
+
+class ThreadPool;
+
+// mdspan layout for a 2D grid whose rows and columns are both ring buffers: row i is stored at (i + rowOffset) % rows
+// and column j at (j + columnOffset) % columns. Sliding the grid by a few rows or columns only changes the offsets.
+struct RingLayout
+{
+    template<typename Extents>
+    class mapping
+    {
+    public:
+        static_assert(Extents::rank() == 2);
+
+        using extents_type = Extents;
+        using index_type = typename extents_type::index_type;
+        using size_type = typename extents_type::size_type;
+        using rank_type = typename extents_type::rank_type;
+        using layout_type = RingLayout;
+
+        constexpr mapping() = default;
+        constexpr mapping(const extents_type &extents, index_type rowOffset = 0, index_type columnOffset = 0)
+            : m_extents(extents)
+            , m_rowOffset(rowOffset)
+            , m_columnOffset(columnOffset)
+        {
+        }
+
+        constexpr const extents_type &extents() const { return m_extents; }
+        constexpr index_type rowOffset() const { return m_rowOffset; }
+        constexpr index_type columnOffset() const { return m_columnOffset; }
+
+        template<typename Row, typename Column>
+        constexpr index_type operator()(Row row, Column column) const
+        {
+            const auto rows = m_extents.extent(0);
+            const auto columns = m_extents.extent(1);
+            return wrap(static_cast<index_type>(row) + m_rowOffset, rows) * columns +
+                   wrap(static_cast<index_type>(column) + m_columnOffset, columns);
+        }
+
+        constexpr index_type required_span_size() const { return m_extents.extent(0) * m_extents.extent(1); }
+
+        static constexpr bool is_always_unique() { return true; }
+        static constexpr bool is_always_exhaustive() { return true; }
+        static constexpr bool is_always_strided() { return false; }
+        static constexpr bool is_unique() { return true; }
+        static constexpr bool is_exhaustive() { return true; }
+        static constexpr bool is_strided() { return false; }
+
+        friend constexpr bool operator==(const mapping &lhs, const mapping &rhs) = default;
+
+    private:
+        // offsets are kept below the extents, so a single subtraction is enough
+        static constexpr index_type wrap(index_type index, index_type extent)
+        {
+            return index >= extent ? index - extent : index;
+        }
+
+        extents_type m_extents;
+        index_type m_rowOffset{0};
+        index_type m_columnOffset{0};
+    };
+};
+
 struct MissionTable
 {
 public:
@@ -20,15 +91,151 @@ public:
         double deltaVArrival;
     };
 
+    // What the table keeps for every cell. The velocities of the transfer orbit are solved again when needed, see
+    // transferOrbit.
+    struct TransferDeltaV
+    {
+        float deltaVDeparture;
+        float deltaVArrival;
+
+        double totalDeltaV() const { return static_cast<double>(deltaVDeparture) + deltaVArrival; }
+    };
+
+    // mdspan accessor over the structure-of-arrays storage of the table: one delta-v plane per side, plus a bitmask of
+    // the cells that have a transfer within the budget. Data handles are cell indices.
+    class TransferAccessor
+    {
+    public:
+        using element_type = const std::optional<TransferDeltaV>;
+        using reference = std::optional<TransferDeltaV>;
+        using data_handle_type = std::size_t;
+        using offset_policy = TransferAccessor;
+
+        constexpr TransferAccessor() = default;
+        constexpr TransferAccessor(const float *deltaVDeparture, const float *deltaVArrival,
+                                   const std::uint64_t *validMask)
+            : m_deltaVDeparture(deltaVDeparture)
+            , m_deltaVArrival(deltaVArrival)
+            , m_validMask(validMask)
+        {
+        }
+
+        constexpr reference access(data_handle_type base, std::size_t index) const
+        {
+            const auto cell = base + index;
+            if ((m_validMask[cell / 64] & (std::uint64_t{1} << (cell % 64))) == 0)
+                return std::nullopt;
+            return TransferDeltaV{m_deltaVDeparture[cell], m_deltaVArrival[cell]};
+        }
+
+        constexpr data_handle_type offset(data_handle_type base, std::size_t index) const { return base + index; }
+
+    private:
+        const float *m_deltaVDeparture{nullptr};
+        const float *m_deltaVArrival{nullptr};
+        const std::uint64_t *m_validMask{nullptr};
+    };
+
     const World *origin() const { return m_origin; }
     const World *destination() const { return m_destination; }
     std::vector<DateState> departures;
     std::vector<DateState> arrivals;
-    std::vector<std::optional<OrbitDeltaV>> transferOrbits;
 
-    explicit MissionTable(const World *origin, const World *destination, JulianDate start, double maxDeltaV);
+    // Transfers indexed by [arrivalIndex, departureIndex], empty where there's no transfer within the budget.
+    using TransferGrid =
+        std::mdspan<const std::optional<TransferDeltaV>, std::dextents<std::size_t, 2>, RingLayout, TransferAccessor>;
+    TransferGrid transfers() const;
+
+    struct Settings
+    {
+        double maxDeltaV; // AU/day
+        LambertSolver solver{LambertSolver::Battin};
+        // Izzo only: also consider transfers with up to this many full revolutions, picking the cheapest branch.
+        int maxRevolutions{0};
+        // Battin only: screen every cell with the single precision batch solver first and only re-solve in double
+        // precision the cells that come close to `maxDeltaV`. Results are the same as without screening except for
+        // cells right at the budget threshold.
+        bool floatScreening{false};
+        // Solve a coarse grid first and only refine it around the budget threshold and around local minima.
+        // Cells far above the budget are left empty and smooth areas well below it are interpolated.
+        bool adaptiveRefinement{false};
+    };
+
+    // If `threadPool` is not null the grid is solved in tiles on the pool, otherwise it's solved on the calling
+    // thread. Both give bit-identical results.
+    explicit MissionTable(const World *origin, const World *destination, JulianDate start, const Settings &settings,
+                          ThreadPool *threadPool = nullptr);
+
+    const Settings &settings() const { return m_settings; }
+
+    // Slides the window of departure and arrival dates to `start`. Dates are sampled at fixed steps from the start
+    // date the table was built with, so the window only moves once `start` crosses a step, and only the departure
+    // columns and arrival rows that weren't in the previous window are solved. Those are solved exactly even in the
+    // adaptive mode. Returns whether the window moved.
+    bool advance(JulianDate start, ThreadPool *threadPool = nullptr);
+
+    // Number of Lambert problems solved so far, including the ones solved when advancing the window.
+    std::size_t solveCount() const { return m_solveCount; }
+
+    // Transfer orbit of a cell, solved on the spot since the table doesn't keep velocities. Empty if the cell has no
+    // transfer. The delta-v can differ slightly from transfers()[arrivalIndex, departureIndex], which is single
+    // precision and, in the adaptive mode, possibly interpolated.
+    std::optional<OrbitDeltaV> transferOrbit(std::size_t arrivalIndex, std::size_t departureIndex) const;
+
+    // Emitted when the window moves and when a MissionTableBuilder publishes new results into the table.
+    muslots::Signal<> transfersChangedSignal;
 
 private:
+    friend class MissionTableBuilder;
+    friend class MissionTableCache;
+
+    // Only samples the dates, the grid starts out empty.
+    struct Unsolved
+    {
+    };
+    explicit MissionTable(const World *origin, const World *destination, JulianDate start, const Settings &settings,
+                          Unsolved);
+
+    // Solves the whole grid in passes of decreasing stride. Cells that aren't solved yet hold the transfer of the
+    // closest coarser sample, so the table can be shown at any time. Calls `publish` after each band of cells and
+    // returns false if it was stopped in between.
+    bool solveProgressive(std::stop_token stopToken, ThreadPool *threadPool, const std::function<void()> &publish);
+
+    // Copies the transfers of a table with the same dates.
+    void copyTransfers(const MissionTable &other);
+
+    // Safe to call concurrently for different cells.
+    void setTransfer(std::size_t cell, const std::optional<TransferDeltaV> &transfer);
+
+    void sampleDepartures(std::size_t begin, std::size_t end);
+    void sampleArrivals(std::size_t begin, std::size_t end);
+    // Fills in the states of `body` at the dates of `states`.
+    void sampleStates(std::size_t body, std::span<DateState> states) const;
+    void solveAll(ThreadPool *threadPool);
+    void solveBlock(std::size_t arrivalBegin, std::size_t arrivalEnd, std::size_t departureBegin,
+                    std::size_t departureEnd, ThreadPool *threadPool);
+    void solveAdaptive(ThreadPool *threadPool);
+
+    static constexpr std::size_t kOriginBody = 0;
+    static constexpr std::size_t kDestinationBody = 1;
+
     const World *m_origin{nullptr};
     const World *m_destination{nullptr};
+    Ephemeris m_ephemeris; // origin and destination
+    Settings m_settings;
+    // departure j is sampled at m_epoch + (m_departureOffset + j) * m_departureStep, and arrival i at
+    // m_epoch + m_minTransitInterval + (m_arrivalOffset + i) * m_arrivalStep
+    JulianDate m_epoch;
+    JulianDays m_departureStep{};
+    JulianDays m_arrivalStep{};
+    JulianDays m_minTransitInterval{};
+    std::int64_t m_departureOffset{0};
+    std::int64_t m_arrivalOffset{0};
+    std::size_t m_rowOffset{0};
+    std::size_t m_columnOffset{0};
+    // laid out with RingLayout
+    std::vector<float> m_deltaVDeparture;
+    std::vector<float> m_deltaVArrival;
+    std::vector<std::uint64_t> m_validMask;
+    std::size_t m_solveCount{0};
 };
@@ -0,0 +1,68 @@
+#include "mission_table_builder.h"
+
+MissionTableBuilder::MissionTableBuilder(const World *origin, const World *destination, JulianDate start,
+                                         const MissionTable::Settings &settings, ThreadPool *threadPool,
+                                         const MissionTableCache *cache)
+{
+    // the table says what it really is, so that it's cached under the right key
+    auto buildSettings = settings;
+    buildSettings.adaptiveRefinement = false;
+
+    if (cache)
+    {
+        m_cache = *cache;
+        m_table = cache->load(origin, destination, start, buildSettings);
+        if (m_table)
+        {
+            // no thread to report it, poll() keeps the builder finished
+            m_buildFinished = true;
+            m_finished = true;
+            return;
+        }
+    }
+
+    m_table.reset(new MissionTable(origin, destination, start, buildSettings, MissionTable::Unsolved{}));
+    m_workingTable.reset(new MissionTable(origin, destination, start, buildSettings, MissionTable::Unsolved{}));
+    m_publishedTable.reset(new MissionTable(origin, destination, start, buildSettings, MissionTable::Unsolved{}));
+    m_thread = std::jthread([this, threadPool](std::stop_token stopToken) { build(stopToken, threadPool); });
+}
+
+MissionTableBuilder::~MissionTableBuilder() = default;
+
+bool MissionTableBuilder::poll()
+{
+    std::unique_lock lock(m_mutex, std::try_to_lock);
+    if (!lock.owns_lock())
+        return false;
+    if (!m_hasResults)
+    {
+        m_finished = m_buildFinished;
+        return false;
+    }
+    m_table->copyTransfers(*m_publishedTable);
+    m_hasResults = false;
+    lock.unlock();
+
+    m_table->transfersChangedSignal();
+    return true;
+}
+
+void MissionTableBuilder::cancel()
+{
+    m_thread.request_stop();
+}
+
+void MissionTableBuilder::build(std::stop_token stopToken, ThreadPool *threadPool)
+{
+    const auto publish = [this] {
+        std::lock_guard lock(m_mutex);
+        m_publishedTable->copyTransfers(*m_workingTable);
+        m_hasResults = true;
+    };
+    const auto completed = m_workingTable->solveProgressive(stopToken, threadPool, publish);
+    if (completed && m_cache)
+        m_cache->store(*m_workingTable);
+
+    std::lock_guard lock(m_mutex);
+    m_buildFinished = completed;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "mission_table.h"
+#include "mission_table_cache.h"
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+class ThreadPool;
+
+// Builds a MissionTable on a background thread, coarse samples first. The main thread picks up the results as they
+// come with poll(), the table can be shown and used while it's being built. Destroying the builder cancels the
+// build, which returns as soon as the band of cells in flight is done.
+class MissionTableBuilder
+{
+public:
+    // Settings::adaptiveRefinement is ignored, every cell is solved. If `threadPool` is not null the background
+    // thread solves each band on it. If `cache` is not null the table is loaded from it when possible, in which case
+    // no thread is started and the builder is finished right away, otherwise the finished table is stored in it.
+    explicit MissionTableBuilder(const World *origin, const World *destination, JulianDate start,
+                                 const MissionTable::Settings &settings, ThreadPool *threadPool = nullptr,
+                                 const MissionTableCache *cache = nullptr);
+    ~MissionTableBuilder();
+
+    MissionTableBuilder(const MissionTableBuilder &) = delete;
+    MissionTableBuilder &operator=(const MissionTableBuilder &) = delete;
+
+    // Only changed by poll(), on the main thread.
+    MissionTable *table() { return m_table.get(); }
+    const MissionTable *table() const { return m_table.get(); }
+
+    // Copies the latest results published by the background thread into table() and emits its
+    // transfersChangedSignal. Never waits for the background thread: if it's busy publishing, this does nothing and
+    // the results are picked up by the next call. Returns whether table() changed.
+    bool poll();
+
+    // True once the build is done and poll() copied its last results.
+    bool isFinished() const { return m_finished; }
+
+    void cancel();
+
+private:
+    void build(std::stop_token stopToken, ThreadPool *threadPool);
+
+    std::optional<MissionTableCache> m_cache;
+    std::unique_ptr<MissionTable> m_table;
+    std::unique_ptr<MissionTable> m_workingTable;   // background thread only
+    std::unique_ptr<MissionTable> m_publishedTable; // guarded by m_mutex
+    std::mutex m_mutex;
+    bool m_hasResults{false};    // guarded by m_mutex
+    bool m_buildFinished{false}; // guarded by m_mutex
+    bool m_finished{false};
+    std::jthread m_thread; // last, so that it's stopped and joined before anything else is destroyed
+};
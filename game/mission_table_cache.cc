@@ -0,0 +1,188 @@
+#include "mission_table_cache.h"
+
+#include <base/file.h>
+
+#include <array>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <type_traits>
+
+namespace
+{
+
+// Bump when the file layout or the way transfers are solved changes.
+constexpr std::uint32_t kFormatVersion = 2;
+
+constexpr std::array<char, 8> kMagic = {'S', 'D', 'P', 'O', 'R', 'K', 'C', 'H'};
+
+struct FileHeader
+{
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t rows;
+    std::uint32_t columns;
+    std::uint32_t padding;
+    std::uint64_t key;
+    std::uint64_t solveCount;
+};
+
+// FNV-1a
+class Hasher
+{
+public:
+    template<typename T>
+        requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+    void add(T value)
+    {
+        const auto *bytes = reinterpret_cast<const unsigned char *>(&value);
+        for (std::size_t i = 0; i != sizeof(T); ++i)
+        {
+            m_hash ^= bytes[i];
+            m_hash *= 0x100000001b3;
+        }
+    }
+
+    void add(JulianDate date) { add(date.time_since_epoch().count()); }
+    void add(JulianDays interval) { add(interval.count()); }
+
+    void add(const OrbitalElements &elements)
+    {
+        add(elements.epoch);
+        add(elements.semiMajorAxis);
+        add(elements.eccentricity);
+        add(elements.inclination);
+        add(elements.longitudePerihelion);
+        add(elements.longitudeAscendingNode);
+        add(elements.meanAnomalyAtEpoch);
+    }
+
+    std::uint64_t hash() const { return m_hash; }
+
+private:
+    std::uint64_t m_hash{0xcbf29ce484222325};
+};
+
+template<typename T>
+std::span<const std::byte> asBytes(const std::vector<T> &values)
+{
+    return std::as_bytes(std::span{values});
+}
+
+} // namespace
+
+std::filesystem::path MissionTableCache::defaultDirectory()
+{
+    if (const auto *cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome && *cacheHome)
+        return std::filesystem::path{cacheHome} / "sundog";
+    if (const auto *home = std::getenv("HOME"); home && *home)
+        return std::filesystem::path{home} / ".cache" / "sundog";
+    return std::filesystem::temp_directory_path() / "sundog";
+}
+
+MissionTableCache::MissionTableCache(std::filesystem::path directory)
+    : m_directory(std::move(directory))
+{
+}
+
+std::unique_ptr<MissionTable> MissionTableCache::load(const World *origin, const World *destination,
+                                                      JulianDate start, const MissionTable::Settings &settings) const
+{
+    std::unique_ptr<MissionTable> table(
+        new MissionTable(origin, destination, start, settings, MissionTable::Unsolved{}));
+    const auto tableKey = key(*table);
+
+    const MappedFile file(filePath(tableKey).string());
+    if (!file.isValid())
+        return {};
+    const auto data = file.data();
+    if (data.size() < sizeof(FileHeader))
+        return {};
+    FileHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    const auto cellCount = table->m_deltaVDeparture.size();
+    const auto planeSize = cellCount * sizeof(float);
+    const auto maskSize = table->m_validMask.size() * sizeof(std::uint64_t);
+    if (header.magic != kMagic || header.version != kFormatVersion || header.key != tableKey ||
+        header.rows != table->arrivals.size() || header.columns != table->departures.size() ||
+        data.size() != sizeof(FileHeader) + 2 * planeSize + maskSize)
+        return {};
+
+    auto contents = data.subspan(sizeof(FileHeader));
+    std::memcpy(table->m_deltaVDeparture.data(), contents.data(), planeSize);
+    contents = contents.subspan(planeSize);
+    std::memcpy(table->m_deltaVArrival.data(), contents.data(), planeSize);
+    contents = contents.subspan(planeSize);
+    std::memcpy(table->m_validMask.data(), contents.data(), maskSize);
+    table->m_solveCount = header.solveCount;
+    return table;
+}
+
+bool MissionTableCache::store(const MissionTable &table) const
+{
+    if (table.m_departureOffset != 0 || table.m_arrivalOffset != 0)
+        return false;
+    assert(table.m_rowOffset == 0 && table.m_columnOffset == 0);
+
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    if (error)
+        return false;
+
+    const auto tableKey = key(table);
+    const FileHeader header{.magic = kMagic,
+                            .version = kFormatVersion,
+                            .rows = static_cast<std::uint32_t>(table.arrivals.size()),
+                            .columns = static_cast<std::uint32_t>(table.departures.size()),
+                            .padding = 0,
+                            .key = tableKey,
+                            .solveCount = table.m_solveCount};
+    std::vector<std::byte> contents;
+    const auto append = [&contents](std::span<const std::byte> bytes) {
+        contents.insert(contents.end(), bytes.begin(), bytes.end());
+    };
+    append(std::as_bytes(std::span{&header, 1}));
+    append(asBytes(table.m_deltaVDeparture));
+    append(asBytes(table.m_deltaVArrival));
+    append(asBytes(table.m_validMask));
+    return writeFile(filePath(tableKey).string(), contents);
+}
+
+std::unique_ptr<MissionTable> MissionTableCache::loadOrSolve(const World *origin, const World *destination,
+                                                             JulianDate start, const MissionTable::Settings &settings,
+                                                             ThreadPool *threadPool) const
+{
+    if (auto table = load(origin, destination, start, settings))
+        return table;
+    auto table = std::make_unique<MissionTable>(origin, destination, start, settings, threadPool);
+    store(*table);
+    return table;
+}
+
+std::uint64_t MissionTableCache::key(const MissionTable &table)
+{
+    Hasher hasher;
+    hasher.add(kFormatVersion);
+    hasher.add(kGMSun);
+    hasher.add(table.m_origin->orbit().elements());
+    hasher.add(table.m_destination->orbit().elements());
+    hasher.add(table.m_epoch);
+    hasher.add(table.m_departureStep);
+    hasher.add(table.m_arrivalStep);
+    hasher.add(table.m_minTransitInterval);
+    hasher.add(table.departures.size());
+    hasher.add(table.arrivals.size());
+    const auto &settings = table.m_settings;
+    hasher.add(settings.maxDeltaV);
+    hasher.add(settings.solver);
+    hasher.add(settings.maxRevolutions);
+    hasher.add(settings.floatScreening);
+    hasher.add(settings.adaptiveRefinement);
+    return hasher.hash();
+}
+
+std::filesystem::path MissionTableCache::filePath(std::uint64_t key) const
+{
+    return m_directory / std::format("{:016x}.porkchop", key);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "mission_table.h"
+
+#include <filesystem>
+#include <memory>
+
+class ThreadPool;
+
+// On-disk cache of mission tables. Files are named after a hash of everything the transfers depend on, including the
+// orbital elements of both worlds, so editing the universe data invalidates them. Files are memory-mapped when loaded
+// and are in native byte order.
+class MissionTableCache
+{
+public:
+    // $XDG_CACHE_HOME/sundog, or ~/.cache/sundog
+    static std::filesystem::path defaultDirectory();
+
+    explicit MissionTableCache(std::filesystem::path directory = defaultDirectory());
+
+    const std::filesystem::path &directory() const { return m_directory; }
+
+    // Table with its transfers loaded from the cache, nullptr if it isn't cached.
+    std::unique_ptr<MissionTable> load(const World *origin, const World *destination, JulianDate start,
+                                       const MissionTable::Settings &settings) const;
+
+    // Only tables whose window never moved can be stored.
+    bool store(const MissionTable &table) const;
+
+    // Loads the table from the cache, or solves it and stores it.
+    std::unique_ptr<MissionTable> loadOrSolve(const World *origin, const World *destination, JulianDate start,
+                                              const MissionTable::Settings &settings,
+                                              ThreadPool *threadPool = nullptr) const;
+
+private:
+    static std::uint64_t key(const MissionTable &table);
+    std::filesystem::path filePath(std::uint64_t key) const;
+
+    std::filesystem::path m_directory;
+};
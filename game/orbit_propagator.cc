@@ -0,0 +1,193 @@
+#include "orbit_propagator.h"
+
+#include "universe.h"
+
+#include <base/thread_pool.h>
+
+#include <atomic>
+#include <cassert>
+#include <cmath>
+
+// References:
+// Curtis, H. D. Orbital Mechanics for Engineering Students, chapter 3.7: Universal Variables, Elsevier, 2014
+// Vallado, D. A. Fundamentals of Astrodynamics and Applications, algorithm 8: Kepler, Microcosm Press, 2013
+
+namespace
+{
+
+// below this |z| the Stumpff functions are evaluated from their series, which avoids both the cancellation in
+// 1 - cos(sqrt(z)) and the transcendental functions
+constexpr auto kSeriesThreshold = 1e-2;
+
+// Newton steps allowed when there's no previous step to warm-start from
+constexpr auto kColdNewtonSteps = 8;
+
+// bodies per task when the advance is split across a thread pool
+constexpr std::size_t kGrainSize = 4096;
+
+struct Stumpff
+{
+    double C;
+    double S;
+};
+
+Stumpff stumpff(double z)
+{
+    if (std::abs(z) < kSeriesThreshold)
+    {
+        return {1.0 / 2.0 - z * (1.0 / 24.0 - z * (1.0 / 720.0 - z * (1.0 / 40320.0 - z / 3628800.0))),
+                1.0 / 6.0 - z * (1.0 / 120.0 - z * (1.0 / 5040.0 - z * (1.0 / 362880.0 - z / 39916800.0)))};
+    }
+    if (z > 0.0)
+    {
+        const auto s = std::sqrt(z);
+        return {(1.0 - std::cos(s)) / z, (s - std::sin(s)) / (s * z)};
+    }
+    const auto s = std::sqrt(-z);
+    return {(std::cosh(s) - 1.0) / -z, (std::sinh(s) - s) / (s * -z)};
+}
+
+} // namespace
+
+OrbitPropagator::OrbitPropagator() = default;
+
+OrbitPropagator::OrbitPropagator(const Settings &settings)
+    : m_settings(settings)
+{
+}
+
+std::size_t OrbitPropagator::add(const Orbit &orbit)
+{
+    const auto body = m_exact.add(orbit);
+    m_states.push_back({});
+    m_orbitPlanes.push_back(m_exact.orbitPlane(body));
+    return body;
+}
+
+void OrbitPropagator::clear()
+{
+    m_exact.clear();
+    m_states.clear();
+    m_orbitPlanes.clear();
+}
+
+void OrbitPropagator::advance(JulianDate date, const Ephemeris::Output &output, ThreadPool *threadPool)
+{
+    assert(output.positions.empty() || output.positions.size() >= size());
+    assert(output.velocities.empty() || output.velocities.size() >= size());
+    assert(output.positionsOnOrbitPlane.empty() || output.positionsOnOrbitPlane.size() >= size());
+
+    // bodies are independent, so the result doesn't depend on how they're split
+    if (threadPool && size() > kGrainSize)
+    {
+        std::atomic<std::size_t> resyncCount{0};
+        threadPool->parallelFor(size(), kGrainSize, [&](std::size_t begin, std::size_t end) {
+            resyncCount.fetch_add(advanceRange(date, begin, end, output), std::memory_order_relaxed);
+        });
+        m_resyncCount += resyncCount.load(std::memory_order_relaxed);
+    }
+    else
+    {
+        m_resyncCount += advanceRange(date, 0, size(), output);
+    }
+}
+
+std::size_t OrbitPropagator::advanceRange(JulianDate date, std::size_t begin, std::size_t end,
+                                          const Ephemeris::Output &output)
+{
+    std::size_t resyncCount = 0;
+    for (std::size_t body = begin; body < end; ++body)
+    {
+        auto &state = m_states[body];
+        if (!state.valid || state.stepsSinceResync >= m_settings.resyncInterval)
+        {
+            resync(body, date);
+            ++resyncCount;
+        }
+        else if (date != state.date)
+        {
+            if (step(state, (date - state.date).count()))
+            {
+                state.date = date;
+                ++state.stepsSinceResync;
+            }
+            else
+            {
+                resync(body, date);
+                ++resyncCount;
+            }
+        }
+
+        const auto &[periapsis, minorAxis] = m_orbitPlanes[body];
+        if (!output.positionsOnOrbitPlane.empty())
+            output.positionsOnOrbitPlane[body] = state.position;
+        if (!output.positions.empty())
+            output.positions[body] = state.position.x * periapsis + state.position.y * minorAxis;
+        if (!output.velocities.empty())
+            output.velocities[body] = state.velocity.x * periapsis + state.velocity.y * minorAxis;
+    }
+    return resyncCount;
+}
+
+// Advances `state` by dt days, returns false if Newton didn't converge.
+bool OrbitPropagator::step(State &state, double dt) const
+{
+    const auto sqrtMu = std::sqrt(kGMSun);
+    const auto r0 = state.position;
+    const auto v0 = state.velocity;
+    const auto r0Length = glm::length(r0);
+    const auto sigma0 = glm::dot(r0, v0) / sqrtMu;
+    const auto alpha = 2.0 / r0Length - glm::dot(v0, v0) / kGMSun; // 1 / a
+
+    // warm start from the ratio chi / dt of the previous step, which barely changes from a frame to the next
+    const auto warm = state.step != 0.0;
+    auto chi = warm ? state.chi * dt / state.step : sqrtMu * dt / r0Length;
+    const auto maxSteps = warm ? m_settings.newtonSteps : kColdNewtonSteps;
+    auto converged = false;
+    for (int i = 0; i < maxSteps && !converged; ++i)
+    {
+        const auto z = alpha * chi * chi;
+        const auto [C, S] = stumpff(z);
+        const auto F = sigma0 * chi * chi * C + (1.0 - alpha * r0Length) * chi * chi * chi * S + r0Length * chi -
+                       sqrtMu * dt;
+        const auto dF = sigma0 * chi * (1.0 - z * S) + (1.0 - alpha * r0Length) * chi * chi * C + r0Length;
+        const auto dChi = F / dF;
+        chi -= dChi;
+        // the error left after a Newton step is of the order of the square of its correction
+        converged = dChi * dChi <= m_settings.tolerance * chi * chi;
+    }
+    if (!converged || !std::isfinite(chi))
+        return false;
+
+    // Lagrange coefficients
+    const auto z = alpha * chi * chi;
+    const auto [C, S] = stumpff(z);
+    const auto f = 1.0 - chi * chi * C / r0Length;
+    const auto g = dt - chi * chi * chi * S / sqrtMu;
+    const auto r = f * r0 + g * v0;
+    const auto rLength = glm::length(r);
+    const auto df = sqrtMu / (rLength * r0Length) * chi * (z * S - 1.0);
+    const auto dg = 1.0 - chi * chi * C / rLength;
+
+    state.position = r;
+    state.velocity = df * r0 + dg * v0;
+    state.step = dt;
+    state.chi = chi;
+    return true;
+}
+
+void OrbitPropagator::resync(std::size_t body, JulianDate date)
+{
+    glm::dvec3 position, velocity;
+    m_exact.compute(body, std::span{&date, 1},
+                    {.positions = std::span{&position, 1}, .velocities = std::span{&velocity, 1}});
+
+    // the previous step, if any, still makes a good warm start for the next one
+    const auto &[periapsis, minorAxis] = m_orbitPlanes[body];
+    auto &state = m_states[body];
+    state.position = {glm::dot(position, periapsis), glm::dot(position, minorAxis)};
+    state.velocity = {glm::dot(velocity, periapsis), glm::dot(velocity, minorAxis)};
+    state.date = date;
+    state.stepsSinceResync = 0;
+    state.valid = true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "ephemeris.h"
+
+#include <vector>
+
+class ThreadPool;
+
+// Incremental alternative to Ephemeris for bodies that move forward by small steps, like at every frame. Each body
+// keeps its last state vector on its orbit plane and advances it with the Lagrange f and g coefficients of the
+// universal-variable formulation, which covers elliptic and hyperbolic orbits alike. Kepler's equation in the
+// universal anomaly chi is solved with a couple of Newton steps warm-started from the chi of the previous step; for
+// the small steps of a frame the Stumpff functions reduce to their series, so an advance costs no transcendental
+// function at all. Bodies go back to the closed form of the Ephemeris after a number of steps, so that rounding errors
+// can't accumulate, and whenever a step is too large for Newton to converge from the warm start.
+class OrbitPropagator
+{
+public:
+    struct Settings
+    {
+        std::size_t resyncInterval{256}; // steps between closed-form states
+        int newtonSteps{2};
+        double tolerance{1e-12}; // relative, on chi
+    };
+
+    OrbitPropagator();
+    explicit OrbitPropagator(const Settings &settings);
+
+    // Returns the index of the body. Its first advance is always a closed-form one.
+    std::size_t add(const Orbit &orbit);
+    void clear();
+
+    std::size_t size() const { return m_states.size(); }
+
+    // Advances every body to `date`, same output as Ephemeris::compute.
+    void advance(JulianDate date, const Ephemeris::Output &output, ThreadPool *threadPool = nullptr);
+
+    // Number of closed-form states computed so far, scheduled or not.
+    std::size_t resyncCount() const { return m_resyncCount; }
+
+private:
+    struct State
+    {
+        glm::dvec2 position; // AU, on the orbit plane
+        glm::dvec2 velocity; // AU/day, on the orbit plane
+        JulianDate date;
+        double step{0.0}; // days, of the last advance
+        double chi{0.0};  // universal anomaly of the last advance
+        std::size_t stepsSinceResync{0};
+        bool valid{false};
+    };
+
+    std::size_t advanceRange(JulianDate date, std::size_t begin, std::size_t end,
+                             const Ephemeris::Output &output); // returns the number of resyncs
+    bool step(State &state, double dt) const;
+    void resync(std::size_t body, JulianDate date);
+
+    Settings m_settings;
+    Ephemeris m_exact;
+    std::vector<State> m_states;
+    std::vector<Ephemeris::OrbitPlane> m_orbitPlanes;
+    std::size_t m_resyncCount{0};
+};
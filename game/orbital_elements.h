@@ -16,6 +16,8 @@ struct OrbitalElements
     double longitudePerihelion = 0.0;    // radians
     double longitudeAscendingNode = 0.0; // radians
     double meanAnomalyAtEpoch = 0.0;     // radians
+
+    bool operator==(const OrbitalElements &other) const = default;
 };
 // longitudePerihelion = longitudeAscendingNode + argumentPerihelion
 
@@ -45,7 +45,13 @@ void ShipInfoGizmo::setShip(Ship *ship)
     m_ship = ship;
 
     if (m_ship)
-        m_stateChangedConnection = m_ship->stateChangedSignal.connect([this](Ship::State) { updateText(); });
+    {
+        m_stateChangedConnection =
+            m_ship->universe()->shipStateChangedSignal.connect([this](Ship *ship, Ship::State) {
+                if (ship == m_ship)
+                    updateText();
+            });
+    }
 
     updateText();
 }
@@ -0,0 +1,222 @@
+#include "lambert.h"
+#include "universe.h"
+
+#include <base/arg_parser.h>
+#include <base/asset_path.h>
+#include <base/thread_pool.h>
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <print>
+
+// Headless simulation: a fleet of ships going from world to world as fast as the universe can be updated, to measure
+// the throughput of the simulation without a window.
+
+namespace
+{
+
+constexpr auto kDwellTime = JulianDays{20.0}; // at each world before the next departure
+
+// Plans the next leg of the docked ships: to another world, on a Lambert transfer with the transit time of a Hohmann
+// transfer between their orbits.
+class Dispatcher
+{
+public:
+    explicit Dispatcher(Universe *universe)
+        : m_universe(universe)
+    {
+        m_universe->shipStateChangedSignal.connect([this](Ship *ship, Ship::State state) {
+            if (state == Ship::State::Docked)
+                m_idleShips.push_back(ship->handle());
+        });
+    }
+
+    void addIdleShip(ShipHandle handle) { m_idleShips.push_back(handle); }
+
+    void dispatch()
+    {
+        const auto worlds = m_universe->worlds();
+        if (m_idleShips.empty() || worlds.size() < 2)
+            return; // nowhere else to go
+
+        const auto date = m_universe->date();
+        m_legs.clear();
+        m_problems.clear();
+        for (const auto handle : m_idleShips)
+        {
+            const auto *ship = m_universe->ship(handle);
+            if (!ship || ship->state() != Ship::State::Docked)
+                continue;
+            const auto *origin = ship->world();
+            const auto originIndex = std::ranges::find(worlds, origin) - worlds.begin();
+            const auto hop = 1 + handle.slot % (worlds.size() - 1);
+            const auto *destination = worlds[(originIndex + hop) % worlds.size()];
+
+            // spread the departures a little, so that the ships of a world don't all leave on the same day
+            const auto departureDate = date + kDwellTime + JulianDays{static_cast<double>(handle.slot % 16)};
+            const auto arrivalDate = departureDate + hohmannTransitTime(origin, destination);
+            m_legs.push_back({handle, origin, destination, departureDate, arrivalDate});
+            m_problems.push_back({.r1 = origin->orbit().position(departureDate),
+                                  .r2 = destination->orbit().position(arrivalDate),
+                                  .dt = (arrivalDate - departureDate).count()});
+        }
+        m_idleShips.clear();
+
+        m_solutions.resize(m_problems.size());
+        lambert_battin_batch<double>(kGMSun, m_problems, m_solutions);
+        for (std::size_t i = 0; i < m_legs.size(); ++i)
+        {
+            const auto &leg = m_legs[i];
+            const auto &solution = m_solutions[i];
+            if (!solution.has_value())
+            {
+                // tried again at the next step
+                ++m_failedCount;
+                m_idleShips.push_back(leg.ship);
+                continue;
+            }
+            const auto originVelocity = leg.origin->orbit().stateVector(leg.departureDate).velocity;
+            const auto destinationVelocity = leg.destination->orbit().stateVector(leg.arrivalDate).velocity;
+            const auto elements = orbitalElementsFromStateVector(m_problems[i].r1, solution->initialVelocity,
+                                                                 leg.departureDate);
+            m_universe->ship(leg.ship)->setMissionPlan(
+                MissionPlan{.origin = leg.origin,
+                            .destination = leg.destination,
+                            .departureDate = leg.departureDate,
+                            .arrivalDate = leg.arrivalDate,
+                            .orbit = Orbit(elements),
+                            .deltaVDeparture = glm::length(solution->initialVelocity - originVelocity),
+                            .deltaVArrival = glm::length(destinationVelocity - solution->finalVelocity)});
+            ++m_plannedCount;
+        }
+    }
+
+    std::size_t plannedCount() const { return m_plannedCount; }
+    std::size_t failedCount() const { return m_failedCount; }
+
+private:
+    struct Leg
+    {
+        ShipHandle ship;
+        const World *origin;
+        const World *destination;
+        JulianDate departureDate;
+        JulianDate arrivalDate;
+    };
+
+    static JulianDays hohmannTransitTime(const World *origin, const World *destination)
+    {
+        const auto a = 0.5 * (origin->orbit().elements().semiMajorAxis +
+                              destination->orbit().elements().semiMajorAxis);
+        return JulianDays{glm::pi<double>() * std::sqrt(a * a * a / kGMSun)};
+    }
+
+    Universe *m_universe;
+    std::vector<ShipHandle> m_idleShips;
+    std::vector<Leg> m_legs;
+    std::vector<LambertProblem> m_problems;
+    std::vector<std::optional<TransferVelocities>> m_solutions;
+    std::size_t m_plannedCount{0};
+    std::size_t m_failedCount{0};
+};
+
+std::size_t peakResidentSetSize() // bytes
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    std::string universePath = dataFilePath("universe.json");
+    std::size_t shipCount = 10'000;
+    double span = 3650.0; // days
+    double step = 1.0;    // days
+    std::size_t threads = std::thread::hardware_concurrency();
+    std::string propagation = "closed-form";
+    std::uint32_t seed = 1; // of the cargo and the economy, fixed so that runs can be compared
+
+    ArgParser parser;
+    parser.addOption(universePath, 'u', "universe");
+    parser.addOption(shipCount, 's', "ships");
+    parser.addOption(span, 'd', "span");
+    parser.addOption(step, 't', "step");
+    parser.addOption(threads, 'j', "threads");
+    parser.addOption(propagation, 'p', "propagation");
+    parser.addOption(seed, 'r', "seed");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    if (step <= 0.0 || threads == 0 || (propagation != "closed-form" && propagation != "incremental"))
+    {
+        std::println(stderr, "Usage: {} [-u universe.json] [-s ships] [-d span in days] [-t step in days] [-j threads] "
+                             "[-p closed-form|incremental] [-r seed]",
+                     argv[0]);
+        return 1;
+    }
+
+    ThreadPool threadPool(threads - 1);
+    Universe universe;
+    universe.setRandomSeed(seed);
+    if (!universe.load(universePath))
+    {
+        std::println(stderr, "Failed to load {}", universePath);
+        return 1;
+    }
+    const auto start = toJulianDate(std::chrono::year_month_day{std::chrono::year{2026}, std::chrono::January,
+                                                                std::chrono::day{1}});
+    universe.setDate(start);
+    universe.setPropagation(propagation == "incremental" ? Universe::Propagation::Incremental
+                                                         : Universe::Propagation::ClosedForm);
+    universe.setThreadPool(&threadPool);
+    universe.update(JulianDays{0.0});
+
+    Dispatcher dispatcher(&universe);
+    const auto worlds = universe.worlds();
+    const auto shipClasses = universe.shipClasses();
+    for (std::size_t i = 0; i < shipCount; ++i)
+    {
+        const auto *ship = universe.addShip(shipClasses[i % shipClasses.size()], worlds[i % worlds.size()],
+                                            std::format("Ship {}", i));
+        dispatcher.addIdleShip(ship->handle());
+    }
+
+    const auto stepCount = static_cast<std::size_t>(span / step);
+    std::uint64_t bodyCount = 0;
+    std::chrono::duration<double> updateTime{0.0};
+    std::chrono::duration<double> dispatchTime{0.0};
+    const auto solvesBefore = keplerSolveCount();
+    for (std::size_t i = 0; i < stepCount; ++i)
+    {
+        const auto dispatchStart = std::chrono::steady_clock::now();
+        dispatcher.dispatch();
+        const auto updateStart = std::chrono::steady_clock::now();
+        universe.update(JulianDays{step});
+        const auto updateEnd = std::chrono::steady_clock::now();
+        dispatchTime += updateStart - dispatchStart;
+        updateTime += updateEnd - updateStart;
+        bodyCount += universe.updatedBodyCount();
+    }
+    const auto solves = keplerSolveCount() - solvesBefore;
+
+    const auto seconds = (updateTime + dispatchTime).count();
+    const auto days = static_cast<double>(stepCount) * step;
+    std::println("{} ships, {} steps of {} days, {}, {} threads", shipCount, stepCount, step, propagation, threads);
+    std::println("simulated days/s: {:.1f} ({:.3f} s, {:.1f}% in Universe::update)", days / seconds, seconds,
+                 100.0 * updateTime.count() / seconds);
+    // bodies positioned by the updates, whether from a Chebyshev fit, a solve of Kepler's equation or a step of the
+    // incremental propagation; the solves of the orbits queried directly are counted on this thread
+    std::println("bodies positioned/s: {:.3g} ({} bodies, {} other Kepler solves)",
+                 static_cast<double>(bodyCount) / seconds, bodyCount, solves);
+    const auto &economy = universe.marketEconomy();
+    // the market node runs alongside the others, on its own it would tick at the second rate
+    const auto ticks = static_cast<double>(economy.tickCount());
+    std::println("market ticks/s: {:.1f}, {:.1f} in the market node ({} ticks of {} worlds x {} items)",
+                 ticks / seconds, ticks / universe.marketUpdateTime().count(), economy.tickCount(),
+                 economy.worldCount(), economy.itemCount());
+    std::println("missions planned: {} ({} Lambert failures)", dispatcher.plannedCount(), dispatcher.failedCount());
+    std::println("peak RSS: {:.1f} MiB", static_cast<double>(peakResidentSetSize()) / (1024.0 * 1024.0));
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+// Thin layer over std::experimental::simd, so that numeric kernels can be written once and instantiated either for
+// native SIMD packs or for plain scalars. The width of the native packs follows the target instruction set, see
+// SUNDOG_SIMD in game/CMakeLists.txt.
+
+#if __has_include(<experimental/simd>) && !defined(SUNDOG_NO_SIMD)
+#include <experimental/simd>
+#define SUNDOG_HAVE_SIMD
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+namespace simd
+{
+
+#if defined(SUNDOG_HAVE_SIMD)
+template<typename T>
+using Pack = std::experimental::native_simd<T>;
+#else
+template<typename T>
+using Pack = T;
+#endif
+
+template<typename P>
+struct PackTraits
+{
+    using ValueType = P;
+    static constexpr std::size_t kWidth = 1;
+};
+
+#if defined(SUNDOG_HAVE_SIMD)
+template<typename T, typename Abi>
+struct PackTraits<std::experimental::simd<T, Abi>>
+{
+    using ValueType = T;
+    static constexpr std::size_t kWidth = std::experimental::simd<T, Abi>::size();
+};
+#endif
+
+template<typename P>
+using ValueType = typename PackTraits<P>::ValueType;
+
+template<typename P>
+inline constexpr std::size_t kWidth = PackTraits<P>::kWidth;
+
+// Builds a pack from `generator(lane)`.
+template<typename P, typename Generator>
+P generate(Generator &&generator)
+{
+    if constexpr (std::is_arithmetic_v<P>)
+        return generator(std::size_t{0});
+    else
+        return P([&generator](auto lane) { return generator(static_cast<std::size_t>(lane)); });
+}
+
+// Reads kWidth<P> consecutive values.
+template<typename P>
+P load(const ValueType<P> *data)
+{
+    if constexpr (std::is_arithmetic_v<P>)
+        return *data;
+#if defined(SUNDOG_HAVE_SIMD)
+    else
+        return P(data, std::experimental::element_aligned);
+#endif
+}
+
+// Writes kWidth<P> consecutive values.
+template<typename P>
+void store(const P &pack, ValueType<P> *data)
+{
+    if constexpr (std::is_arithmetic_v<P>)
+        *data = pack;
+#if defined(SUNDOG_HAVE_SIMD)
+    else
+        pack.copy_to(data, std::experimental::element_aligned);
+#endif
+}
+
+template<typename T>
+    requires std::is_arithmetic_v<T>
+T lane(T value, std::size_t)
+{
+    return value;
+}
+
+template<typename T>
+    requires std::is_arithmetic_v<T>
+T select(bool mask, T a, T b)
+{
+    return mask ? a : b;
+}
+
+inline bool anyOf(bool mask)
+{
+    return mask;
+}
+
+template<typename T>
+    requires std::is_arithmetic_v<T>
+T min(T a, T b)
+{
+    return a < b ? a : b;
+}
+
+template<typename T>
+    requires std::is_arithmetic_v<T>
+T max(T a, T b)
+{
+    return a < b ? b : a;
+}
+
+template<typename T>
+    requires std::is_arithmetic_v<T>
+T sqrt(T value)
+{
+    return std::sqrt(value);
+}
+
+template<typename T>
+    requires std::is_arithmetic_v<T>
+T abs(T value)
+{
+    return std::abs(value);
+}
+
+template<typename T>
+    requires std::is_arithmetic_v<T>
+T floor(T value)
+{
+    return std::floor(value);
+}
+
+template<typename T>
+    requires std::is_arithmetic_v<T>
+T cbrt(T value)
+{
+    return std::cbrt(value);
+}
+
+template<typename T>
+    requires std::is_arithmetic_v<T>
+T sin(T value)
+{
+    return std::sin(value);
+}
+
+template<typename T>
+    requires std::is_arithmetic_v<T>
+T cos(T value)
+{
+    return std::cos(value);
+}
+
+#if defined(SUNDOG_HAVE_SIMD)
+template<typename T, typename Abi>
+T lane(const std::experimental::simd<T, Abi> &pack, std::size_t index)
+{
+    return pack[index];
+}
+
+template<typename T, typename Abi>
+std::experimental::simd<T, Abi> select(const std::experimental::simd_mask<T, Abi> &mask,
+                                       const std::experimental::simd<T, Abi> &a,
+                                       const std::experimental::simd<T, Abi> &b)
+{
+    auto result = b;
+    where(mask, result) = a;
+    return result;
+}
+
+template<typename T, typename Abi>
+bool anyOf(const std::experimental::simd_mask<T, Abi> &mask)
+{
+    return std::experimental::any_of(mask);
+}
+
+template<typename T, typename Abi>
+std::experimental::simd<T, Abi> min(const std::experimental::simd<T, Abi> &a, const std::experimental::simd<T, Abi> &b)
+{
+    return std::experimental::min(a, b);
+}
+
+template<typename T, typename Abi>
+std::experimental::simd<T, Abi> max(const std::experimental::simd<T, Abi> &a, const std::experimental::simd<T, Abi> &b)
+{
+    return std::experimental::max(a, b);
+}
+
+template<typename T, typename Abi>
+std::experimental::simd<T, Abi> sqrt(const std::experimental::simd<T, Abi> &pack)
+{
+    return std::experimental::sqrt(pack);
+}
+
+template<typename T, typename Abi>
+std::experimental::simd<T, Abi> abs(const std::experimental::simd<T, Abi> &pack)
+{
+    return std::experimental::abs(pack);
+}
+
+template<typename T, typename Abi>
+std::experimental::simd<T, Abi> floor(const std::experimental::simd<T, Abi> &pack)
+{
+    return std::experimental::floor(pack);
+}
+
+template<typename T, typename Abi>
+std::experimental::simd<T, Abi> cbrt(const std::experimental::simd<T, Abi> &pack)
+{
+    return std::experimental::cbrt(pack);
+}
+
+template<typename T, typename Abi>
+std::experimental::simd<T, Abi> sin(const std::experimental::simd<T, Abi> &pack)
+{
+    return std::experimental::sin(pack);
+}
+
+template<typename T, typename Abi>
+std::experimental::simd<T, Abi> cos(const std::experimental::simd<T, Abi> &pack)
+{
+    return std::experimental::cos(pack);
+}
+#endif
+
+} // namespace simd
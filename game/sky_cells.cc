@@ -0,0 +1,180 @@
+#include "sky_cells.h"
+
+#include "starfield.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// References:
+// Górski et al., HEALPix: A Framework for High-Resolution Discretization and Fast Analysis of Data Distributed on the
+// Sphere, 2005
+// Cigolle et al., A Survey of Efficient Representations for Independent Unit Vectors, 2014
+
+namespace
+{
+
+glm::vec3 starDirection(float rightAscension, float declination)
+{
+    const auto x = std::cos(rightAscension) * std::cos(declination);
+    const auto y = std::sin(rightAscension) * std::cos(declination);
+    const auto z = std::sin(declination);
+    return {x, y, z};
+}
+
+float signNotZero(float value)
+{
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+std::int16_t toSnorm16(float value)
+{
+    return static_cast<std::int16_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+} // namespace
+
+SkyCells::SkyCells() = default;
+
+SkyCells::SkyCells(const Starfield &starfield)
+    : SkyCells(starfield, Settings{})
+{
+}
+
+SkyCells::SkyCells(const Starfield &starfield, const Settings &settings)
+    : m_settings(settings)
+{
+    const auto starCount = starfield.size();
+    std::vector<glm::vec3> directions(starCount);
+    std::vector<std::uint32_t> cellIndices(starCount);
+    for (std::size_t i = 0; i < starCount; ++i)
+    {
+        directions[i] = starDirection(starfield.rightAscensions()[i], starfield.declinations()[i]);
+        cellIndices[i] = cellIndex(m_settings.resolution, directions[i]);
+    }
+
+    m_stars.resize(starCount);
+    std::iota(m_stars.begin(), m_stars.end(), 0);
+    std::ranges::sort(m_stars, [&](std::uint32_t lhs, std::uint32_t rhs) {
+        if (cellIndices[lhs] != cellIndices[rhs])
+            return cellIndices[lhs] < cellIndices[rhs];
+        return starfield.apparentMagnitudes()[lhs] < starfield.apparentMagnitudes()[rhs];
+    });
+
+    m_instances.reserve(starCount);
+    m_magnitudes.reserve(starCount);
+    for (std::size_t begin = 0; begin < starCount;)
+    {
+        const auto cell = cellIndices[m_stars[begin]];
+        auto end = begin;
+        glm::vec3 sum{0.0f};
+        for (; end < starCount && cellIndices[m_stars[end]] == cell; ++end)
+            sum += directions[m_stars[end]];
+        const auto center = glm::length(sum) > 0.0f ? glm::normalize(sum) : directions[m_stars[begin]];
+        auto minCos = 1.0f;
+        for (auto i = begin; i < end; ++i)
+        {
+            const auto star = m_stars[i];
+            minCos = std::min(minCos, glm::dot(center, directions[star]));
+            const auto magnitude = starfield.apparentMagnitudes()[star];
+            const auto spectralClass = static_cast<std::uint8_t>(starfield.spectralClasses()[star]);
+            m_instances.push_back(packInstance(directions[star], magnitude, spectralClass));
+            m_magnitudes.push_back(magnitude);
+        }
+        // past 90 degrees the cone is bounded by a hemisphere
+        const auto sinRadius = minCos > 0.0f ? std::sqrt(1.0f - minCos * minCos) : 1.0f;
+        m_cells.push_back({.center = center,
+                           .sinRadius = sinRadius,
+                           .begin = static_cast<std::uint32_t>(begin),
+                           .count = static_cast<std::uint32_t>(end - begin)});
+        begin = end;
+    }
+}
+
+float SkyCells::magnitudeLimit(float fieldOfView) const
+{
+    const auto zoom = std::log2(m_settings.referenceFieldOfView / fieldOfView);
+    return m_settings.magnitudeLimit + m_settings.magnitudesPerZoom * zoom;
+}
+
+void SkyCells::select(const glm::mat4 &viewProjection, float magnitudeLimit, std::vector<InstanceRange> &ranges) const
+{
+    // Directions are points at infinity, so only the side planes of the frustum matter, and they go through the
+    // camera: a cell is out if its cone is entirely behind one of them.
+    const auto rows = glm::transpose(viewProjection);
+    std::array<glm::vec3, 4> normals = {glm::vec3{rows[3] + rows[0]}, glm::vec3{rows[3] - rows[0]},
+                                        glm::vec3{rows[3] + rows[1]}, glm::vec3{rows[3] - rows[1]}};
+    for (auto &normal : normals)
+        normal = glm::normalize(normal);
+
+    ranges.clear();
+    for (const auto &cell : m_cells)
+    {
+        const auto outside = std::ranges::any_of(
+            normals, [&cell](const glm::vec3 &normal) { return glm::dot(normal, cell.center) < -cell.sinRadius; });
+        if (outside)
+            continue;
+        const auto magnitudes = std::span{m_magnitudes}.subspan(cell.begin, cell.count);
+        const auto count = static_cast<std::uint32_t>(std::ranges::upper_bound(magnitudes, magnitudeLimit) -
+                                                      magnitudes.begin());
+        if (count == 0)
+            continue;
+        if (!ranges.empty() && ranges.back().begin + ranges.back().count == cell.begin)
+            ranges.back().count += count;
+        else
+            ranges.push_back({cell.begin, count});
+    }
+}
+
+std::uint32_t SkyCells::cellIndex(int resolution, const glm::vec3 &direction)
+{
+    const auto nside = static_cast<std::int64_t>(resolution);
+    const auto z = static_cast<double>(std::clamp(direction.z, -1.0f, 1.0f));
+    const auto za = std::abs(z);
+    auto phi = std::atan2(static_cast<double>(direction.y), static_cast<double>(direction.x));
+    if (phi < 0.0)
+        phi += 2.0 * glm::pi<double>();
+    const auto tt = std::min(phi / glm::half_pi<double>(), std::nextafter(4.0, 0.0)); // in [0, 4)
+
+    if (za <= 2.0 / 3.0)
+    {
+        // equatorial belt: rings 1 to 2 Nside + 1 counted from the north cap, 4 Nside cells each
+        const auto temp1 = static_cast<double>(nside) * (0.5 + tt);
+        const auto temp2 = static_cast<double>(nside) * z * 0.75;
+        const auto jp = static_cast<std::int64_t>(temp1 - temp2); // index of the ascending edge line
+        const auto jm = static_cast<std::int64_t>(temp1 + temp2); // index of the descending edge line
+        const auto ir = nside + 1 + jp - jm;
+        const auto kshift = 1 - (ir & 1);
+        const auto ip = ((jp + jm - nside + kshift + 1) / 2) % (4 * nside);
+        const auto ncap = 2 * nside * (nside - 1);
+        return static_cast<std::uint32_t>(ncap + (ir - 1) * 4 * nside + ip);
+    }
+
+    // polar caps: ring ir from the nearest pole has 4 ir cells
+    const auto tp = tt - std::floor(tt);
+    const auto tmp = static_cast<double>(nside) * std::sqrt(3.0 * (1.0 - za));
+    const auto jp = static_cast<std::int64_t>(tp * tmp);
+    const auto jm = static_cast<std::int64_t>((1.0 - tp) * tmp);
+    const auto ir = jp + jm + 1;
+    const auto ip = static_cast<std::int64_t>(tt * static_cast<double>(ir)) % (4 * ir);
+    if (z > 0.0)
+        return static_cast<std::uint32_t>(2 * ir * (ir - 1) + ip);
+    return static_cast<std::uint32_t>(cellCount(resolution) - 2 * ir * (ir + 1) + ip);
+}
+
+StarInstance SkyCells::packInstance(const glm::vec3 &direction, float magnitude, std::uint8_t spectralClass)
+{
+    // octahedral: project on the octahedron, fold the lower half over the upper one
+    auto p = glm::vec2{direction} / (std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z));
+    if (direction.z < 0.0f)
+        p = (1.0f - glm::abs(glm::vec2{p.y, p.x})) * glm::vec2{signNotZero(p.x), signNotZero(p.y)};
+    const auto normalizedMagnitude = (std::clamp(magnitude, StarInstance::kMinMagnitude, StarInstance::kMaxMagnitude) -
+                                      StarInstance::kMinMagnitude) /
+                                     (StarInstance::kMaxMagnitude - StarInstance::kMinMagnitude);
+    return {.direction = {toSnorm16(p.x), toSnorm16(p.y)},
+            .magnitude = static_cast<std::uint16_t>(std::round(normalizedMagnitude * 65535.0f)),
+            .spectralClass = spectralClass,
+            .padding = 0};
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class Starfield;
+
+// One star as drawn by the starfield renderer: 8 bytes, decoded by the vertex shader.
+struct StarInstance
+{
+    std::array<std::int16_t, 2> direction; // octahedral encoding of the unit vector, normalized
+    std::uint16_t magnitude;               // apparent magnitude in [kMinMagnitude, kMaxMagnitude], normalized
+    std::uint8_t spectralClass;
+    std::uint8_t padding;
+
+    static constexpr auto kMinMagnitude = -2.0f;
+    static constexpr auto kMaxMagnitude = 20.0f;
+};
+
+// Instances to draw, [begin, begin + count).
+struct InstanceRange
+{
+    std::uint32_t begin;
+    std::uint32_t count;
+
+    bool operator==(const InstanceRange &other) const = default;
+};
+
+// Stars bucketed into the equal-area cells of a HEALPix tessellation of the sky, in ring order, and sorted by
+// magnitude within each cell, brightest first. A frame draws the first stars of the cells that intersect the view
+// frustum, down to a magnitude limit that goes up as the field of view narrows. No GL involved, the renderer uploads
+// instances() once and draws the ranges of select().
+class SkyCells
+{
+public:
+    struct Settings
+    {
+        int resolution{8};                               // HEALPix Nside, 12 * Nside^2 cells
+        float magnitudeLimit{6.5f};                      // at the reference field of view
+        float referenceFieldOfView{glm::radians(45.0f)}; // vertical
+        float magnitudesPerZoom{1.5f};                   // fainter each time the field of view is halved
+    };
+
+    struct Cell
+    {
+        glm::vec3 center;    // unit vector
+        float sinRadius;     // of the angle from the center to the farthest star of the cell
+        std::uint32_t begin; // first instance of the cell
+        std::uint32_t count;
+    };
+
+    SkyCells();
+    explicit SkyCells(const Starfield &starfield);
+    explicit SkyCells(const Starfield &starfield, const Settings &settings);
+
+    const Settings &settings() const { return m_settings; }
+
+    // Non-empty cells only.
+    std::span<const Cell> cells() const { return m_cells; }
+    std::span<const StarInstance> instances() const { return m_instances; }
+    std::span<const std::uint32_t> stars() const { return m_stars; } // index in the starfield of each instance
+
+    float magnitudeLimit(float fieldOfView) const; // vertical, radians
+
+    // Instances of the cells in the frustum of `viewProjection`, the transform of the directions of the stars, down to
+    // `magnitudeLimit`. The ranges of consecutive cells are merged.
+    void select(const glm::mat4 &viewProjection, float magnitudeLimit, std::vector<InstanceRange> &ranges) const;
+
+    // HEALPix cell of a unit vector, in ring order.
+    static std::uint32_t cellIndex(int resolution, const glm::vec3 &direction);
+    static std::uint32_t cellCount(int resolution) { return 12 * resolution * resolution; }
+
+    static StarInstance packInstance(const glm::vec3 &direction, float magnitude, std::uint8_t spectralClass);
+
+private:
+    Settings m_settings;
+    std::vector<Cell> m_cells;
+    std::vector<StarInstance> m_instances;
+    std::vector<std::uint32_t> m_stars;
+    std::vector<float> m_magnitudes; // of the instances
+};
@@ -1,54 +1,652 @@
 #include "starfield.h"
 
-#include <base/file.h>
+#include "compiled_assets.h"
 
-#include <base/asset_path.h>
+#include <base/file.h>
+#include <base/thread_pool.h>
 
 #include <glm/glm.hpp>
 
-#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <filesystem>
+#include <optional>
+
+namespace
+{
+
+// Catalogs are parsed in chunks of about this size, each starting at a star.
+constexpr std::size_t kChunkSize = 1 << 20;
 
-Star::SpectralClass toSpectralClass(std::string_view spectralClass)
+SpectralClass toSpectralClass(std::string_view spectralClass)
 {
     if (!spectralClass.empty())
     {
         switch (spectralClass[0])
         {
         case 'O':
-            return Star::SpectralClass::O;
+            return SpectralClass::O;
         case 'B':
-            return Star::SpectralClass::B;
+            return SpectralClass::B;
         case 'A':
-            return Star::SpectralClass::A;
+            return SpectralClass::A;
         case 'F':
-            return Star::SpectralClass::F;
+            return SpectralClass::F;
         case 'G':
-            return Star::SpectralClass::G;
+            return SpectralClass::G;
         case 'K':
-            return Star::SpectralClass::K;
+            return SpectralClass::K;
         case 'M':
-            return Star::SpectralClass::M;
+            return SpectralClass::M;
         }
     }
-    return Star::SpectralClass::A;
+    return SpectralClass::A;
+}
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+std::string_view trimmed(std::string_view text)
+{
+    while (!text.empty() && isSpace(text.front()))
+        text.remove_prefix(1);
+    while (!text.empty() && isSpace(text.back()))
+        text.remove_suffix(1);
+    return text;
 }
 
-void from_json(const nlohmann::json &json, Star &star)
+std::optional<float> parseFloat(std::string_view text)
 {
-    star.bayerName = json.at("bayer_name").get<std::string>();
-    star.properName = json.at("proper_name").get<std::string>();
-    star.rightAscension = glm::radians(json.at("right_ascension").get<float>());
-    star.declination = glm::radians(json.at("declination").get<float>());
-    star.spectralClass = toSpectralClass(json.at("spectral_type").get<std::string>());
-    star.apparentMagnitude = json.at("apparent_magnitude").get<float>();
+    text = trimmed(text);
+    float value = 0.0f;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size())
+        return std::nullopt;
+    return value;
 }
 
-bool Starfield::load(const std::string &path)
+// Stars of one chunk of a catalog, appended to the starfield in chunk order once every chunk is parsed.
+struct CatalogChunk
+{
+    std::vector<float> rightAscensions;
+    std::vector<float> declinations;
+    std::vector<float> apparentMagnitudes;
+    std::vector<SpectralClass> spectralClasses;
+    std::vector<std::pair<std::size_t, std::string>> properNames; // index in the chunk, of the stars that have one
+    bool valid{true};
+
+    std::size_t size() const { return rightAscensions.size(); }
+
+    void add(std::string_view properName, float rightAscension, float declination, SpectralClass spectralClass,
+             float apparentMagnitude)
+    {
+        if (!properName.empty())
+            properNames.emplace_back(size(), properName);
+        rightAscensions.push_back(rightAscension);
+        declinations.push_back(declination);
+        apparentMagnitudes.push_back(apparentMagnitude);
+        spectralClasses.push_back(spectralClass);
+    }
+};
+
+// Offsets of the chunks of the text past `begin`, plus the end of the text: every kChunkSize bytes, moved forward to
+// the start of the next star.
+template<typename IsStarStart>
+std::vector<std::size_t> chunkOffsets(std::string_view text, std::size_t begin, IsStarStart &&isStarStart)
 {
-    const auto jsonData = readFile(path);
-    if (jsonData.empty())
+    std::vector<std::size_t> offsets{begin};
+    for (auto offset = begin + kChunkSize; offset < text.size(); offset += kChunkSize)
+    {
+        while (offset < text.size() && !isStarStart(text, offset))
+            ++offset;
+        if (offset < text.size())
+            offsets.push_back(offset);
+    }
+    offsets.push_back(text.size());
+    return offsets;
+}
+
+// Parses the chunks, on the thread pool if any, then moves their stars into the starfield, which is left untouched
+// if any chunk is invalid.
+template<typename ParseChunk>
+bool parseChunks(Starfield &starfield, std::span<const std::size_t> offsets, ThreadPool *threadPool,
+                 ParseChunk &&parseChunk)
+{
+    std::vector<CatalogChunk> chunks(offsets.size() - 1);
+    const auto parseRange = [&chunks, &offsets, &parseChunk](std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i)
+            chunks[i] = parseChunk(offsets[i], offsets[i + 1]);
+    };
+    if (threadPool)
+        threadPool->parallelFor(chunks.size(), 1, parseRange);
+    else
+        parseRange(0, chunks.size());
+    if (!std::ranges::all_of(chunks, &CatalogChunk::valid))
         return false;
-    const nlohmann::json json = nlohmann::json::parse(jsonData);
-    stars = json.get<std::vector<Star>>();
+
+    std::size_t count = 0;
+    for (const auto &chunk : chunks)
+        count += chunk.size();
+    Starfield::Arrays arrays;
+    StringArena names;
+    arrays.rightAscensions.reserve(count);
+    arrays.declinations.reserve(count);
+    arrays.apparentMagnitudes.reserve(count);
+    arrays.spectralClasses.reserve(count);
+    arrays.properNames.reserve(count);
+    const auto append = [](auto &to, const auto &from) { to.insert(to.end(), from.begin(), from.end()); };
+    for (auto &chunk : chunks)
+    {
+        const auto first = arrays.rightAscensions.size();
+        append(arrays.rightAscensions, chunk.rightAscensions);
+        append(arrays.declinations, chunk.declinations);
+        append(arrays.apparentMagnitudes, chunk.apparentMagnitudes);
+        append(arrays.spectralClasses, chunk.spectralClasses);
+        arrays.properNames.resize(arrays.rightAscensions.size(), 0);
+        for (const auto &[index, name] : chunk.properNames)
+            arrays.properNames[first + index] = names.intern(name);
+        chunk = {};
+    }
+    starfield.assign(std::move(arrays), std::move(names));
     return true;
 }
+
+// Reader of the flat objects of a JSON star catalog, whose values are strings or numbers.
+class JsonReader
+{
+public:
+    JsonReader(std::string_view text, std::size_t offset)
+        : m_text(text)
+        , m_offset(offset)
+    {
+    }
+
+    std::size_t offset() const { return m_offset; }
+
+    void skipWhitespace()
+    {
+        while (m_offset < m_text.size() && isSpace(m_text[m_offset]))
+            ++m_offset;
+    }
+
+    bool peek(char c)
+    {
+        skipWhitespace();
+        return m_offset < m_text.size() && m_text[m_offset] == c;
+    }
+
+    bool consume(char c)
+    {
+        if (!peek(c))
+            return false;
+        ++m_offset;
+        return true;
+    }
+
+    // Into `string`, whose memory is reused from one string to the next.
+    bool readString(std::string &string)
+    {
+        if (!consume('"'))
+            return false;
+        string.clear();
+        while (true)
+        {
+            const auto special = m_text.find_first_of("\"\\", m_offset);
+            if (special == std::string_view::npos)
+                return false;
+            string.append(m_text.substr(m_offset, special - m_offset));
+            m_offset = special + 1;
+            if (m_text[special] == '"')
+                return true;
+            if (m_offset == m_text.size())
+                return false;
+            switch (const auto escaped = m_text[m_offset++])
+            {
+            case 'b':
+                string.push_back('\b');
+                break;
+            case 'f':
+                string.push_back('\f');
+                break;
+            case 'n':
+                string.push_back('\n');
+                break;
+            case 'r':
+                string.push_back('\r');
+                break;
+            case 't':
+                string.push_back('\t');
+                break;
+            case 'u':
+                if (!readCodePoint(string))
+                    return false;
+                break;
+            default:
+                string.push_back(escaped);
+                break;
+            }
+        }
+    }
+
+    // A number or a literal, unparsed.
+    std::optional<std::string_view> readScalar()
+    {
+        skipWhitespace();
+        const auto begin = m_offset;
+        while (m_offset < m_text.size() && m_text[m_offset] != ',' && m_text[m_offset] != '}' &&
+               m_text[m_offset] != ']' && !isSpace(m_text[m_offset]))
+            ++m_offset;
+        if (m_offset == begin)
+            return std::nullopt;
+        return m_text.substr(begin, m_offset - begin);
+    }
+
+private:
+    std::optional<char32_t> readHex()
+    {
+        std::uint32_t value = 0;
+        if (m_text.size() - m_offset < 4)
+            return std::nullopt;
+        const auto *begin = m_text.data() + m_offset;
+        const auto [end, error] = std::from_chars(begin, begin + 4, value, 16);
+        if (error != std::errc{} || end != begin + 4)
+            return std::nullopt;
+        m_offset += 4;
+        return value;
+    }
+
+    // The hex digits of a \u escape, and the low surrogate that follows a high one, appended as UTF-8.
+    bool readCodePoint(std::string &string)
+    {
+        auto codePoint = readHex();
+        if (!codePoint)
+            return false;
+        if (*codePoint >= 0xd800 && *codePoint < 0xdc00)
+        {
+            if (m_text.substr(m_offset, 2) != "\\u")
+                return false;
+            m_offset += 2;
+            const auto low = readHex();
+            if (!low || *low < 0xdc00 || *low >= 0xe000)
+                return false;
+            codePoint = 0x10000 + ((*codePoint - 0xd800) << 10) + (*low - 0xdc00);
+        }
+        const auto c = *codePoint;
+        if (c < 0x80)
+        {
+            string.push_back(static_cast<char>(c));
+        }
+        else if (c < 0x800)
+        {
+            string.push_back(static_cast<char>(0xc0 | (c >> 6)));
+            string.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+        }
+        else if (c < 0x10000)
+        {
+            string.push_back(static_cast<char>(0xe0 | (c >> 12)));
+            string.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3f)));
+            string.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+        }
+        else
+        {
+            string.push_back(static_cast<char>(0xf0 | (c >> 18)));
+            string.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3f)));
+            string.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3f)));
+            string.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+        }
+        return true;
+    }
+
+    std::string_view m_text;
+    std::size_t m_offset;
+};
+
+// A star starts with the '{' of an object right after the '[' or the ',' of the array. A string can look like one too,
+// parseJsonChunk catches chunks that were split inside a star.
+bool isJsonStarStart(std::string_view text, std::size_t offset)
+{
+    if (text[offset] != '{')
+        return false;
+    while (offset > 0 && isSpace(text[offset - 1]))
+        --offset;
+    return offset > 0 && (text[offset - 1] == ',' || text[offset - 1] == '[');
+}
+
+CatalogChunk parseJsonChunk(std::string_view text, std::size_t begin, std::size_t end)
+{
+    CatalogChunk chunk;
+    JsonReader reader(text, begin);
+    std::string key;
+    std::string value;
+    std::string properName;
+    const auto readStar = [&] {
+        if (!reader.consume('{'))
+            return false;
+        std::optional<float> rightAscension;
+        std::optional<float> declination;
+        std::optional<float> apparentMagnitude;
+        auto spectralClass = SpectralClass::A;
+        properName.clear();
+        if (!reader.consume('}'))
+        {
+            do
+            {
+                if (!reader.readString(key) || !reader.consume(':'))
+                    return false;
+                if (reader.peek('"'))
+                {
+                    if (!reader.readString(value))
+                        return false;
+                    if (key == "proper_name")
+                        std::swap(properName, value);
+                    else if (key == "spectral_type")
+                        spectralClass = toSpectralClass(value);
+                }
+                else
+                {
+                    const auto scalar = reader.readScalar();
+                    if (!scalar)
+                        return false;
+                    if (key == "right_ascension")
+                        rightAscension = parseFloat(*scalar);
+                    else if (key == "declination")
+                        declination = parseFloat(*scalar);
+                    else if (key == "apparent_magnitude")
+                        apparentMagnitude = parseFloat(*scalar);
+                }
+            } while (reader.consume(','));
+            if (!reader.consume('}'))
+                return false;
+        }
+        if (!rightAscension || !declination || !apparentMagnitude)
+            return false;
+        chunk.add(properName, glm::radians(*rightAscension), glm::radians(*declination), spectralClass,
+                  *apparentMagnitude);
+        return true;
+    };
+    while (true)
+    {
+        reader.skipWhitespace();
+        if (reader.offset() >= end)
+        {
+            // past the end if the next chunk starts inside the last star of this one
+            chunk.valid = reader.offset() == end;
+            break;
+        }
+        if (!readStar())
+        {
+            chunk.valid = false;
+            break;
+        }
+        if (!reader.consume(','))
+        {
+            // the last star
+            chunk.valid = reader.consume(']');
+            break;
+        }
+    }
+    return chunk;
+}
+
+// Columns of a CSV star catalog, from its header.
+struct CsvColumns
+{
+    std::size_t rightAscension;
+    std::size_t declination;
+    std::size_t apparentMagnitude;
+    std::optional<std::size_t> properName;
+    std::optional<std::size_t> spectralType;
+};
+
+// Fields of a line, without their quotes, into `fields`, whose memory is reused from one line to the next.
+void splitCsvLine(std::string_view line, std::vector<std::string_view> &fields)
+{
+    fields.clear();
+    std::size_t offset = 0;
+    while (true)
+    {
+        if (offset < line.size() && line[offset] == '"')
+        {
+            // up to the closing quote, skipping doubled ones
+            auto end = offset + 1;
+            while (end < line.size() && (line[end] != '"' || (end + 1 < line.size() && line[end + 1] == '"')))
+                end += line[end] == '"' ? 2 : 1;
+            fields.push_back(line.substr(offset + 1, end - offset - 1));
+            offset = line.find(',', end);
+        }
+        else
+        {
+            const auto end = line.find(',', offset);
+            fields.push_back(line.substr(offset, end - offset));
+            offset = end;
+        }
+        if (offset == std::string_view::npos)
+            break;
+        ++offset;
+    }
+}
+
+std::string_view csvLine(std::string_view text, std::size_t &offset)
+{
+    const auto end = std::min(text.find('\n', offset), text.size());
+    auto line = text.substr(offset, end - offset);
+    offset = end + 1;
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+    return line;
+}
+
+std::optional<CsvColumns> readCsvHeader(std::string_view header)
+{
+    std::vector<std::string_view> fields;
+    splitCsvLine(header, fields);
+    const auto column = [&fields](std::string_view name) -> std::optional<std::size_t> {
+        const auto it = std::ranges::find_if(fields, [name](std::string_view field) { return trimmed(field) == name; });
+        if (it == fields.end())
+            return std::nullopt;
+        return it - fields.begin();
+    };
+    const auto rightAscension = column("ra");
+    const auto declination = column("dec");
+    const auto apparentMagnitude = column("mag");
+    if (!rightAscension || !declination || !apparentMagnitude)
+        return std::nullopt;
+    return CsvColumns{.rightAscension = *rightAscension,
+                      .declination = *declination,
+                      .apparentMagnitude = *apparentMagnitude,
+                      .properName = column("proper"),
+                      .spectralType = column("spect")};
+}
+
+// A star starts with a line.
+bool isCsvStarStart(std::string_view text, std::size_t offset)
+{
+    return offset > 0 && text[offset - 1] == '\n';
+}
+
+CatalogChunk parseCsvChunk(std::string_view text, std::size_t begin, std::size_t end, const CsvColumns &columns)
+{
+    constexpr auto kDegreesPerHour = 15.0f;
+
+    const auto columnCount = std::max({columns.rightAscension, columns.declination, columns.apparentMagnitude,
+                                       columns.properName.value_or(0), columns.spectralType.value_or(0)}) +
+                             1;
+    CatalogChunk chunk;
+    std::vector<std::string_view> fields;
+    std::string properName;
+    for (auto offset = begin; offset < end;)
+    {
+        const auto line = csvLine(text, offset);
+        if (trimmed(line).empty())
+            continue;
+        splitCsvLine(line, fields);
+        if (fields.size() < columnCount)
+        {
+            chunk.valid = false;
+            break;
+        }
+        const auto rightAscension = parseFloat(fields[columns.rightAscension]);
+        const auto declination = parseFloat(fields[columns.declination]);
+        const auto apparentMagnitude = parseFloat(fields[columns.apparentMagnitude]);
+        if (!rightAscension || !declination || !apparentMagnitude)
+        {
+            chunk.valid = false;
+            break;
+        }
+        properName.clear();
+        if (columns.properName)
+        {
+            // doubled quotes of a quoted field
+            const auto field = trimmed(fields[*columns.properName]);
+            for (std::size_t i = 0; i < field.size(); ++i)
+            {
+                properName.push_back(field[i]);
+                if (field[i] == '"' && i + 1 < field.size() && field[i + 1] == '"')
+                    ++i;
+            }
+        }
+        const auto spectralClass =
+            columns.spectralType ? toSpectralClass(trimmed(fields[*columns.spectralType])) : SpectralClass::A;
+        chunk.add(properName, glm::radians(kDegreesPerHour * *rightAscension), glm::radians(*declination),
+                  spectralClass, *apparentMagnitude);
+    }
+    return chunk;
+}
+
+std::string_view fileText(const MappedFile &file)
+{
+    const auto data = file.data();
+    return {reinterpret_cast<const char *>(data.data()), data.size()};
+}
+
+} // namespace
+
+bool Starfield::load(const std::string &path, ThreadPool *threadPool)
+{
+    if (const auto compiledPath = compiledAssetPath(path); isCompiledAssetCurrent(path, compiledPath))
+    {
+        MappedFile file(compiledPath);
+        if (file.isValid() && StarfieldAsset::load(*this, std::move(file)))
+            return true;
+    }
+    if (std::filesystem::path{path}.extension() == ".csv")
+        return loadCsv(path, threadPool);
+    return loadJson(path, threadPool);
+}
+
+bool Starfield::loadJson(const std::string &path, ThreadPool *threadPool)
+{
+    const MappedFile file(path);
+    if (!file.isValid())
+        return false;
+    const auto text = fileText(file);
+    JsonReader reader(text, 0);
+    if (!reader.consume('['))
+        return false;
+    if (reader.consume(']'))
+    {
+        clear();
+        return true;
+    }
+    const auto parseChunk = [text](std::size_t begin, std::size_t end) { return parseJsonChunk(text, begin, end); };
+    const auto offsets = chunkOffsets(text, reader.offset(), isJsonStarStart);
+    if (parseChunks(*this, offsets, threadPool, parseChunk))
+        return true;
+    // in one piece, in case the chunks were split inside a string
+    const std::array wholeText{offsets.front(), offsets.back()};
+    return offsets.size() > 2 && parseChunks(*this, wholeText, nullptr, parseChunk);
+}
+
+bool Starfield::loadCsv(const std::string &path, ThreadPool *threadPool)
+{
+    const MappedFile file(path);
+    if (!file.isValid())
+        return false;
+    const auto text = fileText(file);
+    std::size_t headerEnd = 0;
+    const auto columns = readCsvHeader(csvLine(text, headerEnd));
+    if (!columns)
+        return false;
+    const auto offsets = chunkOffsets(text, std::min(headerEnd, text.size()), isCsvStarStart);
+    return parseChunks(*this, offsets, threadPool, [text, &columns](std::size_t begin, std::size_t end) {
+        return parseCsvChunk(text, begin, end, *columns);
+    });
+}
+
+void Starfield::add(std::string_view properName, float rightAscension, float declination,
+                    SpectralClass spectralClass, float apparentMagnitude)
+{
+    ownArrays();
+    m_arrays.rightAscensions.push_back(rightAscension);
+    m_arrays.declinations.push_back(declination);
+    m_arrays.apparentMagnitudes.push_back(apparentMagnitude);
+    m_arrays.spectralClasses.push_back(spectralClass);
+    m_arrays.properNames.push_back(names.intern(properName));
+    updateViews();
+}
+
+void Starfield::reserve(std::size_t count)
+{
+    ownArrays();
+    m_arrays.rightAscensions.reserve(count);
+    m_arrays.declinations.reserve(count);
+    m_arrays.apparentMagnitudes.reserve(count);
+    m_arrays.spectralClasses.reserve(count);
+    m_arrays.properNames.reserve(count);
+    updateViews();
+}
+
+void Starfield::clear()
+{
+    m_arrays = {};
+    m_assetFile = {};
+    names.clear();
+    updateViews();
+}
+
+void Starfield::assign(Arrays arrays, StringArena names)
+{
+    m_arrays = std::move(arrays);
+    m_assetFile = {};
+    this->names = std::move(names);
+    updateViews();
+}
+
+void Starfield::ownArrays()
+{
+    if (!isMapped())
+        return;
+    m_arrays.rightAscensions.assign(m_rightAscensions.begin(), m_rightAscensions.end());
+    m_arrays.declinations.assign(m_declinations.begin(), m_declinations.end());
+    m_arrays.apparentMagnitudes.assign(m_apparentMagnitudes.begin(), m_apparentMagnitudes.end());
+    m_arrays.spectralClasses.assign(m_spectralClasses.begin(), m_spectralClasses.end());
+    m_arrays.properNames.assign(m_properNames.begin(), m_properNames.end());
+    m_assetFile = {};
+}
+
+void Starfield::updateViews()
+{
+    m_rightAscensions = m_arrays.rightAscensions;
+    m_declinations = m_arrays.declinations;
+    m_apparentMagnitudes = m_arrays.apparentMagnitudes;
+    m_spectralClasses = m_arrays.spectralClasses;
+    m_properNames = m_arrays.properNames;
+}
+
+std::size_t Starfield::memoryUsage() const
+{
+    const auto arrayBytes = [](const auto &array) { return array.capacity() * sizeof(array[0]); };
+    const auto viewBytes = [](const auto &view) { return view.size_bytes(); };
+    const auto &arrays = m_arrays;
+    const auto owned = arrayBytes(arrays.rightAscensions) + arrayBytes(arrays.declinations) +
+                       arrayBytes(arrays.apparentMagnitudes) + arrayBytes(arrays.spectralClasses) +
+                       arrayBytes(arrays.properNames);
+    const auto mapped = isMapped() ? viewBytes(m_rightAscensions) + viewBytes(m_declinations) +
+                                         viewBytes(m_apparentMagnitudes) + viewBytes(m_spectralClasses) +
+                                         viewBytes(m_properNames)
+                                   : 0;
+    return owned + mapped + names.memoryUsage();
+}
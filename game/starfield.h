@@ -1,31 +1,90 @@
 #pragma once
 
+#include "string_arena.h"
+
+#include <base/file.h>
+
+#include <cstdint>
+#include <span>
 #include <string>
 #include <vector>
 
-struct Star
+class ThreadPool;
+
+enum class SpectralClass : std::uint8_t
 {
-    enum class SpectralClass
-    {
-        O,
-        B,
-        A,
-        F,
-        G,
-        K,
-        M
-    };
-    std::string bayerName;
-    std::string properName;
-    float rightAscension;
-    float declination;
-    SpectralClass spectralClass;
-    float apparentMagnitude;
+    O,
+    B,
+    A,
+    F,
+    G,
+    K,
+    M
 };
 
-struct Starfield
+// Stars in structure-of-arrays form, one element per star in each array, in the order of the catalog. Only the proper
+// names are kept, since they're the only ones displayed: most stars don't have one and refer to the empty string of
+// the arena. The arrays are either owned by the starfield or read in place from a memory-mapped compiled asset, which
+// stays mapped until the starfield is changed. Movable but not copyable.
+class Starfield
 {
-    std::vector<Star> stars;
+public:
+    // Owned storage of the arrays.
+    struct Arrays
+    {
+        std::vector<float> rightAscensions; // radians
+        std::vector<float> declinations;    // radians
+        std::vector<float> apparentMagnitudes;
+        std::vector<SpectralClass> spectralClasses;
+        std::vector<std::uint32_t> properNames; // in names
+    };
+
+    // Reads the compiled asset next to the file in place if it's up to date (see compiled_assets.h), otherwise parses
+    // the catalog, as CSV if the file has a .csv extension and as JSON otherwise.
+    bool load(const std::string &path, ThreadPool *threadPool = nullptr);
+
+    // The catalogs are mapped and parsed in chunks, on the thread pool if any, ignoring any compiled asset.
+    // JSON: an array of objects with right_ascension and declination in degrees, apparent_magnitude, and optionally
+    // proper_name and spectral_type, as in stars.json.
+    bool loadJson(const std::string &path, ThreadPool *threadPool = nullptr);
+    // CSV: a header line and one star per line, with the columns of the HYG database: ra in hours, dec in degrees,
+    // mag, and optionally proper and spect. Fields can be quoted but not span lines.
+    bool loadCsv(const std::string &path, ThreadPool *threadPool = nullptr);
+
+    std::size_t size() const { return m_rightAscensions.size(); }
+    std::string_view properName(std::size_t index) const { return names[m_properNames[index]]; }
+
+    std::span<const float> rightAscensions() const { return m_rightAscensions; } // radians
+    std::span<const float> declinations() const { return m_declinations; }       // radians
+    std::span<const float> apparentMagnitudes() const { return m_apparentMagnitudes; }
+    std::span<const SpectralClass> spectralClasses() const { return m_spectralClasses; }
+    std::span<const std::uint32_t> properNames() const { return m_properNames; } // in names
+
+    // Whether the arrays are read in place from a compiled asset.
+    bool isMapped() const { return m_assetFile.isValid(); }
+
+    void add(std::string_view properName, float rightAscension, float declination, SpectralClass spectralClass,
+             float apparentMagnitude);
+    void reserve(std::size_t count);
+    void clear();
+    // Replaces the stars, the proper names of `arrays` referring to `names`.
+    void assign(Arrays arrays, StringArena names);
+
+    std::size_t memoryUsage() const; // bytes, including the arrays of a mapped asset
+
+    StringArena names;
+
+private:
+    friend class StarfieldAsset;
+
+    void ownArrays(); // copies the arrays of a mapped asset, before changing them
+    void updateViews();
 
-    bool load(const std::string &path);
+    Arrays m_arrays;
+    MappedFile m_assetFile;
+    std::span<const float> m_rightAscensions;
+    std::span<const float> m_declinations;
+    std::span<const float> m_apparentMagnitudes;
+    std::span<const SpectralClass> m_spectralClasses;
+    std::span<const std::uint32_t> m_properNames;
 };
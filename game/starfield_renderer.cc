@@ -0,0 +1,61 @@
+#include "starfield_renderer.h"
+
+#include <cstddef>
+
+namespace
+{
+
+enum Attribute : GLuint
+{
+    Direction,
+    Magnitude,
+    SpectralClass
+};
+
+} // namespace
+
+StarfieldRenderer::StarfieldRenderer(const Starfield &starfield, const SkyCells::Settings &settings)
+    : m_cells(starfield, settings)
+    , m_instanceBuffer(gl::Buffer::Target::ArrayBuffer, gl::Buffer::Usage::StaticDraw)
+{
+    m_instanceBuffer.bind();
+    m_instanceBuffer.data(std::as_bytes(m_cells.instances()));
+
+    m_vertexArray.bind();
+    for (const auto attribute : {Direction, Magnitude, SpectralClass})
+    {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+    m_vertexArray.unbind();
+}
+
+void StarfieldRenderer::render(const glm::mat4 &mvp, float fieldOfView) const
+{
+    m_cells.select(mvp, m_cells.magnitudeLimit(fieldOfView), m_ranges);
+
+    // No base instance in GL 4.1: the attributes are pointed at the first instance of each range instead. The quad of
+    // each star comes from gl_VertexID.
+    m_drawnStarCount = 0;
+    m_vertexArray.bind();
+    m_instanceBuffer.bind();
+    for (const auto &range : m_ranges)
+    {
+        setInstanceOffset(range.begin);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, range.count);
+        m_drawnStarCount += range.count;
+    }
+    m_vertexArray.unbind();
+}
+
+void StarfieldRenderer::setInstanceOffset(std::size_t instance) const
+{
+    constexpr auto kStride = sizeof(StarInstance);
+    const auto offset = instance * kStride;
+    const auto pointer = [offset](std::size_t member) { return reinterpret_cast<const void *>(offset + member); };
+    glVertexAttribPointer(Direction, 2, GL_SHORT, GL_TRUE, kStride, pointer(offsetof(StarInstance, direction)));
+    glVertexAttribPointer(Magnitude, 1, GL_UNSIGNED_SHORT, GL_TRUE, kStride,
+                          pointer(offsetof(StarInstance, magnitude)));
+    glVertexAttribIPointer(SpectralClass, 1, GL_UNSIGNED_BYTE, kStride,
+                           pointer(offsetof(StarInstance, spectralClass)));
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "sky_cells.h"
+
+#include <base/glhelpers.h>
+
+// Draws a starfield as one instance per star, with ShaderManager::Shader::Starfield: only the stars of the sky cells
+// in view, down to the magnitude limit of the field of view.
+class StarfieldRenderer
+{
+public:
+    explicit StarfieldRenderer(const Starfield &starfield, const SkyCells::Settings &settings = {});
+
+    // `mvp` transforms the directions of the stars, `fieldOfView` is vertical, in radians. The shader must be current.
+    void render(const glm::mat4 &mvp, float fieldOfView) const;
+
+    std::size_t drawnStarCount() const { return m_drawnStarCount; } // by the last render
+
+private:
+    void setInstanceOffset(std::size_t instance) const;
+
+    SkyCells m_cells;
+    gl::Buffer m_instanceBuffer;
+    gl::VertexArray m_vertexArray;
+    mutable std::vector<InstanceRange> m_ranges;
+    mutable std::size_t m_drawnStarCount{0};
+};
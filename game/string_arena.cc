@@ -0,0 +1,55 @@
+#include "string_arena.h"
+
+#include <algorithm>
+#include <functional>
+
+StringArena::StringArena()
+{
+    clear();
+}
+
+std::uint32_t StringArena::intern(std::string_view string)
+{
+    if (string.empty())
+        return 0;
+    const auto hash = std::hash<std::string_view>{}(string);
+    const auto [begin, end] = m_indices.equal_range(hash);
+    for (auto it = begin; it != end; ++it)
+    {
+        if ((*this)[it->second] == string)
+            return it->second;
+    }
+    const auto index = static_cast<std::uint32_t>(size());
+    m_chars.append(string);
+    m_offsets.push_back(static_cast<std::uint32_t>(m_chars.size()));
+    m_indices.emplace(hash, index);
+    return index;
+}
+
+void StringArena::clear()
+{
+    m_chars.clear();
+    m_offsets.assign(2, 0);
+    m_indices.clear();
+}
+
+bool StringArena::assign(std::string_view chars, std::span<const std::uint32_t> offsets)
+{
+    if (offsets.size() < 2 || offsets[0] != 0 || offsets[1] != 0 || offsets.back() > chars.size() ||
+        !std::ranges::is_sorted(offsets))
+        return false;
+    m_chars.assign(chars.substr(0, offsets.back()));
+    m_offsets.assign(offsets.begin(), offsets.end());
+    m_indices.clear();
+    for (std::uint32_t index = 1; index < size(); ++index)
+        m_indices.emplace(std::hash<std::string_view>{}((*this)[index]), index);
+    return true;
+}
+
+std::size_t StringArena::memoryUsage() const
+{
+    // a node of the index is about the size of a key, a value and a pointer to the next node
+    constexpr auto kIndexNodeSize = sizeof(std::size_t) + sizeof(std::uint32_t) + sizeof(void *);
+    return m_chars.capacity() + m_offsets.capacity() * sizeof(std::uint32_t) +
+           m_indices.bucket_count() * sizeof(void *) + m_indices.size() * kIndexNodeSize;
+}
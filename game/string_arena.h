@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Interned strings, stored back to back in one buffer and referred to by index. Each distinct string is stored once,
+// index 0 is the empty string.
+class StringArena
+{
+public:
+    StringArena();
+
+    std::uint32_t intern(std::string_view string);
+
+    std::string_view operator[](std::uint32_t index) const
+    {
+        return std::string_view{m_chars}.substr(m_offsets[index], m_offsets[index + 1] - m_offsets[index]);
+    }
+    std::size_t size() const { return m_offsets.size() - 1; } // including the empty string
+
+    void clear();
+
+    // Raw storage, string i is chars()[offsets()[i], offsets()[i + 1]).
+    std::string_view chars() const { return m_chars; }
+    std::span<const std::uint32_t> offsets() const { return m_offsets; }
+
+    // Replaces the strings with ones in raw storage. Returns false, leaving the arena untouched, if the offsets don't
+    // start with the empty string or go past the chars.
+    bool assign(std::string_view chars, std::span<const std::uint32_t> offsets);
+
+    std::size_t memoryUsage() const; // bytes
+
+private:
+    std::string m_chars;
+    std::vector<std::uint32_t> m_offsets;
+    std::unordered_multimap<std::size_t, std::uint32_t> m_indices; // by hash of the string
+};
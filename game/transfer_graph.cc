@@ -0,0 +1,268 @@
+#include "transfer_graph.h"
+
+#include "lambert.h"
+#include "orbital_elements.h"
+
+#include <base/thread_pool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <ranges>
+#include <tuple>
+
+TransferGraph::TransferGraph(const Universe *universe, JulianDate start, const Settings &settings,
+                             ThreadPool *threadPool)
+    : m_start(start)
+    , m_settings(settings)
+    , m_slotCount(static_cast<std::size_t>(settings.horizon / settings.slotInterval) + 1)
+    , m_worlds(universe->worlds() | std::ranges::to<std::vector<const World *>>())
+{
+    const auto worldCount = m_worlds.size();
+
+    // bodies of the ephemeris of the universe are its worlds
+    std::vector<JulianDate> slotDates(m_slotCount);
+    for (std::size_t slot = 0; slot < m_slotCount; ++slot)
+        slotDates[slot] = slotDate(slot);
+    std::vector<glm::dvec3> positions(m_slotCount);
+    std::vector<glm::dvec3> velocities(m_slotCount);
+    m_states.resize(nodeCount());
+    for (std::size_t i = 0; i < worldCount; ++i)
+    {
+        universe->ephemeris().compute(i, slotDates, {.positions = positions, .velocities = velocities});
+        for (std::size_t slot = 0; slot < m_slotCount; ++slot)
+            m_states[nodeIndex(i, slot)] = {positions[slot], velocities[slot]};
+    }
+
+    // cheapest transfer for every pair and departure slot, pairs are independent so they're solved in parallel
+    const auto pairCount = worldCount * worldCount;
+    std::vector<Edge> departures(pairCount * m_slotCount);
+    const auto solvePairs = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t pair = begin; pair < end; ++pair)
+        {
+            const auto originIndex = pair / worldCount;
+            const auto destinationIndex = pair % worldCount;
+            if (originIndex != destinationIndex)
+                solvePair(originIndex, destinationIndex,
+                          std::span{departures}.subspan(pair * m_slotCount, m_slotCount));
+        }
+    };
+    if (threadPool)
+        threadPool->parallelFor(pairCount, 1, solvePairs);
+    else
+        solvePairs(0, pairCount);
+
+    m_minDeltaV.assign(pairCount, std::numeric_limits<float>::infinity());
+    m_edgeOffsets.reserve(nodeCount() + 1);
+    m_edgeOffsets.push_back(0);
+    for (std::size_t originIndex = 0; originIndex < worldCount; ++originIndex)
+    {
+        for (std::size_t slot = 0; slot < m_slotCount; ++slot)
+        {
+            for (std::size_t destinationIndex = 0; destinationIndex < worldCount; ++destinationIndex)
+            {
+                const auto pair = originIndex * worldCount + destinationIndex;
+                const auto &edge = departures[pair * m_slotCount + slot];
+                if (edge.target == kNoTarget)
+                    continue;
+                m_edges.push_back(edge);
+                m_minDeltaV[pair] = std::min(m_minDeltaV[pair], edge.deltaV());
+            }
+            m_edgeOffsets.push_back(static_cast<std::uint32_t>(m_edges.size()));
+        }
+    }
+}
+
+void TransferGraph::solvePair(std::size_t originIndex, std::size_t destinationIndex, std::span<Edge> departures) const
+{
+    // transit times between half and one and a half times the Hohmann transfer time, like MissionTable
+    // Hohmann transfer: tH = pi * sqrt((r1 + r2)^3 / 8 * GM), assuming kGMSun = (4.0 * pi^2) AU^3/years^2
+    const auto semiMajorAxis = 0.5 * (m_worlds[originIndex]->orbit().elements().semiMajorAxis +
+                                      m_worlds[destinationIndex]->orbit().elements().semiMajorAxis);
+    const JulianDays transitHohmann = JulianYears{0.5 * std::pow(semiMajorAxis, 3.0 / 2.0)};
+    const auto minTransitSlots =
+        std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(0.5 * transitHohmann / m_settings.slotInterval)));
+    const auto maxTransitSlots = std::max(
+        minTransitSlots, static_cast<std::size_t>(std::floor(1.5 * transitHohmann / m_settings.slotInterval)));
+    if (minTransitSlots >= m_slotCount)
+        return;
+    const auto transitSlotCount = maxTransitSlots - minTransitSlots + 1;
+    const auto maxSamples = std::max<std::size_t>(m_settings.maxTransitSamples, 1);
+    const auto transitStride = (transitSlotCount + maxSamples - 1) / maxSamples;
+
+    std::vector<LambertProblem> problems;
+    std::vector<std::pair<std::size_t, std::size_t>> slots; // departure and arrival slot of each problem
+    for (std::size_t departureSlot = 0; departureSlot + minTransitSlots < m_slotCount; ++departureSlot)
+    {
+        const auto &departureState = m_states[nodeIndex(originIndex, departureSlot)];
+        for (auto transitSlots = minTransitSlots;
+             transitSlots <= maxTransitSlots && departureSlot + transitSlots < m_slotCount;
+             transitSlots += transitStride)
+        {
+            const auto arrivalSlot = departureSlot + transitSlots;
+            const auto &arrivalState = m_states[nodeIndex(destinationIndex, arrivalSlot)];
+            problems.push_back({.r1 = departureState.position,
+                                .r2 = arrivalState.position,
+                                .dt = (static_cast<double>(transitSlots) * m_settings.slotInterval).count()});
+            slots.emplace_back(departureSlot, arrivalSlot);
+        }
+    }
+
+    std::vector<std::optional<TransferVelocities>> solutions(problems.size());
+    lambert_battin_batch<double>(kGMSun, problems, solutions);
+
+    for (std::size_t i = 0; i < problems.size(); ++i)
+    {
+        const auto &solution = solutions[i];
+        if (!solution)
+            continue;
+        const auto [departureSlot, arrivalSlot] = slots[i];
+        const auto deltaVDeparture =
+            glm::length(solution->initialVelocity - m_states[nodeIndex(originIndex, departureSlot)].velocity);
+        const auto deltaVArrival =
+            glm::length(solution->finalVelocity - m_states[nodeIndex(destinationIndex, arrivalSlot)].velocity);
+        const auto deltaV = deltaVDeparture + deltaVArrival;
+        // lambert_battin sometimes returns vec3{inf}
+        if (!std::isfinite(deltaV) || deltaV > m_settings.maxLegDeltaV)
+            continue;
+        auto &edge = departures[departureSlot];
+        if (edge.target == kNoTarget || deltaV < edge.deltaV())
+            edge = Edge{.target = nodeIndex(destinationIndex, arrivalSlot),
+                        .deltaVDeparture = static_cast<float>(deltaVDeparture),
+                        .deltaVArrival = static_cast<float>(deltaVArrival)};
+    }
+}
+
+std::optional<std::size_t> TransferGraph::worldIndex(const World *world) const
+{
+    const auto it = std::ranges::find(m_worlds, world);
+    if (it == m_worlds.end())
+        return {};
+    return std::distance(m_worlds.begin(), it);
+}
+
+std::vector<float> TransferGraph::lowerBounds(std::size_t destinationIndex) const
+{
+    // Dijkstra towards the destination on the graph of the worlds, weighted with the cheapest transfer of each pair
+    // at any date. No route through the time-expanded graph can be cheaper.
+    const auto worldCount = m_worlds.size();
+    std::vector<float> bounds(worldCount, std::numeric_limits<float>::infinity());
+    std::vector<bool> done(worldCount, false);
+    bounds[destinationIndex] = 0.0f;
+    for (std::size_t step = 0; step < worldCount; ++step)
+    {
+        std::optional<std::size_t> next;
+        for (std::size_t i = 0; i < worldCount; ++i)
+        {
+            if (!done[i] && (!next || bounds[i] < bounds[*next]))
+                next = i;
+        }
+        if (!std::isfinite(bounds[*next]))
+            break;
+        done[*next] = true;
+        for (std::size_t i = 0; i < worldCount; ++i)
+            bounds[i] = std::min(bounds[i], m_minDeltaV[i * worldCount + *next] + bounds[*next]);
+    }
+    return bounds;
+}
+
+std::optional<TransferGraph::Route> TransferGraph::findRoute(const World *origin, const World *destination,
+                                                             JulianDate earliestDeparture, const Budget &budget) const
+{
+    const auto originIndex = worldIndex(origin);
+    const auto destinationIndex = worldIndex(destination);
+    if (!originIndex || !destinationIndex)
+        return {};
+
+    const auto lastSlotDate = budget.latestArrival ? std::min(*budget.latestArrival, end()) : end();
+    const auto firstSlotIndex = std::max(0.0, std::ceil((earliestDeparture - m_start) / m_settings.slotInterval));
+    const auto lastSlotIndex = std::floor((lastSlotDate - m_start) / m_settings.slotInterval);
+    if (firstSlotIndex > lastSlotIndex)
+        return {};
+    const auto firstSlot = static_cast<std::size_t>(firstSlotIndex);
+    const auto lastSlot = static_cast<std::size_t>(lastSlotIndex);
+    if (*originIndex == *destinationIndex)
+        return Route{.startDate = slotDate(firstSlot)};
+
+    const auto bounds = lowerBounds(*destinationIndex);
+    if (bounds[*originIndex] > budget.maxDeltaV)
+        return {};
+
+    std::vector<float> costs(nodeCount(), std::numeric_limits<float>::infinity());
+    std::vector<std::uint32_t> previousNodes(nodeCount(), kNoTarget);
+    std::vector<std::uint32_t> previousEdges(nodeCount(), kNoTarget); // kNoTarget when waiting
+    std::vector<bool> closed(nodeCount(), false);
+
+    // ties on the estimate go to the earliest slot
+    using QueueEntry = std::tuple<float, std::size_t, std::uint32_t>; // estimate, slot, node
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>> queue;
+    const auto relax = [&](std::uint32_t node, std::uint32_t target, std::uint32_t edgeIndex, float cost) {
+        const auto estimate = cost + bounds[nodeWorld(target)];
+        if (nodeSlot(target) > lastSlot || estimate > budget.maxDeltaV || cost >= costs[target])
+            return;
+        costs[target] = cost;
+        previousNodes[target] = node;
+        previousEdges[target] = edgeIndex;
+        queue.emplace(estimate, nodeSlot(target), target);
+    };
+
+    const auto startNode = nodeIndex(*originIndex, firstSlot);
+    costs[startNode] = 0.0f;
+    queue.emplace(bounds[*originIndex], nodeSlot(startNode), startNode);
+    while (!queue.empty())
+    {
+        const auto node = std::get<2>(queue.top());
+        queue.pop();
+        if (closed[node])
+            continue;
+        closed[node] = true;
+
+        if (nodeWorld(node) == *destinationIndex)
+        {
+            Route route{.startDate = slotDate(firstSlot)};
+            for (auto current = node; current != startNode; current = previousNodes[current])
+            {
+                if (previousEdges[current] == kNoTarget)
+                    continue;
+                const auto &edge = m_edges[previousEdges[current]];
+                const auto previous = previousNodes[current];
+                route.legs.push_back({.origin = m_worlds[nodeWorld(previous)],
+                                      .destination = m_worlds[nodeWorld(current)],
+                                      .departureDate = slotDate(nodeSlot(previous)),
+                                      .arrivalDate = slotDate(nodeSlot(current)),
+                                      .deltaVDeparture = edge.deltaVDeparture,
+                                      .deltaVArrival = edge.deltaVArrival});
+                route.totalDeltaV += edge.deltaV();
+            }
+            std::ranges::reverse(route.legs);
+            return route;
+        }
+
+        const auto cost = costs[node];
+        if (nodeSlot(node) + 1 < m_slotCount)
+            relax(node, node + 1, kNoTarget, cost);
+        for (auto edgeIndex = m_edgeOffsets[node]; edgeIndex < m_edgeOffsets[node + 1]; ++edgeIndex)
+            relax(node, m_edges[edgeIndex].target, edgeIndex, cost + m_edges[edgeIndex].deltaV());
+    }
+    return {};
+}
+
+std::optional<MissionPlan> TransferGraph::missionPlan(const Leg &leg) const
+{
+    const auto posDeparture = leg.origin->orbit().position(leg.departureDate);
+    const auto posArrival = leg.destination->orbit().position(leg.arrivalDate);
+    const auto transfer =
+        lambert_battin(kGMSun, posDeparture, posArrival, (leg.arrivalDate - leg.departureDate).count());
+    if (!transfer)
+        return {};
+
+    MissionPlan plan{.origin = leg.origin,
+                     .destination = leg.destination,
+                     .departureDate = leg.departureDate,
+                     .arrivalDate = leg.arrivalDate};
+    plan.orbit.setElements(orbitalElementsFromStateVector(posArrival, transfer->finalVelocity, leg.arrivalDate));
+    plan.orbit.setKeplerSolver(KeplerSolver::Markley);
+    plan.deltaVDeparture = leg.deltaVDeparture;
+    plan.deltaVArrival = leg.deltaVArrival;
+    return plan;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "universe.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+class ThreadPool;
+
+// Time-expanded graph of the transfers between every pair of worlds. Time is split in slots of equal length starting
+// at `start`, and the nodes of the graph are (world, slot) pairs. Each node has an edge to the next slot of the same
+// world (waiting, free), and at most one transfer edge per other world: the cheapest transfer departing at the start
+// of the slot, over a few transit times around the Hohmann transfer time. That's a summary of the porkchop plot of
+// every pair along its departure axis, which is enough to plan routes with several stops in a few milliseconds.
+//
+// The graph only covers [start, start + horizon], it needs to be built again when the universe date gets close to
+// the end.
+class TransferGraph
+{
+public:
+    struct Settings
+    {
+        JulianDays slotInterval{5.0};
+        JulianDays horizon{JulianYears{2.0}};
+        std::size_t maxTransitSamples{32}; // per departure slot and destination
+        double maxLegDeltaV{0.03};         // AU/day, transfers above this are left out
+    };
+
+    struct Leg
+    {
+        const World *origin{nullptr};
+        const World *destination{nullptr};
+        JulianDate departureDate;
+        JulianDate arrivalDate;
+        float deltaVDeparture; // AU/day
+        float deltaVArrival;   // AU/day
+    };
+
+    struct Route
+    {
+        std::vector<Leg> legs;   // none if the origin is the destination
+        double totalDeltaV{0.0}; // AU/day
+        JulianDate startDate;    // earliest departure, rounded up to a slot
+
+        JulianDate arrivalDate() const { return legs.empty() ? startDate : legs.back().arrivalDate; }
+    };
+
+    struct Budget
+    {
+        double maxDeltaV{std::numeric_limits<double>::infinity()}; // AU/day, over the whole route
+        std::optional<JulianDate> latestArrival;
+    };
+
+    // If `threadPool` is not null the pairs of worlds are solved on it.
+    explicit TransferGraph(const Universe *universe, JulianDate start, const Settings &settings,
+                           ThreadPool *threadPool = nullptr);
+
+    JulianDate start() const { return m_start; }
+    JulianDate end() const { return slotDate(m_slotCount - 1); }
+    const Settings &settings() const { return m_settings; }
+    std::size_t slotCount() const { return m_slotCount; }
+    std::size_t nodeCount() const { return m_worlds.size() * m_slotCount; }
+    std::size_t edgeCount() const { return m_edges.size(); }
+
+    // Cheapest route from `origin` to `destination` leaving no earlier than `earliestDeparture`, or nothing if there's
+    // none within the budget. Departures are rounded up to the next slot. Among routes of the same cost the one that
+    // arrives first wins. A* search, with the cheapest route between the worlds at any date as the heuristic.
+    std::optional<Route> findRoute(const World *origin, const World *destination, JulianDate earliestDeparture,
+                                   const Budget &budget) const;
+
+    // Mission plan following a leg of a route, or nothing if the scalar Lambert solver finds no transfer where the
+    // batch one did, which can happen for transfers close to 180 degrees.
+    std::optional<MissionPlan> missionPlan(const Leg &leg) const;
+
+private:
+    static constexpr auto kNoTarget = std::numeric_limits<std::uint32_t>::max();
+
+    struct Edge
+    {
+        std::uint32_t target{kNoTarget}; // node index
+        float deltaVDeparture;
+        float deltaVArrival;
+
+        float deltaV() const { return deltaVDeparture + deltaVArrival; }
+    };
+
+    std::uint32_t nodeIndex(std::size_t worldIndex, std::size_t slot) const
+    {
+        return static_cast<std::uint32_t>(worldIndex * m_slotCount + slot);
+    }
+    std::size_t nodeWorld(std::uint32_t node) const { return node / m_slotCount; }
+    std::size_t nodeSlot(std::uint32_t node) const { return node % m_slotCount; }
+    JulianDate slotDate(std::size_t slot) const
+    {
+        return m_start + static_cast<double>(slot) * m_settings.slotInterval;
+    }
+    std::optional<std::size_t> worldIndex(const World *world) const;
+
+    void solvePair(std::size_t originIndex, std::size_t destinationIndex, std::span<Edge> departures) const;
+    std::vector<float> lowerBounds(std::size_t destinationIndex) const;
+
+    JulianDate m_start;
+    Settings m_settings;
+    std::size_t m_slotCount{0};
+    std::vector<const World *> m_worlds;
+    std::vector<Orbit::StateVector3> m_states; // per node
+    // transfer edges in compressed rows: the edges of node i are [m_edgeOffsets[i], m_edgeOffsets[i + 1])
+    std::vector<std::uint32_t> m_edgeOffsets;
+    std::vector<Edge> m_edges;
+    // cheapest transfer between each pair of worlds over every slot, row-major by origin
+    std::vector<float> m_minDeltaV;
+};
@@ -1,10 +1,14 @@
 #include "universe.h"
 
+#include "compiled_assets.h"
+
 #include <base/file.h>
 #include <base/asset_path.h>
+#include <base/thread_pool.h>
 
 #include <glm/gtx/transform.hpp>
 
+#include <chrono>
 #include <random>
 
 // References:
@@ -15,34 +19,9 @@
 namespace
 {
 
-constexpr auto kTolerance = 1e-10;
-constexpr auto kMaxIterations = 50;
-
-constexpr double eccentricAnomalyElliptic(double M, double e)
-{
-    auto E = M;
-    for (std::size_t iteration = 0; iteration < kMaxIterations; ++iteration)
-    {
-        const auto dE = (E - e * std::sin(E) - M) / (1.0 - e * std::cos(E));
-        E -= dE;
-        if (std::abs(dE) < kTolerance)
-            break;
-    }
-    return E;
-}
-
-constexpr double eccentricAnomalyHyperbolic(double M, double e)
-{
-    auto H = std::log(2.0 * M / e + 1.8);
-    for (std::size_t iteration = 0; iteration < kMaxIterations; ++iteration)
-    {
-        const auto dH = (e * std::sinh(H) - H - M) / (e * std::cosh(H) - 1.0);
-        H -= dH;
-        if (std::abs(dH) < kTolerance)
-            break;
-    }
-    return H;
-}
+// dates covered by each Chebyshev fit of the worlds: the next one is fitted in the background once the date is halfway
+// through, and short enough that a fit picked up by the thread waiting on an update doesn't stall it
+constexpr auto kEphemerisCacheSpan = JulianDays{60.0};
 
 constexpr double trueAnomalyElliptic(double E, double e)
 {
@@ -82,31 +61,20 @@ double Orbit::meanAnomaly(JulianDate when) const
 
 double Orbit::eccentricAnomaly(JulianDate when) const
 {
-    const auto e = m_elems.eccentricity;
-    const auto M = meanAnomaly(when);
-    if (e < 1.0)
-    {
-        return eccentricAnomalyElliptic(M, e);
-    }
-    else
-    {
-        return eccentricAnomalyHyperbolic(M, e);
-    }
+    return solveKepler(m_keplerSolver, meanAnomaly(when), m_elems.eccentricity).anomaly;
 }
 
 double Orbit::trueAnomaly(JulianDate when) const
 {
     const auto e = m_elems.eccentricity;
-    const auto M = meanAnomaly(when);
+    const auto anomaly = eccentricAnomaly(when);
     if (e < 1.0)
     {
-        const auto E = eccentricAnomalyElliptic(M, e);
-        return trueAnomalyElliptic(E, e);
+        return trueAnomalyElliptic(anomaly, e);
     }
     else
     {
-        const auto H = eccentricAnomalyHyperbolic(M, e);
-        return trueAnomalyHyperbolic(H, e);
+        return trueAnomalyHyperbolic(anomaly, e);
     }
 }
 
@@ -122,7 +90,7 @@ glm::dvec2 Orbit::positionOnOrbitPlane(JulianDate when) const
             // elliptical orbit
 
             // eccentric anomaly
-            const auto E = eccentricAnomalyElliptic(M, e);
+            const auto E = solveKepler(m_keplerSolver, M, e).anomaly;
 
             // true anomaly
             const auto nu = trueAnomalyElliptic(E, e);
@@ -137,7 +105,7 @@ glm::dvec2 Orbit::positionOnOrbitPlane(JulianDate when) const
             // hyperbolic orbit
 
             // eccentric anomaly
-            const auto H = eccentricAnomalyHyperbolic(M, e);
+            const auto H = solveKepler(m_keplerSolver, M, e).anomaly;
 
             // true anomaly
             const auto nu = trueAnomalyHyperbolic(H, e);
@@ -160,24 +128,25 @@ glm::dvec3 Orbit::position(JulianDate when) const
 }
 
 Orbit::StateVector2 Orbit::stateVectorOnOrbitPlane(JulianDate when) const
+{
+    return stateVectorFromAnomaly(eccentricAnomaly(when));
+}
+
+Orbit::StateVector2 Orbit::stateVectorFromAnomaly(double anomaly) const
 {
     const auto e = m_elems.eccentricity;
     const auto a = m_elems.semiMajorAxis;
-    const auto M = meanAnomaly(when);
 
-    const auto [nu, r, p] = [this, e, a, M]() -> std::tuple<double, double, double> {
+    const auto [nu, r, p] = [e, a, anomaly]() -> std::tuple<double, double, double> {
         if (e < 1.0)
         {
             // elliptical orbit
 
-            // eccentric anomaly
-            const auto E = eccentricAnomalyElliptic(M, e);
-
             // true anomaly
-            const auto nu = trueAnomalyElliptic(E, e);
+            const auto nu = trueAnomalyElliptic(anomaly, e);
 
             // radius
-            const auto r = a * (1.0 - e * std::cos(E));
+            const auto r = a * (1.0 - e * std::cos(anomaly));
 
             const auto p = a * (1.0 - e * e);
 
@@ -187,14 +156,11 @@ Orbit::StateVector2 Orbit::stateVectorOnOrbitPlane(JulianDate when) const
         {
             // hyperbolic orbit
 
-            // eccentric anomaly
-            const auto H = eccentricAnomalyHyperbolic(M, e);
-
             // true anomaly
-            const auto nu = trueAnomalyHyperbolic(H, e);
+            const auto nu = trueAnomalyHyperbolic(anomaly, e);
 
             // radius
-            const auto r = a * (1.0 - e * std::cosh(H));
+            const auto r = a * (1.0 - e * std::cosh(anomaly));
 
             const auto p = std::abs(a) * (e * e - 1.0);
 
@@ -224,6 +190,18 @@ Orbit::StateVector3 Orbit::stateVector(JulianDate when) const
     return {m_orbitRotationMatrix * glm::dvec3(position, 0.0), m_orbitRotationMatrix * glm::dvec3(velocity, 0.0)};
 }
 
+Orbit::State Orbit::state(JulianDate when) const
+{
+    const auto e = m_elems.eccentricity;
+    const auto anomaly = eccentricAnomaly(when);
+    const auto onOrbitPlane = stateVectorFromAnomaly(anomaly);
+    return {.eccentricAnomaly = anomaly,
+            .trueAnomaly = e < 1.0 ? trueAnomalyElliptic(anomaly, e) : trueAnomalyHyperbolic(anomaly, e),
+            .onOrbitPlane = onOrbitPlane,
+            .stateVector = {m_orbitRotationMatrix * glm::dvec3(onOrbitPlane.position, 0.0),
+                            m_orbitRotationMatrix * glm::dvec3(onOrbitPlane.velocity, 0.0)}};
+}
+
 void Orbit::updatePeriod()
 {
     // assuming kGMSun = (4.0 * pi^2) AU^3/years^2
@@ -244,207 +222,589 @@ void Orbit::updateOrbitRotationMatrix()
     m_orbitRotationMatrix = rN * ri * rw;
 }
 
-World::World(const Universe *universe, const OrbitalElements &elems)
+void MarketPrices::resize(std::size_t worldCount, std::size_t itemCount)
+{
+    m_itemCount = itemCount;
+    m_sellPrices.assign(worldCount * itemCount, 0);
+    m_buyPrices.assign(worldCount * itemCount, 0);
+}
+
+std::span<std::uint64_t> MarketPrices::sellPrices(std::size_t world)
+{
+    return std::span{m_sellPrices}.subspan(world * m_itemCount, m_itemCount);
+}
+
+std::span<const std::uint64_t> MarketPrices::sellPrices(std::size_t world) const
+{
+    return std::span{m_sellPrices}.subspan(world * m_itemCount, m_itemCount);
+}
+
+std::span<std::uint64_t> MarketPrices::buyPrices(std::size_t world)
+{
+    return std::span{m_buyPrices}.subspan(world * m_itemCount, m_itemCount);
+}
+
+std::span<const std::uint64_t> MarketPrices::buyPrices(std::size_t world) const
+{
+    return std::span{m_buyPrices}.subspan(world * m_itemCount, m_itemCount);
+}
+
+World::World(const Universe *universe, std::size_t index, const OrbitalElements &elems)
     : m_universe(universe)
+    , m_index(index)
     , m_orbit(elems)
 {
-    std::random_device rnd;
-    for (const auto *sector : m_universe->marketSectors())
-    {
-        for (const auto &item : sector->items)
-        {
-            const bool bought = static_cast<bool>(rnd() % 2);
-            const bool sold = static_cast<bool>(rnd() % 2);
-            if (!bought && !sold)
-                continue;
-            const auto buyPrice = bought ? rnd() % 50000 + 5000 : 0;
-            const auto sellPrice = sold ? rnd() % 50000 + 5000 : 0;
-            m_marketItemPrices.emplace_back(item.get(), buyPrice, sellPrice);
-        }
-    }
 }
 
-void World::update()
+std::span<const std::uint64_t> World::sellPrices() const
 {
-    m_currentPositionOnOrbitPlane = m_orbit.positionOnOrbitPlane(m_universe->date());
-    m_currentPosition = m_orbit.orbitRotationMatrix() * glm::dvec3(m_currentPositionOnOrbitPlane, 0.0);
+    return m_universe->m_marketPrices.sellPrices(m_index);
 }
 
-const MarketItemPrice *World::findMarketItemPrice(const MarketItem *item) const
+std::span<const std::uint64_t> World::buyPrices() const
 {
-    auto it = std::ranges::find_if(m_marketItemPrices, [item](const auto &price) { return price.item == item; });
-    return it != m_marketItemPrices.end() ? &*it : nullptr;
+    return m_universe->m_marketPrices.buyPrices(m_index);
 }
 
-Ship::Ship(const Universe *universe, const ShipClass *shipClass, const World *world)
-    : m_universe(universe)
-    , m_shipClass(shipClass)
-    , m_world(world)
+glm::dvec2 World::currentPositionOnOrbitPlane() const
+{
+    return m_universe->m_worldPositionsOnOrbitPlane[m_index];
+}
+
+glm::dvec3 World::currentPosition() const
 {
-    std::random_device rnd;
-    for (const auto *sector : m_universe->marketSectors())
+    return m_universe->m_worldPositions[m_index];
+}
+
+const Orbit::State &World::currentState() const
+{
+    const auto date = m_universe->date();
+    if (m_currentStateDate != date)
     {
-        for (const auto &item : sector->items)
-        {
-            if ((rnd() % 2) == 0)
-                changeCargo(item.get(), rnd() % 10);
-        }
+        m_currentState = m_orbit.state(date);
+        m_currentStateDate = date;
     }
+    return m_currentState;
+}
+
+std::optional<MarketItemPrice> World::findMarketItemPrice(const MarketItem *item) const
+{
+    const auto sellPrice = sellPrices()[item->id];
+    const auto buyPrice = buyPrices()[item->id];
+    if (sellPrice == 0 && buyPrice == 0)
+        return std::nullopt;
+    return MarketItemPrice{item, sellPrice, buyPrice};
+}
+
+Ship::Ship(Universe *universe, std::uint32_t slot)
+    : m_universe(universe)
+    , m_slot(slot)
+{
+}
+
+std::size_t Ship::index() const
+{
+    return m_universe->m_ships.slotIndex(m_slot);
+}
+
+ShipHandle Ship::handle() const
+{
+    return m_universe->m_ships.handles[index()];
 }
 
-Ship::~Ship() = default;
+const ShipClass *Ship::shipClass() const
+{
+    return m_universe->m_ships.shipClasses[index()];
+}
+
+const std::string &Ship::name() const
+{
+    return m_universe->m_ships.names[index()];
+}
+
+glm::dvec3 Ship::currentPosition() const
+{
+    const auto &ships = m_universe->m_ships;
+    const auto i = index();
+    if (ships.states[i] == State::Docked)
+        return ships.worlds[i]->currentPosition();
+    return ships.positions[i];
+}
+
+Ship::State Ship::state() const
+{
+    return m_universe->m_ships.states[index()];
+}
 
 void Ship::setMissionPlan(std::optional<MissionPlan> missionPlan)
 {
-    m_missionPlan = std::move(missionPlan);
+    auto &ships = m_universe->m_ships;
+    const auto i = index();
+    auto &plan = ships.missionPlans[i];
+    plan = std::move(missionPlan);
+    ships.currentStates[i].date.reset();
+    const auto serial = ++ships.missionSerials[i];
+    if (plan.has_value())
+    {
+        ships.transitAnomalies[i] = {.departure = plan->orbit.trueAnomaly(plan->departureDate),
+                                     .arrival = plan->orbit.trueAnomaly(plan->arrivalDate)};
+        auto &events = m_universe->m_shipEvents;
+        const auto handle = ships.handles[i];
+        events.push(plan->departureDate, {Universe::ShipEvent::Kind::Departure, handle, serial});
+        events.push(plan->arrivalDate, {Universe::ShipEvent::Kind::Arrival, handle, serial});
+    }
 }
 
 const std::optional<MissionPlan> &Ship::missionPlan() const
 {
-    return m_missionPlan;
+    return m_universe->m_ships.missionPlans[index()];
+}
+
+const Orbit::State &Ship::currentState() const
+{
+    const auto &ships = m_universe->m_ships;
+    const auto i = index();
+    const auto &plan = ships.missionPlans[i];
+    assert(plan.has_value());
+    auto &[state, stateDate] = ships.currentStates[i];
+    const auto date = m_universe->date();
+    if (stateDate != date)
+    {
+        state = plan->orbit.state(date);
+        stateDate = date;
+    }
+    return state;
+}
+
+double Ship::departureTrueAnomaly() const
+{
+    return m_universe->m_ships.transitAnomalies[index()].departure;
+}
+
+double Ship::arrivalTrueAnomaly() const
+{
+    return m_universe->m_ships.transitAnomalies[index()].arrival;
 }
 
 int Ship::totalCargo() const
 {
-    return std::ranges::fold_left(m_cargo, 0, [](int count, const auto &item) { return count + item.second; });
+    return m_universe->m_ships.cargoTotal(index());
 }
 
 int Ship::cargoCapacity() const
 {
-    return m_shipClass->cargoCapacity;
+    return shipClass()->cargoCapacity;
+}
+
+std::span<const int> Ship::cargoCounts() const
+{
+    return m_universe->m_ships.cargo(index());
 }
 
 int Ship::cargo(const MarketItem *item) const
 {
-    auto it = m_cargo.find(item);
-    return it != m_cargo.end() ? it->second : 0;
+    return cargoCounts()[item->id];
 }
 
 void Ship::changeCargo(const MarketItem *item, int count)
 {
-    const auto currentCargo = cargo(item);
-    auto updatedCargo = std::clamp(currentCargo + count, 0, cargoCapacity());
-    if (updatedCargo == currentCargo)
+    const auto cargo = this->cargo(item);
+    const auto updatedCargo = std::clamp(cargo + count, 0, cargoCapacity());
+    if (updatedCargo == cargo)
         return;
-    auto it = m_cargo.find(item);
-    if (updatedCargo == 0)
+    m_universe->m_ships.setCargo(index(), item->id, updatedCargo);
+    m_universe->shipCargoChangedSignal(this, item);
+}
+
+const World *Ship::world() const
+{
+    if (state() != State::Docked)
+        return nullptr;
+    const auto *world = m_universe->m_ships.worlds[index()];
+    assert(world != nullptr);
+    return world;
+}
+
+const Orbit *Ship::orbit() const
+{
+    if (state() != State::InTransit)
+        return nullptr;
+    const auto &plan = missionPlan();
+    assert(plan.has_value());
+    return &plan->orbit;
+}
+
+ShipHandle ShipStore::add(const ShipClass *shipClass, const World *world, std::string name)
+{
+    std::uint32_t slot;
+    if (!m_freeSlots.empty())
     {
-        // remove if 0
-        if (it != m_cargo.end())
-            m_cargo.erase(it);
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
     }
     else
     {
-        if (it == m_cargo.end())
-            it = m_cargo.insert(it, {item, 0});
-        it->second = updatedCargo;
+        slot = static_cast<std::uint32_t>(m_slots.size());
+        m_slots.emplace_back();
+    }
+    const auto index = size();
+    m_slots[slot].index = static_cast<std::uint32_t>(index);
+    const ShipHandle handle{slot, m_slots[slot].generation};
+
+    handles.push_back(handle);
+    shipClasses.push_back(shipClass);
+    names.push_back(std::move(name));
+    states.push_back(Ship::State::Docked);
+    worlds.push_back(world);
+    positions.emplace_back(0.0);
+    missionPlans.emplace_back();
+    missionSerials.push_back(0);
+    transitAnomalies.emplace_back();
+    currentStates.emplace_back();
+    m_cargo.resize(m_cargo.size() + m_cargoItems.size(), 0);
+    m_cargoTotals.push_back(0);
+    return handle;
+}
+
+void ShipStore::remove(ShipHandle handle)
+{
+    assert(contains(handle));
+    const auto index = this->index(handle);
+    const auto last = size() - 1;
+    if (index != last)
+    {
+        // the last ship takes the place of the removed one
+        const auto moved = handles[last];
+        handles[index] = moved;
+        shipClasses[index] = shipClasses[last];
+        names[index] = std::move(names[last]);
+        states[index] = states[last];
+        worlds[index] = worlds[last];
+        positions[index] = positions[last];
+        missionPlans[index] = std::move(missionPlans[last]);
+        missionSerials[index] = missionSerials[last];
+        transitAnomalies[index] = transitAnomalies[last];
+        currentStates[index] = currentStates[last];
+        const auto rowSize = m_cargoItems.size();
+        std::ranges::copy(cargo(last), m_cargo.begin() + index * rowSize);
+        m_cargoTotals[index] = m_cargoTotals[last];
+        m_slots[moved.slot].index = static_cast<std::uint32_t>(index);
     }
-    cargoChangedSignal(item);
+    handles.pop_back();
+    shipClasses.pop_back();
+    names.pop_back();
+    states.pop_back();
+    worlds.pop_back();
+    positions.pop_back();
+    missionPlans.pop_back();
+    missionSerials.pop_back();
+    transitAnomalies.pop_back();
+    currentStates.pop_back();
+    m_cargo.resize(m_cargo.size() - m_cargoItems.size());
+    m_cargoTotals.pop_back();
+
+    auto &slot = m_slots[handle.slot];
+    slot.index = kFreeSlot;
+    ++slot.generation;
+    m_freeSlots.push_back(handle.slot);
 }
 
-void Ship::update()
+void ShipStore::reserve(std::size_t count)
 {
-    const auto date = m_universe->date();
+    handles.reserve(count);
+    shipClasses.reserve(count);
+    names.reserve(count);
+    states.reserve(count);
+    worlds.reserve(count);
+    positions.reserve(count);
+    missionPlans.reserve(count);
+    missionSerials.reserve(count);
+    transitAnomalies.reserve(count);
+    currentStates.reserve(count);
+    m_cargo.reserve(count * m_cargoItems.size());
+    m_cargoTotals.reserve(count);
+    m_slots.reserve(count);
+    m_freeSlots.reserve(count);
+}
+
+bool ShipStore::contains(ShipHandle handle) const
+{
+    return handle.slot < m_slots.size() && m_slots[handle.slot].index != kFreeSlot &&
+           m_slots[handle.slot].generation == handle.generation;
+}
+
+void ShipStore::setCargoItems(std::vector<const MarketItem *> items)
+{
+    assert(size() == 0);
+    assert(std::ranges::all_of(std::views::iota(std::size_t{0}, items.size()),
+                               [&items](std::size_t column) { return items[column]->id == column; }));
+    m_cargoItems = std::move(items);
+}
+
+std::span<const int> ShipStore::cargo(std::size_t index) const
+{
+    return std::span{m_cargo}.subspan(index * m_cargoItems.size(), m_cargoItems.size());
+}
+
+void ShipStore::setCargo(std::size_t index, std::uint32_t item, int count)
+{
+    auto &cargo = m_cargo[index * m_cargoItems.size() + item];
+    m_cargoTotals[index] += count - cargo;
+    cargo = count;
+}
 
-    // update state
+void ShipStore::setCargo(std::size_t index, std::span<const int> counts)
+{
+    assert(counts.size() == m_cargoItems.size());
+    std::ranges::copy(counts, m_cargo.begin() + index * m_cargoItems.size());
+    m_cargoTotals[index] = std::ranges::fold_left(counts, 0, std::plus{});
+}
 
-    switch (m_state)
+Universe::Universe()
+{
+    // Worlds and ships don't depend on each other, docked ships read the positions of their worlds when asked for them.
+    // Ships in transit are the ones left after the departures and arrivals. The market depends on neither.
+    m_updateGraph.add([this] { updateWorlds(); });
+    const auto shipEvents = m_updateGraph.add([this] { applyShipEvents(); });
+    m_updateGraph.add([this] { updateShipsInTransit(); }, {shipEvents});
+    m_updateGraph.add([this] { updateMarket(); });
+}
+
+void Universe::setDate(JulianDate date)
+{
+    if (date == m_date)
+        return;
+    m_date = date;
+    m_marketDate = date; // the market isn't simulated across jumps
+    dateChangedSignal(m_date);
+}
+
+void Universe::update(Seconds elapsed)
+{
+    const auto previousDate = m_date;
+    m_date = m_date + elapsed;
+
+    m_updateGraph.run(m_threadPool);
+
+    // signalled last, on the calling thread, once everything is up to date; the handlers may add or remove ships
+    if (m_date != previousDate)
+        dateChangedSignal(m_date);
+    if (m_marketPricesChanged)
+        marketPricesChangedSignal();
+    for (const auto &[handle, state] : m_stateChanges)
     {
-    case State::Docked: {
-        assert(m_world != nullptr);
-        if (m_missionPlan.has_value() && m_missionPlan->departureDate < date && date < m_missionPlan->arrivalDate)
+        if (auto *ship = this->ship(handle))
+            shipStateChangedSignal(ship, state);
+    }
+}
+
+void Universe::updateWorlds()
+{
+    const Ephemeris::Output worldOutput{.positions = m_worldPositions,
+                                        .positionsOnOrbitPlane = m_worldPositionsOnOrbitPlane};
+    if (m_propagation == Propagation::Incremental)
+    {
+        m_worldPropagator.advance(m_date, worldOutput);
+    }
+    else
+    {
+        updateEphemerisCache();
+        m_ephemerisCache.compute(m_date, worldOutput);
+    }
+}
+
+void Universe::updateEphemerisCache()
+{
+    // the positions always come from a fit, whatever the number of threads and however far the one made ahead got
+    if (!m_ephemerisCache.covers(m_date))
+    {
+        if (m_nextEphemerisCache && m_nextEphemerisCache->begin <= m_date &&
+            m_date <= m_nextEphemerisCache->begin + kEphemerisCacheSpan)
         {
-            assert(m_world == m_missionPlan->origin); // sanity check
-            // started mission
-            m_world = nullptr;
-            setState(State::InTransit);
+            // caught up with the fit made ahead, which is helped with if it isn't done yet
+            auto &fit = *m_nextEphemerisCache;
+            const auto done = [&fit] { return fit.done.load(std::memory_order_acquire); };
+            if (fit.threadPool)
+                fit.threadPool->waitUntil(fit.group, done);
+            m_ephemerisCache = std::move(fit.ephemeris);
         }
-        break;
-    }
-    case State::InTransit: {
-        assert(m_missionPlan.has_value());
-        if (m_missionPlan->arrivalDate < date)
+        else
         {
-            // arrived at destination
-            m_world = m_missionPlan->destination;
-            m_missionPlan.reset();
-            setState(State::Docked);
+            // after a jump, a fit takes well under a millisecond
+            m_ephemerisCache = ChebyshevEphemeris(m_ephemeris, m_date, m_date + kEphemerisCacheSpan, {});
         }
-        break;
+        m_nextEphemerisCache.reset();
     }
+    else if (!m_nextEphemerisCache && m_date - m_ephemerisCache.begin() >= kEphemerisCacheSpan / 2)
+    {
+        fitEphemerisCache(m_ephemerisCache.end());
     }
+}
 
-    // update position
-
-    switch (m_state)
+void Universe::fitEphemerisCache(JulianDate begin)
+{
+    // inline without a thread pool, like any other task
+    auto fit = std::make_shared<EphemerisFit>();
+    fit->begin = begin;
+    fit->threadPool = m_threadPool;
+    m_nextEphemerisCache = fit;
+    const auto task = [fit, ephemeris = m_ephemeris, begin] {
+        fit->ephemeris = ChebyshevEphemeris(ephemeris, begin, begin + kEphemerisCacheSpan, {});
+        fit->done.store(true, std::memory_order_release);
+    };
+    if (m_threadPool)
     {
-    case State::Docked: {
-        assert(m_world != nullptr);
-        m_currentPosition = m_world->currentPosition();
-        break;
+        fit->group = m_threadPool->createGroup();
+        m_threadPool->submit(task, fit->group);
     }
-    case State::InTransit: {
-        assert(m_missionPlan.has_value());
-        m_currentPosition = m_missionPlan->orbit.position(date);
-        break;
+    else
+    {
+        task();
     }
+}
+
+void Universe::updateMarket()
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    // ticks of fixed length whatever the length of the updates, several per update at high time warp
+    const auto tickLength = JulianDays{m_marketEconomy.settings().tickLength};
+    m_marketPricesChanged = false;
+    while (m_marketDate + tickLength <= m_date)
+    {
+        m_marketEconomy.tick(m_threadPool);
+        m_marketDate = m_marketDate + tickLength;
+        m_marketPricesChanged = true;
     }
+    if (m_marketPricesChanged)
+        writeMarketPrices();
+    m_marketUpdateTime += std::chrono::steady_clock::now() - start;
 }
 
-const World *Ship::world() const
+void Universe::applyShipEvents()
 {
-    if (m_state != State::Docked)
-        return nullptr;
-    assert(m_world != nullptr);
-    return m_world;
+    // start and end the missions that are due, in date order, so that a step can take a ship through both
+    m_stateChanges.clear();
+    m_shipEvents.popDue(m_date, [this](JulianDate, const ShipEvent &event) { applyShipEvent(event); });
 }
 
-const Orbit *Ship::orbit() const
+void Universe::updateShipsInTransit()
 {
-    if (m_state != State::InTransit)
-        return nullptr;
-    assert(m_missionPlan.has_value());
-    return &m_missionPlan->orbit;
+    auto &ships = m_ships;
+
+    // batched; the ones that arrived or were removed are dropped here rather than one at a time
+    std::erase_if(m_shipsInTransit, [&ships](ShipHandle handle) {
+        return !ships.contains(handle) || ships.states[ships.index(handle)] != Ship::State::InTransit;
+    });
+    m_transitShips.clear();
+    for (const auto handle : m_shipsInTransit)
+        m_transitShips.push_back(ships.index(handle));
+    const auto transitOrbit = [&ships](std::size_t i) -> const Orbit & { return ships.missionPlans[i]->orbit; };
+    m_transitPositions.resize(m_transitShips.size());
+    if (m_propagation == Propagation::Incremental)
+    {
+        // the propagator keeps the states of the previous update, so it's only rebuilt when the orbits change
+        const auto sameOrbits = std::ranges::equal(m_transitShips, m_transitOrbits, {}, [&](std::size_t i) {
+            return transitOrbit(i).elements();
+        });
+        if (!sameOrbits)
+        {
+            m_transitPropagator.clear();
+            m_transitOrbits.clear();
+            for (const auto i : m_transitShips)
+            {
+                m_transitPropagator.add(transitOrbit(i));
+                m_transitOrbits.push_back(transitOrbit(i).elements());
+            }
+        }
+        m_transitPropagator.advance(m_date, {.positions = m_transitPositions}, m_threadPool);
+    }
+    else
+    {
+        // ships in transit come and go as their mission plans start and end, so their ephemeris is simply rebuilt
+        m_transitEphemeris.clear();
+        for (const auto i : m_transitShips)
+            m_transitEphemeris.add(transitOrbit(i));
+        m_transitEphemeris.compute(m_date, {.positions = m_transitPositions}, m_threadPool);
+    }
+    for (std::size_t k = 0; k < m_transitShips.size(); ++k)
+        ships.positions[m_transitShips[k]] = m_transitPositions[k];
 }
 
-void Ship::setState(State state)
+void Universe::applyShipEvent(const ShipEvent &event)
 {
-    if (state == m_state)
+    auto &ships = m_ships;
+    if (!ships.contains(event.ship))
         return;
-    m_state = state;
-    stateChangedSignal(m_state);
+    const auto i = ships.index(event.ship);
+    if (ships.missionSerials[i] != event.missionSerial)
+        return; // the mission plan was replaced since
+    auto &plan = ships.missionPlans[i];
+    assert(plan.has_value());
+    switch (event.kind)
+    {
+    case ShipEvent::Kind::Departure:
+        if (ships.states[i] != Ship::State::Docked)
+            return;
+        assert(ships.worlds[i] == plan->origin); // sanity check
+        ships.worlds[i] = nullptr;
+        ships.states[i] = Ship::State::InTransit;
+        m_shipsInTransit.push_back(event.ship);
+        break;
+    case ShipEvent::Kind::Arrival:
+        if (ships.states[i] != Ship::State::InTransit)
+            return;
+        ships.worlds[i] = plan->destination;
+        plan.reset();
+        ships.states[i] = Ship::State::Docked;
+        break;
+    }
+    m_stateChanges.push_back({event.ship, ships.states[i]});
 }
 
-Universe::Universe() = default;
-
-void Universe::setDate(JulianDate date)
+Ship *Universe::ship(ShipHandle handle) const
 {
-    if (date == m_date)
-        return;
-    m_date = date;
-    dateChangedSignal(m_date);
+    return m_ships.contains(handle) ? &m_shipViews[handle.slot] : nullptr;
 }
 
-void Universe::update(Seconds elapsed)
+Ship *Universe::addShip(const ShipClass *shipClass, const World *world, std::string_view name)
 {
-    setDate(m_date + elapsed);
+    const auto handle = m_ships.add(shipClass, world, std::string{name});
+    while (m_shipViews.size() < m_ships.slotCount())
+        m_shipViews.emplace_back(this, static_cast<std::uint32_t>(m_shipViews.size()));
 
-    for (auto &world : m_worlds)
-        world->update();
+    // random cargo to start with
+    const auto index = m_ships.index(handle);
+    const auto capacity = static_cast<int>(shipClass->cargoCapacity);
+    for (std::uint32_t item = 0; item < m_ships.cargoItems().size(); ++item)
+    {
+        if ((m_random() % 2) == 0)
+            m_ships.setCargo(index, item, std::min(static_cast<int>(m_random() % 10), capacity));
+    }
 
-    for (auto &ship : m_ships)
-        ship->update();
+    auto *ship = &m_shipViews[handle.slot];
+    shipAddedSignal(ship);
+    return ship;
 }
 
-Ship *Universe::addShip(const ShipClass *shipClass, const World *world, std::string_view name)
+void Universe::removeShip(Ship *ship)
 {
-    auto &ship = m_ships.emplace_back(std::make_unique<Ship>(this, shipClass, world));
-    ship->name = name;
-    shipAddedSignal(ship.get());
-    return ship.get();
+    shipAboutToBeRemovedSignal(ship);
+    m_ships.remove(ship->handle());
 }
 
 bool Universe::load(const std::string &path)
+{
+    if (const auto compiledPath = compiledAssetPath(path); isCompiledAssetCurrent(path, compiledPath))
+    {
+        const MappedFile file(compiledPath);
+        if (file.isValid() && UniverseAsset::load(*this, file.data()))
+            return true;
+    }
+    return loadJson(path);
+}
+
+bool Universe::loadJson(const std::string &path)
 {
     const auto jsonData = readFile(path);
     if (jsonData.empty())
@@ -479,6 +839,8 @@ bool Universe::load(const std::string &path)
         }
     }
 
+    initializeMarket();
+
     // worlds
     for (const nlohmann::json &worldJson : json.at("worlds"))
     {
@@ -489,7 +851,7 @@ bool Universe::load(const std::string &path)
         auto marketName = worldJson.at("market").get<std::string>();
         auto orbit = worldJson.at("orbit").get<OrbitalElements>();
         auto texture = worldJson.at("texture").get<std::string>();
-        auto &world = m_worlds.emplace_back(std::make_unique<World>(this, orbit));
+        auto &world = m_worlds.emplace_back(std::make_unique<World>(this, m_worlds.size(), orbit));
         world->name = std::move(name);
         world->radius = radius;
         world->rotationPeriod = rotationPeriod;
@@ -497,6 +859,50 @@ bool Universe::load(const std::string &path)
         world->marketName = std::move(marketName);
         world->diffuseTexture = std::move(texture);
     }
+    initializeWorlds();
+    initializeEconomy();
 
     return true;
 }
+
+void Universe::initializeMarket()
+{
+    std::vector<const MarketItem *> items;
+    for (const auto &sector : m_marketSectors)
+    {
+        for (const auto &item : sector->items)
+        {
+            item->id = static_cast<std::uint32_t>(items.size());
+            items.push_back(item.get());
+        }
+    }
+    m_ships.setCargoItems(std::move(items));
+}
+
+void Universe::initializeWorlds()
+{
+    for (const auto &world : m_worlds)
+    {
+        m_ephemeris.add(world->orbit());
+        m_worldPropagator.add(world->orbit());
+    }
+    m_worldPositions.resize(m_worlds.size());
+    m_worldPositionsOnOrbitPlane.resize(m_worlds.size());
+    m_ephemerisCache = {};
+    m_nextEphemerisCache.reset();
+    m_marketPrices.resize(m_worlds.size(), marketItems().size());
+}
+
+void Universe::initializeEconomy()
+{
+    // seeded by the universe, see setRandomSeed
+    m_marketEconomy.reset(m_worlds.size(), marketItems().size(), m_random());
+    m_marketDate = m_date;
+    writeMarketPrices();
+}
+
+void Universe::writeMarketPrices()
+{
+    for (std::size_t world = 0; world < m_worlds.size(); ++world)
+        m_marketEconomy.writePrices(world, m_marketPrices.sellPrices(world), m_marketPrices.buyPrices(world));
+}
@@ -1,18 +1,30 @@
 #pragma once
 
+#include "chebyshev_ephemeris.h"
+#include "ephemeris.h"
+#include "event_queue.h"
+#include "kepler.h"
+#include "market_economy.h"
+#include "orbit_propagator.h"
 #include "orbital_elements.h"
 
-#include <base/window_base.h> // FIXME for Seconds, put it somewhere else
-#include <base/glhelpers.h>
+#include <base/duration.h>
+#include <base/task_graph.h>
 
 #include <muslots/muslots.h>
 
 #include <nlohmann/json.hpp>
 
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <random>
+
 struct MarketSector;
 
 struct MarketItem
 {
+    std::uint32_t id{0}; // index in Universe::marketItems(), assigned at load
     const MarketSector *sector{nullptr};
     std::string name;
     std::string description;
@@ -46,12 +58,25 @@ public:
     using StateVector2 = StateVector<2>;
     using StateVector3 = StateVector<3>;
 
+    // Everything that comes out of one solve of Kepler's equation.
+    struct State
+    {
+        double eccentricAnomaly; // hyperbolic anomaly if e >= 1
+        double trueAnomaly;
+        StateVector2 onOrbitPlane; // {AU, AU/day}
+        StateVector3 stateVector;  // {AU, AU/day}
+    };
+
     Orbit();
     explicit Orbit(const OrbitalElements &elems);
 
     void setElements(const OrbitalElements &elems);
     OrbitalElements elements() const { return m_elems; }
 
+    // Newton by default, Markley is as accurate and several times faster on eccentric orbits.
+    void setKeplerSolver(KeplerSolver solver) { m_keplerSolver = solver; }
+    KeplerSolver keplerSolver() const { return m_keplerSolver; }
+
     glm::dmat3 orbitRotationMatrix() const { return m_orbitRotationMatrix; }
     JulianDays period() const { return m_period; }
     double meanAnomaly(JulianDate when) const;      // radians
@@ -64,11 +89,15 @@ public:
     StateVector2 stateVectorOnOrbitPlane(JulianDate when) const; // {AU, AU/day}
     StateVector3 stateVector(JulianDate when) const;             // {AU, AU/day}
 
+    State state(JulianDate when) const;
+
 private:
+    StateVector2 stateVectorFromAnomaly(double anomaly) const;
     void updatePeriod();
     void updateOrbitRotationMatrix();
 
     OrbitalElements m_elems;
+    KeplerSolver m_keplerSolver{KeplerSolver::Newton};
     JulianDays m_period{0.0};
     glm::dmat3 m_orbitRotationMatrix;
 };
@@ -80,22 +109,53 @@ struct MarketItemPrice
     uint64_t buyPrice{0};  // 0: not bought
 };
 
+// Prices of the market items at every world, as worlds x items matrices: one row per world, in the order of
+// Universe::worlds(), indexed by MarketItem::id.
+class MarketPrices
+{
+public:
+    void resize(std::size_t worldCount, std::size_t itemCount); // all items not traded
+
+    std::size_t worldCount() const { return m_itemCount != 0 ? m_sellPrices.size() / m_itemCount : 0; }
+    std::size_t itemCount() const { return m_itemCount; }
+
+    std::span<std::uint64_t> sellPrices(std::size_t world);
+    std::span<const std::uint64_t> sellPrices(std::size_t world) const;
+    std::span<std::uint64_t> buyPrices(std::size_t world);
+    std::span<const std::uint64_t> buyPrices(std::size_t world) const;
+
+private:
+    std::size_t m_itemCount{0};
+    std::vector<std::uint64_t> m_sellPrices; // 0: not sold
+    std::vector<std::uint64_t> m_buyPrices;  // 0: not bought
+};
+
 class Universe;
+class ThreadPool;
 
 class World
 {
 public:
-    explicit World(const Universe *universe, const OrbitalElements &elems);
+    explicit World(const Universe *universe, std::size_t index, const OrbitalElements &elems);
 
     const Universe *universe() const { return m_universe; }
+    std::size_t index() const { return m_index; } // in Universe::worlds()
     const Orbit &orbit() const { return m_orbit; }
-    std::span<const MarketItemPrice> marketItemPrices() const { return m_marketItemPrices; }
-    const MarketItemPrice *findMarketItemPrice(const MarketItem *item) const;
 
-    void update();
+    // Rows of Universe::marketPrices(), indexed by MarketItem::id.
+    std::span<const std::uint64_t> sellPrices() const;
+    std::span<const std::uint64_t> buyPrices() const;
 
-    glm::dvec2 currentPositionOnOrbitPlane() const { return m_currentPositionOnOrbitPlane; }
-    glm::dvec3 currentPosition() const { return m_currentPosition; }
+    // The items traded here, in the order of their ids.
+    auto marketItemPrices() const;
+    std::optional<MarketItemPrice> findMarketItemPrice(const MarketItem *item) const; // if traded here
+
+    // updated by Universe::update
+    glm::dvec2 currentPositionOnOrbitPlane() const;
+    glm::dvec3 currentPosition() const;
+
+    // State of the orbit at the date of the universe, solved on first use at each date.
+    const Orbit::State &currentState() const;
 
     std::string name;
     double radius; // km
@@ -106,13 +166,10 @@ public:
 
 private:
     const Universe *m_universe{nullptr};
-    // TODO: replace this with std::unordered_map<const MarketItem *, Price>?
-    // TODO: change API to something like `std::optional<Price> price(const MarketItem *item) const`
-    // to make it easier to build the market snapshot table from World/Ship?
-    std::vector<MarketItemPrice> m_marketItemPrices;
+    std::size_t m_index{0};
     Orbit m_orbit;
-    glm::dvec2 m_currentPositionOnOrbitPlane;
-    glm::dvec3 m_currentPosition;
+    mutable Orbit::State m_currentState;
+    mutable std::optional<JulianDate> m_currentStateDate;
 };
 
 struct MissionPlan
@@ -128,6 +185,19 @@ struct MissionPlan
     JulianDays transitTime() const { return arrivalDate - departureDate; }
 };
 
+// Reference to a ship of a Universe that can outlive it: once the ship is removed, the generation of its slot is
+// bumped, so the handle stops resolving even after the slot is reused.
+struct ShipHandle
+{
+    std::uint32_t slot{0};
+    std::uint32_t generation{0};
+
+    bool operator==(const ShipHandle &other) const = default;
+};
+
+// View on a ship, whose data lives in the ShipStore of its universe. There's one view per slot of the store, at a
+// stable address, so that Ship pointers can be handed around like before; a pointer must be dropped when
+// Universe::shipAboutToBeRemovedSignal is emitted for it, use handle() to keep a reference that can go stale.
 class Ship
 {
 public:
@@ -137,24 +207,32 @@ public:
         InTransit
     };
 
-    explicit Ship(const Universe *universe, const ShipClass *shipClass, const World *initialWorld);
-    ~Ship();
+    explicit Ship(Universe *universe, std::uint32_t slot);
 
-    const Universe *universe() const { return m_universe; }
-    const ShipClass *shipClass() const { return m_shipClass; }
+    Universe *universe() const { return m_universe; }
+    ShipHandle handle() const;
+    const ShipClass *shipClass() const;
+    const std::string &name() const;
 
     const World *world() const; // if State == Docked
     const Orbit *orbit() const; // if State == InTransit
 
-    void update();
-
-    glm::dvec3 currentPosition() const { return m_currentPosition; }
-    State state() const { return m_state; }
+    glm::dvec3 currentPosition() const;
+    State state() const;
 
+    // Schedules the departure and the arrival of the mission, Universe::update applies them when they're due.
     void setMissionPlan(std::optional<MissionPlan> missionPlan);
     const std::optional<MissionPlan> &missionPlan() const;
 
-    int totalCargo() const;
+    // State of the transfer orbit of the mission plan at the date of the universe, solved on first use at each date.
+    // Only valid with a mission plan.
+    const Orbit::State &currentState() const;
+
+    // True anomalies of the transfer orbit at departure and arrival, solved when the mission plan is set.
+    double departureTrueAnomaly() const;
+    double arrivalTrueAnomaly() const;
+
+    int totalCargo() const; // cached
     int cargoCapacity() const;
 
     struct ItemCargo
@@ -163,48 +241,144 @@ public:
         int cargo;
     };
 
-    const auto cargo() const
-    {
-        return m_cargo | std::views::transform([](const auto &item) -> ItemCargo {
-                   return ItemCargo{item.first, item.second};
-               });
-    }
+    auto cargo() const;
+    std::span<const int> cargoCounts() const; // indexed by MarketItem::id
 
     int cargo(const MarketItem *item) const;
     void changeCargo(const MarketItem *item, int count);
 
-    muslots::Signal<State> stateChangedSignal;
-    muslots::Signal<const MarketItem *> cargoChangedSignal;
+private:
+    std::size_t index() const; // in the components of the ShipStore
 
-    std::string name;
+    Universe *m_universe{nullptr};
+    std::uint32_t m_slot{0};
+};
+
+// Ships in structure-of-arrays form. Each component is a dense array with one element per ship, so that updates go
+// through contiguous memory; removing a ship moves the last one into its place, and the slots of removed ships are
+// reused, so adding and removing ships doesn't allocate once the arrays have grown.
+class ShipStore
+{
+public:
+    // true anomalies of the transfer orbit of the mission plan
+    struct TransitAnomalies
+    {
+        double departure{0.0};
+        double arrival{0.0};
+    };
+
+    struct CachedState
+    {
+        Orbit::State state;
+        std::optional<JulianDate> date;
+    };
+
+    ShipHandle add(const ShipClass *shipClass, const World *world, std::string name);
+    void remove(ShipHandle handle);
+    void reserve(std::size_t count);
+
+    std::size_t size() const { return handles.size(); }
+    bool contains(ShipHandle handle) const;
+    std::size_t index(ShipHandle handle) const { return m_slots[handle.slot].index; } // of a valid handle
+    std::size_t slotIndex(std::uint32_t slot) const { return m_slots[slot].index; }   // of a used slot
+    std::size_t slotCount() const { return m_slots.size(); }
+
+    // The columns of the cargo rows, set before adding any ship: the market items, in the order of their ids.
+    void setCargoItems(std::vector<const MarketItem *> items);
+    std::span<const MarketItem *const> cargoItems() const { return m_cargoItems; }
+    std::span<const int> cargo(std::size_t index) const;
+    int cargoTotal(std::size_t index) const { return m_cargoTotals[index]; }
+    // Both keep the total up to date.
+    void setCargo(std::size_t index, std::uint32_t item, int count);
+    void setCargo(std::size_t index, std::span<const int> counts);
+
+    // Components, in dense order. Only add() and remove() change their size.
+    std::vector<ShipHandle> handles;
+    std::vector<const ShipClass *> shipClasses;
+    std::vector<std::string> names;
+    std::vector<Ship::State> states;
+    std::vector<const World *> worlds; // if docked
+    std::vector<glm::dvec3> positions; // AU, if in transit, updated by Universe::update
+    std::vector<std::optional<MissionPlan>> missionPlans;
+    std::vector<std::uint32_t> missionSerials; // bumped by Ship::setMissionPlan, events of older plans are dropped
+    std::vector<TransitAnomalies> transitAnomalies;
+    mutable std::vector<CachedState> currentStates; // of Ship::currentState
 
 private:
-    void setState(State state);
+    static constexpr auto kFreeSlot = std::numeric_limits<std::uint32_t>::max();
 
-    const Universe *m_universe{nullptr};
-    const ShipClass *m_shipClass{nullptr};
-    const World *m_world{nullptr};
-    State m_state{State::Docked};
-    std::optional<MissionPlan> m_missionPlan;
-    std::unordered_map<const MarketItem *, int> m_cargo;
-    glm::dvec3 m_currentPosition;
+    struct Slot
+    {
+        std::uint32_t index{kFreeSlot};
+        std::uint32_t generation{0};
+    };
+
+    std::vector<Slot> m_slots;
+    std::vector<std::uint32_t> m_freeSlots;
+    std::vector<const MarketItem *> m_cargoItems;
+    std::vector<int> m_cargo;       // one row of cargoItems().size() per ship
+    std::vector<int> m_cargoTotals; // sum of each row
 };
 
 struct Universe
 {
 public:
+    enum class Propagation
+    {
+        ClosedForm, // positions solved from the orbital elements at every update
+        Incremental // state vectors of the previous update advanced with OrbitPropagator, for small steps
+    };
+
     Universe();
 
+    // Loads the compiled asset next to the file if it's up to date (see compiled_assets.h), parses the JSON otherwise.
     bool load(const std::string &path);
+    // Parses the JSON, ignoring any compiled asset.
+    bool loadJson(const std::string &path);
 
     void setDate(JulianDate date);
     JulianDate date() const { return m_date; }
 
+    // Worlds and ships are updated on the thread pool, if any. The signals are emitted afterwards on the calling
+    // thread, in the order of the events that caused them, whatever the number of threads.
     void update(Seconds elapsed);
 
+    // Seeds the initial cargo of the ships and the economy, set before loading for reproducible runs.
+    void setRandomSeed(std::uint32_t seed) { m_random.seed(seed); }
+
+    void setThreadPool(ThreadPool *threadPool) { m_threadPool = threadPool; }
+    ThreadPool *threadPool() const { return m_threadPool; }
+
+    // Bodies positioned by the last update: the worlds and the ships in transit.
+    std::size_t updatedBodyCount() const { return m_worlds.size() + m_transitShips.size(); }
+
+    void setPropagation(Propagation propagation) { m_propagation = propagation; }
+    Propagation propagation() const { return m_propagation; }
+
+    // Bodies are the worlds, in the same order as worlds().
+    const Ephemeris &ephemeris() const { return m_ephemeris; }
+
     auto worlds() const { return m_worlds | std::views::transform(&std::unique_ptr<World>::get); }
 
-    auto ships() const { return m_ships | std::views::transform(&std::unique_ptr<Ship>::get); }
+    auto ships() const
+    {
+        return m_ships.handles |
+               std::views::transform([this](ShipHandle handle) { return &m_shipViews[handle.slot]; });
+    }
+
+    // nullptr if the ship was removed
+    Ship *ship(ShipHandle handle) const;
+
+    // For bulk access to the ships.
+    const ShipStore &shipStore() const { return m_ships; }
+
+    // In the order of their ids.
+    std::span<const MarketItem *const> marketItems() const { return m_ships.cargoItems(); }
+    const MarketPrices &marketPrices() const { return m_marketPrices; }
+    // Ticked by update, the prices are written out after the ticks.
+    const MarketEconomy &marketEconomy() const { return m_marketEconomy; }
+    // Wall time spent in the market node of the updates so far, ticks and prices.
+    Seconds marketUpdateTime() const { return m_marketUpdateTime; }
 
     auto marketSectors() const
     {
@@ -219,15 +393,113 @@ public:
     }
 
     Ship *addShip(const ShipClass *shipClass, const World *world, std::string_view name);
+    void removeShip(Ship *ship);
 
     muslots::Signal<JulianDate> dateChangedSignal;
     muslots::Signal<Ship *> shipAddedSignal;
     muslots::Signal<Ship *> shipAboutToBeRemovedSignal;
+    muslots::Signal<Ship *, Ship::State> shipStateChangedSignal;
+    muslots::Signal<Ship *, const MarketItem *> shipCargoChangedSignal;
+    muslots::Signal<> marketPricesChangedSignal;
 
 private:
+    friend class World;
+    friend class Ship;
+    friend class UniverseSnapshot;
+    friend class UniverseAsset;
+    friend class UniverseDefinitions;
+
+    struct ShipEvent
+    {
+        enum class Kind
+        {
+            Departure,
+            Arrival
+        };
+        Kind kind;
+        ShipHandle ship;
+        std::uint32_t missionSerial;
+    };
+
+    struct ShipStateChange
+    {
+        ShipHandle ship;
+        Ship::State state;
+    };
+
+    // Chebyshev fit of the worlds made on the thread pool, shared with the task so that it can outlive the universe.
+    struct EphemerisFit
+    {
+        JulianDate begin;
+        ThreadPool *threadPool{nullptr}; // running the fit, if any
+        std::uint64_t group{0};          // of the fit on the thread pool
+        ChebyshevEphemeris ephemeris;
+        std::atomic<bool> done{false};
+    };
+
+    void initializeMarket();
+    void initializeWorlds();
+    void initializeEconomy();
+    void writeMarketPrices();
+    void updateWorlds();
+    void updateEphemerisCache();
+    void fitEphemerisCache(JulianDate begin);
+    void updateMarket();
+    void applyShipEvents();
+    void updateShipsInTransit();
+    void applyShipEvent(const ShipEvent &event);
+
     JulianDate m_date{};
+    Propagation m_propagation{Propagation::ClosedForm};
+    ThreadPool *m_threadPool{nullptr};
+    TaskGraph m_updateGraph;
     std::vector<std::unique_ptr<MarketSector>> m_marketSectors;
     std::vector<std::unique_ptr<ShipClass>> m_shipClasses;
     std::vector<std::unique_ptr<World>> m_worlds;
-    std::vector<std::unique_ptr<Ship>> m_ships;
+    MarketPrices m_marketPrices;
+    MarketEconomy m_marketEconomy;
+    JulianDate m_marketDate{};         // of the last tick
+    bool m_marketPricesChanged{false}; // by the last update
+    Seconds m_marketUpdateTime{0.0};
+    ShipStore m_ships;
+    mutable std::deque<Ship> m_shipViews; // one per slot of m_ships, never moved
+    std::mt19937 m_random{std::random_device{}()};
+    EventQueue<ShipEvent> m_shipEvents;          // departures and arrivals of the mission plans
+    std::vector<ShipStateChange> m_stateChanges; // applied by applyShipEvents, in date order
+    std::vector<ShipHandle> m_shipsInTransit;    // in order of departure, cleaned up by updateShipsInTransit
+    Ephemeris m_ephemeris;
+    ChebyshevEphemeris m_ephemerisCache;               // replaced by the next fit when the date leaves it
+    std::shared_ptr<EphemerisFit> m_nextEphemerisCache; // of the span after it
+    OrbitPropagator m_worldPropagator;
+    std::vector<glm::dvec3> m_worldPositions;
+    std::vector<glm::dvec2> m_worldPositionsOnOrbitPlane;
+    Ephemeris m_transitEphemeris;
+    OrbitPropagator m_transitPropagator;
+    std::vector<OrbitalElements> m_transitOrbits; // of m_transitPropagator
+    std::vector<std::size_t> m_transitShips;     // indices in m_ships of m_shipsInTransit
+    std::vector<glm::dvec3> m_transitPositions;
 };
+
+inline auto World::marketItemPrices() const
+{
+    const auto items = m_universe->marketItems();
+    const auto sellPrices = this->sellPrices();
+    const auto buyPrices = this->buyPrices();
+    return std::views::iota(std::size_t{0}, items.size()) |
+           std::views::filter([sellPrices, buyPrices](std::size_t item) {
+               return sellPrices[item] != 0 || buyPrices[item] != 0;
+           }) |
+           std::views::transform([items, sellPrices, buyPrices](std::size_t item) {
+               return MarketItemPrice{items[item], sellPrices[item], buyPrices[item]};
+           });
+}
+
+inline auto Ship::cargo() const
+{
+    const auto &ships = m_universe->m_ships;
+    const auto row = ships.cargo(index());
+    const auto items = ships.cargoItems();
+    return std::views::iota(std::size_t{0}, row.size()) |
+           std::views::filter([row](std::size_t column) { return row[column] != 0; }) |
+           std::views::transform([row, items](std::size_t column) { return ItemCargo{items[column], row[column]}; });
+}
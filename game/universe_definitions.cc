@@ -0,0 +1,163 @@
+#include "universe_definitions.h"
+
+#include "universe.h"
+
+#include <memory>
+
+namespace
+{
+
+using Section = UniverseDefinitions::Section;
+
+template<typename Record, typename Byte>
+auto records(std::span<Byte> data, std::span<const SectionRange> sections, Section section)
+{
+    return sectionRecords<Record>(data, sections[section]);
+}
+
+} // namespace
+
+void UniverseDefinitions::countRecords(const Universe &universe, std::span<SectionRange> sections)
+{
+    const auto items = universe.m_ships.cargoItems();
+
+    sections[ShipClasses].count = universe.m_shipClasses.size();
+    sections[MarketSectors].count = universe.m_marketSectors.size();
+    sections[MarketItems].count = items.size();
+    sections[Worlds].count = universe.m_worlds.size();
+    sections[Strings].count = 0;
+    for (const auto &shipClass : universe.m_shipClasses)
+        sections[Strings].count += shipClass->name.size() + shipClass->drive.size();
+    for (const auto &sector : universe.m_marketSectors)
+        sections[Strings].count += sector->name.size();
+    for (const auto *item : items)
+        sections[Strings].count += item->name.size() + item->description.size();
+    for (const auto &world : universe.m_worlds)
+        sections[Strings].count += world->name.size() + world->marketName.size() + world->diffuseTexture.size();
+}
+
+void UniverseDefinitions::write(const Universe &universe, std::span<std::byte> data,
+                                std::span<const SectionRange> sections, StringWriter &strings)
+{
+    const auto items = universe.m_ships.cargoItems();
+
+    const auto shipClassRecords = records<ShipClassRecord>(data, sections, ShipClasses);
+    for (std::size_t i = 0; const auto &shipClass : universe.m_shipClasses)
+    {
+        shipClassRecords[i++] = {.name = strings.add(shipClass->name),
+                                 .drive = strings.add(shipClass->drive),
+                                 .cargoCapacity = shipClass->cargoCapacity,
+                                 .specificImpulse = shipClass->specificImpulse,
+                                 .thrust = shipClass->thrust,
+                                 .power = shipClass->power};
+    }
+
+    const auto sectorRecords = records<MarketSectorRecord>(data, sections, MarketSectors);
+    for (std::size_t i = 0; const auto &sector : universe.m_marketSectors)
+    {
+        sectorRecords[i++] = {.name = strings.add(sector->name),
+                              .itemCount = static_cast<std::uint32_t>(sector->items.size()),
+                              .padding = 0};
+    }
+    const auto itemRecords = records<MarketItemRecord>(data, sections, MarketItems);
+    for (std::size_t i = 0; i < items.size(); ++i)
+        itemRecords[i] = {.name = strings.add(items[i]->name), .description = strings.add(items[i]->description)};
+
+    const auto worldRecords = records<WorldRecord>(data, sections, Worlds);
+    for (std::size_t i = 0; const auto &world : universe.m_worlds)
+    {
+        worldRecords[i++] = {.name = strings.add(world->name),
+                             .marketName = strings.add(world->marketName),
+                             .diffuseTexture = strings.add(world->diffuseTexture),
+                             .priceCount = 0,
+                             .padding = 0,
+                             .radius = world->radius,
+                             .rotationPeriod = world->rotationPeriod.count(),
+                             .axialTilt = world->axialTilt,
+                             .orbit = world->orbit().elements()};
+    }
+}
+
+bool UniverseDefinitions::validate(std::span<const std::byte> data, std::span<const SectionRange> sections)
+{
+    const StringReader strings(records<char>(data, sections, Strings));
+    const auto sectorRecords = records<MarketSectorRecord>(data, sections, MarketSectors);
+    const auto itemRecords = records<MarketItemRecord>(data, sections, MarketItems);
+
+    std::size_t itemCount = 0;
+    for (const auto &record : sectorRecords)
+        itemCount += record.itemCount;
+    if (itemCount != itemRecords.size())
+        return false;
+
+    const auto validString = [&strings](StringRef ref) { return strings.contains(ref); };
+    for (const auto &record : records<ShipClassRecord>(data, sections, ShipClasses))
+    {
+        if (!validString(record.name) || !validString(record.drive))
+            return false;
+    }
+    for (const auto &record : sectorRecords)
+    {
+        if (!validString(record.name))
+            return false;
+    }
+    for (const auto &record : itemRecords)
+    {
+        if (!validString(record.name) || !validString(record.description))
+            return false;
+    }
+    for (const auto &record : records<WorldRecord>(data, sections, Worlds))
+    {
+        if (!validString(record.name) || !validString(record.marketName) || !validString(record.diffuseTexture))
+            return false;
+    }
+    return true;
+}
+
+void UniverseDefinitions::read(Universe &universe, std::span<const std::byte> data,
+                               std::span<const SectionRange> sections)
+{
+    const StringReader strings(records<char>(data, sections, Strings));
+
+    for (const auto &record : records<ShipClassRecord>(data, sections, ShipClasses))
+    {
+        auto &shipClass = universe.m_shipClasses.emplace_back(std::make_unique<ShipClass>());
+        shipClass->name = strings.string(record.name);
+        shipClass->drive = strings.string(record.drive);
+        shipClass->cargoCapacity = record.cargoCapacity;
+        shipClass->specificImpulse = record.specificImpulse;
+        shipClass->thrust = record.thrust;
+        shipClass->power = record.power;
+    }
+
+    const auto itemRecords = records<MarketItemRecord>(data, sections, MarketItems);
+    for (auto itemRecord = itemRecords.begin();
+         const auto &record : records<MarketSectorRecord>(data, sections, MarketSectors))
+    {
+        auto &sector = universe.m_marketSectors.emplace_back(std::make_unique<MarketSector>());
+        sector->name = strings.string(record.name);
+        for (std::size_t i = 0; i < record.itemCount; ++i, ++itemRecord)
+        {
+            auto &item = sector->items.emplace_back(std::make_unique<MarketItem>());
+            item->sector = sector.get();
+            item->name = strings.string(itemRecord->name);
+            item->description = strings.string(itemRecord->description);
+        }
+    }
+    universe.initializeMarket();
+
+    const auto worldRecords = records<WorldRecord>(data, sections, Worlds);
+    universe.m_worlds.reserve(worldRecords.size());
+    for (const auto &record : worldRecords)
+    {
+        auto &world =
+            universe.m_worlds.emplace_back(std::make_unique<World>(&universe, universe.m_worlds.size(), record.orbit));
+        world->name = strings.string(record.name);
+        world->radius = record.radius;
+        world->rotationPeriod = JulianDays{record.rotationPeriod};
+        world->axialTilt = record.axialTilt;
+        world->marketName = strings.string(record.marketName);
+        world->diffuseTexture = strings.string(record.diffuseTexture);
+    }
+    universe.initializeWorlds();
+}
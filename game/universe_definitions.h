@@ -0,0 +1,88 @@
+#pragma once
+
+#include "binary_layout.h"
+#include "orbital_elements.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+struct Universe;
+
+// Records of the definitions of a universe, as in universe.json: ship classes, market and worlds. They're the first
+// sections of both the compiled universe asset and the universe snapshots, which only differ in what follows.
+
+struct ShipClassRecord
+{
+    StringRef name;
+    StringRef drive;
+    std::uint64_t cargoCapacity; // units
+    double specificImpulse;
+    double thrust;
+    double power;
+};
+
+struct MarketSectorRecord
+{
+    StringRef name;
+    std::uint32_t itemCount;
+    std::uint32_t padding;
+};
+
+struct MarketItemRecord
+{
+    StringRef name;
+    StringRef description;
+};
+
+struct WorldRecord
+{
+    StringRef name;
+    StringRef marketName;
+    StringRef diffuseTexture;
+    std::uint32_t priceCount; // of the market item prices stored after the definitions, if any
+    std::uint32_t padding;
+    double radius;
+    double rotationPeriod; // days
+    double axialTilt;      // radians
+    OrbitalElements orbit;
+};
+
+static_assert(std::is_trivially_copyable_v<OrbitalElements>);
+static_assert(std::is_trivially_copyable_v<WorldRecord> && alignof(WorldRecord) <= kSectionAlignment);
+
+class UniverseDefinitions
+{
+public:
+    // the first sections of the file, in this order
+    enum Section : std::size_t
+    {
+        Strings, // chars, the strings of the definitions first
+        ShipClasses,
+        MarketSectors,
+        MarketItems, // the items of each sector in turn
+        Worlds,
+        SectionCount
+    };
+
+    static constexpr std::array<std::size_t, SectionCount> kRecordSizes = {
+        sizeof(char), sizeof(ShipClassRecord), sizeof(MarketSectorRecord), sizeof(MarketItemRecord),
+        sizeof(WorldRecord)};
+
+    // Sets the record counts of the definition sections. Strings stored after the definitions are added on top.
+    static void countRecords(const Universe &universe, std::span<SectionRange> sections);
+
+    // Writes the records of the definitions, and their strings at the start of the string section. The price counts
+    // of the worlds are left at zero.
+    static void write(const Universe &universe, std::span<std::byte> data, std::span<const SectionRange> sections,
+                      StringWriter &strings);
+
+    // Whether the item counts of the sectors add up and every string is in the string section, in data whose layout
+    // was already checked.
+    static bool validate(std::span<const std::byte> data, std::span<const SectionRange> sections);
+
+    // Adds the definitions of valid data to a universe that has none, and initializes its market and worlds.
+    static void read(Universe &universe, std::span<const std::byte> data, std::span<const SectionRange> sections);
+};
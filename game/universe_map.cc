@@ -2,6 +2,7 @@
 
 #include "style_settings.h"
 #include "starfield.h"
+#include "starfield_renderer.h"
 
 #include <base/asset_path.h>
 #include <base/system.h>
@@ -21,6 +22,7 @@ namespace
 
 constexpr auto kZNear = 0.1f;
 constexpr auto kZFar = 100.0f;
+const auto kFieldOfView = glm::radians(45.0f); // vertical
 
 double scaledRadius(double radius)
 {
@@ -51,98 +53,6 @@ glm::vec3 latLonToCartesian(float lat, float lon)
     return {x, y, z};
 }
 
-std::unique_ptr<Mesh> createStarfieldMesh(const Starfield *starfield)
-{
-    constexpr auto kDistance = kZFar - 0.1f;
-
-    struct Vertex
-    {
-        glm::vec3 position;
-        glm::vec2 offs;
-        glm::vec4 color;
-    };
-
-    auto mesh = std::make_unique<Mesh>();
-
-    const auto &stars = starfield->stars;
-
-    constexpr auto kMinRadius = 0.04f;
-    constexpr auto kMaxRadius = 0.16f;
-
-    std::vector<Vertex> verts;
-    verts.reserve(stars.size() * 4);
-    for (const auto &star : stars)
-    {
-        const auto rightAscension = star.rightAscension;
-        const auto declination = star.declination;
-        const auto magnitude = std::clamp(star.apparentMagnitude, -1.5f, 10.0f);
-
-        const auto tint = [spectralClass = star.spectralClass]() -> glm::vec3 {
-            switch (spectralClass)
-            {
-            case Star::SpectralClass::O:
-                return glm::vec3{155, 176, 255}; // blue
-            case Star::SpectralClass::B:
-                return glm::vec3{170, 191, 255}; // blue-white
-            case Star::SpectralClass::A:
-                return glm::vec3{202, 215, 255}; // white
-            case Star::SpectralClass::F:
-                return glm::vec3{248, 247, 255}; // yellow-white
-            case Star::SpectralClass::G:
-                return glm::vec3{255, 244, 234}; // yellow
-            case Star::SpectralClass::K:
-                return glm::vec3{255, 210, 161}; // orange
-            case Star::SpectralClass::M:
-                return glm::vec3{255, 204, 111}; // red
-            }
-        }();
-        const auto color = glm::vec4{tint / 255.0f, 0.5f};
-
-        const auto x = std::cos(rightAscension) * std::cos(declination);
-        const auto y = std::sin(rightAscension) * std::cos(declination);
-        const auto z = std::sin(declination);
-        const auto direction = glm::vec3{x, y, z};
-
-        constexpr auto kUpVector = glm::vec3{0.0f, 0.0f, 1.0f};
-        const auto u = glm::normalize(glm::cross(direction, kUpVector));
-        const auto v = glm::normalize(glm::cross(u, direction));
-
-        const auto position = kDistance * direction;
-
-        const auto brightness = std::pow(10.0f, -0.4f * magnitude);
-        const auto brightnessNorm = brightness / std::pow(10.0f, -0.5f * -1.5f);
-        const auto radius = glm::mix(kMinRadius, kMaxRadius, brightnessNorm);
-
-        verts.push_back(Vertex{.position = position, .offs = glm::vec2{-radius, -radius}, .color = color});
-        verts.push_back(Vertex{.position = position, .offs = glm::vec2{-radius, radius}, .color = color});
-        verts.push_back(Vertex{.position = position, .offs = glm::vec2{radius, -radius}, .color = color});
-        verts.push_back(Vertex{.position = position, .offs = glm::vec2{radius, radius}, .color = color});
-    }
-    mesh->setVertexData(std::as_bytes(std::span{verts}), verts.size());
-
-    std::vector<uint32_t> indices;
-    indices.reserve(stars.size() * 6);
-    for (std::size_t i = 0; i < 4 * stars.size(); i += 4)
-    {
-        indices.push_back(i + 0);
-        indices.push_back(i + 1);
-        indices.push_back(i + 3);
-
-        indices.push_back(i + 3);
-        indices.push_back(i + 2);
-        indices.push_back(i + 0);
-    }
-    mesh->setIndexData(indices);
-
-    const std::array<Mesh::VertexAttribute, 3> attributes = {
-        Mesh::VertexAttribute{3, Mesh::Type::Float, offsetof(Vertex, position)},
-        Mesh::VertexAttribute{2, Mesh::Type::Float, offsetof(Vertex, offs)},
-        Mesh::VertexAttribute{4, Mesh::Type::Float, offsetof(Vertex, color)}};
-    mesh->setVertexAttributes(attributes, sizeof(Vertex));
-
-    return mesh;
-}
-
 std::unique_ptr<Mesh> createSphereMesh()
 {
     constexpr auto kRings = 30;
@@ -378,9 +288,7 @@ void ShipLabel::updateStateText()
         const auto eta = missionPlan->arrivalDate;
         m_etaText->setText(std::format("ETA {:D}", eta));
 
-        const auto *orbit = m_ship->orbit();
-        assert(orbit != nullptr);
-        const auto [_, velocity] = orbit->stateVector(m_ship->universe()->date());
+        const auto velocity = m_ship->currentState().stateVector.velocity;
         const auto speed = glm::length(velocity) * 1.496e+8 / (24 * 60 * 60);
         m_speedText->setText(std::format("{:.2f} km/s", speed));
     }
@@ -420,7 +328,7 @@ void UniverseMap::setViewportSize(const SizeI &size)
 {
     m_viewportSize = size;
     m_projectionMatrix =
-        glm::perspective(glm::radians(45.0f), static_cast<float>(size.width()) / size.height(), kZNear, kZFar);
+        glm::perspective(kFieldOfView, static_cast<float>(size.width()) / size.height(), kZNear, kZFar);
     m_cameraController.setViewportSize(size);
 }
 
@@ -450,21 +358,21 @@ void UniverseMap::render() const
         shaderManager->setUniform(ShaderManager::Uniform::ModelViewProjectionMatrix, mvp);
         shaderManager->setUniform(ShaderManager::Uniform::AspectRatio, static_cast<float>(m_viewportSize.width()) /
                                                                            static_cast<float>(m_viewportSize.height()));
-        m_starfieldMesh->draw(Mesh::Primitive::Triangles);
+        m_starfieldRenderer->render(mvp, kFieldOfView);
 
 #if 0
         const auto &font = g_styleSettings.smallFont;
         m_overlayPainter->setFont(font);
 
         // star labels
-        const auto &stars = m_starfield->stars;
-        for (const auto &star : stars)
+        for (std::size_t i = 0; i < m_starfield->size(); ++i)
         {
-            if (star.properName.empty())
+            const auto properName = m_starfield->properName(i);
+            if (properName.empty())
                 continue;
 
-            const auto rightAscension = star.rightAscension;
-            const auto declination = star.declination;
+            const auto rightAscension = m_starfield->rightAscensions()[i];
+            const auto declination = m_starfield->declinations()[i];
 
             const auto x = std::cos(rightAscension) * std::cos(declination);
             const auto y = std::sin(rightAscension) * std::cos(declination);
@@ -477,7 +385,7 @@ void UniverseMap::render() const
             {
                 glm::vec2 screenPosition = (glm::vec2{clipSpacePosition} * glm::vec2{0.5f, -0.5f} + glm::vec2{0.5f}) *
                                            glm::vec2{m_viewportSize.width(), m_viewportSize.height()};
-                m_overlayPainter->drawText(screenPosition, star.properName);
+                m_overlayPainter->drawText(screenPosition, properName);
             }
         }
 #endif
@@ -561,7 +469,7 @@ void UniverseMap::render() const
         if (const auto *orbit = ship->orbit())
         {
             constexpr auto kRadius = 0.025f;
-            const auto position = orbit->positionOnOrbitPlane(m_universe->date());
+            const auto position = ship->currentState().onOrbitPlane.position;
             const auto orbitRotation = glm::mat4{orbit->orbitRotationMatrix()};
             const auto translationMatrix = glm::translate(glm::mat4{1.0f}, glm::vec3{position, 0.0f});
             const auto scaleMatrix = glm::scale(glm::mat4{1.0f}, glm::vec3{kRadius});
@@ -598,7 +506,7 @@ void UniverseMap::render() const
     {
         const auto &orbit = world->orbit();
 
-        const auto currentAngle = orbit.eccentricAnomaly(m_universe->date());
+        const auto currentAngle = world->currentState().eccentricAnomaly;
 
         const auto elems = orbit.elements();
         const auto semiMajorAxis = elems.semiMajorAxis;
@@ -633,10 +541,10 @@ void UniverseMap::render() const
         {
             const auto &orbit = plan->orbit;
 
-            const auto startAngle = orbit.trueAnomaly(plan->departureDate);
+            const auto startAngle = ship->departureTrueAnomaly();
             const auto currentAngle =
-                m_universe->date() > plan->departureDate ? orbit.trueAnomaly(m_universe->date()) : startAngle;
-            const auto endAngle = orbit.trueAnomaly(plan->arrivalDate);
+                m_universe->date() > plan->departureDate ? ship->currentState().trueAnomaly : startAngle;
+            const auto endAngle = ship->arrivalTrueAnomaly();
 
             shaderManager->setUniform(ShaderManager::Uniform::Thickness,
                                       3.0f / static_cast<float>(m_viewportSize.height()));
@@ -680,12 +588,12 @@ void UniverseMap::render() const
 
 void UniverseMap::initializeStarfield()
 {
-    m_starfield->load(dataFilePath("stars.json"));
+    m_starfield->load(dataFilePath("stars.json"), m_universe->threadPool());
+    m_starfieldRenderer = std::make_unique<StarfieldRenderer>(*m_starfield);
 }
 
 void UniverseMap::initializeMeshes()
 {
-    m_starfieldMesh = createStarfieldMesh(m_starfield.get());
     m_sphereMesh = createSphereMesh();
     m_emptyVAO = std::make_unique<gl::VertexArray>();
 }
@@ -3,6 +3,7 @@
 #include "universe.h"
 #include "camera_controller.h"
 
+#include <base/glhelpers.h>
 #include <base/rect.h>
 #include <base/window_base.h>
 
@@ -15,6 +16,7 @@ class Mesh;
 class Painter;
 class MapLabel;
 class Starfield;
+class StarfieldRenderer;
 
 class UniverseMap
 {
@@ -52,7 +54,6 @@ private:
     Universe *m_universe{nullptr};
     Painter *m_overlayPainter;
     SizeI m_viewportSize;
-    std::unique_ptr<Mesh> m_starfieldMesh;
     std::unique_ptr<Mesh> m_sphereMesh;
     std::unique_ptr<gl::VertexArray> m_emptyVAO;
     glm::mat4 m_projectionMatrix;
@@ -61,4 +62,5 @@ private:
     std::vector<std::unique_ptr<MapLabel>> m_labels;
     std::vector<muslots::Connection> m_connections;
     std::unique_ptr<Starfield> m_starfield;
+    std::unique_ptr<StarfieldRenderer> m_starfieldRenderer;
 };
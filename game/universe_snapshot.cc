@@ -0,0 +1,367 @@
+#include "universe_snapshot.h"
+
+#include "binary_layout.h"
+#include "universe.h"
+#include "universe_definitions.h"
+
+#include <base/file.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace
+{
+
+// Bump when the layout of the header or of any record changes.
+constexpr std::uint32_t kFormatVersion = 2;
+
+constexpr std::array<char, 8> kMagic = {'S', 'D', 'U', 'N', 'I', 'V', 'R', 'S'};
+
+constexpr std::uint32_t kNone = std::numeric_limits<std::uint32_t>::max();
+
+// the definitions first, laid out by UniverseDefinitions
+enum Section : std::size_t
+{
+    Strings = UniverseDefinitions::Strings, // chars, the ship names after the strings of the definitions
+    ShipClasses = UniverseDefinitions::ShipClasses,
+    MarketSectors = UniverseDefinitions::MarketSectors,
+    MarketItems = UniverseDefinitions::MarketItems,
+    Worlds = UniverseDefinitions::Worlds,
+    MarketItemPrices = UniverseDefinitions::SectionCount, // the prices of each world in turn
+    Ships,
+    Cargo,   // int32, one row of MarketItems per ship
+    Economy, // floats, the components of the MarketEconomy in turn
+    SectionCount
+};
+
+struct FileHeader
+{
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t sectionCount;
+    std::uint64_t size; // bytes, of the whole snapshot
+    double date;        // Julian days
+    std::uint64_t economySeed;
+    std::uint64_t economyTickCount;
+    double marketDate; // Julian days, of the last tick of the economy
+    std::array<SectionRange, SectionCount> sections;
+};
+
+struct MarketItemPriceRecord
+{
+    std::uint32_t item; // in the order of the MarketItems section
+    std::uint32_t padding;
+    std::uint64_t sellPrice;
+    std::uint64_t buyPrice;
+};
+
+struct MissionPlanRecord
+{
+    std::uint32_t origin;
+    std::uint32_t destination;
+    double departureDate; // Julian days
+    double arrivalDate;   // Julian days
+    OrbitalElements orbit;
+    double deltaVDeparture;
+    double deltaVArrival;
+};
+
+struct ShipRecord
+{
+    StringRef name;
+    std::uint32_t shipClass;
+    std::uint32_t world; // kNone if in transit
+    std::uint8_t state;
+    std::uint8_t hasMissionPlan;
+    std::array<std::uint8_t, 6> padding;
+    MissionPlanRecord missionPlan;
+};
+
+template<Section section>
+struct SectionRecord;
+// clang-format off
+template<> struct SectionRecord<Strings> { using type = char; };
+template<> struct SectionRecord<ShipClasses> { using type = ShipClassRecord; };
+template<> struct SectionRecord<MarketSectors> { using type = MarketSectorRecord; };
+template<> struct SectionRecord<MarketItems> { using type = MarketItemRecord; };
+template<> struct SectionRecord<Worlds> { using type = WorldRecord; };
+template<> struct SectionRecord<MarketItemPrices> { using type = MarketItemPriceRecord; };
+template<> struct SectionRecord<Ships> { using type = ShipRecord; };
+template<> struct SectionRecord<Cargo> { using type = std::int32_t; };
+template<> struct SectionRecord<Economy> { using type = float; };
+// clang-format on
+
+constexpr std::array<std::size_t, SectionCount> kRecordSizes = {
+    sizeof(char),          sizeof(ShipClassRecord),       sizeof(MarketSectorRecord), sizeof(MarketItemRecord),
+    sizeof(WorldRecord),   sizeof(MarketItemPriceRecord), sizeof(ShipRecord),         sizeof(std::int32_t),
+    sizeof(float)};
+
+static_assert(std::is_trivially_copyable_v<ShipRecord> && alignof(ShipRecord) <= kSectionAlignment);
+
+template<Section section, typename Byte>
+auto records(std::span<Byte> data, const FileHeader &header)
+{
+    return sectionRecords<typename SectionRecord<section>::type>(data, header.sections[section]);
+}
+
+constexpr std::size_t kEconomyComponentCount = 5;
+
+// in the order of the Economy section, const or not
+template<typename MarketEconomyType>
+auto economyComponents(MarketEconomyType &economy)
+{
+    const auto components =
+        std::array{&economy.production, &economy.consumption, &economy.supply, &economy.demand, &economy.basePrices};
+    static_assert(std::tuple_size_v<decltype(components)> == kEconomyComponentCount);
+    return components;
+}
+
+double toDays(JulianDate date)
+{
+    return date.time_since_epoch().count();
+}
+
+JulianDate fromDays(double days)
+{
+    return JulianDate{JulianDays{days}};
+}
+
+} // namespace
+
+void UniverseSnapshot::capture(const Universe &universe, std::vector<std::byte> &buffer)
+{
+    const auto &ships = universe.m_ships;
+    const auto items = ships.cargoItems();
+    const auto &economy = universe.m_marketEconomy;
+
+    FileHeader header{.magic = kMagic,
+                      .version = kFormatVersion,
+                      .sectionCount = SectionCount,
+                      .size = 0,
+                      .date = toDays(universe.m_date),
+                      .economySeed = economy.seed(),
+                      .economyTickCount = economy.tickCount(),
+                      .marketDate = toDays(universe.m_marketDate),
+                      .sections = {}};
+    auto &sections = header.sections;
+    UniverseDefinitions::countRecords(universe, sections);
+    for (const auto &world : universe.m_worlds)
+        sections[MarketItemPrices].count += std::ranges::distance(world->marketItemPrices());
+    sections[Ships].count = ships.size();
+    sections[Cargo].count = ships.size() * items.size();
+    for (const auto *component : economyComponents(economy))
+        sections[Economy].count += component->size();
+    for (const auto &name : ships.names)
+        sections[Strings].count += name.size();
+
+    // The buffer keeps its size from one capture to the next, so it's not cleared: every record is written whole and
+    // only the padding between the sections is zeroed.
+    header.size = layoutSections(sizeof(FileHeader), header.sections, kRecordSizes);
+    buffer.resize(header.size);
+    const auto data = std::span{buffer};
+    std::memcpy(data.data(), &header, sizeof(header));
+    clearSectionPadding(data, header.sections, kRecordSizes);
+
+    StringWriter strings(records<Strings>(data, header));
+    UniverseDefinitions::write(universe, data, header.sections, strings);
+
+    std::unordered_map<const ShipClass *, std::uint32_t> shipClassIndices;
+    for (std::size_t i = 0; const auto &shipClass : universe.m_shipClasses)
+        shipClassIndices.emplace(shipClass.get(), static_cast<std::uint32_t>(i++));
+    const auto worldIndex = [](const World *world) { return static_cast<std::uint32_t>(world->index()); };
+
+    const auto worldRecords = records<Worlds>(data, header);
+    for (std::size_t i = 0, priceIndex = 0; const auto &world : universe.m_worlds)
+    {
+        auto prices = world->marketItemPrices();
+        worldRecords[i++].priceCount = static_cast<std::uint32_t>(std::ranges::distance(prices));
+        for (const auto &price : prices)
+        {
+            records<MarketItemPrices>(data, header)[priceIndex++] = {.item = price.item->id,
+                                                                     .padding = 0,
+                                                                     .sellPrice = price.sellPrice,
+                                                                     .buyPrice = price.buyPrice};
+        }
+    }
+
+    // the bulk of a large universe: one pass over the dense components of the ships
+    const auto shipRecords = records<Ships>(data, header);
+    for (std::size_t i = 0; i < ships.size(); ++i)
+    {
+        ShipRecord record{};
+        record.name = strings.add(ships.names[i]);
+        record.shipClass = shipClassIndices.at(ships.shipClasses[i]);
+        record.world = ships.worlds[i] ? worldIndex(ships.worlds[i]) : kNone;
+        record.state = static_cast<std::uint8_t>(ships.states[i]);
+        if (const auto &plan = ships.missionPlans[i]; plan.has_value())
+        {
+            record.hasMissionPlan = 1;
+            record.missionPlan = {.origin = worldIndex(plan->origin),
+                                  .destination = worldIndex(plan->destination),
+                                  .departureDate = toDays(plan->departureDate),
+                                  .arrivalDate = toDays(plan->arrivalDate),
+                                  .orbit = plan->orbit.elements(),
+                                  .deltaVDeparture = plan->deltaVDeparture,
+                                  .deltaVArrival = plan->deltaVArrival};
+        }
+        shipRecords[i] = record;
+    }
+    const auto cargo = records<Cargo>(data, header);
+    for (std::size_t i = 0; i < ships.size(); ++i)
+        std::ranges::copy(ships.cargo(i), cargo.begin() + i * items.size());
+    for (auto out = records<Economy>(data, header).begin(); const auto *component : economyComponents(economy))
+        out = std::ranges::copy(*component, out).out;
+    assert(strings.size() == header.sections[Strings].count);
+}
+
+bool UniverseSnapshot::restore(Universe &universe, std::span<const std::byte> data)
+{
+    if (!universe.m_worlds.empty() || !universe.m_marketSectors.empty() || universe.m_ships.size() != 0)
+        return false;
+
+    // layout first: everything below reads the records in place
+    if (data.size() < sizeof(FileHeader))
+        return false;
+    FileHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != kMagic || header.version != kFormatVersion || header.sectionCount != SectionCount ||
+        header.size != data.size() || !validSections(data, sizeof(FileHeader), header.sections, kRecordSizes))
+        return false;
+
+    const StringReader strings(records<Strings>(data, header));
+    const auto shipClassRecords = records<ShipClasses>(data, header);
+    const auto itemRecords = records<MarketItems>(data, header);
+    const auto worldRecords = records<Worlds>(data, header);
+    const auto priceRecords = records<MarketItemPrices>(data, header);
+    const auto shipRecords = records<Ships>(data, header);
+    const auto cargo = records<Cargo>(data, header);
+    const auto economy = records<Economy>(data, header);
+
+    std::size_t priceCount = 0;
+    for (const auto &record : worldRecords)
+        priceCount += record.priceCount;
+    if (priceCount != priceRecords.size() || cargo.size() != shipRecords.size() * itemRecords.size() ||
+        economy.size() != kEconomyComponentCount * worldRecords.size() * itemRecords.size())
+        return false;
+
+    // then the references between records, before the universe is touched
+    if (!UniverseDefinitions::validate(data, header.sections))
+        return false;
+    const auto validWorld = [&worldRecords](std::uint32_t world) { return world < worldRecords.size(); };
+    for (const auto &record : priceRecords)
+    {
+        if (record.item >= itemRecords.size())
+            return false;
+    }
+    for (const auto &record : shipRecords)
+    {
+        const auto state = static_cast<Ship::State>(record.state);
+        const auto &plan = record.missionPlan;
+        if (!strings.contains(record.name) || record.shipClass >= shipClassRecords.size() ||
+            (state != Ship::State::Docked && state != Ship::State::InTransit) ||
+            (state == Ship::State::Docked && !validWorld(record.world)) ||
+            (state == Ship::State::InTransit && !record.hasMissionPlan) ||
+            (record.hasMissionPlan && (!validWorld(plan.origin) || !validWorld(plan.destination))))
+            return false;
+    }
+
+    UniverseDefinitions::read(universe, data, header.sections);
+    for (std::size_t world = 0, priceIndex = 0; world < worldRecords.size(); ++world)
+    {
+        const auto sellPrices = universe.m_marketPrices.sellPrices(world);
+        const auto buyPrices = universe.m_marketPrices.buyPrices(world);
+        const auto count = worldRecords[world].priceCount;
+        for (const auto &price : priceRecords.subspan(priceIndex, count))
+        {
+            sellPrices[price.item] = price.sellPrice;
+            buyPrices[price.item] = price.buyPrice;
+        }
+        priceIndex += count;
+    }
+    auto &marketEconomy = universe.m_marketEconomy;
+    marketEconomy.resize(worldRecords.size(), itemRecords.size(), header.economySeed, header.economyTickCount);
+    for (auto in = economy.begin(); auto *component : economyComponents(marketEconomy))
+    {
+        std::copy_n(in, component->size(), component->begin());
+        in += component->size();
+    }
+    universe.setDate(fromDays(header.date));
+    universe.m_marketDate = fromDays(header.marketDate);
+
+    auto &ships = universe.m_ships;
+    const auto worlds = universe.worlds();
+    ships.reserve(shipRecords.size());
+    for (std::size_t i = 0; i < shipRecords.size(); ++i)
+    {
+        const auto &record = shipRecords[i];
+        const auto docked = static_cast<Ship::State>(record.state) == Ship::State::Docked;
+        const auto *world = docked ? worlds[record.world] : nullptr;
+        ships.add(universe.m_shipClasses[record.shipClass].get(), world, strings.string(record.name));
+        ships.setCargo(i, cargo.subspan(i * itemRecords.size(), itemRecords.size()));
+    }
+    while (universe.m_shipViews.size() < ships.slotCount())
+        universe.m_shipViews.emplace_back(&universe, static_cast<std::uint32_t>(universe.m_shipViews.size()));
+
+    // mission plans last, they schedule the events of the ships
+    for (std::size_t i = 0; i < shipRecords.size(); ++i)
+    {
+        const auto &record = shipRecords[i];
+        const auto handle = ships.handles[i];
+        if (record.hasMissionPlan)
+        {
+            const auto &plan = record.missionPlan;
+            universe.m_shipViews[handle.slot].setMissionPlan(
+                MissionPlan{.origin = worlds[plan.origin],
+                            .destination = worlds[plan.destination],
+                            .departureDate = fromDays(plan.departureDate),
+                            .arrivalDate = fromDays(plan.arrivalDate),
+                            .orbit = Orbit(plan.orbit),
+                            .deltaVDeparture = plan.deltaVDeparture,
+                            .deltaVArrival = plan.deltaVArrival});
+        }
+        if (static_cast<Ship::State>(record.state) == Ship::State::InTransit)
+        {
+            ships.states[i] = Ship::State::InTransit;
+            ships.worlds[i] = nullptr;
+            universe.m_shipsInTransit.push_back(handle);
+        }
+    }
+
+    return true;
+}
+
+bool UniverseSnapshot::save(const Universe &universe, const std::string &path)
+{
+    std::vector<std::byte> buffer;
+    capture(universe, buffer);
+    return writeFile(path, buffer);
+}
+
+bool UniverseSnapshot::load(Universe &universe, const std::string &path)
+{
+    const MappedFile file(path);
+    return file.isValid() && restore(universe, file.data());
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    wait();
+}
+
+void SnapshotWriter::checkpoint(const Universe &universe, std::string path)
+{
+    wait();
+    UniverseSnapshot::capture(universe, m_buffer);
+    m_writer = std::jthread([this, path = std::move(path)] { m_written = writeFile(path, m_buffer); });
+}
+
+bool SnapshotWriter::wait()
+{
+    if (m_writer.joinable())
+        m_writer.join();
+    return m_written;
+}
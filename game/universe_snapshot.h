@@ -0,0 +1,52 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Universe;
+
+// Binary snapshot of the whole state of a universe: date, ship classes, market, worlds and their prices, economy,
+// ships with their cargo and mission plans. Sections of fixed-size records at aligned offsets, plus a table for the
+// strings, so that a memory-mapped file is checked by its header and section bounds and then read in place. Native
+// byte order.
+class UniverseSnapshot
+{
+public:
+    // Serializes the universe into `buffer`, whose memory is reused from one capture to the next.
+    static void capture(const Universe &universe, std::vector<std::byte> &buffer);
+
+    // Restores a snapshot into a universe that wasn't loaded yet. Returns false if the data isn't a valid snapshot,
+    // in which case the universe is left untouched.
+    static bool restore(Universe &universe, std::span<const std::byte> data);
+
+    static bool save(const Universe &universe, const std::string &path);
+    static bool load(Universe &universe, const std::string &path);
+};
+
+// Checkpoints a universe regularly: the snapshot is captured on the calling thread and written to disk on a background
+// thread, so a checkpoint only costs the frame its capture. A checkpoint taken while the previous one is still being
+// written waits for it.
+class SnapshotWriter
+{
+public:
+    SnapshotWriter() = default;
+    ~SnapshotWriter();
+
+    SnapshotWriter(SnapshotWriter &&) = delete;
+    SnapshotWriter &operator=(SnapshotWriter &&) = delete;
+
+    SnapshotWriter(const SnapshotWriter &) = delete;
+    SnapshotWriter &operator=(const SnapshotWriter &) = delete;
+
+    void checkpoint(const Universe &universe, std::string path);
+
+    // Waits for the last checkpoint to be written, returns whether it was.
+    bool wait();
+
+private:
+    std::vector<std::byte> m_buffer;
+    std::jthread m_writer;
+    bool m_written{true};
+};
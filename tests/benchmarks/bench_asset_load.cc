@@ -0,0 +1,140 @@
+#include "bench_util.h"
+
+#include <game/compiled_assets.h>
+#include <game/starfield.h>
+#include <game/universe.h>
+
+#include <base/arg_parser.h>
+#include <base/asset_path.h>
+#include <base/file.h>
+
+#include <nlohmann/json.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <print>
+#include <type_traits>
+
+namespace
+{
+
+// Evicts the file from the page cache, so that the next load reads it from the disk.
+void dropFromPageCache(const std::string &path)
+{
+    const auto fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+// measureSeconds, with the file dropped from the page cache before each call if `cold`
+template<typename Func>
+double measureLoadSeconds(int iterations, const std::string &path, bool cold, Func &&func)
+{
+    double seconds = 0.0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        if (cold)
+            dropFromPageCache(path);
+        seconds += measureSeconds(1, func);
+    }
+    return seconds / iterations;
+}
+
+// The entries of the array, repeated until there are `count` of them, renamed so that the strings don't repeat.
+nlohmann::json repeat(const nlohmann::json &entries, std::size_t count, const char *nameKey)
+{
+    auto result = nlohmann::json::array();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto entry = entries[i % entries.size()];
+        if (i >= entries.size())
+            entry[nameKey] = std::format("{} {}", entry[nameKey].get<std::string>(), i / entries.size());
+        result.push_back(std::move(entry));
+    }
+    return result;
+}
+
+void writeJson(const std::string &path, const nlohmann::json &json)
+{
+    std::ofstream(path) << json;
+}
+
+template<typename Asset, typename T>
+void benchmark(const char *name, const std::string &jsonPath, int iterations)
+{
+    const auto compiledPath = compiledAssetPath(jsonPath);
+    {
+        T value;
+        value.loadJson(jsonPath);
+        writeFile(compiledPath, Asset::compile(value));
+    }
+    for (const auto cold : {true, false})
+    {
+        const auto jsonSeconds = measureLoadSeconds(iterations, jsonPath, cold, [&] {
+            T value;
+            value.loadJson(jsonPath);
+        });
+        const auto compiledSeconds = measureLoadSeconds(iterations, compiledPath, cold, [&] {
+            T value;
+            // the star arrays are read in place, as Starfield::load does
+            if constexpr (std::is_same_v<T, Starfield>)
+            {
+                Asset::load(value, MappedFile(compiledPath));
+            }
+            else
+            {
+                const MappedFile file(compiledPath);
+                Asset::load(value, file.data());
+            }
+        });
+        std::println("{} {}: JSON {:.3f} ms ({} bytes), compiled {:.3f} ms ({} bytes)", name, cold ? "cold" : "warm",
+                     1000.0 * jsonSeconds, std::filesystem::file_size(jsonPath), 1000.0 * compiledSeconds,
+                     std::filesystem::file_size(compiledPath));
+    }
+    std::filesystem::remove(compiledPath);
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    std::size_t worldCount = 2'000;
+    std::size_t starCount = 100'000;
+    int iterations = 10;
+
+    ArgParser parser;
+    parser.addOption(worldCount, 'w', "worlds");
+    parser.addOption(starCount, 'n', "stars");
+    parser.addOption(iterations, 'i', "iterations");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    const auto directory = std::filesystem::temp_directory_path();
+
+    // the shipped data files first, then large ones made out of them
+    const auto universeJson = nlohmann::json::parse(readFile(dataFilePath("universe.json")));
+    const auto starsJson = nlohmann::json::parse(readFile(dataFilePath("stars.json")));
+    const auto universePath = (directory / "bench_asset_load_universe.json").string();
+    const auto starsPath = (directory / "bench_asset_load_stars.json").string();
+    for (const auto scaled : {false, true})
+    {
+        auto universe = universeJson;
+        if (scaled)
+            universe["worlds"] = repeat(universeJson["worlds"], worldCount, "name");
+        writeJson(universePath, universe);
+        const auto stars = scaled ? repeat(starsJson, starCount, "proper_name") : starsJson;
+        writeJson(starsPath, stars);
+
+        std::println("{} worlds, {} stars", universe["worlds"].size(), stars.size());
+        benchmark<UniverseAsset, Universe>("universe", universePath, iterations);
+        benchmark<StarfieldAsset, Starfield>("stars", starsPath, iterations);
+    }
+
+    std::filesystem::remove(universePath);
+    std::filesystem::remove(starsPath);
+}
@@ -0,0 +1,219 @@
+#include "bench_util.h"
+
+#include <game/chebyshev_ephemeris.h>
+#include <game/ephemeris.h>
+#include <game/mission_table.h>
+
+#include <base/arg_parser.h>
+#include <base/asset_path.h>
+#include <base/thread_pool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <print>
+#include <random>
+#include <thread>
+
+namespace
+{
+
+// Asteroid-belt-ish orbits, with a few comets thrown in.
+std::vector<Orbit> randomOrbits(std::size_t count, JulianDate epoch)
+{
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<double> semiMajorAxis(0.4, 30.0);
+    std::uniform_real_distribution<double> eccentricity(0.0, 0.3);
+    std::uniform_real_distribution<double> cometEccentricity(0.3, 0.95);
+    std::uniform_real_distribution<double> inclination(0.0, 0.3);
+    std::uniform_real_distribution<double> angle(0.0, 2.0 * glm::pi<double>());
+    std::vector<Orbit> orbits;
+    orbits.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const OrbitalElements elements{.epoch = epoch,
+                                       .semiMajorAxis = semiMajorAxis(generator),
+                                       .eccentricity = i % 10 == 0 ? cometEccentricity(generator)
+                                                                   : eccentricity(generator),
+                                       .inclination = inclination(generator),
+                                       .longitudePerihelion = angle(generator),
+                                       .longitudeAscendingNode = angle(generator),
+                                       .meanAnomalyAtEpoch = angle(generator)};
+        orbits.emplace_back(elements);
+    }
+    return orbits;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    std::size_t maxThreads = std::thread::hardware_concurrency();
+    std::size_t workPerSize = 2'000'000; // bodies solved per measurement
+
+    ArgParser parser;
+    parser.addOption(maxThreads, 't', "max-threads");
+    parser.addOption(workPerSize, 'w', "work");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    const auto epoch = toJulianDate(std::chrono::year_month_day{std::chrono::year{2000}, std::chrono::January,
+                                                                std::chrono::day{1}});
+    const auto date = epoch + JulianYears{26.3};
+    ThreadPool threadPool(maxThreads - 1);
+
+    for (const std::size_t count : {std::size_t{10}, std::size_t{1'000}, std::size_t{1'000'000}})
+    {
+        const auto orbits = randomOrbits(count, epoch);
+        Ephemeris ephemeris;
+        for (const auto &orbit : orbits)
+            ephemeris.add(orbit);
+
+        const auto iterations = static_cast<int>(std::max<std::size_t>(workPerSize / count, 1));
+        std::vector<glm::dvec3> referencePositions(count), referenceVelocities(count);
+        const auto scalarSeconds = measureSeconds(iterations, [&] {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const auto [position, velocity] = orbits[i].stateVector(date);
+                referencePositions[i] = position;
+                referenceVelocities[i] = velocity;
+            }
+        });
+
+        std::vector<glm::dvec3> positions(count), velocities(count);
+        const Ephemeris::Output output{.positions = positions, .velocities = velocities};
+        const auto batchSeconds = measureSeconds(iterations, [&] { ephemeris.compute(date, output); });
+        const auto threadedSeconds = measureSeconds(iterations, [&] { ephemeris.compute(date, output, &threadPool); });
+
+        double maxPositionError = 0.0;
+        double maxVelocityError = 0.0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            maxPositionError = std::max(maxPositionError, glm::length(positions[i] - referencePositions[i]));
+            maxVelocityError = std::max(maxVelocityError, glm::length(velocities[i] - referenceVelocities[i]));
+        }
+
+        std::println("{:7} orbits: Orbit::stateVector {:.3g} bodies/s, batch {:.3g} bodies/s ({:.2f}x), {} threads "
+                     "{:.3g} bodies/s ({:.2f}x), max error {:.2g} AU, {:.2g} AU/day",
+                     count, count / scalarSeconds, count / batchSeconds, scalarSeconds / batchSeconds, maxThreads,
+                     count / threadedSeconds, scalarSeconds / threadedSeconds, maxPositionError, maxVelocityError);
+    }
+
+    // one orbit at many dates, the way MissionTable samples its departures and arrivals
+    {
+        constexpr std::size_t kDateCount = 1'000;
+        const auto orbits = randomOrbits(1, epoch);
+        Ephemeris ephemeris;
+        ephemeris.add(orbits.front());
+        std::vector<JulianDate> dates(kDateCount);
+        for (std::size_t i = 0; i < kDateCount; ++i)
+            dates[i] = date + JulianDays{static_cast<double>(i)};
+
+        const auto iterations = static_cast<int>(std::max<std::size_t>(workPerSize / kDateCount, 1));
+        std::vector<glm::dvec3> referencePositions(kDateCount);
+        const auto scalarSeconds = measureSeconds(iterations, [&] {
+            for (std::size_t i = 0; i < kDateCount; ++i)
+                referencePositions[i] = orbits.front().position(dates[i]);
+        });
+        std::vector<glm::dvec3> positions(kDateCount);
+        const auto batchSeconds =
+            measureSeconds(iterations, [&] { ephemeris.compute(0, dates, {.positions = positions}); });
+        double maxPositionError = 0.0;
+        for (std::size_t i = 0; i < kDateCount; ++i)
+            maxPositionError = std::max(maxPositionError, glm::length(positions[i] - referencePositions[i]));
+        std::println("{} dates: Orbit::position {:.3g} dates/s, batch {:.3g} dates/s ({:.2f}x), max error {:.2g} AU",
+                     kDateCount, kDateCount / scalarSeconds, kDateCount / batchSeconds, scalarSeconds / batchSeconds,
+                     maxPositionError);
+    }
+
+    // Chebyshev fit of the worlds over a year, Universe::update keeps fits of a couple of months
+    Universe universe;
+    if (!universe.load(dataFilePath("universe.json")))
+    {
+        std::println(stderr, "Failed to load universe");
+        return 1;
+    }
+    const auto &exact = universe.ephemeris();
+    const auto worldCount = exact.size();
+    const auto fitBegin = date;
+    const auto fitEnd = date + JulianYears{1.0};
+    std::optional<ChebyshevEphemeris> chebyshev;
+    const auto fitSeconds =
+        measureSeconds(10, [&] { chebyshev.emplace(exact, fitBegin, fitEnd, ChebyshevEphemeris::Settings{}); });
+
+    // error against the exact ephemeris at random dates
+    {
+        std::mt19937 generator(1234);
+        std::uniform_real_distribution<double> offset(0.0, (fitEnd - fitBegin).count());
+        std::vector<glm::dvec3> positions(worldCount), velocities(worldCount);
+        std::vector<glm::dvec3> exactPositions(worldCount), exactVelocities(worldCount);
+        double maxPositionError = 0.0;
+        double maxVelocityError = 0.0;
+        for (int i = 0; i < 10'000; ++i)
+        {
+            const auto when = fitBegin + JulianDays{offset(generator)};
+            chebyshev->compute(when, {.positions = positions, .velocities = velocities});
+            exact.compute(when, {.positions = exactPositions, .velocities = exactVelocities});
+            for (std::size_t body = 0; body < worldCount; ++body)
+            {
+                maxPositionError = std::max(maxPositionError, glm::length(positions[body] - exactPositions[body]));
+                maxVelocityError = std::max(maxVelocityError, glm::length(velocities[body] - exactVelocities[body]));
+            }
+        }
+        std::println("chebyshev: {} worlds over a year fitted in {:.2f} ms, {} segments, error bound {:.2g} AU, "
+                     "measured max error {:.2g} AU, {:.2g} AU/day",
+                     worldCount, 1000.0 * fitSeconds, chebyshev->segmentCount(), chebyshev->errorBound(),
+                     maxPositionError, maxVelocityError);
+    }
+
+    // per-frame update of the worlds
+    {
+        const auto worlds = universe.worlds();
+        std::vector<glm::dvec3> positions(worldCount);
+        std::vector<glm::dvec2> positionsOnOrbitPlane(worldCount);
+        const Ephemeris::Output output{.positions = positions, .positionsOnOrbitPlane = positionsOnOrbitPlane};
+        constexpr auto kFrames = 100'000;
+        const auto frameDate = [&](int frame) { return fitBegin + JulianDays{frame * 0.001}; };
+        int frame = 0;
+        const auto orbitSeconds = measureSeconds(kFrames, [&] {
+            const auto when = frameDate(frame++);
+            for (std::size_t i = 0; i < worldCount; ++i)
+            {
+                positionsOnOrbitPlane[i] = worlds[i]->orbit().positionOnOrbitPlane(when);
+                positions[i] = worlds[i]->orbit().orbitRotationMatrix() * glm::dvec3(positionsOnOrbitPlane[i], 0.0);
+            }
+        });
+        frame = 0;
+        const auto exactSeconds = measureSeconds(kFrames, [&] { exact.compute(frameDate(frame++), output); });
+        frame = 0;
+        const auto chebyshevSeconds =
+            measureSeconds(kFrames, [&] { chebyshev->compute(frameDate(frame++), output); });
+        std::println("per-frame update of {} worlds: Orbit {:.2f} us, Ephemeris {:.2f} us, Chebyshev {:.2f} us "
+                     "({:.2f}x over Orbit, {:.2f}x over Ephemeris)",
+                     worldCount, 1e6 * orbitSeconds, 1e6 * exactSeconds, 1e6 * chebyshevSeconds,
+                     orbitSeconds / chebyshevSeconds, exactSeconds / chebyshevSeconds);
+    }
+
+    // the states sampled by a mission table, against the cost of solving it
+    {
+        const auto *origin = universe.worlds()[2];       // Earth
+        const auto *destination = universe.worlds()[11]; // Vesta
+        const MissionTable::Settings tableSettings{.maxDeltaV = 0.03};
+        const MissionTable table(origin, destination, fitBegin, tableSettings);
+        const auto tableSeconds =
+            measureSeconds(1, [&] { MissionTable(origin, destination, fitBegin, tableSettings); });
+        std::vector<JulianDate> dates;
+        for (const auto &state : table.departures)
+            dates.push_back(state.date);
+        for (const auto &state : table.arrivals)
+            dates.push_back(state.date);
+        std::vector<glm::dvec3> positions(dates.size()), velocities(dates.size());
+        const Ephemeris::Output output{.positions = positions, .velocities = velocities};
+        const auto exactSeconds = measureSeconds(100, [&] { exact.compute(2, dates, output); });
+        const auto chebyshevSeconds = measureSeconds(100, [&] { chebyshev->compute(2, dates, output); });
+        std::println("mission table: {} states sampled in {:.1f} us exact, {:.1f} us Chebyshev ({:.0f}% inside the "
+                     "fit), {:.2f}% of the {:.1f} ms it takes to solve the table",
+                     dates.size(), 1e6 * exactSeconds, 1e6 * chebyshevSeconds,
+                     100.0 * std::ranges::count_if(dates, [&](JulianDate when) { return chebyshev->covers(when); }) /
+                         dates.size(),
+                     100.0 * exactSeconds / tableSeconds, 1000.0 * tableSeconds);
+    }
+}
@@ -0,0 +1,122 @@
+#include "bench_util.h"
+
+#include <game/kepler.h>
+
+#include <base/arg_parser.h>
+
+#include <algorithm>
+#include <cmath>
+#include <print>
+#include <vector>
+
+namespace
+{
+
+// Error on the anomaly, from the residual of Kepler's equation divided by its derivative, in extended precision.
+double anomalyError(double anomaly, double M, double e)
+{
+    const auto x = static_cast<long double>(anomaly);
+    const auto m = static_cast<long double>(M);
+    const auto ecc = static_cast<long double>(e);
+    if (e < 1.0)
+        return static_cast<double>(std::abs((x - ecc * std::sin(x) - m) / (1.0L - ecc * std::cos(x))));
+    return static_cast<double>(std::abs((ecc * std::sinh(x) - x - m) / (ecc * std::cosh(x) - 1.0L)));
+}
+
+struct Row
+{
+    double maxError{0.0};
+    double meanIterations{0.0};
+    double nanoseconds{0.0};
+};
+
+Row measureRow(KeplerSolver solver, std::span<const double> meanAnomalies, double e, int iterations)
+{
+    Row row;
+    for (const auto M : meanAnomalies)
+    {
+        const auto solution = solveKepler(solver, M, e);
+        row.maxError = std::max(row.maxError, anomalyError(solution.anomaly, M, e));
+        row.meanIterations += solution.iterations;
+    }
+    row.meanIterations /= meanAnomalies.size();
+
+    volatile double sink = 0.0;
+    const auto seconds = measureSeconds(iterations, [&] {
+        double sum = 0.0;
+        for (const auto M : meanAnomalies)
+            sum += solveKepler(solver, M, e).anomaly;
+        sink = sum;
+    });
+    row.nanoseconds = 1e9 * seconds / meanAnomalies.size();
+    return row;
+}
+
+constexpr std::array kSolvers = {std::pair{KeplerSolver::Newton, "newton"}, std::pair{KeplerSolver::Danby, "danby"},
+                                 std::pair{KeplerSolver::Markley, "markley"},
+                                 std::pair{KeplerSolver::Lookup, "lookup"}};
+
+void printTable(std::span<const double> eccentricities, std::span<const double> meanAnomalies, int iterations)
+{
+    std::print("{:>7}", "e");
+    for (const auto &[solver, name] : kSolvers)
+        std::print(" | {:>8} {:>5} {:>6}", name, "iter", "ns");
+    std::println("");
+    for (const auto e : eccentricities)
+    {
+        std::print("{:7.3f}", e);
+        for (const auto &[solver, name] : kSolvers)
+        {
+            const auto row = measureRow(solver, meanAnomalies, e, iterations);
+            std::print(" | {:8.1e} {:5.2f} {:6.1f}", row.maxError, row.meanIterations, row.nanoseconds);
+        }
+        std::println("");
+    }
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    int iterations = 100;
+    std::size_t samples = 1000; // mean anomalies per eccentricity
+
+    ArgParser parser;
+    parser.addOption(iterations, 'i', "iterations");
+    parser.addOption(samples, 's', "samples");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    // max error on E (radians), mean iterations and nanoseconds per solve for each eccentricity, over one turn of
+    // mean anomalies
+    std::vector<double> meanAnomalies(samples);
+    for (std::size_t i = 0; i < samples; ++i)
+        meanAnomalies[i] = 2.0 * glm::pi<double>() * (static_cast<double>(i) + 0.5) / samples;
+    std::println("elliptic, M in [0, 2 pi]");
+    printTable(std::array{0.0, 0.1, 0.3, 0.5, 0.7, 0.9, 0.95, 0.99, 0.999}, meanAnomalies, iterations);
+
+    // hyperbolic branch, Markley and Lookup fall back to Danby there
+    std::vector<double> hyperbolicAnomalies(samples);
+    for (std::size_t i = 0; i < samples; ++i)
+        hyperbolicAnomalies[i] = 50.0 * (static_cast<double>(i) + 0.5) / samples;
+    std::println("hyperbolic, M in [0, 50]");
+    printTable(std::array{1.01, 1.1, 1.5, 2.0, 5.0}, hyperbolicAnomalies, iterations);
+
+    // Markley on SIMD packs
+    {
+        using P = simd::Pack<double>;
+        constexpr auto kWidth = simd::kWidth<P>;
+        constexpr auto e = 0.5;
+        const auto packCount = samples / kWidth;
+        volatile double sink = 0.0;
+        const auto seconds = measureSeconds(iterations, [&] {
+            P sum{0.0};
+            for (std::size_t i = 0; i < packCount; ++i)
+            {
+                const auto M = simd::generate<P>([&](std::size_t lane) { return meanAnomalies[i * kWidth + lane]; });
+                sum += markleyEccentricAnomaly(M, P{e});
+            }
+            sink = simd::lane(sum, 0);
+        });
+        std::println("markley, {} lanes: {:.1f} ns per solve", kWidth, 1e9 * seconds / (packCount * kWidth));
+    }
+}
@@ -0,0 +1,125 @@
+#include "bench_util.h"
+
+#include <game/lambert.h>
+#include <game/mission_table.h>
+
+#include <base/arg_parser.h>
+#include <base/asset_path.h>
+
+#include <algorithm>
+#include <print>
+
+namespace
+{
+
+struct Errors
+{
+    std::size_t mismatches{0}; // solved by one path but not by the other
+    double maxVelocityError{0.0};
+};
+
+Errors compare(std::span<const std::optional<TransferVelocities>> solutions,
+               std::span<const std::optional<TransferVelocities>> reference)
+{
+    Errors errors;
+    for (std::size_t i = 0; i < reference.size(); ++i)
+    {
+        if (solutions[i].has_value() != reference[i].has_value())
+        {
+            ++errors.mismatches;
+            continue;
+        }
+        if (!reference[i])
+            continue;
+        const auto error = std::max(glm::length(solutions[i]->initialVelocity - reference[i]->initialVelocity),
+                                    glm::length(solutions[i]->finalVelocity - reference[i]->finalVelocity));
+        // NaNs and infinities are compared as-is
+        if (!(error <= errors.maxVelocityError))
+            errors.maxVelocityError = error;
+    }
+    return errors;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    int iterations = 3;
+
+    ArgParser parser;
+    parser.addOption(iterations, 'i', "iterations");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    Universe universe;
+    if (!universe.load(dataFilePath("universe.json")))
+    {
+        std::println(stderr, "Failed to load universe");
+        return 1;
+    }
+
+    // same grid as the one built in Game::initialize
+    const auto worlds = universe.worlds();
+    const auto *origin = worlds[2];       // Earth
+    const auto *destination = worlds[11]; // Vesta
+    const auto start = JulianClock::now() + JulianYears{150.0};
+    const MissionTable::Settings settings{.maxDeltaV = 0.03};
+    const MissionTable table(origin, destination, start, settings);
+
+    std::vector<LambertProblem> problems;
+    for (const auto &arrival : table.arrivals)
+    {
+        for (const auto &departure : table.departures)
+        {
+            if (arrival.date <= departure.date)
+                continue;
+            const auto transitInterval = arrival.date - departure.date;
+            problems.emplace_back(departure.worldPosition, arrival.worldPosition, transitInterval.count());
+        }
+    }
+    const auto problemCount = static_cast<double>(problems.size());
+
+    std::println("{} -> {}: {} problems, batch width {} (double) / {} (float)", origin->name, destination->name,
+                 problems.size(), lambertBatchWidth<double>(), lambertBatchWidth<float>());
+
+    std::vector<std::optional<TransferVelocities>> reference(problems.size());
+    const auto scalarSeconds = measureSeconds(iterations, [&] {
+        std::ranges::transform(problems, reference.begin(), [](const LambertProblem &problem) {
+            return lambert_battin(kGMSun, problem.r1, problem.r2, problem.dt);
+        });
+    });
+    std::println("scalar: {:.1f} ms, {:.0f} solves/s", 1000.0 * scalarSeconds, problemCount / scalarSeconds);
+
+    const auto benchmarkBatch = [&]<typename T>(std::string_view name) {
+        std::vector<std::optional<TransferVelocities>> solutions(problems.size());
+        const auto seconds =
+            measureSeconds(iterations, [&] { lambert_battin_batch<T>(kGMSun, problems, solutions); });
+        const auto errors = compare(solutions, reference);
+        std::println("{}: {:.1f} ms, {:.0f} solves/s, speedup {:.2f}x, {} mismatches, max velocity error {:g} AU/day",
+                     name, 1000.0 * seconds, problemCount / seconds, scalarSeconds / seconds, errors.mismatches,
+                     errors.maxVelocityError);
+    };
+    benchmarkBatch.operator()<double>("batch double");
+    benchmarkBatch.operator()<float>("batch float");
+
+    // full table, float screening against the plain double precision solve
+    const auto tableSeconds =
+        measureSeconds(iterations, [&] { MissionTable table(origin, destination, start, settings); });
+    auto screeningSettings = settings;
+    screeningSettings.floatScreening = true;
+    std::optional<MissionTable> screenedTable;
+    const auto screenedSeconds = measureSeconds(
+        iterations, [&] { screenedTable.emplace(origin, destination, start, screeningSettings); });
+    std::size_t differences = 0;
+    const auto transfers = table.transfers();
+    const auto screenedTransfers = screenedTable->transfers();
+    for (std::size_t i = 0; i < transfers.extent(0); ++i)
+    {
+        for (std::size_t j = 0; j < transfers.extent(1); ++j)
+        {
+            if (transfers[i, j].has_value() != screenedTransfers[i, j].has_value())
+                ++differences;
+        }
+    }
+    std::println("mission table: {:.1f} ms, with float screening: {:.1f} ms ({:.2f}x), {} cells differ",
+                 1000.0 * tableSeconds, 1000.0 * screenedSeconds, tableSeconds / screenedSeconds, differences);
+}
@@ -0,0 +1,182 @@
+#include <game/lambert.h>
+#include <game/universe.h>
+
+#include <base/arg_parser.h>
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <print>
+#include <random>
+
+namespace
+{
+
+struct Problem
+{
+    glm::dvec3 r1;
+    glm::dvec3 r2;
+    double dt;
+};
+
+// Random heliocentric geometries between 0.3 and 10 AU, close to the ecliptic, with times of flight between 10 days
+// and 5 years.
+std::vector<Problem> randomProblems(std::size_t count, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> radius(0.3, 10.0);
+    std::uniform_real_distribution<double> longitude(0.0, 2.0 * glm::pi<double>());
+    std::uniform_real_distribution<double> latitude(-0.2, 0.2);
+    std::uniform_real_distribution<double> timeOfFlight(10.0, 5.0 * 365.25);
+    const auto randomPosition = [&] {
+        const auto r = radius(generator);
+        const auto lon = longitude(generator);
+        const auto lat = latitude(generator);
+        return r * glm::dvec3{std::cos(lat) * std::cos(lon), std::cos(lat) * std::sin(lon), std::sin(lat)};
+    };
+    std::vector<Problem> problems(count);
+    std::ranges::generate(problems, [&] {
+        const auto r1 = randomPosition();
+        const auto r2 = randomPosition();
+        return Problem{r1, r2, timeOfFlight(generator)};
+    });
+    return problems;
+}
+
+// Propagates a two-body state for `dt` with universal variables, used to check the solvers independently of each
+// other.
+glm::dvec3 propagate(double mu, const glm::dvec3 &r0, const glm::dvec3 &v0, double dt)
+{
+    const auto stumpffC = [](double z) {
+        if (z > 1e-8)
+            return (1.0 - std::cos(std::sqrt(z))) / z;
+        if (z < -1e-8)
+            return (std::cosh(std::sqrt(-z)) - 1.0) / -z;
+        return 0.5 - z / 24.0;
+    };
+    const auto stumpffS = [](double z) {
+        if (z > 1e-8)
+            return (std::sqrt(z) - std::sin(std::sqrt(z))) / std::pow(z, 1.5);
+        if (z < -1e-8)
+            return (std::sinh(std::sqrt(-z)) - std::sqrt(-z)) / std::pow(-z, 1.5);
+        return 1.0 / 6.0 - z / 120.0;
+    };
+
+    const auto sqrtMu = std::sqrt(mu);
+    const auto r0mag = glm::length(r0);
+    const auto vr0 = glm::dot(r0, v0) / r0mag;
+    const auto alpha = 2.0 / r0mag - glm::dot(v0, v0) / mu;
+
+    // universal Kepler equation, F(chi) = 0, F is monotonically increasing
+    const auto kepler = [&](double chi) {
+        const auto z = alpha * chi * chi;
+        const auto c = stumpffC(z);
+        const auto s = stumpffS(z);
+        const auto f = r0mag * vr0 / sqrtMu * chi * chi * c + (1.0 - alpha * r0mag) * chi * chi * chi * s +
+                       r0mag * chi - sqrtMu * dt;
+        const auto df = r0mag * vr0 / sqrtMu * chi * (1.0 - alpha * chi * chi * s) +
+                        (1.0 - alpha * r0mag) * chi * chi * c + r0mag;
+        return std::pair{f, df};
+    };
+
+    // bracket the root, then Newton iterations falling back to bisection whenever they leave the bracket
+    double low = 0.0;
+    double high = sqrtMu * dt / r0mag;
+    while (kepler(high).first < 0.0)
+    {
+        low = high;
+        high *= 2.0;
+    }
+    double chi = 0.5 * (low + high);
+    for (int i = 0; i < 200 && high - low > 1e-14 * high; ++i)
+    {
+        const auto [f, df] = kepler(chi);
+        if (f < 0.0)
+            low = chi;
+        else
+            high = chi;
+        const auto next = chi - f / df;
+        chi = next >= low && next <= high ? next : 0.5 * (low + high);
+        if (std::abs(f) < 1e-15 * sqrtMu * dt)
+            break;
+    }
+
+    const auto z = alpha * chi * chi;
+    const auto f = 1.0 - chi * chi / r0mag * stumpffC(z);
+    const auto g = dt - chi * chi * chi * stumpffS(z) / sqrtMu;
+    return f * r0 + g * v0;
+}
+
+struct Results
+{
+    double seconds{0.0};
+    std::size_t unsolved{0};  // problems without any solution
+    std::size_t solutions{0}; // every branch found
+    std::size_t inaccurate{0};
+    double maxPositionError{0.0}; // relative, over accurate solutions
+    double meanIterations{0.0};
+};
+
+Results benchmark(LambertSolver solver, std::span<const Problem> problems, int maxRevolutions)
+{
+    constexpr double kAccurate = 1e-6;
+
+    std::vector<std::vector<LambertSolution>> solutions(problems.size());
+    const auto start = std::chrono::steady_clock::now();
+    std::ranges::transform(problems, solutions.begin(), [solver, maxRevolutions](const Problem &problem) {
+        return solve_lambert(solver, kGMSun, problem.r1, problem.r2, problem.dt, OrbitType::Prograde,
+                             maxRevolutions);
+    });
+    Results results;
+    results.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t iterations = 0;
+    for (std::size_t i = 0; i < problems.size(); ++i)
+    {
+        const auto &problem = problems[i];
+        if (solutions[i].empty())
+            ++results.unsolved;
+        for (const auto &solution : solutions[i])
+        {
+            ++results.solutions;
+            iterations += solution.iterations;
+            const auto r2 = propagate(kGMSun, problem.r1, solution.velocities.initialVelocity, problem.dt);
+            const auto error = glm::length(r2 - problem.r2) / glm::length(problem.r2);
+            if (!(error < kAccurate))
+                ++results.inaccurate;
+            else
+                results.maxPositionError = std::max(results.maxPositionError, error);
+        }
+    }
+    results.meanIterations = results.solutions ? static_cast<double>(iterations) / results.solutions : 0.0;
+    return results;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    std::size_t count = 100000;
+    int maxRevolutions = 2;
+    unsigned seed = 1;
+
+    ArgParser parser;
+    parser.addOption(count, 'n', "problems");
+    parser.addOption(maxRevolutions, 'r', "max-revolutions");
+    parser.addOption(seed, 's', "seed");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    const auto problems = randomProblems(count, seed);
+    std::println("{} random problems, up to {} revolutions", problems.size(), maxRevolutions);
+
+    const auto report = [&problems](std::string_view name, const Results &results) {
+        std::println("{}: {:.0f} solves/s, {} unsolved, {} solutions, {} inaccurate, max position error {:g}, "
+                     "{:.2f} iterations/solution",
+                     name, problems.size() / results.seconds, results.unsolved, results.solutions,
+                     results.inaccurate, results.maxPositionError, results.meanIterations);
+    };
+    report("battin", benchmark(LambertSolver::Battin, problems, 0));
+    report("izzo", benchmark(LambertSolver::Izzo, problems, 0));
+    report("izzo, multi-revolution", benchmark(LambertSolver::Izzo, problems, maxRevolutions));
+}
@@ -0,0 +1,45 @@
+#include "bench_util.h"
+
+#include <game/market_economy.h>
+
+#include <base/arg_parser.h>
+#include <base/thread_pool.h>
+
+#include <algorithm>
+#include <print>
+#include <vector>
+
+int main(int argc, const char *argv[])
+{
+    std::size_t worldCount = 1000;
+    std::size_t itemCount = 500;
+    std::size_t threadCount = std::thread::hardware_concurrency();
+    int iterations = 1000; // ticks
+
+    ArgParser parser;
+    parser.addOption(worldCount, 'w', "worlds");
+    parser.addOption(itemCount, 'n', "items");
+    parser.addOption(threadCount, 'j', "threads");
+    parser.addOption(iterations, 'i', "iterations");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    ThreadPool threadPool(std::max<std::size_t>(threadCount, 1) - 1);
+
+    MarketEconomy economy;
+    economy.reset(worldCount, itemCount, 1);
+    const auto inlineSeconds = measureSeconds(iterations, [&] { economy.tick(); });
+    const auto parallelSeconds = measureSeconds(iterations, [&] { economy.tick(&threadPool); });
+
+    // the prices of every world, as the universe writes them out after its ticks
+    std::vector<std::uint64_t> sellPrices(itemCount), buyPrices(itemCount);
+    const auto pricesSeconds = measureSeconds(std::max(iterations / 10, 1), [&] {
+        for (std::size_t world = 0; world < worldCount; ++world)
+            economy.writePrices(world, sellPrices, buyPrices);
+    });
+
+    const auto cellCount = static_cast<double>(worldCount * itemCount);
+    std::println("{} worlds x {} items: {:.0f} ticks/s ({:.3g} cells/s), {:.0f} ticks/s on {} threads; prices written "
+                 "in {:.2f} ms",
+                 worldCount, itemCount, 1.0 / inlineSeconds, cellCount / inlineSeconds, 1.0 / parallelSeconds,
+                 threadCount, 1000.0 * pricesSeconds);
+}
@@ -0,0 +1,71 @@
+#include "bench_util.h"
+
+#include <game/mission_optimizer.h>
+#include <game/mission_table.h>
+
+#include <base/arg_parser.h>
+#include <base/asset_path.h>
+
+#include <limits>
+#include <print>
+#include <random>
+
+int main(int argc, const char *argv[])
+{
+    int iterations = 3;
+    int hoverSamples = 1000;
+
+    ArgParser parser;
+    parser.addOption(iterations, 'i', "iterations");
+    parser.addOption(hoverSamples, 'n', "hover-samples");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    Universe universe;
+    if (!universe.load(dataFilePath("universe.json")))
+    {
+        std::println(stderr, "Failed to load universe");
+        return 1;
+    }
+
+    // same table as the one built in Game::initialize
+    const auto worlds = universe.worlds();
+    const auto *origin = worlds[2];       // Earth
+    const auto *destination = worlds[11]; // Vesta
+    const auto start = JulianClock::now() + JulianYears{150.0};
+    const MissionTable table(origin, destination, start, MissionTable::Settings{.maxDeltaV = 0.03});
+
+    double gridDeltaV = std::numeric_limits<double>::max();
+    const auto transfers = table.transfers();
+    for (std::size_t i = 0; i < transfers.extent(0); ++i)
+    {
+        for (std::size_t j = 0; j < transfers.extent(1); ++j)
+        {
+            if (const auto orbit = transfers[i, j])
+                gridDeltaV = std::min(gridDeltaV, orbit->totalDeltaV());
+        }
+    }
+
+    std::optional<MissionPlan> plan;
+    const auto bestPlanSeconds = measureSeconds(iterations, [&] { plan = MissionOptimizer(&table).bestPlan(); });
+    if (!plan)
+    {
+        std::println(stderr, "No mission plan found");
+        return 1;
+    }
+    const auto planDeltaV = plan->deltaVDeparture + plan->deltaVArrival;
+    std::println("best plan: {:.2f} ms, delta-v {:.8f} AU/day (grid minimum {:.8f}, {:.3f}% lower)",
+                 1000.0 * bestPlanSeconds, planDeltaV, gridDeltaV, 100.0 * (gridDeltaV - planDeltaV) / gridDeltaV);
+
+    // hovering random cells, the first visit of every basin pays for the optimization
+    MissionOptimizer optimizer(&table);
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<std::size_t> arrival(0, table.arrivals.size() - 1);
+    std::uniform_int_distribution<std::size_t> departure(0, table.departures.size() - 1);
+    std::size_t snapped = 0;
+    const auto hoverSeconds = measureSeconds(hoverSamples, [&] {
+        if (optimizer.basinPlan(arrival(generator), departure(generator)))
+            ++snapped;
+    });
+    std::println("hover: {:.3f} ms per move, {} of {} moves snapped to a basin", 1000.0 * hoverSeconds, snapped,
+                 hoverSamples);
+}
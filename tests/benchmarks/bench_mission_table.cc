@@ -0,0 +1,221 @@
+#include "bench_util.h"
+
+#include <game/mission_table.h>
+#include <game/mission_table_builder.h>
+#include <game/mission_table_cache.h>
+
+#include <base/arg_parser.h>
+#include <base/asset_path.h>
+#include <base/thread_pool.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <print>
+#include <thread>
+
+namespace
+{
+
+bool bitIdentical(const MissionTable &lhs, const MissionTable &rhs)
+{
+    const auto lhsTransfers = lhs.transfers();
+    const auto rhsTransfers = rhs.transfers();
+    if (lhsTransfers.extents() != rhsTransfers.extents())
+        return false;
+    for (std::size_t i = 0; i < lhsTransfers.extent(0); ++i)
+    {
+        for (std::size_t j = 0; j < lhsTransfers.extent(1); ++j)
+        {
+            const auto lhsTransfer = lhsTransfers[i, j];
+            const auto rhsTransfer = rhsTransfers[i, j];
+            if (lhsTransfer.has_value() != rhsTransfer.has_value())
+                return false;
+            if (lhsTransfer && std::memcmp(&*lhsTransfer, &*rhsTransfer, sizeof(MissionTable::TransferDeltaV)) != 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+std::optional<std::pair<std::size_t, std::size_t>> cheapestTransfer(const MissionTable &table)
+{
+    std::optional<std::pair<std::size_t, std::size_t>> cheapest;
+    double cheapestDeltaV = std::numeric_limits<double>::max();
+    const auto transfers = table.transfers();
+    for (std::size_t i = 0; i < transfers.extent(0); ++i)
+    {
+        for (std::size_t j = 0; j < transfers.extent(1); ++j)
+        {
+            if (const auto orbit = transfers[i, j])
+            {
+                if (const auto deltaV = orbit->totalDeltaV(); deltaV < cheapestDeltaV)
+                {
+                    cheapest = std::pair{i, j};
+                    cheapestDeltaV = deltaV;
+                }
+            }
+        }
+    }
+    return cheapest;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    std::size_t maxThreads = std::thread::hardware_concurrency();
+    int iterations = 3;
+    double maxDeltaV = 0.03;
+
+    ArgParser parser;
+    parser.addOption(maxThreads, 't', "max-threads");
+    parser.addOption(iterations, 'i', "iterations");
+    parser.addOption(maxDeltaV, 'd', "max-delta-v");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    Universe universe;
+    if (!universe.load(dataFilePath("universe.json")))
+    {
+        std::println(stderr, "Failed to load universe");
+        return 1;
+    }
+
+    // same table as the one built in Game::initialize
+    const auto worlds = universe.worlds();
+    const auto *origin = worlds[2];       // Earth
+    const auto *destination = worlds[11]; // Vesta
+    const auto start = JulianClock::now() + JulianYears{150.0};
+    const MissionTable::Settings settings{.maxDeltaV = maxDeltaV};
+
+    const MissionTable reference(origin, destination, start, settings);
+    const auto solveCount = static_cast<double>(reference.departures.size() * reference.arrivals.size());
+
+    const auto serialSeconds =
+        measureSeconds(iterations, [&] { MissionTable table(origin, destination, start, settings); });
+    std::println("{} -> {}: {}x{} grid", origin->name, destination->name, reference.departures.size(),
+                 reference.arrivals.size());
+    std::println("serial: {:.1f} ms, {:.0f} solves/s", 1000.0 * serialSeconds, solveCount / serialSeconds);
+
+    for (std::size_t threads = 1; threads <= maxThreads; ++threads)
+    {
+        // the calling thread also runs tiles, so the pool only needs threads - 1 workers
+        ThreadPool threadPool(threads - 1);
+        std::optional<MissionTable> table;
+        const auto seconds = measureSeconds(iterations, [&] {
+            table.emplace(origin, destination, start, settings, &threadPool);
+        });
+        std::println("{:2} threads: {:.1f} ms, {:.0f} solves/s, speedup {:.2f}x{}", threads, 1000.0 * seconds,
+                     solveCount / seconds, serialSeconds / seconds,
+                     bitIdentical(*table, reference) ? "" : " (MISMATCH)");
+    }
+
+    // adaptive refinement against the full grid
+    auto adaptiveSettings = settings;
+    adaptiveSettings.adaptiveRefinement = true;
+    std::optional<MissionTable> adaptive;
+    const auto adaptiveSeconds = measureSeconds(iterations, [&] {
+        adaptive.emplace(origin, destination, start, adaptiveSettings);
+    });
+    std::size_t visibilityDifferences = 0;
+    double maxDeltaVError = 0.0;
+    const auto referenceTransfers = reference.transfers();
+    const auto adaptiveTransfers = adaptive->transfers();
+    for (std::size_t i = 0; i < referenceTransfers.extent(0); ++i)
+    {
+        for (std::size_t j = 0; j < referenceTransfers.extent(1); ++j)
+        {
+            const auto expected = referenceTransfers[i, j];
+            const auto actual = adaptiveTransfers[i, j];
+            if (expected.has_value() != actual.has_value())
+                ++visibilityDifferences;
+            else if (expected)
+                maxDeltaVError =
+                    std::max(maxDeltaVError, std::abs(expected->totalDeltaV() - actual->totalDeltaV()));
+        }
+    }
+    std::println("adaptive: {:.1f} ms, speedup {:.2f}x, {} solves ({:.1f}% of {}), {} cells differ in visibility, max "
+                 "delta-v error {:g}, best plan {}",
+                 1000.0 * adaptiveSeconds, serialSeconds / adaptiveSeconds, adaptive->solveCount(),
+                 100.0 * adaptive->solveCount() / reference.solveCount(), reference.solveCount(),
+                 visibilityDifferences, maxDeltaVError,
+                 cheapestTransfer(*adaptive) == cheapestTransfer(reference) ? "matches" : "DIFFERS");
+
+    // sliding window: advance a table through time warp one frame at a time, then compare it with a table whose
+    // window jumped straight to the final date and was solved from scratch
+    constexpr auto kFrameStep = JulianDays{5.0};
+    constexpr auto kWarpInterval = JulianDays{1000.0};
+    MissionTable sliding(origin, destination, start, settings);
+    const auto initialSolveCount = sliding.solveCount();
+    std::size_t moves = 0;
+    const auto slidingStart = std::chrono::steady_clock::now();
+    for (auto date = start + kFrameStep; date <= start + kWarpInterval; date += kFrameStep)
+    {
+        if (sliding.advance(date))
+            ++moves;
+    }
+    const auto slidingSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - slidingStart).count();
+    MissionTable jumped(origin, destination, start, settings);
+    jumped.advance(start + kWarpInterval);
+    const auto advanceSolveCount = static_cast<double>(sliding.solveCount() - initialSolveCount) / moves;
+    std::println("sliding window: {} moves, {:.2f} ms and {:.0f} solves per move ({:.1f}% of the grid){}", moves,
+                 1000.0 * slidingSeconds / moves, advanceSolveCount, 100.0 * advanceSolveCount / solveCount,
+                 bitIdentical(sliding, jumped) ? "" : " (MISMATCH)");
+
+    // progressive build in the background, polled the way the main loop does it
+    {
+        using Clock = std::chrono::steady_clock;
+        ThreadPool threadPool(maxThreads - 1);
+        const auto buildStart = Clock::now();
+        MissionTableBuilder builder(origin, destination, start, settings, &threadPool);
+        std::optional<double> firstResultsSeconds;
+        double maxPollSeconds = 0.0;
+        std::size_t updates = 0;
+        while (!builder.isFinished())
+        {
+            const auto pollStart = Clock::now();
+            if (builder.poll())
+            {
+                ++updates;
+                if (!firstResultsSeconds)
+                    firstResultsSeconds = std::chrono::duration<double>(Clock::now() - buildStart).count();
+            }
+            const auto pollSeconds = std::chrono::duration<double>(Clock::now() - pollStart).count();
+            maxPollSeconds = std::max(maxPollSeconds, pollSeconds);
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        const auto buildSeconds = std::chrono::duration<double>(Clock::now() - buildStart).count();
+
+        const auto cancelStart = Clock::now();
+        {
+            MissionTableBuilder cancelled(origin, destination, start, settings, &threadPool);
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+        const auto cancelSeconds = std::chrono::duration<double>(Clock::now() - cancelStart).count() - 0.01;
+
+        std::println("progressive: first results after {:.1f} ms, done after {:.1f} ms, {} updates, "
+                     "max poll {:.3f} ms, cancelled in {:.1f} ms{}",
+                     1000.0 * firstResultsSeconds.value_or(0.0), 1000.0 * buildSeconds, updates,
+                     1000.0 * maxPollSeconds, 1000.0 * cancelSeconds,
+                     bitIdentical(*builder.table(), reference) ? "" : " (MISMATCH)");
+    }
+
+    // on-disk cache, in a scratch directory
+    {
+        const MissionTableCache cache(std::filesystem::temp_directory_path() / "sundog-bench-mission-table");
+        std::filesystem::remove_all(cache.directory());
+        const auto storeSeconds = measureSeconds(iterations, [&] { cache.store(reference); });
+        std::unique_ptr<MissionTable> cached;
+        const auto loadSeconds =
+            measureSeconds(iterations, [&] { cached = cache.load(origin, destination, start, settings); });
+        auto otherSettings = settings;
+        otherSettings.maxDeltaV *= 2.0;
+        const auto stale = cache.load(origin, destination, start, otherSettings) != nullptr;
+        std::println("cache: store {:.2f} ms, load {:.2f} ms ({:.0f}x faster than solving){}{}", 1000.0 * storeSeconds,
+                     1000.0 * loadSeconds, serialSeconds / loadSeconds,
+                     cached && bitIdentical(*cached, reference) ? "" : " (MISMATCH)", stale ? " (STALE HIT)" : "");
+        std::filesystem::remove_all(cache.directory());
+    }
+}
@@ -0,0 +1,140 @@
+#include "bench_util.h"
+
+#include <game/orbit_propagator.h>
+#include <game/universe.h>
+
+#include <base/arg_parser.h>
+#include <base/asset_path.h>
+
+#include <algorithm>
+#include <chrono>
+#include <print>
+#include <random>
+
+namespace
+{
+
+// Transfer orbits like the ones of mission plans, elliptic or hyperbolic, near their periapsis at `epoch`.
+std::vector<Orbit> transferOrbits(std::size_t count, JulianDate epoch, bool hyperbolic)
+{
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<double> semiMajorAxis(0.8, 5.0);
+    std::uniform_real_distribution<double> eccentricity(0.1, 0.9);
+    std::uniform_real_distribution<double> hyperbolicEccentricity(1.05, 2.5);
+    std::uniform_real_distribution<double> inclination(0.0, 0.1);
+    std::uniform_real_distribution<double> angle(0.0, 2.0 * glm::pi<double>());
+    std::uniform_real_distribution<double> meanAnomaly(-0.5, 0.5);
+    std::vector<Orbit> orbits;
+    orbits.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const OrbitalElements elements{.epoch = epoch,
+                                       .semiMajorAxis = hyperbolic ? -semiMajorAxis(generator)
+                                                                   : semiMajorAxis(generator),
+                                       .eccentricity = hyperbolic ? hyperbolicEccentricity(generator)
+                                                                  : eccentricity(generator),
+                                       .inclination = inclination(generator),
+                                       .longitudePerihelion = angle(generator),
+                                       .longitudeAscendingNode = angle(generator),
+                                       .meanAnomalyAtEpoch = meanAnomaly(generator)};
+        orbits.emplace_back(elements);
+    }
+    return orbits;
+}
+
+void measure(std::string_view name, std::span<const Orbit> orbits, JulianDate start, int frames,
+             const OrbitPropagator::Settings &settings)
+{
+    Ephemeris ephemeris;
+    for (const auto &orbit : orbits)
+        ephemeris.add(orbit);
+    const auto count = orbits.size();
+    std::vector<glm::dvec3> positions(count), exactPositions(count);
+
+    for (const auto step : {JulianDays{1.0 / 60.0}, JulianDays{0.5}, JulianDays{5.0}})
+    {
+        // accuracy, against the closed form at every frame
+        OrbitPropagator propagator(settings);
+        for (const auto &orbit : orbits)
+            propagator.add(orbit);
+        double maxError = 0.0;
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            const auto date = start + static_cast<double>(frame) * step;
+            propagator.advance(date, {.positions = positions});
+            ephemeris.compute(date, {.positions = exactPositions});
+            for (std::size_t i = 0; i < count; ++i)
+                maxError = std::max(maxError, glm::length(positions[i] - exactPositions[i]));
+        }
+        const auto resyncs = static_cast<double>(propagator.resyncCount()) / (static_cast<double>(frames) * count);
+
+        int frame = 0;
+        const auto exactSeconds = measureSeconds(frames, [&] {
+            ephemeris.compute(start + static_cast<double>(frame++) * step, {.positions = exactPositions});
+        });
+        OrbitPropagator timedPropagator(settings);
+        for (const auto &orbit : orbits)
+            timedPropagator.add(orbit);
+        frame = 0;
+        const auto incrementalSeconds = measureSeconds(frames, [&] {
+            timedPropagator.advance(start + static_cast<double>(frame++) * step, {.positions = positions});
+        });
+        std::println("{}, {} bodies, {:.3f} days/frame: closed form {:.1f} ns/body, incremental {:.1f} ns/body "
+                     "({:.2f}x), max error {:.2g} AU, {:.2f}% closed-form states",
+                     name, count, step.count(), 1e9 * exactSeconds / count, 1e9 * incrementalSeconds / count,
+                     exactSeconds / incrementalSeconds, maxError, 100.0 * resyncs);
+    }
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    int frames = 10'000;
+    std::size_t transferCount = 1'000;
+    OrbitPropagator::Settings settings;
+
+    ArgParser parser;
+    parser.addOption(frames, 'f', "frames");
+    parser.addOption(transferCount, 'n', "transfers");
+    parser.addOption(settings.resyncInterval, 'r', "resync-interval");
+    parser.addOption(settings.newtonSteps, 's', "newton-steps");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    Universe universe;
+    if (!universe.load(dataFilePath("universe.json")))
+    {
+        std::println(stderr, "Failed to load universe");
+        return 1;
+    }
+    const auto start = toJulianDate(std::chrono::year_month_day{std::chrono::year{2026}, std::chrono::January,
+                                                                std::chrono::day{1}});
+
+    std::vector<Orbit> worldOrbits;
+    for (const auto *world : universe.worlds())
+        worldOrbits.push_back(world->orbit());
+    measure("worlds", worldOrbits, start, frames, settings);
+    measure("elliptic transfers", transferOrbits(transferCount, start, false), start, frames, settings);
+    measure("hyperbolic transfers", transferOrbits(transferCount, start, true), start, frames, settings);
+
+    // the whole per-frame update of the universe, with a ship in transit
+    const auto *origin = universe.worlds()[2];
+    auto *ship = universe.addShip(universe.shipClasses()[0], origin, "Ship");
+    Orbit transferOrbit(transferOrbits(1, start, false).front().elements());
+    ship->setMissionPlan(MissionPlan{.origin = origin,
+                                     .destination = universe.worlds()[11],
+                                     .departureDate = start,
+                                     .arrivalDate = start + JulianYears{2.0},
+                                     .orbit = transferOrbit});
+    for (const auto propagation : {Universe::Propagation::ClosedForm, Universe::Propagation::Incremental})
+    {
+        universe.setPropagation(propagation);
+        universe.setDate(start + JulianDays{1.0});
+        universe.update(JulianDays{0.0});
+        const auto seconds = measureSeconds(frames, [&] { universe.update(JulianDays{0.5}); });
+        std::println("Universe::update, {}: {:.2f} us", propagation == Universe::Propagation::ClosedForm
+                                                              ? "closed form"
+                                                              : "incremental",
+                     1e6 * seconds);
+    }
+}
@@ -0,0 +1,140 @@
+#include "bench_util.h"
+
+#include <game/universe.h>
+
+#include <base/arg_parser.h>
+#include <base/asset_path.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <print>
+#include <random>
+
+namespace
+{
+
+std::size_t allocationCount = 0;
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (auto *p = std::malloc(size))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+int main(int argc, const char *argv[])
+{
+    std::size_t shipCount = 100'000;
+    int frames = 100;
+
+    ArgParser parser;
+    parser.addOption(shipCount, 's', "ships");
+    parser.addOption(frames, 'f', "frames");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    Universe universe;
+    if (!universe.load(dataFilePath("universe.json")))
+    {
+        std::println(stderr, "Failed to load universe");
+        return 1;
+    }
+    const auto start = toJulianDate(std::chrono::year_month_day{std::chrono::year{2026}, std::chrono::January,
+                                                                std::chrono::day{1}});
+    universe.setDate(start);
+    universe.update(JulianDays{0.0});
+
+    const auto *shipClass = universe.shipClasses()[0];
+    const auto worlds = universe.worlds();
+    std::mt19937 generator(1234);
+
+    const auto addShips = [&] {
+        for (std::size_t i = 0; i < shipCount; ++i)
+            universe.addShip(shipClass, worlds[i % worlds.size()], std::format("Ship {}", i));
+    };
+    const auto removeShips = [&] {
+        // in random order, so that the dense arrays get shuffled
+        std::vector<ShipHandle> handles(universe.shipStore().handles);
+        std::ranges::shuffle(handles, generator);
+        for (const auto handle : handles)
+            universe.removeShip(universe.ship(handle));
+    };
+
+    auto allocations = allocationCount;
+    const auto addSeconds = measureSeconds(1, addShips);
+    std::println("add {} ships: {:.1f} ms, {} allocations", shipCount, 1000.0 * addSeconds,
+                 allocationCount - allocations);
+
+    std::uniform_real_distribution<double> semiMajorAxis(1.2, 3.0);
+    std::uniform_real_distribution<double> angle(0.0, 2.0 * glm::pi<double>());
+    const auto setMissionPlan = [&](Ship *ship, JulianDate departureDate, JulianDate arrivalDate) {
+        const auto a = semiMajorAxis(generator);
+        const OrbitalElements elements{.epoch = start,
+                                       .semiMajorAxis = a,
+                                       .eccentricity = 1.0 - 1.0 / a,
+                                       .longitudePerihelion = angle(generator)};
+        ship->setMissionPlan(MissionPlan{.origin = ship->world(),
+                                         .destination = worlds[0],
+                                         .departureDate = departureDate,
+                                         .arrivalDate = arrivalDate,
+                                         .orbit = Orbit(elements)});
+    };
+
+    // the whole fleet is docked, waiting for missions that start in a month
+    for (auto *ship : universe.ships())
+        setMissionPlan(ship, start + JulianDays{30.0}, start + JulianYears{1.0});
+    const auto dockedSeconds = measureSeconds(frames, [&] { universe.update(JulianDays{1.0 / 60.0}); });
+    std::println("Universe::update, {} ships docked: {:.3f} ms", universe.shipStore().size(), 1000.0 * dockedSeconds);
+
+    // half the fleet leaves the worlds on transfer orbits instead
+    for (auto *ship : universe.ships())
+    {
+        if (generator() % 2 == 0)
+            continue;
+        setMissionPlan(ship, start + JulianDays{1.0}, start + JulianYears{5.0});
+    }
+    universe.update(JulianDays{2.0});
+
+    for (const auto propagation : {Universe::Propagation::ClosedForm, Universe::Propagation::Incremental})
+    {
+        universe.setPropagation(propagation);
+        universe.update(JulianDays{1.0 / 60.0});
+        const auto seconds = measureSeconds(frames, [&] { universe.update(JulianDays{1.0 / 60.0}); });
+        std::println("Universe::update, {} ships, {}: {:.2f} ms", universe.shipStore().size(),
+                     propagation == Universe::Propagation::ClosedForm ? "closed form" : "incremental",
+                     1000.0 * seconds);
+    }
+
+    // a step across every departure and arrival left
+    const auto crossingSeconds = measureSeconds(1, [&] { universe.update(JulianYears{10.0}); });
+    const auto arrivedCount = std::ranges::count_if(universe.ships(), [&](const Ship *ship) {
+        return ship->world() == worlds[0] && !ship->missionPlan().has_value();
+    });
+    std::println("Universe::update across all the departures and arrivals: {:.1f} ms, {} of {} ships arrived",
+                 1000.0 * crossingSeconds, arrivedCount, universe.shipStore().size());
+
+    allocations = allocationCount;
+    const auto removeSeconds = measureSeconds(1, removeShips);
+    std::println("remove {} ships: {:.1f} ms, {} allocations", shipCount, 1000.0 * removeSeconds,
+                 allocationCount - allocations);
+
+    // the slots and the component arrays of the removed ships are reused
+    allocations = allocationCount;
+    const auto readdSeconds = measureSeconds(1, addShips);
+    std::println("add {} ships again: {:.1f} ms, {} allocations", shipCount, 1000.0 * readdSeconds,
+                 allocationCount - allocations);
+}
@@ -0,0 +1,117 @@
+#include "bench_util.h"
+
+#include <game/starfield.h>
+
+#include <base/arg_parser.h>
+#include <base/file.h>
+#include <base/thread_pool.h>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <print>
+#include <random>
+
+namespace
+{
+
+// Random stars, one in a hundred with a proper name, in the format of stars.json and in the format of the HYG database.
+void writeCatalogs(std::size_t starCount, const std::string &jsonPath, const std::string &csvPath)
+{
+    constexpr std::string_view kSpectralTypes = "OBAFGKM";
+
+    std::mt19937 generator(starCount);
+    std::uniform_real_distribution<float> rightAscension(0.0f, 360.0f);
+    std::uniform_real_distribution<float> declination(-90.0f, 90.0f);
+    std::uniform_real_distribution<float> magnitude(-1.5f, 12.0f);
+    std::ofstream json(jsonPath);
+    std::ofstream csv(csvPath);
+    json << "[\n";
+    csv << "id,hip,bf,proper,ra,dec,dist,mag,spect\n";
+    for (std::size_t i = 0; i < starCount; ++i)
+    {
+        const auto properName = i % 100 == 0 ? std::format("Star {}", i / 100) : std::string{};
+        const auto ra = rightAscension(generator);
+        const auto dec = declination(generator);
+        const auto mag = magnitude(generator);
+        const auto spectralType = std::format("{}{}V", kSpectralTypes[i % kSpectralTypes.size()], i % 10);
+        json << std::format("{}  {{\"bayer_name\": \"HIP {}\", \"proper_name\": \"{}\", \"right_ascension\": {}, "
+                            "\"declination\": {}, \"spectral_type\": \"{}\", \"apparent_magnitude\": {}}}",
+                            i == 0 ? "" : ",\n", i, properName, ra, dec, spectralType, mag);
+        csv << std::format("{},{},,\"{}\",{},{},10.0,{},{}\n", i, i, properName, ra / 15.0f, dec, mag, spectralType);
+    }
+    json << "\n]\n";
+}
+
+// The right ascensions of the CSV catalog are in hours rounded to float, so they're only compared within a tolerance.
+bool sameStars(const Starfield &json, const Starfield &csv)
+{
+    if (json.size() != csv.size() || !std::ranges::equal(json.declinations(), csv.declinations()) ||
+        !std::ranges::equal(json.apparentMagnitudes(), csv.apparentMagnitudes()) ||
+        !std::ranges::equal(json.spectralClasses(), csv.spectralClasses()))
+        return false;
+    for (std::size_t i = 0; i < json.size(); ++i)
+    {
+        if (std::abs(json.rightAscensions()[i] - csv.rightAscensions()[i]) > 1e-5f ||
+            json.properName(i) != csv.properName(i))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    std::size_t threadCount = std::thread::hardware_concurrency();
+    int iterations = 3;
+
+    ArgParser parser;
+    parser.addOption(threadCount, 'j', "threads");
+    parser.addOption(iterations, 'i', "iterations");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    ThreadPool threadPool(std::max<std::size_t>(threadCount, 1) - 1);
+    const auto directory = std::filesystem::temp_directory_path();
+    const auto jsonPath = (directory / "bench_star_catalog.json").string();
+    const auto csvPath = (directory / "bench_star_catalog.csv").string();
+
+    for (const std::size_t starCount : {10'000, 100'000, 1'000'000})
+    {
+        writeCatalogs(starCount, jsonPath, csvPath);
+
+        // what the loader used to start with, before converting to one Star with two std::string per star
+        const auto domSeconds = measureSeconds(iterations, [&] {
+            const auto json = nlohmann::json::parse(readFile(jsonPath));
+            return json.size();
+        });
+
+        Starfield jsonStarfield;
+        bool loaded = true;
+        const auto jsonSeconds = measureSeconds(iterations, [&] { loaded &= jsonStarfield.loadJson(jsonPath); });
+        const auto jsonParallelSeconds =
+            measureSeconds(iterations, [&] { loaded &= jsonStarfield.loadJson(jsonPath, &threadPool); });
+        Starfield starfield;
+        const auto csvSeconds = measureSeconds(iterations, [&] { loaded &= starfield.loadCsv(csvPath); });
+        const auto csvParallelSeconds =
+            measureSeconds(iterations, [&] { loaded &= starfield.loadCsv(csvPath, &threadPool); });
+        if (!loaded || starfield.size() != starCount)
+        {
+            std::println(stderr, "Failed to load the catalogs of {} stars", starCount);
+            return 1;
+        }
+
+        std::println("{} stars: JSON DOM {:.1f} ms; JSON {:.1f} ms, {:.1f} ms on {} threads; CSV {:.1f} ms, {:.1f} ms "
+                     "on {} threads; {:.1f} bytes/star, {} names{}",
+                     starfield.size(), 1000.0 * domSeconds, 1000.0 * jsonSeconds, 1000.0 * jsonParallelSeconds,
+                     threadCount, 1000.0 * csvSeconds, 1000.0 * csvParallelSeconds, threadCount,
+                     static_cast<double>(starfield.memoryUsage()) / static_cast<double>(starfield.size()),
+                     starfield.names.size() - 1, sameStars(jsonStarfield, starfield) ? "" : " (MISMATCH)");
+    }
+
+    std::filesystem::remove(jsonPath);
+    std::filesystem::remove(csvPath);
+}
@@ -0,0 +1,132 @@
+#include <game/universe.h>
+
+#include <base/arg_parser.h>
+#include <base/asset_path.h>
+
+#include <chrono>
+#include <print>
+#include <random>
+
+namespace
+{
+
+// What UniverseMap::render and the ship labels ask for at each frame, straight from the orbits like they used to.
+double queryOrbits(const Universe &universe)
+{
+    const auto date = universe.date();
+    double sum = 0.0;
+    for (const auto *world : universe.worlds())
+        sum += world->orbit().eccentricAnomaly(date);
+    for (const auto *ship : universe.ships())
+    {
+        const auto &plan = ship->missionPlan();
+        if (!plan.has_value())
+            continue;
+        if (const auto *orbit = ship->orbit())
+        {
+            sum += glm::length(orbit->stateVector(date).velocity);
+            sum += orbit->positionOnOrbitPlane(date).x;
+        }
+        sum += plan->orbit.trueAnomaly(plan->departureDate);
+        sum += date > plan->departureDate ? plan->orbit.trueAnomaly(date) : 0.0;
+        sum += plan->orbit.trueAnomaly(plan->arrivalDate);
+    }
+    return sum;
+}
+
+// Same, through the date-stamped caches of World and Ship.
+double queryCaches(const Universe &universe)
+{
+    const auto date = universe.date();
+    double sum = 0.0;
+    for (const auto *world : universe.worlds())
+        sum += world->currentState().eccentricAnomaly;
+    for (const auto *ship : universe.ships())
+    {
+        const auto &plan = ship->missionPlan();
+        if (!plan.has_value())
+            continue;
+        if (ship->orbit())
+        {
+            sum += glm::length(ship->currentState().stateVector.velocity);
+            sum += ship->currentState().onOrbitPlane.position.x;
+        }
+        sum += ship->departureTrueAnomaly();
+        sum += date > plan->departureDate ? ship->currentState().trueAnomaly : 0.0;
+        sum += ship->arrivalTrueAnomaly();
+    }
+    return sum;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    int frames = 10'000;
+    std::size_t shipCount = 50;
+
+    ArgParser parser;
+    parser.addOption(frames, 'f', "frames");
+    parser.addOption(shipCount, 's', "ships");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    Universe universe;
+    if (!universe.load(dataFilePath("universe.json")))
+    {
+        std::println(stderr, "Failed to load universe");
+        return 1;
+    }
+    const auto start = toJulianDate(std::chrono::year_month_day{std::chrono::year{2026}, std::chrono::January,
+                                                                std::chrono::day{1}});
+    universe.setDate(start);
+    universe.setPropagation(Universe::Propagation::Incremental);
+
+    // ships on their way from Earth, on transfer orbits that leave it at departure
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<double> semiMajorAxis(1.2, 3.0);
+    std::uniform_real_distribution<double> angle(0.0, 2.0 * glm::pi<double>());
+    const auto *origin = universe.worlds()[2];
+    for (std::size_t i = 0; i < shipCount; ++i)
+    {
+        const auto a = semiMajorAxis(generator);
+        const OrbitalElements elements{.epoch = start,
+                                       .semiMajorAxis = a,
+                                       .eccentricity = 1.0 - 1.0 / a,
+                                       .longitudePerihelion = angle(generator)};
+        auto *ship = universe.addShip(universe.shipClasses()[0], origin, std::format("Ship {}", i));
+        ship->setMissionPlan(MissionPlan{.origin = origin,
+                                         .destination = universe.worlds()[11],
+                                         .departureDate = start - JulianDays{1.0},
+                                         .arrivalDate = start + JulianYears{2.0},
+                                         .orbit = Orbit(elements)});
+    }
+
+    // Kepler solves per frame, on this thread, for the update of the universe and for the queries of the map
+    for (const auto step : {JulianDays{1.0 / 60.0}, JulianDays{0.0}})
+    {
+        for (const auto cached : {false, true})
+        {
+            std::uint64_t updateSolves = 0;
+            std::uint64_t querySolves = 0;
+            double sum = 0.0;
+            std::chrono::duration<double> queryTime{0.0};
+            for (int frame = 0; frame < frames; ++frame)
+            {
+                const auto solvesBefore = keplerSolveCount();
+                universe.update(step);
+                const auto solvesAfterUpdate = keplerSolveCount();
+                const auto queryStart = std::chrono::steady_clock::now();
+                // the map renders once per frame, but its labels and gizmos ask again
+                for (int pass = 0; pass < 2; ++pass)
+                    sum += cached ? queryCaches(universe) : queryOrbits(universe);
+                queryTime += std::chrono::steady_clock::now() - queryStart;
+                updateSolves += solvesAfterUpdate - solvesBefore;
+                querySolves += keplerSolveCount() - solvesAfterUpdate;
+            }
+            std::println("{} days/frame, {}: {:.1f} Kepler solves/frame in update, {:.1f} in queries, "
+                         "{:.2f} us/frame of queries (checksum {:.3f})",
+                         step.count(), cached ? "caches" : "orbits", static_cast<double>(updateSolves) / frames,
+                         static_cast<double>(querySolves) / frames, 1e6 * queryTime.count() / frames, sum / frames);
+        }
+    }
+}
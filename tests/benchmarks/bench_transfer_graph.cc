@@ -0,0 +1,108 @@
+#include "bench_util.h"
+
+#include <game/transfer_graph.h>
+
+#include <base/arg_parser.h>
+#include <base/asset_path.h>
+#include <base/thread_pool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <print>
+#include <random>
+#include <thread>
+
+int main(int argc, const char *argv[])
+{
+    std::size_t maxThreads = std::thread::hardware_concurrency();
+    int iterations = 1;
+    int queries = 1000;
+    double maxLegDeltaV = 0.03;
+
+    ArgParser parser;
+    parser.addOption(maxThreads, 't', "max-threads");
+    parser.addOption(iterations, 'i', "iterations");
+    parser.addOption(queries, 'q', "queries");
+    parser.addOption(maxLegDeltaV, 'd', "max-delta-v");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    Universe universe;
+    if (!universe.load(dataFilePath("universe.json")))
+    {
+        std::println(stderr, "Failed to load universe");
+        return 1;
+    }
+
+    const auto start = toJulianDate(toYearMonthDay(JulianClock::now()));
+    const TransferGraph::Settings settings{.maxLegDeltaV = maxLegDeltaV};
+
+    std::optional<TransferGraph> graph;
+    const auto serialSeconds = measureSeconds(iterations, [&] { graph.emplace(&universe, start, settings); });
+    std::println("{} worlds, {} slots, {} nodes, {} transfer edges", universe.worlds().size(), graph->slotCount(),
+                 graph->nodeCount(), graph->edgeCount());
+    std::println("serial build: {:.1f} ms", 1000.0 * serialSeconds);
+    for (std::size_t threads = 2; threads <= maxThreads; ++threads)
+    {
+        ThreadPool threadPool(threads - 1);
+        const auto seconds =
+            measureSeconds(iterations, [&] { graph.emplace(&universe, start, settings, &threadPool); });
+        std::println("{:2} threads build: {:.1f} ms, speedup {:.2f}x", threads, 1000.0 * seconds,
+                     serialSeconds / seconds);
+    }
+
+    // random queries over the first half of the graph, with a one year time budget
+    const auto worlds = universe.worlds();
+    std::mt19937 generator(1234);
+    std::uniform_int_distribution<std::size_t> worldDistribution(0, worlds.size() - 1);
+    std::uniform_real_distribution<double> dateDistribution(0.0, 0.5 * (graph->end() - start).count());
+    std::size_t found = 0;
+    std::size_t legCount = 0;
+    double maxQuerySeconds = 0.0;
+    double totalQuerySeconds = 0.0;
+    for (int i = 0; i < queries; ++i)
+    {
+        const auto *origin = worlds[worldDistribution(generator)];
+        const auto *destination = worlds[worldDistribution(generator)];
+        const auto departure = start + JulianDays{dateDistribution(generator)};
+        const TransferGraph::Budget budget{.latestArrival = departure + JulianYears{1.0}};
+        const auto queryStart = std::chrono::steady_clock::now();
+        const auto route = graph->findRoute(origin, destination, departure, budget);
+        const auto seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - queryStart).count();
+        maxQuerySeconds = std::max(maxQuerySeconds, seconds);
+        totalQuerySeconds += seconds;
+        if (route)
+        {
+            ++found;
+            legCount += route->legs.size();
+        }
+    }
+    std::println("{} queries: {} routes found, {:.2f} legs per route, {:.3f} ms per query, max {:.3f} ms", queries,
+                 found, static_cast<double>(legCount) / std::max<std::size_t>(found, 1),
+                 1000.0 * totalQuerySeconds / queries, 1000.0 * maxQuerySeconds);
+
+    // same pair as Game::initialize
+    const auto *origin = worlds[2];       // Earth
+    const auto *destination = worlds[11]; // Vesta
+    if (const auto route = graph->findRoute(origin, destination, start, {}))
+    {
+        std::println("{} -> {}: {} legs, total delta-v {:g} AU/day, arrival {:D}", origin->name,
+                     destination->name, route->legs.size(), route->totalDeltaV, route->arrivalDate());
+        for (const auto &leg : route->legs)
+        {
+            const auto plan = graph->missionPlan(leg);
+            if (!plan)
+            {
+                std::println("  {} -> {}: no transfer", leg.origin->name, leg.destination->name);
+                continue;
+            }
+            std::println("  {} -> {}: {:D} -> {:D}, delta-v {:g} AU/day", leg.origin->name,
+                         leg.destination->name, leg.departureDate, leg.arrivalDate,
+                         plan->deltaVDeparture + plan->deltaVArrival);
+        }
+    }
+    else
+    {
+        std::println("{} -> {}: no route", origin->name, destination->name);
+    }
+}
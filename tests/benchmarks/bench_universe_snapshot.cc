@@ -0,0 +1,145 @@
+#include "bench_util.h"
+
+#include <game/universe.h>
+#include <game/universe_snapshot.h>
+
+#include <base/arg_parser.h>
+#include <base/asset_path.h>
+
+#include <chrono>
+#include <filesystem>
+#include <print>
+#include <random>
+
+namespace
+{
+
+// Half the fleet in transit, the other half docked with a mission ahead.
+void addShips(Universe &universe, std::size_t shipCount)
+{
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<double> semiMajorAxis(1.2, 3.0);
+    std::uniform_real_distribution<double> angle(0.0, 2.0 * glm::pi<double>());
+    const auto worlds = universe.worlds();
+    const auto start = universe.date();
+    for (std::size_t i = 0; i < shipCount; ++i)
+    {
+        const auto *origin = worlds[i % worlds.size()];
+        auto *ship = universe.addShip(universe.shipClasses()[i % universe.shipClasses().size()], origin,
+                                      std::format("Ship {}", i));
+        const auto a = semiMajorAxis(generator);
+        const OrbitalElements elements{.epoch = start,
+                                       .semiMajorAxis = a,
+                                       .eccentricity = 1.0 - 1.0 / a,
+                                       .longitudePerihelion = angle(generator)};
+        const auto departureDate = start + JulianDays{i % 2 == 0 ? -1.0 : 10.0};
+        ship->setMissionPlan(MissionPlan{.origin = origin,
+                                         .destination = worlds[(i + 1) % worlds.size()],
+                                         .departureDate = departureDate,
+                                         .arrivalDate = departureDate + JulianYears{1.0},
+                                         .orbit = Orbit(elements)});
+    }
+    universe.update(JulianDays{0.0});
+}
+
+bool sameState(const Universe &lhs, const Universe &rhs)
+{
+    if (lhs.date() != rhs.date() || lhs.worlds().size() != rhs.worlds().size() ||
+        lhs.shipStore().size() != rhs.shipStore().size())
+        return false;
+    for (std::size_t i = 0; i < lhs.worlds().size(); ++i)
+    {
+        auto lhsPrices = lhs.worlds()[i]->marketItemPrices();
+        auto rhsPrices = rhs.worlds()[i]->marketItemPrices();
+        if (!std::ranges::equal(lhsPrices, rhsPrices, [](const MarketItemPrice &a, const MarketItemPrice &b) {
+                return a.item->name == b.item->name && a.sellPrice == b.sellPrice && a.buyPrice == b.buyPrice;
+            }))
+            return false;
+    }
+    const auto &lhsShips = lhs.shipStore();
+    const auto &rhsShips = rhs.shipStore();
+    for (std::size_t i = 0; i < lhsShips.size(); ++i)
+    {
+        const auto &lhsPlan = lhsShips.missionPlans[i];
+        const auto &rhsPlan = rhsShips.missionPlans[i];
+        if (lhsShips.names[i] != rhsShips.names[i] || lhsShips.states[i] != rhsShips.states[i] ||
+            !std::ranges::equal(lhsShips.cargo(i), rhsShips.cargo(i)) || lhsPlan.has_value() != rhsPlan.has_value() ||
+            (lhsPlan && (lhsPlan->arrivalDate != rhsPlan->arrivalDate ||
+                         lhsPlan->orbit.elements() != rhsPlan->orbit.elements())))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    std::size_t shipCount = 100'000;
+    int iterations = 20;
+
+    ArgParser parser;
+    parser.addOption(shipCount, 's', "ships");
+    parser.addOption(iterations, 'i', "iterations");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    const auto jsonPath = dataFilePath("universe.json");
+    const auto snapshotPath = (std::filesystem::temp_directory_path() / "bench_universe_snapshot.bin").string();
+    const auto start = toJulianDate(std::chrono::year_month_day{std::chrono::year{2026}, std::chrono::January,
+                                                                std::chrono::day{1}});
+
+    // the definitions alone, as in universe.json
+    Universe universe;
+    if (!universe.load(jsonPath))
+    {
+        std::println(stderr, "Failed to load universe");
+        return 1;
+    }
+    universe.setDate(start);
+    const auto jsonSeconds = measureSeconds(iterations, [&] {
+        Universe loaded;
+        loaded.load(jsonPath);
+    });
+    UniverseSnapshot::save(universe, snapshotPath);
+    const auto emptySnapshotSeconds = measureSeconds(iterations, [&] {
+        Universe loaded;
+        UniverseSnapshot::load(loaded, snapshotPath);
+    });
+    std::println("load without ships: JSON {:.3f} ms, snapshot {:.3f} ms ({} bytes)", 1000.0 * jsonSeconds,
+                 1000.0 * emptySnapshotSeconds, std::filesystem::file_size(snapshotPath));
+
+    addShips(universe, shipCount);
+
+    std::vector<std::byte> buffer;
+    UniverseSnapshot::capture(universe, buffer);
+    const auto captureSeconds = measureSeconds(iterations, [&] { UniverseSnapshot::capture(universe, buffer); });
+    const auto saveSeconds = measureSeconds(iterations, [&] { UniverseSnapshot::save(universe, snapshotPath); });
+    SnapshotWriter writer;
+    std::chrono::duration<double> checkpointTime{0.0};
+    for (int i = 0; i < iterations; ++i)
+    {
+        writer.wait();
+        const auto checkpointStart = std::chrono::steady_clock::now();
+        writer.checkpoint(universe, snapshotPath);
+        checkpointTime += std::chrono::steady_clock::now() - checkpointStart;
+    }
+    writer.wait();
+    std::println("{} ships, {:.1f} MiB: capture {:.2f} ms, save {:.2f} ms, checkpoint on the calling thread {:.2f} ms",
+                 shipCount, static_cast<double>(buffer.size()) / (1024.0 * 1024.0), 1000.0 * captureSeconds,
+                 1000.0 * saveSeconds, 1000.0 * checkpointTime.count() / iterations);
+
+    bool roundTrip = true;
+    const auto loadSeconds = measureSeconds(iterations, [&] {
+        Universe loaded;
+        roundTrip = UniverseSnapshot::load(loaded, snapshotPath) && sameState(universe, loaded) && roundTrip;
+    });
+    std::println("{} ships: load {:.2f} ms, round trip {}", shipCount, 1000.0 * loadSeconds,
+                 roundTrip ? "identical" : "DIFFERENT");
+
+    // a truncated file is rejected before the universe is touched
+    buffer.resize(buffer.size() / 2);
+    Universe truncated;
+    std::println("truncated snapshot: {}", UniverseSnapshot::restore(truncated, buffer) ? "accepted" : "rejected");
+
+    std::filesystem::remove(snapshotPath);
+}
@@ -0,0 +1,102 @@
+#include <game/universe.h>
+
+#include <base/arg_parser.h>
+#include <base/asset_path.h>
+#include <base/thread_pool.h>
+
+#include <chrono>
+#include <print>
+#include <random>
+
+namespace
+{
+
+// Ships between the worlds, with departures and arrivals spread over the frames that are measured.
+void addShips(Universe &universe, std::size_t shipCount, JulianDate start)
+{
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<double> semiMajorAxis(1.2, 3.0);
+    std::uniform_real_distribution<double> angle(0.0, 2.0 * glm::pi<double>());
+    std::uniform_real_distribution<double> departure(-1.0, 2.0);
+    std::uniform_real_distribution<double> transitTime(0.5, 3.0);
+    const auto worlds = universe.worlds();
+    for (std::size_t i = 0; i < shipCount; ++i)
+    {
+        const auto *origin = worlds[i % worlds.size()];
+        auto *ship = universe.addShip(universe.shipClasses()[0], origin, std::format("Ship {}", i));
+        const auto a = semiMajorAxis(generator);
+        const OrbitalElements elements{.epoch = start,
+                                       .semiMajorAxis = a,
+                                       .eccentricity = 1.0 - 1.0 / a,
+                                       .longitudePerihelion = angle(generator)};
+        const auto departureDate = start + JulianDays{departure(generator)};
+        ship->setMissionPlan(MissionPlan{.origin = origin,
+                                         .destination = worlds[(i + 1) % worlds.size()],
+                                         .departureDate = departureDate,
+                                         .arrivalDate = departureDate + JulianDays{transitTime(generator)},
+                                         .orbit = Orbit(elements)});
+    }
+}
+
+} // namespace
+
+int main(int argc, const char *argv[])
+{
+    std::size_t shipCount = 100'000;
+    std::size_t maxThreads = std::thread::hardware_concurrency();
+    int frames = 300;
+
+    ArgParser parser;
+    parser.addOption(shipCount, 's', "ships");
+    parser.addOption(maxThreads, 't', "max-threads");
+    parser.addOption(frames, 'f', "frames");
+    parser.parse(std::span{argv + 1, argv + argc});
+
+    const auto start = toJulianDate(std::chrono::year_month_day{std::chrono::year{2026}, std::chrono::January,
+                                                                std::chrono::day{1}});
+
+    // every thread count has to give the same positions and the same signals, in the same order
+    for (const auto propagation : {Universe::Propagation::ClosedForm, Universe::Propagation::Incremental})
+    {
+        for (std::size_t threads = 1; threads <= std::max<std::size_t>(maxThreads, 2); threads *= 2)
+        {
+            ThreadPool threadPool(threads - 1);
+            Universe universe;
+            if (!universe.load(dataFilePath("universe.json")))
+            {
+                std::println(stderr, "Failed to load universe");
+                return 1;
+            }
+            universe.setDate(start);
+            universe.setPropagation(propagation);
+            universe.setThreadPool(&threadPool);
+            addShips(universe, shipCount, start);
+
+            std::uint64_t signalHash = 0;
+            std::size_t signalCount = 0;
+            universe.shipStateChangedSignal.connect([&](Ship *ship, Ship::State state) {
+                const auto handle = ship->handle();
+                signalHash = signalHash * 1'000'003 + (handle.slot * 2 + static_cast<std::uint64_t>(state));
+                ++signalCount;
+            });
+
+            std::chrono::duration<double> elapsed{0.0};
+            for (int frame = 0; frame < frames; ++frame)
+            {
+                const auto frameStart = std::chrono::steady_clock::now();
+                universe.update(JulianDays{1.0 / 60.0});
+                elapsed += std::chrono::steady_clock::now() - frameStart;
+            }
+
+            double positionSum = 0.0;
+            for (const auto *ship : universe.ships())
+            {
+                const auto position = ship->currentPosition();
+                positionSum += position.x + 2.0 * position.y + 3.0 * position.z;
+            }
+            std::println("{}, {} threads: {:.2f} ms/frame, {} state changes (hash {:016x}), position checksum {:.17f}",
+                         propagation == Universe::Propagation::ClosedForm ? "closed form" : "incremental", threads,
+                         1000.0 * elapsed.count() / frames, signalCount, signalHash, positionSum);
+        }
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <chrono>
+
+// Average wall time of a call to `func`, in seconds.
+template<typename Func>
+double measureSeconds(int iterations, Func &&func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        func();
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    return elapsed.count() / iterations;
+}
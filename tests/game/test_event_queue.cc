@@ -0,0 +1,115 @@
+#include <game/event_queue.h>
+#include <game/universe.h>
+
+#include <base/asset_path.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <utility>
+#include <vector>
+
+TEST_CASE("order", "[event_queue]")
+{
+    const auto start = toJulianDate(std::chrono::year_month_day{std::chrono::year{2026}, std::chrono::January,
+                                                                std::chrono::day{1}});
+    const auto day = [start](double days) { return start + JulianDays{days}; };
+
+    // events at the same date come out in the order they were pushed, whatever the heap does with the others
+    EventQueue<int> events;
+    for (int i = 0; i < 20; ++i)
+        events.push(day(i % 2 == 0 ? 2.0 : 1.0), i);
+    events.push(day(0.5), -1);
+    REQUIRE(events.size() == 21);
+    REQUIRE(events.nextDate() == day(0.5));
+
+    std::vector<std::pair<JulianDate, int>> popped;
+    const auto pop = [&popped](JulianDate date, int event) { popped.emplace_back(date, event); };
+    REQUIRE(events.popDue(day(0.5), pop) == 0); // strictly before the date
+    REQUIRE(events.popDue(day(1.5), pop) == 11);
+    REQUIRE(popped.front() == std::pair{day(0.5), -1});
+    for (int i = 0; i < 10; ++i)
+        REQUIRE(popped[i + 1] == std::pair{day(1.0), 2 * i + 1});
+
+    // pushed while popping: popped in the same call if due, after the events already there at the same date
+    popped.clear();
+    const auto count = events.popDue(day(3.0), [&](JulianDate date, int event) {
+        pop(date, event);
+        if (event == 0)
+        {
+            events.push(day(2.0), 100);
+            events.push(day(2.5), 101);
+            events.push(day(4.0), 102);
+        }
+    });
+    REQUIRE(count == 12);
+    for (int i = 0; i < 10; ++i)
+        REQUIRE(popped[i] == std::pair{day(2.0), 2 * i});
+    REQUIRE(popped[10] == std::pair{day(2.0), 100});
+    REQUIRE(popped[11] == std::pair{day(2.5), 101});
+    REQUIRE(events.size() == 1);
+    REQUIRE(events.nextDate() == day(4.0));
+
+    events.clear();
+    REQUIRE(events.empty());
+}
+
+TEST_CASE("replaced mission plans", "[event_queue]")
+{
+    Universe universe;
+    REQUIRE(universe.load(dataFilePath("universe.json")));
+    const auto start = toJulianDate(std::chrono::year_month_day{std::chrono::year{2026}, std::chrono::January,
+                                                                std::chrono::day{1}});
+    const auto day = [start](double days) { return start + JulianDays{days}; };
+    universe.setDate(start);
+
+    const auto worlds = universe.worlds();
+    REQUIRE(worlds.size() >= 3);
+    auto *ship = universe.addShip(universe.shipClasses()[0], worlds[0], "Ship");
+    const auto handle = ship->handle();
+    std::vector<std::pair<ShipHandle, Ship::State>> states;
+    universe.shipStateChangedSignal.connect(
+        [&states](Ship *changed, Ship::State state) { states.emplace_back(changed->handle(), state); });
+
+    const auto missionPlan = [&](const World *origin, const World *destination, JulianDate departureDate,
+                                 JulianDate arrivalDate) {
+        const OrbitalElements elements{.epoch = start, .semiMajorAxis = 1.5, .eccentricity = 1.0 / 3.0};
+        return MissionPlan{.origin = origin,
+                           .destination = destination,
+                           .departureDate = departureDate,
+                           .arrivalDate = arrivalDate,
+                           .orbit = Orbit(elements)};
+    };
+
+    // the events of the first plan are left in the queue, and dropped when they come due
+    ship->setMissionPlan(missionPlan(worlds[0], worlds[1], day(1.0), day(10.0)));
+    ship->setMissionPlan(missionPlan(worlds[0], worlds[2], day(3.0), day(5.0)));
+
+    universe.update(JulianDays{2.0});
+    REQUIRE(ship->state() == Ship::State::Docked);
+    REQUIRE(ship->world() == worlds[0]);
+    REQUIRE(states.empty());
+
+    universe.update(JulianDays{2.0});
+    REQUIRE(ship->state() == Ship::State::InTransit);
+
+    universe.update(JulianDays{2.0});
+    REQUIRE(ship->state() == Ship::State::Docked);
+    REQUIRE(ship->world() == worlds[2]);
+    REQUIRE(!ship->missionPlan().has_value());
+
+    universe.update(JulianDays{6.0});
+    REQUIRE(ship->state() == Ship::State::Docked);
+    REQUIRE(ship->world() == worlds[2]);
+    REQUIRE(states == std::vector{std::pair{handle, Ship::State::InTransit}, std::pair{handle, Ship::State::Docked}});
+
+    // and so are the ones of a removed ship, even once its slot is reused
+    ship->setMissionPlan(missionPlan(worlds[2], worlds[1], day(13.0), day(20.0)));
+    universe.removeShip(ship);
+    auto *other = universe.addShip(universe.shipClasses()[0], worlds[0], "Other");
+    REQUIRE(other->handle().slot == handle.slot);
+    REQUIRE(universe.ship(handle) == nullptr);
+    states.clear();
+    universe.update(JulianDays{10.0});
+    REQUIRE(other->state() == Ship::State::Docked);
+    REQUIRE(states.empty());
+}
@@ -0,0 +1,69 @@
+#include <game/kepler.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+
+constexpr std::pair<KeplerSolver, double> kSolvers[] = {
+    {KeplerSolver::Newton, 1e-10},
+    {KeplerSolver::Danby, 1e-12},
+    {KeplerSolver::Markley, 1e-12},
+    {KeplerSolver::Lookup, 1e-9},
+};
+
+// mean anomalies over several turns both ways
+constexpr int kSamples = 2000;
+constexpr double kMaxMeanAnomaly = 20.0;
+
+double meanAnomaly(int sample)
+{
+    return kMaxMeanAnomaly * (2.0 * sample / kSamples - 1.0);
+}
+
+} // namespace
+
+TEST_CASE("elliptic", "[kepler]")
+{
+    // up to the eccentricities the lookup table leaves to Danby, and close to parabolic
+    for (const auto [solver, tolerance] : kSolvers)
+    {
+        for (const auto e : {0.0, 0.01, 0.1, 0.3, 0.5, 0.7, 0.9, 0.95, 0.97, 0.99, 0.999, 0.9999})
+        {
+            auto previous = -INFINITY;
+            for (int sample = 0; sample <= kSamples; ++sample)
+            {
+                const auto M = meanAnomaly(sample);
+                const auto E = solveKepler(solver, M, e).anomaly;
+                REQUIRE(std::abs(E - e * std::sin(E) - M) < tolerance);
+                // continuous across the whole turns
+                REQUIRE(E >= previous);
+                previous = E;
+            }
+        }
+    }
+}
+
+TEST_CASE("hyperbolic", "[kepler]")
+{
+    // every solver but Newton falls back to Danby
+    for (const auto [solver, tolerance] : kSolvers)
+    {
+        for (const auto e : {1.0, 1.001, 1.01, 1.1, 1.5, 3.0, 10.0})
+        {
+            auto previous = -INFINITY;
+            for (int sample = 0; sample <= kSamples; ++sample)
+            {
+                const auto M = meanAnomaly(sample);
+                const auto H = solveKepler(solver, M, e).anomaly;
+                REQUIRE(std::abs(e * std::sinh(H) - H - M) < tolerance * std::max(1.0, std::abs(M)));
+                REQUIRE(H >= previous);
+                previous = H;
+            }
+        }
+    }
+}
@@ -0,0 +1,173 @@
+#include <game/lambert.h>
+#include <game/universe.h>
+
+#include <glm/gtc/constants.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// Random heliocentric geometries between 0.5 and 5 AU, close to the ecliptic, with times of flight between 20 days
+// and 4 years. About half of them go the long way around.
+std::vector<LambertProblem> randomProblems(std::size_t count, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> radius(0.5, 5.0);
+    std::uniform_real_distribution<double> longitude(0.0, 2.0 * glm::pi<double>());
+    std::uniform_real_distribution<double> latitude(-0.2, 0.2);
+    std::uniform_real_distribution<double> timeOfFlight(20.0, 4.0 * 365.25);
+    const auto randomPosition = [&] {
+        const auto r = radius(generator);
+        const auto lon = longitude(generator);
+        const auto lat = latitude(generator);
+        return r * glm::dvec3{std::cos(lat) * std::cos(lon), std::cos(lat) * std::sin(lon), std::sin(lat)};
+    };
+    std::vector<LambertProblem> problems(count);
+    std::ranges::generate(problems, [&] {
+        const auto r1 = randomPosition();
+        const auto r2 = randomPosition();
+        return LambertProblem{r1, r2, timeOfFlight(generator)};
+    });
+    return problems;
+}
+
+// Propagates a two-body state for `dt` with universal variables, so the solutions are checked independently of both
+// solvers.
+glm::dvec3 propagate(double mu, const glm::dvec3 &r0, const glm::dvec3 &v0, double dt)
+{
+    const auto stumpffC = [](double z) {
+        if (z > 1e-8)
+            return (1.0 - std::cos(std::sqrt(z))) / z;
+        if (z < -1e-8)
+            return (std::cosh(std::sqrt(-z)) - 1.0) / -z;
+        return 0.5 - z / 24.0;
+    };
+    const auto stumpffS = [](double z) {
+        if (z > 1e-8)
+            return (std::sqrt(z) - std::sin(std::sqrt(z))) / std::pow(z, 1.5);
+        if (z < -1e-8)
+            return (std::sinh(std::sqrt(-z)) - std::sqrt(-z)) / std::pow(-z, 1.5);
+        return 1.0 / 6.0 - z / 120.0;
+    };
+
+    const auto sqrtMu = std::sqrt(mu);
+    const auto r0mag = glm::length(r0);
+    const auto vr0 = glm::dot(r0, v0) / r0mag;
+    const auto alpha = 2.0 / r0mag - glm::dot(v0, v0) / mu;
+
+    // universal Kepler equation, F(chi) = 0, F is monotonically increasing
+    const auto kepler = [&](double chi) {
+        const auto z = alpha * chi * chi;
+        const auto c = stumpffC(z);
+        const auto s = stumpffS(z);
+        const auto f = r0mag * vr0 / sqrtMu * chi * chi * c + (1.0 - alpha * r0mag) * chi * chi * chi * s +
+                       r0mag * chi - sqrtMu * dt;
+        const auto df = r0mag * vr0 / sqrtMu * chi * (1.0 - alpha * chi * chi * s) +
+                        (1.0 - alpha * r0mag) * chi * chi * c + r0mag;
+        return std::pair{f, df};
+    };
+
+    // bracket the root, then Newton iterations falling back to bisection whenever they leave the bracket
+    double low = 0.0;
+    double high = sqrtMu * dt / r0mag;
+    while (kepler(high).first < 0.0)
+    {
+        low = high;
+        high *= 2.0;
+    }
+    double chi = 0.5 * (low + high);
+    for (int i = 0; i < 200 && high - low > 1e-14 * high; ++i)
+    {
+        const auto [f, df] = kepler(chi);
+        if (f < 0.0)
+            low = chi;
+        else
+            high = chi;
+        const auto next = chi - f / df;
+        chi = next >= low && next <= high ? next : 0.5 * (low + high);
+        if (std::abs(f) < 1e-15 * sqrtMu * dt)
+            break;
+    }
+
+    const auto z = alpha * chi * chi;
+    const auto f = 1.0 - chi * chi / r0mag * stumpffC(z);
+    const auto g = dt - chi * chi * chi * stumpffS(z) / sqrtMu;
+    return f * r0 + g * v0;
+}
+
+// Position error at the end of the transfer, relative to the distance of the destination.
+double residual(const LambertProblem &problem, const TransferVelocities &velocities)
+{
+    const auto r2 = propagate(kGMSun, problem.r1, velocities.initialVelocity, problem.dt);
+    return glm::length(r2 - problem.r2) / glm::length(problem.r2);
+}
+
+// A margin over the tolerances of the solvers, Battin's iteration stops at steps of 1e-8 on its x variable.
+constexpr double kAccurate = 1e-7;
+
+double relativeDifference(const glm::dvec3 &v, const glm::dvec3 &reference)
+{
+    return glm::length(v - reference) / glm::length(reference);
+}
+
+} // namespace
+
+TEST_CASE("zero revolutions", "[lambert]")
+{
+    // both solvers find the same transfer, in both directions and on both sides of a half turn
+    for (const auto ot : {OrbitType::Prograde, OrbitType::Retrograde})
+    {
+        for (const auto &problem : randomProblems(500, 1))
+        {
+            const auto battin = lambert_battin(kGMSun, problem.r1, problem.r2, problem.dt, ot);
+            const auto izzo = lambert_izzo(kGMSun, problem.r1, problem.r2, problem.dt, ot);
+            REQUIRE(battin.has_value());
+            REQUIRE(izzo.size() == 1);
+            REQUIRE(izzo[0].revolutions == 0);
+            REQUIRE(residual(problem, *battin) < kAccurate);
+            REQUIRE(residual(problem, izzo[0].velocities) < kAccurate);
+            REQUIRE(relativeDifference(izzo[0].velocities.initialVelocity, battin->initialVelocity) < 1e-6);
+            REQUIRE(relativeDifference(izzo[0].velocities.finalVelocity, battin->finalVelocity) < 1e-6);
+
+            // in the requested direction
+            const auto angularMomentum = glm::cross(problem.r1, battin->initialVelocity);
+            REQUIRE((angularMomentum.z > 0.0) == (ot == OrbitType::Prograde));
+        }
+    }
+}
+
+TEST_CASE("multiple revolutions", "[lambert]")
+{
+    constexpr int kMaxRevolutions = 3;
+
+    // every branch reaches the destination, the zero revolution solution first and then a pair for each number of
+    // revolutions up to the largest one the time of flight allows
+    std::size_t multiRevolution = 0;
+    for (const auto &problem : randomProblems(500, 2))
+    {
+        const auto solutions = lambert_izzo(kGMSun, problem.r1, problem.r2, problem.dt, OrbitType::Prograde,
+                                            kMaxRevolutions);
+        REQUIRE(!solutions.empty());
+        REQUIRE(solutions.size() % 2 == 1);
+        for (std::size_t i = 0; i < solutions.size(); ++i)
+        {
+            const auto &solution = solutions[i];
+            REQUIRE(solution.revolutions == static_cast<int>((i + 1) / 2));
+            REQUIRE(residual(problem, solution.velocities) < kAccurate);
+            REQUIRE(glm::cross(problem.r1, solution.velocities.initialVelocity).z > 0.0);
+        }
+        multiRevolution += solutions.size() - 1;
+
+        // the two branches of a pair are different transfers
+        for (std::size_t i = 1; i + 1 < solutions.size(); i += 2)
+            REQUIRE(relativeDifference(solutions[i].velocities.initialVelocity,
+                                       solutions[i + 1].velocities.initialVelocity) > 1e-6);
+    }
+    REQUIRE(multiRevolution > 100);
+}
@@ -0,0 +1,91 @@
+#include <game/market_economy.h>
+
+#include <base/thread_pool.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <vector>
+
+TEST_CASE("determinism", "[market_economy]")
+{
+    // enough cells for a tick to be split across the pool, and rows that aren't a whole number of packs
+    constexpr std::size_t kWorldCount = 300;
+    constexpr std::size_t kItemCount = 131;
+
+    MarketEconomy inlineEconomy;
+    inlineEconomy.reset(kWorldCount, kItemCount, 42);
+    MarketEconomy parallelEconomy;
+    parallelEconomy.reset(kWorldCount, kItemCount, 42);
+    ThreadPool threadPool(3);
+    for (int i = 0; i < 50; ++i)
+    {
+        inlineEconomy.tick();
+        parallelEconomy.tick(&threadPool);
+    }
+    REQUIRE(inlineEconomy.tickCount() == 50);
+    REQUIRE(inlineEconomy.supply == parallelEconomy.supply);
+    REQUIRE(inlineEconomy.demand == parallelEconomy.demand);
+
+    MarketEconomy otherEconomy;
+    otherEconomy.reset(kWorldCount, kItemCount, 43);
+    for (int i = 0; i < 50; ++i)
+        otherEconomy.tick();
+    REQUIRE(otherEconomy.supply != inlineEconomy.supply);
+}
+
+TEST_CASE("prices", "[market_economy]")
+{
+    constexpr std::size_t kWorldCount = 20;
+    constexpr std::size_t kItemCount = 40;
+
+    MarketEconomy economy;
+    economy.reset(kWorldCount, kItemCount, 7);
+    for (int i = 0; i < 100; ++i)
+        economy.tick();
+
+    const auto &settings = economy.settings();
+    std::vector<std::uint64_t> sellPrices(kItemCount), buyPrices(kItemCount);
+    for (std::size_t world = 0; world < kWorldCount; ++world)
+    {
+        economy.writePrices(world, sellPrices, buyPrices);
+        for (std::size_t item = 0; item < kItemCount; ++item)
+        {
+            const auto cell = world * kItemCount + item;
+            REQUIRE(economy.supply[cell] >= 0.0f);
+            REQUIRE(economy.demand[cell] >= 0.0f);
+
+            const auto price = economy.price(world, item);
+            REQUIRE(price >= settings.minPriceRatio * economy.basePrices[cell]);
+            REQUIRE(price <= settings.maxPriceRatio * economy.basePrices[cell]);
+
+            // only the items produced are sold, only the items consumed are bought, with the spread in between
+            REQUIRE((sellPrices[item] != 0) == (economy.production[cell] > 0.0f));
+            REQUIRE((buyPrices[item] != 0) == (economy.consumption[cell] > 0.0f));
+            if (sellPrices[item] != 0 && buyPrices[item] != 0)
+                REQUIRE(sellPrices[item] > buyPrices[item]);
+        }
+    }
+}
+
+TEST_CASE("supply and demand", "[market_economy]")
+{
+    MarketEconomy economy;
+    economy.resize(1, 1, 0);
+    economy.basePrices[0] = 1000.0f;
+    economy.production[0] = 0.0f;
+    economy.consumption[0] = 1.0f;
+    const auto balancedPrice = economy.price(0, 0);
+
+    // a world that consumes an item it doesn't produce sees its price go up as the demand accumulates
+    for (int i = 0; i < 10; ++i)
+        economy.tick();
+    REQUIRE(economy.demand[0] > 0.0f);
+    REQUIRE(economy.price(0, 0) > balancedPrice);
+
+    // and go down once a ship delivers more than is wanted
+    economy.supply[0] = economy.demand[0] + 100.0f;
+    economy.tick();
+    REQUIRE(economy.demand[0] == 0.0f);
+    REQUIRE(economy.price(0, 0) < balancedPrice);
+}
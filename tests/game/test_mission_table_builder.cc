@@ -0,0 +1,49 @@
+#include <game/mission_table_builder.h>
+#include <game/mission_table_cache.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+namespace
+{
+
+void waitUntilFinished(MissionTableBuilder &builder)
+{
+    while (!builder.isFinished())
+    {
+        builder.poll();
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+}
+
+} // namespace
+
+TEST_CASE("cached build", "[mission_table_builder]")
+{
+    const auto epoch = JulianDate{JulianDays{2451545.0}};
+    const World origin(nullptr, 0, OrbitalElements{.epoch = epoch, .semiMajorAxis = 1.0});
+    const World destination(nullptr, 1, OrbitalElements{.epoch = epoch, .semiMajorAxis = 1.52});
+    const MissionTable::Settings settings{.maxDeltaV = 0.03};
+
+    const MissionTableCache cache(std::filesystem::temp_directory_path() / "sundog-test-mission-table-builder");
+    std::filesystem::remove_all(cache.directory());
+
+    // solved on the background thread, then stored
+    {
+        MissionTableBuilder builder(&origin, &destination, epoch, settings, nullptr, &cache);
+        REQUIRE(!builder.isFinished());
+        waitUntilFinished(builder);
+    }
+
+    // loaded from the cache, finished right away and still finished after polling
+    MissionTableBuilder builder(&origin, &destination, epoch, settings, nullptr, &cache);
+    REQUIRE(builder.isFinished());
+    REQUIRE(!builder.poll());
+    REQUIRE(builder.isFinished());
+    REQUIRE(builder.table() != nullptr);
+
+    std::filesystem::remove_all(cache.directory());
+}
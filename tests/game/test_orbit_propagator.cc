@@ -0,0 +1,105 @@
+#include <game/orbit_propagator.h>
+#include <game/universe.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+constexpr double kAccurate = 1e-9;
+
+// Elliptic orbits up to e = 0.9 and hyperbolic ones, starting on either side of the periapsis.
+std::vector<Orbit> testOrbits(JulianDate epoch)
+{
+    std::vector<Orbit> orbits;
+    for (const auto [semiMajorAxis, eccentricity] :
+         {std::pair{1.0, 0.0}, std::pair{1.5, 0.3}, std::pair{3.0, 0.9}, std::pair{-1.0, 1.2}, std::pair{-2.0, 3.0}})
+    {
+        for (const auto meanAnomaly : {-0.3, 0.0, 2.0})
+        {
+            orbits.emplace_back(OrbitalElements{.epoch = epoch,
+                                                .semiMajorAxis = semiMajorAxis,
+                                                .eccentricity = eccentricity,
+                                                .inclination = 0.1,
+                                                .longitudePerihelion = 1.0,
+                                                .longitudeAscendingNode = 2.0,
+                                                .meanAnomalyAtEpoch = meanAnomaly});
+        }
+    }
+    return orbits;
+}
+
+double relativeDifference(const glm::dvec3 &v, const glm::dvec3 &reference)
+{
+    return glm::length(v - reference) / glm::length(reference);
+}
+
+// Advances the propagator to `date` and checks every body against the closed form of its orbit.
+void requireClosedForm(OrbitPropagator &propagator, std::span<const Orbit> orbits, JulianDate date)
+{
+    std::vector<glm::dvec3> positions(orbits.size()), velocities(orbits.size());
+    propagator.advance(date, {.positions = positions, .velocities = velocities});
+    for (std::size_t i = 0; i < orbits.size(); ++i)
+    {
+        const auto [position, velocity] = orbits[i].stateVector(date);
+        REQUIRE(relativeDifference(positions[i], position) < kAccurate);
+        REQUIRE(relativeDifference(velocities[i], velocity) < kAccurate);
+    }
+}
+
+} // namespace
+
+TEST_CASE("steps", "[orbit_propagator]")
+{
+    const auto start = toJulianDate(std::chrono::year_month_day{std::chrono::year{2026}, std::chrono::January,
+                                                                std::chrono::day{1}});
+    const auto orbits = testOrbits(start);
+    const auto count = orbits.size();
+
+    // frame steps, and steps of several days, stay on the orbits up to the scheduled resyncs
+    for (const auto step : {JulianDays{1.0 / 60.0}, JulianDays{0.5}, JulianDays{5.0}})
+    {
+        OrbitPropagator propagator(OrbitPropagator::Settings{.resyncInterval = 16});
+        for (const auto &orbit : orbits)
+            propagator.add(orbit);
+
+        for (int frame = 0; frame <= 40; ++frame)
+            requireClosedForm(propagator, orbits, start + static_cast<double>(frame) * step);
+        // at the first frame, then after every 16 steps, and the larger steps also whenever the warm start isn't
+        // close enough for Newton to converge
+        if (step < JulianDays{0.1})
+            REQUIRE(propagator.resyncCount() == 3 * count);
+        else
+            REQUIRE(propagator.resyncCount() >= 3 * count);
+    }
+}
+
+TEST_CASE("resync", "[orbit_propagator]")
+{
+    const auto start = toJulianDate(std::chrono::year_month_day{std::chrono::year{2026}, std::chrono::January,
+                                                                std::chrono::day{1}});
+    const auto orbits = testOrbits(start);
+
+    OrbitPropagator propagator;
+    for (const auto &orbit : orbits)
+        propagator.add(orbit);
+    auto date = start;
+    for (int frame = 0; frame < 10; ++frame, date += JulianDays{0.5})
+        requireClosedForm(propagator, orbits, date);
+    const auto resyncCount = propagator.resyncCount();
+
+    // a jump far ahead, and one back, land on the orbits whether the warm start converges or not
+    date += JulianDays{400.0};
+    requireClosedForm(propagator, orbits, date);
+    date -= JulianDays{150.0};
+    requireClosedForm(propagator, orbits, date);
+    REQUIRE(propagator.resyncCount() > resyncCount);
+
+    // and the steps that follow carry on from there
+    for (int frame = 0; frame < 10; ++frame, date += JulianDays{0.5})
+        requireClosedForm(propagator, orbits, date);
+}
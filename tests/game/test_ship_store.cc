@@ -0,0 +1,52 @@
+#include <game/universe.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <vector>
+
+TEST_CASE("handles", "[ship_store]")
+{
+    const std::array items = {MarketItem{.id = 0}, MarketItem{.id = 1}};
+    ShipStore store;
+    store.setCargoItems({&items[0], &items[1]});
+
+    const auto a = store.add(nullptr, nullptr, "a");
+    const auto b = store.add(nullptr, nullptr, "b");
+    const auto c = store.add(nullptr, nullptr, "c");
+    store.setCargo(store.index(c), std::vector{3, 4});
+    REQUIRE(store.size() == 3);
+    REQUIRE(store.slotCount() == 3);
+
+    // the last ship takes the place of the removed one, along with its components
+    store.remove(a);
+    REQUIRE(!store.contains(a));
+    REQUIRE(store.contains(b));
+    REQUIRE(store.contains(c));
+    REQUIRE(store.size() == 2);
+    REQUIRE(store.index(c) == 0);
+    REQUIRE(store.handles[0] == c);
+    REQUIRE(store.names[0] == "c");
+    REQUIRE(store.cargo(0)[1] == 4);
+    REQUIRE(store.cargoTotal(0) == 7);
+    REQUIRE(store.index(b) == 1);
+    REQUIRE(store.names[1] == "b");
+
+    // the slot is reused with another generation, the old handle stays stale
+    const auto d = store.add(nullptr, nullptr, "d");
+    REQUIRE(d.slot == a.slot);
+    REQUIRE(d.generation == a.generation + 1);
+    REQUIRE(d != a);
+    REQUIRE(store.contains(d));
+    REQUIRE(!store.contains(a));
+    REQUIRE(store.slotCount() == 3);
+    REQUIRE(store.index(d) == 2);
+    REQUIRE(store.cargoTotal(2) == 0);
+
+    // removing the last ship moves nothing
+    store.remove(d);
+    REQUIRE(!store.contains(d));
+    REQUIRE(store.index(c) == 0);
+    REQUIRE(store.index(b) == 1);
+    REQUIRE(!store.contains(ShipHandle{.slot = 3}));
+}
@@ -0,0 +1,133 @@
+#include <game/sky_cells.h>
+#include <game/starfield.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+
+Starfield randomStarfield(std::size_t starCount)
+{
+    std::mt19937 generator(starCount);
+    std::uniform_real_distribution<float> rightAscension(0.0f, glm::radians(360.0f));
+    std::uniform_real_distribution<float> sinDeclination(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> magnitude(-1.5f, 12.0f);
+    Starfield starfield;
+    for (std::size_t i = 0; i < starCount; ++i)
+        starfield.add({}, rightAscension(generator), std::asin(sinDeclination(generator)), SpectralClass::G,
+                      magnitude(generator));
+    return starfield;
+}
+
+// Looking at right ascension 0, declination 0.
+glm::mat4 viewProjection(float fieldOfView)
+{
+    const auto projection = glm::perspective(fieldOfView, 16.0f / 9.0f, 0.1f, 100.0f);
+    const auto view = glm::lookAt(glm::vec3{0.0f}, glm::vec3{1.0f, 0.0f, 0.0f}, glm::vec3{0.0f, 0.0f, 1.0f});
+    return projection * view;
+}
+
+bool selected(const std::vector<InstanceRange> &ranges, std::uint32_t instance)
+{
+    return std::ranges::any_of(ranges, [instance](const auto &range) {
+        return instance >= range.begin && instance < range.begin + range.count;
+    });
+}
+
+std::uint32_t instanceOf(const SkyCells &cells, std::uint32_t star)
+{
+    return static_cast<std::uint32_t>(std::ranges::find(cells.stars(), star) - cells.stars().begin());
+}
+
+} // namespace
+
+TEST_CASE("cell index", "[sky_cells]")
+{
+    for (const auto resolution : {1, 2, 8})
+    {
+        const auto cellCount = SkyCells::cellCount(resolution);
+        std::vector<int> hits(cellCount);
+        std::mt19937 generator(resolution);
+        std::normal_distribution<float> distribution;
+        for (int i = 0; i < 100'000; ++i)
+        {
+            const auto direction =
+                glm::normalize(glm::vec3{distribution(generator), distribution(generator), distribution(generator)});
+            const auto cell = SkyCells::cellIndex(resolution, direction);
+            REQUIRE(cell < cellCount);
+            ++hits[cell];
+        }
+        // equal areas, none of them left empty
+        REQUIRE(std::ranges::none_of(hits, [](int count) { return count == 0; }));
+    }
+    REQUIRE(SkyCells::cellIndex(8, {0.0f, 0.0f, 1.0f}) < 4);
+    REQUIRE(SkyCells::cellIndex(8, {0.0f, 0.0f, -1.0f}) >= SkyCells::cellCount(8) - 4);
+}
+
+TEST_CASE("instances", "[sky_cells]")
+{
+    const auto starfield = randomStarfield(10'000);
+    const SkyCells cells(starfield);
+    REQUIRE(cells.instances().size() == starfield.size());
+    REQUIRE(cells.stars().size() == starfield.size());
+
+    std::size_t instanceCount = 0;
+    for (const auto &cell : cells.cells())
+    {
+        REQUIRE(cell.begin == instanceCount);
+        REQUIRE(cell.count > 0);
+        const auto stars = cells.stars().subspan(cell.begin, cell.count);
+        const auto magnitude = [&starfield](std::uint32_t star) { return starfield.apparentMagnitudes()[star]; };
+        REQUIRE(std::ranges::is_sorted(stars, {}, magnitude));
+        instanceCount += cell.count;
+    }
+    REQUIRE(instanceCount == starfield.size());
+}
+
+TEST_CASE("selection", "[sky_cells]")
+{
+    Starfield starfield = randomStarfield(10'000);
+    const auto ahead = static_cast<std::uint32_t>(starfield.size());
+    starfield.add("ahead", 0.0f, 0.0f, SpectralClass::A, 1.0f);
+    const auto behind = static_cast<std::uint32_t>(starfield.size());
+    starfield.add("behind", glm::radians(180.0f), 0.0f, SpectralClass::A, 1.0f);
+    const auto faint = static_cast<std::uint32_t>(starfield.size());
+    starfield.add("faint", glm::radians(1.0f), glm::radians(1.0f), SpectralClass::M, 11.0f);
+    const SkyCells cells(starfield);
+
+    const auto fieldOfView = glm::radians(45.0f);
+    std::vector<InstanceRange> ranges;
+    cells.select(viewProjection(fieldOfView), cells.magnitudeLimit(fieldOfView), ranges);
+    REQUIRE(selected(ranges, instanceOf(cells, ahead)));
+    REQUIRE(!selected(ranges, instanceOf(cells, behind)));
+    REQUIRE(!selected(ranges, instanceOf(cells, faint)));
+
+    // a small part of the sky in view, down to magnitude 6.5
+    std::uint32_t selectedCount = 0;
+    for (const auto &range : ranges)
+        selectedCount += range.count;
+    REQUIRE(selectedCount < starfield.size() / 4);
+
+    cells.select(viewProjection(fieldOfView), 12.0f, ranges);
+    REQUIRE(selected(ranges, instanceOf(cells, faint)));
+
+    // merged ranges
+    for (std::size_t i = 1; i < ranges.size(); ++i)
+        REQUIRE(ranges[i - 1].begin + ranges[i - 1].count < ranges[i].begin);
+}
+
+TEST_CASE("magnitude limit", "[sky_cells]")
+{
+    const SkyCells cells(randomStarfield(100));
+    const auto &settings = cells.settings();
+    REQUIRE(cells.magnitudeLimit(settings.referenceFieldOfView) == settings.magnitudeLimit);
+    REQUIRE(cells.magnitudeLimit(0.5f * settings.referenceFieldOfView) ==
+            settings.magnitudeLimit + settings.magnitudesPerZoom);
+    REQUIRE(cells.magnitudeLimit(2.0f * settings.referenceFieldOfView) < settings.magnitudeLimit);
+}
@@ -0,0 +1,241 @@
+#include <game/compiled_assets.h>
+#include <game/starfield.h>
+
+#include <base/file.h>
+#include <base/thread_pool.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <span>
+
+namespace
+{
+
+// A proper name, escaped for JSON and quoted for CSV. Empty names are left out of the JSON objects.
+struct CatalogName
+{
+    std::string_view name;
+    std::string_view json;
+    std::string_view csv;
+};
+
+constexpr std::array kNames = {
+    CatalogName{"", "", ""},
+    CatalogName{"Sirius", R"("Sirius")", "Sirius"},
+    CatalogName{"Tab\tQuote\"Back\\slash/", R"("Tab\tQuote\"Back\\slash\/")", "\"Tab\tQuote\"\"Back\\slash/\""},
+    CatalogName{"Comma, brace}", R"("Comma, brace}")", R"("Comma, brace}")"},
+    CatalogName{"\u00e9 \u2609 \U0001d538", R"("\u00e9 \u2609 \ud835\udd38")", "\"\u00e9 \u2609 \U0001d538\""},
+};
+
+// looks like the start of a star to the chunking of the JSON parser
+constexpr auto kBraceName = CatalogName{"Comma, {brace", R"("Comma, {brace")", R"("Comma, {brace")"};
+
+constexpr std::string_view kSpectralTypes = "OBAFGKM";
+
+// More than a couple of chunks of each format, every star with values exact in decimal and in float, right ascensions
+// in multiples of a quarter of an hour.
+constexpr std::size_t kStarCount = 40'000;
+
+float rightAscensionHours(std::size_t star)
+{
+    return 0.25f * static_cast<float>(star % 96);
+}
+
+float declination(std::size_t star)
+{
+    return static_cast<float>(star % 180) - 89.5f;
+}
+
+float magnitude(std::size_t star)
+{
+    return 0.125f * static_cast<float>(star % 100) - 1.5f;
+}
+
+std::string writeJson(std::size_t starCount, std::span<const CatalogName> names = kNames)
+{
+    const auto path = (std::filesystem::temp_directory_path() / "sundog-test-starfield.json").string();
+    std::ofstream json(path);
+    json << "[\n";
+    for (std::size_t i = 0; i < starCount; ++i)
+    {
+        const auto &name = names[i % names.size()];
+        json << std::format("{}  {{\"bayer_name\": \"HIP {}\", ", i == 0 ? "" : ",\n", i);
+        if (!name.name.empty())
+            json << std::format("\"proper_name\": {}, ", name.json);
+        json << std::format("\"right_ascension\": {}, \"declination\": {}, \"spectral_type\": \"{}V\", "
+                            "\"apparent_magnitude\": {}}}",
+                            15.0f * rightAscensionHours(i), declination(i), kSpectralTypes[i % kSpectralTypes.size()],
+                            magnitude(i));
+    }
+    json << "\n]\n";
+    return path;
+}
+
+std::string writeCsv(std::size_t starCount)
+{
+    const auto path = (std::filesystem::temp_directory_path() / "sundog-test-starfield.csv").string();
+    std::ofstream csv(path);
+    csv << "id,proper,ra,dec,mag,spect\r\n";
+    for (std::size_t i = 0; i < starCount; ++i)
+    {
+        csv << std::format("{},{},{},{},{},{}V\r\n", i, kNames[i % kNames.size()].csv, rightAscensionHours(i),
+                           declination(i), magnitude(i), kSpectralTypes[i % kSpectralTypes.size()]);
+    }
+    return path;
+}
+
+std::string writeText(std::string_view name, std::string_view text)
+{
+    const auto path = (std::filesystem::temp_directory_path() / name).string();
+    std::ofstream(path) << text;
+    return path;
+}
+
+void requireSameStars(const Starfield &lhs, const Starfield &rhs)
+{
+    REQUIRE(std::ranges::equal(lhs.rightAscensions(), rhs.rightAscensions()));
+    REQUIRE(std::ranges::equal(lhs.declinations(), rhs.declinations()));
+    REQUIRE(std::ranges::equal(lhs.apparentMagnitudes(), rhs.apparentMagnitudes()));
+    REQUIRE(std::ranges::equal(lhs.spectralClasses(), rhs.spectralClasses()));
+    REQUIRE(lhs.size() == rhs.size());
+    for (std::size_t i = 0; i < lhs.size(); ++i)
+        REQUIRE(lhs.properName(i) == rhs.properName(i));
+}
+
+} // namespace
+
+TEST_CASE("json and csv catalogs", "[starfield]")
+{
+    const auto jsonPath = writeJson(kStarCount);
+    const auto csvPath = writeCsv(kStarCount);
+    ThreadPool threadPool(3);
+
+    Starfield json;
+    REQUIRE(json.loadJson(jsonPath));
+    REQUIRE(json.size() == kStarCount);
+    for (std::size_t i = 0; i < kStarCount; ++i)
+    {
+        REQUIRE(json.properName(i) == kNames[i % kNames.size()].name);
+        REQUIRE(json.rightAscensions()[i] == glm::radians(15.0f * rightAscensionHours(i)));
+        REQUIRE(json.declinations()[i] == glm::radians(declination(i)));
+        REQUIRE(json.apparentMagnitudes()[i] == magnitude(i));
+        REQUIRE(json.spectralClasses()[i] == static_cast<SpectralClass>(i % kSpectralTypes.size()));
+    }
+
+    // the same stars whatever the format and the number of threads, right ascensions in hours in the CSV
+    Starfield parallelJson;
+    REQUIRE(parallelJson.loadJson(jsonPath, &threadPool));
+    requireSameStars(json, parallelJson);
+    Starfield csv;
+    REQUIRE(csv.loadCsv(csvPath));
+    requireSameStars(json, csv);
+    Starfield parallelCsv;
+    REQUIRE(parallelCsv.loadCsv(csvPath, &threadPool));
+    requireSameStars(json, parallelCsv);
+
+    std::filesystem::remove(jsonPath);
+    std::filesystem::remove(csvPath);
+}
+
+TEST_CASE("json chunk split inside a string", "[starfield]")
+{
+    const auto jsonPath = writeJson(kStarCount, std::span{&kBraceName, 1});
+    ThreadPool threadPool(3);
+    Starfield starfield;
+    REQUIRE(starfield.loadJson(jsonPath, &threadPool));
+    REQUIRE(starfield.size() == kStarCount);
+    REQUIRE(starfield.properName(kStarCount - 1) == kBraceName.name);
+    std::filesystem::remove(jsonPath);
+}
+
+TEST_CASE("small catalogs", "[starfield]")
+{
+    Starfield starfield;
+    REQUIRE(starfield.loadJson(writeText("sundog-test-starfield-empty.json", " [ ] ")));
+    REQUIRE(starfield.size() == 0);
+
+    const auto json = writeText("sundog-test-starfield-small.json",
+                                R"([{"right_ascension": 90, "declination": -45, "apparent_magnitude": 1.5,)"
+                                R"( "proper_name": "A \"B\" C"}])");
+    REQUIRE(starfield.loadJson(json));
+    REQUIRE(starfield.size() == 1);
+    REQUIRE(starfield.properName(0) == "A \"B\" C");
+    REQUIRE(starfield.rightAscensions()[0] == glm::radians(90.0f));
+    REQUIRE(starfield.declinations()[0] == glm::radians(-45.0f));
+    REQUIRE(starfield.spectralClasses()[0] == SpectralClass::A);
+
+    const auto csv = writeText("sundog-test-starfield-small.csv", "ra,dec,mag\n6,-45,1.5\n\n");
+    REQUIRE(starfield.loadCsv(csv));
+    REQUIRE(starfield.size() == 1);
+    REQUIRE(starfield.properName(0).empty());
+    REQUIRE(starfield.rightAscensions()[0] == glm::radians(90.0f));
+}
+
+TEST_CASE("invalid catalogs", "[starfield]")
+{
+    Starfield starfield;
+    starfield.add("Sol", 0.0f, 0.0f, SpectralClass::G, -26.7f);
+
+    // left untouched
+    for (const auto &[name, text] :
+         {std::pair{"sundog-test-starfield-missing.json", R"([{"right_ascension": 1, "declination": 2}])"},
+          std::pair{"sundog-test-starfield-unterminated.json", R"([{"right_ascension": 1, "declination": 2, )"
+                                                               R"("apparent_magnitude": 3, "proper_name": "A)"},
+          std::pair{"sundog-test-starfield-surrogate.json", R"([{"right_ascension": 1, "declination": 2, )"
+                                                            R"("apparent_magnitude": 3, "proper_name": "\ud835"}])"}})
+    {
+        REQUIRE(!starfield.loadJson(writeText(name, text)));
+        REQUIRE(starfield.size() == 1);
+    }
+    REQUIRE(!starfield.loadCsv(writeText("sundog-test-starfield-header.csv", "ra,mag\n1,2\n")));
+    REQUIRE(!starfield.loadCsv(writeText("sundog-test-starfield-number.csv", "ra,dec,mag\n1,2,x\n")));
+    REQUIRE(!starfield.loadCsv(writeText("sundog-test-starfield-columns.csv", "ra,dec,mag\n1,2\n")));
+    REQUIRE(starfield.size() == 1);
+    REQUIRE(starfield.properName(0) == "Sol");
+}
+
+TEST_CASE("compiled asset", "[starfield]")
+{
+    const auto jsonPath = writeJson(1000);
+    Starfield json;
+    REQUIRE(json.loadJson(jsonPath));
+    const auto assetPath = compiledAssetPath(jsonPath);
+    REQUIRE(writeFile(assetPath, StarfieldAsset::compile(json)));
+
+    // read in place from the mapping, moved along with the starfield
+    Starfield mapped;
+    REQUIRE(StarfieldAsset::load(mapped, MappedFile(assetPath)));
+    REQUIRE(mapped.isMapped());
+    const auto moved = std::move(mapped);
+    REQUIRE(moved.isMapped());
+    requireSameStars(json, moved);
+
+    Starfield copied;
+    REQUIRE(StarfieldAsset::load(copied, MappedFile(assetPath).data()));
+    REQUIRE(!copied.isMapped());
+    requireSameStars(json, copied);
+
+    // copied out of the mapping before a change
+    Starfield changed;
+    REQUIRE(changed.load(jsonPath));
+    REQUIRE(changed.isMapped());
+    changed.add("Sol", 0.0f, 0.0f, SpectralClass::G, -26.7f);
+    REQUIRE(!changed.isMapped());
+    REQUIRE(changed.size() == json.size() + 1);
+    REQUIRE(changed.properName(json.size()) == "Sol");
+    REQUIRE(changed.properName(2) == json.properName(2));
+    REQUIRE(changed.rightAscensions()[3] == json.rightAscensions()[3]);
+
+    REQUIRE(!StarfieldAsset::load(changed, MappedFile(jsonPath)));
+    REQUIRE(changed.size() == json.size() + 1);
+
+    std::filesystem::remove(jsonPath);
+    std::filesystem::remove(assetPath);
+}
@@ -0,0 +1,123 @@
+#include <base/task_graph.h>
+#include <base/thread_pool.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+TEST_CASE("dependency order", "[task_graph]")
+{
+    // random dependencies on up to three of the tasks added before
+    constexpr std::size_t kTaskCount = 200;
+    std::mt19937 generator(1234);
+    std::vector<std::vector<TaskGraph::TaskId>> dependencies(kTaskCount);
+    for (std::size_t id = 1; id < kTaskCount; ++id)
+    {
+        std::uniform_int_distribution<TaskGraph::TaskId> dependency(0, id - 1);
+        const auto count = std::uniform_int_distribution<int>(0, 3)(generator);
+        for (int i = 0; i < count; ++i)
+            dependencies[id].push_back(dependency(generator));
+    }
+
+    // each task takes a ticket when it runs, which must come after the tickets of its dependencies, and checks that
+    // they're done (assertions are made on the test thread only)
+    std::atomic<std::size_t> nextTicket{0};
+    std::vector<std::size_t> tickets(kTaskCount);
+    std::vector<std::atomic<int>> runCounts(kTaskCount);
+    std::atomic<bool> ranEarly{false};
+    TaskGraph graph;
+    for (std::size_t id = 0; id < kTaskCount; ++id)
+    {
+        const auto task = [&, id] {
+            for (const auto dependency : dependencies[id])
+            {
+                if (runCounts[dependency].load() != runCounts[id].load() + 1)
+                    ranEarly.store(true);
+            }
+            tickets[id] = nextTicket++;
+            ++runCounts[id];
+        };
+        const auto &d = dependencies[id];
+        switch (d.size())
+        {
+        case 0:
+            graph.add(task);
+            break;
+        case 1:
+            graph.add(task, {d[0]});
+            break;
+        case 2:
+            graph.add(task, {d[0], d[1]});
+            break;
+        default:
+            graph.add(task, {d[0], d[1], d[2]});
+            break;
+        }
+    }
+    REQUIRE(graph.size() == kTaskCount);
+
+    const auto requireOrder = [&](int runs) {
+        REQUIRE(!ranEarly.load());
+        for (std::size_t id = 0; id < kTaskCount; ++id)
+        {
+            REQUIRE(runCounts[id].load() == runs);
+            for (const auto dependency : dependencies[id])
+                REQUIRE(tickets[dependency] < tickets[id]);
+        }
+    };
+
+    // inline, in the order the tasks were added
+    graph.run(nullptr);
+    requireOrder(1);
+    for (std::size_t id = 0; id < kTaskCount; ++id)
+        REQUIRE(tickets[id] == id);
+
+    // and on a pool, any number of times
+    ThreadPool threadPool(4);
+    for (int run = 2; run <= 20; ++run)
+    {
+        graph.run(&threadPool);
+        requireOrder(run);
+    }
+}
+
+TEST_CASE("other work on the pool", "[task_graph]")
+{
+    ThreadPool threadPool(1);
+
+    // the only worker is kept busy, with another job queued behind it
+    std::atomic<bool> started{false};
+    std::atomic<bool> released{false};
+    std::atomic<bool> queuedRan{false};
+    threadPool.submit([&] {
+        started.store(true);
+        while (!released.load())
+            std::this_thread::yield();
+    });
+    while (!started.load())
+        std::this_thread::yield();
+    threadPool.submit([&queuedRan] { queuedRan.store(true); });
+
+    // so the graph runs on the waiting thread, which leaves the queued job to the worker
+    const auto callerId = std::this_thread::get_id();
+    std::vector<std::thread::id> threadIds(3);
+    TaskGraph graph;
+    const auto first = graph.add([&] { threadIds[0] = std::this_thread::get_id(); });
+    const auto second = graph.add([&] { threadIds[1] = std::this_thread::get_id(); }, {first});
+    graph.add([&] { threadIds[2] = std::this_thread::get_id(); }, {second});
+    graph.run(&threadPool);
+    REQUIRE(threadIds == std::vector{callerId, callerId, callerId});
+    REQUIRE(!queuedRan.load());
+
+    // and so does a parallelFor
+    std::atomic<int> sum{0};
+    threadPool.parallelFor(10, 1, [&sum](std::size_t begin, std::size_t) { sum += static_cast<int>(begin); });
+    REQUIRE(sum.load() == 45);
+    REQUIRE(!queuedRan.load());
+
+    released.store(true);
+    threadPool.waitUntil(ThreadPool::kNoGroup, [&queuedRan] { return queuedRan.load(); });
+}
@@ -0,0 +1,67 @@
+#include <game/universe.h>
+#include <game/universe_snapshot.h>
+
+#include <base/asset_path.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <format>
+#include <span>
+#include <vector>
+
+TEST_CASE("round trip", "[universe_snapshot]")
+{
+    Universe universe;
+    universe.setRandomSeed(1234);
+    REQUIRE(universe.load(dataFilePath("universe.json")));
+    const auto start = toJulianDate(std::chrono::year_month_day{std::chrono::year{2026}, std::chrono::January,
+                                                                std::chrono::day{1}});
+    universe.setDate(start);
+
+    // ships docked, in transit and arrived, with a removed one to leave a free slot
+    const auto worlds = universe.worlds();
+    const auto shipClasses = universe.shipClasses();
+    for (std::size_t i = 0; i < 12; ++i)
+    {
+        const auto *origin = worlds[i % worlds.size()];
+        auto *ship = universe.addShip(shipClasses[i % shipClasses.size()], origin, std::format("Ship {}", i));
+        if (i % 3 == 0)
+            continue;
+        const auto a = 1.2 + 0.1 * static_cast<double>(i);
+        const OrbitalElements elements{.epoch = start,
+                                       .semiMajorAxis = a,
+                                       .eccentricity = 1.0 - 1.0 / a,
+                                       .longitudePerihelion = 0.5 * static_cast<double>(i)};
+        const auto departureDate = start + JulianDays{static_cast<double>(i % 4)};
+        ship->setMissionPlan(MissionPlan{.origin = origin,
+                                         .destination = worlds[(i + 1) % worlds.size()],
+                                         .departureDate = departureDate,
+                                         .arrivalDate = departureDate + JulianDays{i % 2 == 0 ? 1.0 : 100.0},
+                                         .orbit = Orbit(elements),
+                                         .deltaVDeparture = 0.01,
+                                         .deltaVArrival = 0.02});
+    }
+    universe.removeShip(universe.ships()[4]);
+    universe.update(JulianDays{2.5});
+
+    std::vector<std::byte> snapshot;
+    UniverseSnapshot::capture(universe, snapshot);
+    Universe restored;
+    REQUIRE(UniverseSnapshot::restore(restored, snapshot));
+    std::vector<std::byte> restoredSnapshot;
+    UniverseSnapshot::capture(restored, restoredSnapshot);
+    REQUIRE(restoredSnapshot == snapshot);
+
+    // and the restored universe carries on the same: departures and arrivals still due, market ticks
+    universe.update(JulianDays{10.0});
+    restored.update(JulianDays{10.0});
+    UniverseSnapshot::capture(universe, snapshot);
+    UniverseSnapshot::capture(restored, restoredSnapshot);
+    REQUIRE(restoredSnapshot == snapshot);
+
+    // only into a universe that wasn't loaded, and left untouched by a truncated snapshot
+    REQUIRE(!UniverseSnapshot::restore(restored, snapshot));
+    Universe truncated;
+    REQUIRE(!UniverseSnapshot::restore(truncated, std::span{snapshot}.first(snapshot.size() / 2)));
+    REQUIRE(truncated.worlds().empty());
+}
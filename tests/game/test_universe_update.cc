@@ -0,0 +1,107 @@
+#include <game/universe.h>
+#include <game/universe_snapshot.h>
+
+#include <base/asset_path.h>
+#include <base/thread_pool.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <format>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+struct UpdateResult
+{
+    std::vector<std::byte> snapshot;
+    std::vector<std::pair<ShipHandle, Ship::State>> stateChanges;
+    int priceChanges{0};
+    std::vector<glm::dvec3> worldPositions; // after every update
+    std::vector<glm::dvec3> shipPositions;
+};
+
+// Updates a universe with ships coming and going between the worlds, enough of them in transit for their update to
+// be split across the pool, with a jump halfway through.
+UpdateResult runUpdates(Universe::Propagation propagation, std::size_t threadCount)
+{
+    const auto threadPool = threadCount > 0 ? std::make_unique<ThreadPool>(threadCount) : nullptr;
+    Universe universe;
+    universe.setRandomSeed(1234);
+    REQUIRE(universe.load(dataFilePath("universe.json")));
+    const auto start = toJulianDate(std::chrono::year_month_day{std::chrono::year{2026}, std::chrono::January,
+                                                                std::chrono::day{1}});
+    universe.setDate(start);
+    universe.setPropagation(propagation);
+    universe.setThreadPool(threadPool.get());
+
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<double> semiMajorAxis(1.2, 3.0);
+    std::uniform_real_distribution<double> angle(0.0, 2.0 * glm::pi<double>());
+    std::uniform_real_distribution<double> departure(0.0, 20.0);
+    std::uniform_real_distribution<double> transitTime(0.5, 30.0);
+    const auto worlds = universe.worlds();
+    for (std::size_t i = 0; i < 10'000; ++i)
+    {
+        const auto *origin = worlds[i % worlds.size()];
+        auto *ship = universe.addShip(universe.shipClasses()[0], origin, std::format("Ship {}", i));
+        const auto a = semiMajorAxis(generator);
+        const OrbitalElements elements{.epoch = start,
+                                       .semiMajorAxis = a,
+                                       .eccentricity = 1.0 - 1.0 / a,
+                                       .longitudePerihelion = angle(generator)};
+        const auto departureDate = start + JulianDays{departure(generator)};
+        ship->setMissionPlan(MissionPlan{.origin = origin,
+                                         .destination = worlds[(i + 1) % worlds.size()],
+                                         .departureDate = departureDate,
+                                         .arrivalDate = departureDate + JulianDays{transitTime(generator)},
+                                         .orbit = Orbit(elements)});
+    }
+
+    UpdateResult result;
+    universe.shipStateChangedSignal.connect(
+        [&result](Ship *ship, Ship::State state) { result.stateChanges.emplace_back(ship->handle(), state); });
+    universe.marketPricesChangedSignal.connect([&result] { ++result.priceChanges; });
+
+    // past the point where the next fit of the world ephemeris is made ahead, and across a jump
+    const auto update = [&] {
+        universe.update(JulianDays{0.25});
+        for (const auto *world : universe.worlds())
+            result.worldPositions.push_back(world->currentPosition());
+    };
+    for (int frame = 0; frame < 160; ++frame)
+        update();
+    universe.setDate(universe.date() + JulianDays{100.0});
+    for (int frame = 0; frame < 20; ++frame)
+        update();
+
+    UniverseSnapshot::capture(universe, result.snapshot);
+    for (const auto *ship : universe.ships())
+        result.shipPositions.push_back(ship->currentPosition());
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("thread count", "[universe]")
+{
+    // the same positions, state, and signals in the same order, without a pool and with one or several workers
+    for (const auto propagation : {Universe::Propagation::ClosedForm, Universe::Propagation::Incremental})
+    {
+        const auto reference = runUpdates(propagation, 0);
+        REQUIRE(!reference.stateChanges.empty());
+        REQUIRE(reference.priceChanges > 0);
+        for (const auto threadCount : {1, 4})
+        {
+            const auto result = runUpdates(propagation, threadCount);
+            REQUIRE(result.snapshot == reference.snapshot);
+            REQUIRE(result.stateChanges == reference.stateChanges);
+            REQUIRE(result.priceChanges == reference.priceChanges);
+            REQUIRE(result.worldPositions == reference.worldPositions);
+            REQUIRE(result.shipPositions == reference.shipPositions);
+        }
+    }
+}